@@ -197,6 +197,25 @@ inline static MpgxResult setVkBufferData(
 	return SUCCESS_MPGX_RESULT;
 }
 
+inline static bool isVkHeapBudgetEnough(
+	VmaAllocator allocator,
+	uint32_t heapIndex,
+	VkDeviceSize size)
+{
+	assert(allocator);
+	assert(heapIndex < VK_MAX_MEMORY_HEAPS);
+	assert(size > 0);
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+
+	vmaGetHeapBudgets(
+		allocator,
+		budgets);
+
+	VmaBudget budget = budgets[heapIndex];
+	return budget.usage + size <= budget.budget;
+}
+
 inline static void destroyVkBuffer(
 	VmaAllocator allocator,
 	Buffer buffer)
@@ -218,6 +237,7 @@ inline static MpgxResult createVkBuffer(
 	VkBuffer* stagingBuffer,
 	VmaAllocation* stagingAllocation,
 	size_t* stagingSize,
+	uint32_t resizableBarHeapIndex,
 	Window window,
 	BufferType type,
 	BufferUsage usage,
@@ -327,14 +347,42 @@ inline static MpgxResult createVkBuffer(
 
 	VkBuffer handle;
 	VmaAllocation allocation;
+	VkResult vkResult;
+	bool isAllocated = false;
+
+	// Resizable BAR: write initial data directly to the
+	// host visible VRAM, without staging buffer and queue wait.
+	if (data && !isIntegrated &&
+		usage == GPU_ONLY_BUFFER_USAGE &&
+		resizableBarHeapIndex != UINT32_MAX &&
+		isVkHeapBudgetEnough(allocator, resizableBarHeapIndex, size))
+	{
+		allocationCreateInfo.requiredFlags =
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
 
-	VkResult vkResult = vmaCreateBuffer(
-		allocator,
-		&bufferCreateInfo,
-		&allocationCreateInfo,
-		&handle,
-		&allocation,
-		NULL);
+		vkResult = vmaCreateBuffer(
+			allocator,
+			&bufferCreateInfo,
+			&allocationCreateInfo,
+			&handle,
+			&allocation,
+			NULL);
+
+		allocationCreateInfo.requiredFlags = 0;
+		isAllocated = vkResult == VK_SUCCESS;
+	}
+
+	if (!isAllocated)
+	{
+		vkResult = vmaCreateBuffer(
+			allocator,
+			&bufferCreateInfo,
+			&allocationCreateInfo,
+			&handle,
+			&allocation,
+			NULL);
+	}
 
 	if (vkResult != VK_SUCCESS)
 	{
@@ -466,6 +514,324 @@ inline static MpgxResult createVkBuffer(
 	*buffer = bufferInstance;
 	return SUCCESS_MPGX_RESULT;
 }
+
+inline static MpgxResult reserveVkStagingBuffer(
+	VmaAllocator allocator,
+	size_t size,
+	VkBuffer* stagingBuffer,
+	VmaAllocation* stagingAllocation,
+	size_t* stagingSize)
+{
+	assert(allocator);
+	assert(size > 0);
+	assert(stagingBuffer);
+	assert(stagingAllocation);
+	assert(stagingSize);
+
+	if (size <= *stagingSize)
+		return SUCCESS_MPGX_RESULT;
+
+	VkBufferCreateInfo bufferCreateInfo = {
+		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		NULL,
+		0,
+		size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		NULL,
+	};
+
+	VmaAllocationCreateInfo allocationCreateInfo;
+	memset(&allocationCreateInfo, 0, sizeof(VmaAllocationCreateInfo));
+
+	allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+	allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+	VkBuffer stagingBufferInstance;
+	VmaAllocation stagingAllocationInstance;
+
+	VkResult vkResult = vmaCreateBuffer(
+		allocator,
+		&bufferCreateInfo,
+		&allocationCreateInfo,
+		&stagingBufferInstance,
+		&stagingAllocationInstance,
+		NULL);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	vmaDestroyBuffer(
+		allocator,
+		*stagingBuffer,
+		*stagingAllocation);
+
+	*stagingBuffer = stagingBufferInstance;
+	*stagingAllocation = stagingAllocationInstance;
+	*stagingSize = size;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult setVkBuffersData(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkQueue transferQueue,
+	VkCommandBuffer transferCommandBuffer,
+	VkFence transferFence,
+	VkBuffer* stagingBuffer,
+	VmaAllocation* stagingAllocation,
+	size_t* stagingSize,
+	const BufferDataInfo* infos,
+	size_t infoCount)
+{
+	assert(device);
+	assert(allocator);
+	assert(transferQueue);
+	assert(transferCommandBuffer);
+	assert(transferFence);
+	assert(stagingBuffer);
+	assert(stagingAllocation);
+	assert(stagingSize);
+	assert(infos);
+	assert(infoCount > 0);
+
+	size_t* stagingOffsets = malloc(
+		infoCount * sizeof(size_t));
+
+	if (!stagingOffsets)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	VmaAllocation* flushAllocations = malloc(
+		infoCount * sizeof(VmaAllocation));
+
+	if (!flushAllocations)
+	{
+		free(stagingOffsets);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	VkDeviceSize* flushOffsets = malloc(
+		infoCount * sizeof(VkDeviceSize) * 2);
+
+	if (!flushOffsets)
+	{
+		free(flushAllocations);
+		free(stagingOffsets);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	VkDeviceSize* flushSizes = flushOffsets + infoCount;
+	uint32_t flushCount = 0;
+	size_t stagingDataSize = 0;
+
+	// Host visible buffers are written directly and flushed
+	// at once, others are copied through the staging buffer.
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		const BufferDataInfo* info = &infos[i];
+		Buffer buffer = info->buffer;
+
+		assert(buffer);
+		assert(info->data);
+		assert(info->size > 0);
+		assert(info->size + info->offset <= buffer->vk.size);
+		assert(!buffer->vk.isMapped);
+		assert(buffer->vk.window == infos[0].buffer->vk.window);
+
+		VmaAllocationInfo allocationInfo;
+
+		vmaGetAllocationInfo(
+			allocator,
+			buffer->vk.allocation,
+			&allocationInfo);
+
+		VkMemoryPropertyFlags memoryPropertyFlags;
+
+		vmaGetMemoryTypeProperties(
+			allocator,
+			allocationInfo.memoryType,
+			&memoryPropertyFlags);
+
+		if (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			stagingOffsets[i] = SIZE_MAX;
+			continue;
+		}
+
+		assert(buffer->vk.type & TRANSFER_DESTINATION_BUFFER_TYPE);
+		stagingOffsets[i] = stagingDataSize;
+		stagingDataSize += info->size;
+	}
+
+	MpgxResult mpgxResult;
+	VkResult vkResult;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		if (stagingOffsets[i] != SIZE_MAX)
+			continue;
+
+		const BufferDataInfo* info = &infos[i];
+		VmaAllocation allocation = info->buffer->vk.allocation;
+		void* mappedData;
+
+		vkResult = vmaMapMemory(
+			allocator,
+			allocation,
+			&mappedData);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			free(flushOffsets);
+			free(flushAllocations);
+			free(stagingOffsets);
+			return vkToMpgxResult(vkResult);
+		}
+
+		uint8_t* mappedBytes = mappedData;
+		memcpy(mappedBytes + info->offset, info->data, info->size);
+
+		vmaUnmapMemory(
+			allocator,
+			allocation);
+
+		flushAllocations[flushCount] = allocation;
+		flushOffsets[flushCount] = info->offset;
+		flushSizes[flushCount] = info->size;
+		flushCount++;
+	}
+
+	if (flushCount > 0)
+	{
+		vkResult = vmaFlushAllocations(
+			allocator,
+			flushCount,
+			flushAllocations,
+			flushOffsets,
+			flushSizes);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			free(flushOffsets);
+			free(flushAllocations);
+			free(stagingOffsets);
+			return vkToMpgxResult(vkResult);
+		}
+	}
+
+	free(flushOffsets);
+	free(flushAllocations);
+
+	if (stagingDataSize == 0)
+	{
+		free(stagingOffsets);
+		return SUCCESS_MPGX_RESULT;
+	}
+
+	mpgxResult = reserveVkStagingBuffer(
+		allocator,
+		stagingDataSize,
+		stagingBuffer,
+		stagingAllocation,
+		stagingSize);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	void* mapData;
+
+	mpgxResult = mapVkBuffer(
+		allocator,
+		*stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		stagingDataSize,
+		0,
+		&mapData);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	uint8_t* map = (uint8_t*)mapData;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		size_t stagingOffset = stagingOffsets[i];
+
+		if (stagingOffset == SIZE_MAX)
+			continue;
+
+		memcpy(map + stagingOffset, infos[i].data, infos[i].size);
+	}
+
+	mpgxResult = unmapVkBuffer(
+		allocator,
+		*stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		stagingDataSize,
+		0);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		NULL,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		NULL,
+	};
+
+	vkResult = vkBeginCommandBuffer(
+		transferCommandBuffer,
+		&commandBufferBeginInfo);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		free(stagingOffsets);
+		return vkToMpgxResult(vkResult);
+	}
+
+	VkBuffer stagingBufferInstance = *stagingBuffer;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		size_t stagingOffset = stagingOffsets[i];
+
+		if (stagingOffset == SIZE_MAX)
+			continue;
+
+		const BufferDataInfo* info = &infos[i];
+
+		VkBufferCopy bufferCopy = {
+			stagingOffset,
+			info->offset,
+			info->size,
+		};
+
+		vkCmdCopyBuffer(
+			transferCommandBuffer,
+			stagingBufferInstance,
+			info->buffer->vk.handle,
+			1,
+			&bufferCopy);
+	}
+
+	free(stagingOffsets);
+
+	return endSubmitWaitVkCommandBuffer(
+		device,
+		transferQueue,
+		transferFence,
+		transferCommandBuffer);
+}
 #endif
 
 #if MPGX_SUPPORT_OPENGL
@@ -38,6 +38,8 @@ typedef struct VkComputePipeline_T
 	const char* name;
 #endif
 	VkPipelineCache cache;
+	VkSpecializationInfo* specializationInfo;
+	VkReflectedLayout reflectedLayout;
 	VkPipelineLayout layout;
 	VkPipeline vkHandle;
 } VkComputePipeline_T;
@@ -57,13 +59,121 @@ typedef struct VkComputePipelineCreateData
 	const VkDescriptorSetLayout* setLayouts;
 	uint32_t pushConstantRangeCount;
 	const VkPushConstantRange* pushConstantRanges;
+	const VkSpecializationInfo* specializationInfo;
 } VkComputePipelineCreateData;
+typedef struct VkComputePipelineEntry
+{
+	uint8_t* key;
+	size_t keySize;
+	VkPipeline handle;
+	size_t refCount;
+} VkComputePipelineEntry;
+
+inline static void getVkReflectedComputeCreateData(
+	VkReflectedLayout reflectedLayout,
+	VkComputePipelineCreateData* createData)
+{
+	assert(reflectedLayout);
+	assert(createData);
+
+	VkComputePipelineCreateData createDataInstance = {
+		reflectedLayout->setLayoutCount,
+		reflectedLayout->setLayouts,
+		reflectedLayout->pushConstantRangeCount,
+		&reflectedLayout->pushConstantRange,
+		NULL,
+	};
+
+	*createData = createDataInstance;
+}
+
+inline static MpgxResult createVkComputePipelineKey(
+	Shader shader,
+	const VkComputePipelineCreateData* createData,
+	uint8_t** key,
+	size_t* keySize)
+{
+	assert(shader);
+	assert(createData);
+	assert(key);
+	assert(keySize);
+
+	const VkSpecializationInfo* specializationInfo =
+		createData->specializationInfo;
+	uint32_t mapEntryCount = 0;
+	uint64_t dataSize = 0;
+
+	if (specializationInfo)
+	{
+		mapEntryCount = specializationInfo->mapEntryCount;
+		dataSize = specializationInfo->dataSize;
+	}
+
+	size_t setLayoutSize = createData->setLayoutCount *
+		sizeof(VkDescriptorSetLayout);
+	size_t pushConstantSize = createData->pushConstantRangeCount *
+		sizeof(VkPushConstantRange);
+	size_t mapEntrySize = mapEntryCount *
+		sizeof(VkSpecializationMapEntry);
+
+	size_t size = sizeof(uint64_t) * 2 + sizeof(uint32_t) * 3 +
+		sizeof(uint64_t) + setLayoutSize + pushConstantSize +
+		mapEntrySize + (size_t)dataSize;
+
+	uint8_t* keyInstance = malloc(size);
+
+	if (!keyInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	uint8_t* data = keyInstance;
+
+	// Shader code hash is used instead of the module handle,
+	// because destroyed module handle can be reused.
+	uint64_t shaderSize = shader->vk.size;
+	memcpy(data, &shader->vk.hash, sizeof(uint64_t));
+	data += sizeof(uint64_t);
+	memcpy(data, &shaderSize, sizeof(uint64_t));
+	data += sizeof(uint64_t);
+
+	// Counts separate the variable size parts of the key
+	memcpy(data, &createData->setLayoutCount, sizeof(uint32_t));
+	data += sizeof(uint32_t);
+	memcpy(data, &createData->pushConstantRangeCount, sizeof(uint32_t));
+	data += sizeof(uint32_t);
+	memcpy(data, &mapEntryCount, sizeof(uint32_t));
+	data += sizeof(uint32_t);
+	memcpy(data, &dataSize, sizeof(uint64_t));
+	data += sizeof(uint64_t);
+
+	if (setLayoutSize > 0)
+	{
+		memcpy(data, createData->setLayouts, setLayoutSize);
+		data += setLayoutSize;
+	}
+	if (pushConstantSize > 0)
+	{
+		memcpy(data, createData->pushConstantRanges, pushConstantSize);
+		data += pushConstantSize;
+	}
+	if (mapEntrySize > 0)
+	{
+		memcpy(data, specializationInfo->pMapEntries, mapEntrySize);
+		data += mapEntrySize;
+	}
+	if (dataSize > 0)
+		memcpy(data, specializationInfo->pData, (size_t)dataSize);
+
+	*key = keyInstance;
+	*keySize = size;
+	return SUCCESS_MPGX_RESULT;
+}
 
 inline static MpgxResult createVkComputePipelineHandle(
 	VkDevice device,
 	VkPipelineCache cache,
 	VkPipelineLayout layout,
 	Shader shader,
+	const VkSpecializationInfo* specializationInfo,
 	VkPipeline* handle)
 {
 	assert(device);
@@ -79,7 +189,7 @@ inline static MpgxResult createVkComputePipelineHandle(
 		shader->vk.stage,
 		shader->vk.handle,
 		"main",
-		NULL, // TODO: pass here shader dynamic constants
+		specializationInfo,
 	};
 
 	VkComputePipelineCreateInfo computePipelineCreateInfo = {
@@ -122,28 +232,34 @@ inline static void destroyVkComputePipeline(
 		device,
 		computePipeline->vk.vkHandle,
 		NULL);
-	vkDestroyPipelineLayout(
-		device,
-		computePipeline->vk.layout,
-		NULL);
-	vkDestroyPipelineCache(
-		device,
-		computePipeline->vk.cache,
-		NULL);
+
+	if (!computePipeline->vk.reflectedLayout)
+	{
+		vkDestroyPipelineLayout(
+			device,
+			computePipeline->vk.layout,
+			NULL);
+	}
+
+	free(computePipeline->vk.specializationInfo);
 	free(computePipeline);
 }
 inline static MpgxResult createVkComputePipeline(
 	VkDevice device,
+	VkPipelineCache cache,
 	const VkComputePipelineCreateData* createData,
+	VkReflectedLayout reflectedLayout,
 	Window window,
 	const char* name,
 	OnComputePipelineBind onBind,
 	OnComputePipelineDestroy onDestroy,
 	void* handle,
 	Shader shader,
+	VkPipeline sharedHandle,
 	ComputePipeline* computePipeline)
 {
 	assert(device);
+	assert(cache);
 	assert(createData);
 	assert(window);
 	assert(onDestroy);
@@ -165,67 +281,77 @@ inline static MpgxResult createVkComputePipeline(
 	computePipelineInstance->vk.handle = handle;
 	computePipelineInstance->vk.shader = shader;
 
-	VkPipelineCacheCreateInfo cacheCreateInfo = {
-		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
-		NULL,
-		0,
-		0,
-		NULL,
-	};
+	computePipelineInstance->vk.cache = cache;
 
-	VkPipelineCache cache;
+	VkSpecializationInfo* specializationInfo;
 
-	VkResult vkResult = vkCreatePipelineCache(
-		device,
-		&cacheCreateInfo,
-		NULL,
-		&cache);
+	MpgxResult mpgxResult = createVkSpecializationInfo(
+		createData->specializationInfo,
+		&specializationInfo);
 
-	if (vkResult != VK_SUCCESS)
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
 	{
 		destroyVkComputePipeline(
 			device,
 			computePipelineInstance);
-		return vkToMpgxResult(vkResult);
+		return mpgxResult;
 	}
 
-	computePipelineInstance->vk.cache = cache;
-
-	VkPipelineLayoutCreateInfo layoutCreateInfo = {
-		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		NULL,
-		0,
-		createData->setLayoutCount,
-		createData->setLayouts,
-		createData->pushConstantRangeCount,
-		createData->pushConstantRanges,
-	};
+	computePipelineInstance->vk.specializationInfo = specializationInfo;
+	computePipelineInstance->vk.reflectedLayout = reflectedLayout;
 
 	VkPipelineLayout layout;
 
-	vkResult = vkCreatePipelineLayout(
-		device,
-		&layoutCreateInfo,
-		NULL,
-		&layout);
-
-	if (vkResult != VK_SUCCESS)
+	if (reflectedLayout)
 	{
-		destroyVkComputePipeline(
+		layout = reflectedLayout->layout;
+	}
+	else
+	{
+		VkPipelineLayoutCreateInfo layoutCreateInfo = {
+			VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			NULL,
+			0,
+			createData->setLayoutCount,
+			createData->setLayouts,
+			createData->pushConstantRangeCount,
+			createData->pushConstantRanges,
+		};
+
+		VkResult vkResult = vkCreatePipelineLayout(
 			device,
-			computePipelineInstance);
-		return vkToMpgxResult(vkResult);
+			&layoutCreateInfo,
+			NULL,
+			&layout);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			destroyVkComputePipeline(
+				device,
+				computePipelineInstance);
+			return vkToMpgxResult(vkResult);
+		}
 	}
 
 	computePipelineInstance->vk.layout = layout;
 
+	// Identical permutation handle is created with the
+	// identically defined layout, so layouts are compatible.
+	if (sharedHandle)
+	{
+		computePipelineInstance->vk.vkHandle = sharedHandle;
+		*computePipeline = computePipelineInstance;
+		return SUCCESS_MPGX_RESULT;
+	}
+
 	VkPipeline vkHandle;
 
-	MpgxResult mpgxResult = createVkComputePipelineHandle(
+	mpgxResult = createVkComputePipelineHandle(
 		device,
 		cache,
 		layout,
 		shader,
+		specializationInfo,
 		&vkHandle);
 
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
@@ -17,18 +17,62 @@
 #pragma once
 #include "mpgx/_source/image.h"
 
+#if MPGX_SUPPORT_VULKAN
+typedef struct VkPipelineLibraryEntry
+{
+	uint8_t* key;
+	size_t keySize;
+	VkPipeline library;
+} VkPipelineLibraryEntry;
+typedef struct VkMultisampleAttachment
+{
+	VkImage image;
+	VmaAllocation allocation;
+	VkImageView imageView;
+} VkMultisampleAttachment;
+typedef struct VkRetiredFramebuffer
+{
+	VkFramebuffer handle;
+	VkMultisampleAttachment* multisampleAttachments;
+	size_t multisampleAttachmentCount;
+	VkPipeline* pipelines;
+	size_t pipelineCount;
+	uint32_t frameIndex;
+} VkRetiredFramebuffer;
+
+typedef struct VkRenderPassEntry
+{
+	uint8_t* key;
+	size_t keySize;
+	VkRenderPass renderPass;
+} VkRenderPassEntry;
+typedef struct VkRenderPassCache_T
+{
+	VkRenderPassEntry* entries;
+	size_t entryCount;
+	size_t entryCapacity;
+} VkRenderPassCache_T;
+
+typedef VkRenderPassCache_T* VkRenderPassCache;
+#endif
+
 typedef struct BaseFramebuffer_T
 {
 	Window window;
 	Image* colorAttachments;
 	size_t colorAttachmentCount;
 	Image depthStencilAttachment;
+	Image* gBufferAttachments;
+	size_t gBufferAttachmentCount;
+	AttachmentLoadOp* loadOps;
+	AttachmentStoreOp* storeOps;
 	GraphicsPipeline* pipelines;
 	size_t pipelineCapacity;
 	size_t pipelineCount;
 	Vec2I size;
 	bool isDefault;
 	bool useBeginClear;
+	uint8_t sampleCount;
 #ifndef NDEBUG
 	bool isEnumerating;
 #endif
@@ -40,19 +84,29 @@ typedef struct VkFramebuffer_T
 	Image* colorAttachments;
 	size_t colorAttachmentCount;
 	Image depthStencilAttachment;
+	Image* gBufferAttachments;
+	size_t gBufferAttachmentCount;
+	AttachmentLoadOp* loadOps;
+	AttachmentStoreOp* storeOps;
 	GraphicsPipeline* pipelines;
 	size_t pipelineCapacity;
 	size_t pipelineCount;
 	Vec2I size;
 	bool isDefault;
 	bool useBeginClear;
+	uint8_t sampleCount;
 #ifndef NDEBUG
 	bool isEnumerating;
 #endif
-	uint8_t _alignment[6];
+	uint8_t _alignment[5];
 	VkRenderPass renderPass;
 	VkFramebuffer handle;
 	VkClearAttachment* clearAttachments;
+	VkClearValue* clearValues;
+	VkPipelineLibraryEntry* libraryEntries;
+	size_t libraryEntryCapacity;
+	size_t libraryEntryCount;
+	VkMultisampleAttachment* multisampleAttachments;
 } VkFramebuffer_T;
 #endif
 #if MPGX_SUPPORT_OPENGL
@@ -62,17 +116,25 @@ typedef struct GlFramebuffer_T
 	Image* colorAttachments;
 	size_t colorAttachmentCount;
 	Image depthStencilAttachment;
+	Image* gBufferAttachments;
+	size_t gBufferAttachmentCount;
+	AttachmentLoadOp* loadOps;
+	AttachmentStoreOp* storeOps;
 	GraphicsPipeline* pipelines;
 	size_t pipelineCapacity;
 	size_t pipelineCount;
 	Vec2I size;
 	bool isDefault;
 	bool useBeginClear;
+	uint8_t sampleCount;
 #ifndef NDEBUG
 	bool isEnumerating;
 #endif
-	uint8_t _alignment[2];
+	uint8_t _alignment[1];
 	GLuint handle;
+	GLuint subpassHandle;
+	GLuint resolveHandle;
+	GLuint* renderbuffers;
 } GlFramebuffer_T;
 #endif
 union Framebuffer_T
@@ -86,6 +148,83 @@ union Framebuffer_T
 #endif
 };
 
+inline static size_t getFramebufferSubpassColorCount(
+	size_t colorAttachmentCount,
+	size_t gBufferAttachmentCount,
+	uint8_t subpassIndex)
+{
+	// G-buffer is written by the first deferred subpass
+	return gBufferAttachmentCount > 0 && subpassIndex == 0 ?
+		gBufferAttachmentCount : colorAttachmentCount;
+}
+inline static AttachmentLoadOp getFramebufferLoadOp(
+	const AttachmentLoadOp* loadOps,
+	bool useBeginClear,
+	size_t attachmentIndex)
+{
+	// Attachments are cleared or discarded by default
+	if (!loadOps)
+	{
+		return useBeginClear ?
+			CLEAR_ATTACHMENT_LOAD_OP :
+			DONT_CARE_ATTACHMENT_LOAD_OP;
+	}
+
+	return loadOps[attachmentIndex];
+}
+inline static AttachmentStoreOp getFramebufferStoreOp(
+	const AttachmentStoreOp* storeOps,
+	size_t attachmentIndex)
+{
+	return storeOps ? storeOps[attachmentIndex] :
+		STORE_ATTACHMENT_STORE_OP;
+}
+inline static bool createFramebufferAttachmentOps(
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	size_t attachmentCount,
+	AttachmentLoadOp** loadOpArray,
+	AttachmentStoreOp** storeOpArray)
+{
+	assert(loadOpArray);
+	assert(storeOpArray);
+
+	AttachmentLoadOp* loadOpArrayInstance = NULL;
+
+	if (loadOps && attachmentCount > 0)
+	{
+		loadOpArrayInstance = malloc(
+			attachmentCount * sizeof(AttachmentLoadOp));
+
+		if (!loadOpArrayInstance)
+			return false;
+
+		memcpy(loadOpArrayInstance, loadOps,
+			attachmentCount * sizeof(AttachmentLoadOp));
+	}
+
+	AttachmentStoreOp* storeOpArrayInstance = NULL;
+
+	if (storeOps && attachmentCount > 0)
+	{
+		storeOpArrayInstance = malloc(
+			attachmentCount * sizeof(AttachmentStoreOp));
+
+		if (!storeOpArrayInstance)
+		{
+			free(loadOpArrayInstance);
+			return false;
+		}
+
+		memcpy(storeOpArrayInstance, storeOps,
+			attachmentCount * sizeof(AttachmentStoreOp));
+	}
+
+	*loadOpArray = loadOpArrayInstance;
+	*storeOpArray = storeOpArrayInstance;
+	return true;
+}
+
 #if MPGX_SUPPORT_VULKAN
 typedef struct VkGraphicsPipelineCreateData
 {
@@ -97,22 +236,31 @@ typedef struct VkGraphicsPipelineCreateData
 	const VkDescriptorSetLayout* setLayouts;
 	uint32_t pushConstantRangeCount;
 	const VkPushConstantRange* pushConstantRanges;
+	const VkSpecializationInfo* specializationInfo;
 } VkGraphicsPipelineCreateData;
 
 inline static MpgxResult createVkGeneralRenderPass(
 	VkDevice device,
+	VkSampleCountFlagBits sampleCount,
 	bool useBeginClear,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
 	VkRenderPass* renderPass)
 {
 	assert(device);
+	assert(sampleCount == VK_SAMPLE_COUNT_1_BIT ||
+		colorAttachmentCount > 0);
 	assert(renderPass);
 	// TODO: add attachment assertions
 
-	size_t attachmentCount = depthStencilAttachment ?
+	bool isMultisampled = sampleCount > VK_SAMPLE_COUNT_1_BIT;
+	size_t resolveOffset = depthStencilAttachment ?
 		colorAttachmentCount + 1 : colorAttachmentCount;
+	size_t attachmentCount = isMultisampled ?
+		resolveOffset + colorAttachmentCount : resolveOffset;
 
 	VkAttachmentDescription* attachmentDescriptions = malloc(
 		attachmentCount * sizeof(VkAttachmentDescription));
@@ -124,8 +272,9 @@ inline static MpgxResult createVkGeneralRenderPass(
 
 	if (colorAttachmentCount > 0)
 	{
-		colorReferences = malloc(
-			colorAttachmentCount * sizeof(VkAttachmentReference));
+		colorReferences = malloc((isMultisampled ?
+			colorAttachmentCount * 2 : colorAttachmentCount) *
+			sizeof(VkAttachmentReference));
 
 		if (!colorReferences)
 		{
@@ -133,17 +282,31 @@ inline static MpgxResult createVkGeneralRenderPass(
 			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
 
+		// Multisampled attachments are discarded after the resolve
 		VkAttachmentDescription attachmentDescription = {
+			0,
+			0,
+			sampleCount,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			isMultisampled ?
+				VK_IMAGE_LAYOUT_UNDEFINED :
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			isMultisampled ?
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL :
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		};
+		VkAttachmentDescription resolveDescription = {
 			0,
 			0,
 			VK_SAMPLE_COUNT_1_BIT,
-			useBeginClear ?
-				VK_ATTACHMENT_LOAD_OP_CLEAR :
-				VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			VK_ATTACHMENT_STORE_OP_STORE,
 			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
 			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 		};
 		VkAttachmentReference attachmentReference = {
@@ -154,10 +317,31 @@ inline static MpgxResult createVkGeneralRenderPass(
 		for (size_t i = 0; i < colorAttachmentCount; i++)
 		{
 			Image colorAttachment = colorAttachments[i];
+
+			// Attachment operation values match the Vulkan ones
+			VkAttachmentStoreOp storeOp = (VkAttachmentStoreOp)
+				getFramebufferStoreOp(storeOps, i);
+
 			attachmentDescription.format = colorAttachment->vk.vkFormat;
+			attachmentDescription.loadOp = (VkAttachmentLoadOp)
+				getFramebufferLoadOp(loadOps, useBeginClear, i);
+
+			if (!isMultisampled)
+				attachmentDescription.storeOp = storeOp;
+
 			attachmentDescriptions[i] = attachmentDescription;
 			attachmentReference.attachment = (uint32_t)i;
 			colorReferences[i] = attachmentReference;
+
+			if (isMultisampled)
+			{
+				size_t resolveIndex = resolveOffset + i;
+				resolveDescription.format = colorAttachment->vk.vkFormat;
+				resolveDescription.storeOp = storeOp;
+				attachmentDescriptions[resolveIndex] = resolveDescription;
+				attachmentReference.attachment = (uint32_t)resolveIndex;
+				colorReferences[colorAttachmentCount + i] = attachmentReference;
+			}
 		}
 	}
 	else
@@ -169,6 +353,14 @@ inline static MpgxResult createVkGeneralRenderPass(
 	{
 		ImageFormat format = depthStencilAttachment->vk.format;
 
+		VkAttachmentLoadOp loadOp = (VkAttachmentLoadOp)getFramebufferLoadOp(
+			loadOps, useBeginClear, colorAttachmentCount);
+
+		// Multisampled depth/stencil is not resolved
+		VkAttachmentStoreOp storeOp = isMultisampled ?
+			VK_ATTACHMENT_STORE_OP_DONT_CARE : (VkAttachmentStoreOp)
+			getFramebufferStoreOp(storeOps, colorAttachmentCount);
+
 		VkAttachmentLoadOp stencilLoadOp;
 		VkAttachmentStoreOp stencilStoreOp;
 
@@ -186,25 +378,25 @@ inline static MpgxResult createVkGeneralRenderPass(
 		case D16_UNORM_S8_UINT_IMAGE_FORMAT:
 		case D24_UNORM_S8_UINT_IMAGE_FORMAT:
 		case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
-			stencilLoadOp = useBeginClear ?
-				VK_ATTACHMENT_LOAD_OP_CLEAR :
-				VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-			stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+			stencilLoadOp = loadOp;
+			stencilStoreOp = storeOp;
 			break;
 		}
 
 		VkAttachmentDescription attachmentDescription = {
 			0,
 			depthStencilAttachment->vk.vkFormat,
-			VK_SAMPLE_COUNT_1_BIT,
-			useBeginClear ?
-				VK_ATTACHMENT_LOAD_OP_CLEAR :
-				VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-			VK_ATTACHMENT_STORE_OP_STORE,
+			sampleCount,
+			loadOp,
+			storeOp,
 			stencilLoadOp,
 			stencilStoreOp,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+			isMultisampled ?
+				VK_IMAGE_LAYOUT_UNDEFINED :
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			isMultisampled ?
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL :
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
 		};
 
 		attachmentDescriptions[colorAttachmentCount] = attachmentDescription;
@@ -221,13 +413,28 @@ inline static MpgxResult createVkGeneralRenderPass(
 		NULL,
 		(uint32_t)colorAttachmentCount,
 		colorReferences,
-		NULL,
+		isMultisampled ?
+			colorReferences + colorAttachmentCount : NULL,
 		depthStencilAttachment ?
 			&depthStencilAttachmentReference : NULL,
 		0,
 		NULL,
 	};
 
+	// Attachments are transitioned into the subpass layouts by
+	// the tracked image barriers before the render pass begin.
+	VkSubpassDependency subpassDependency = {
+		0,
+		VK_SUBPASS_EXTERNAL,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+		VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		VK_ACCESS_SHADER_READ_BIT,
+		VK_DEPENDENCY_BY_REGION_BIT,
+	};
+
 	VkRenderPassCreateInfo renderPassCreateInfo = {
 		VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
 		NULL,
@@ -236,8 +443,8 @@ inline static MpgxResult createVkGeneralRenderPass(
 		attachmentDescriptions,
 		1,
 		&subpassDescription,
-		0,
-		NULL,
+		1,
+		&subpassDependency,
 	};
 
 	VkRenderPass renderPassInstance;
@@ -276,7 +483,7 @@ inline static MpgxResult createVkShadowRenderPass(
 		VK_ATTACHMENT_STORE_OP_STORE,
 		VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 		VK_ATTACHMENT_STORE_OP_DONT_CARE,
-		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
 		VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
 	};
 	VkAttachmentReference attachmentReference = {
@@ -343,590 +550,833 @@ inline static MpgxResult createVkShadowRenderPass(
 	*renderPass = renderPassInstance;
 	return SUCCESS_MPGX_RESULT;
 }
-
-inline static MpgxResult createVkFramebufferHandle(
+inline static MpgxResult createVkDeferredRenderPass(
 	VkDevice device,
-	VkRenderPass renderPass,
-	size_t attachmentCount,
-	VkImageView* imageViews,
-	Vec2I size,
-	VkFramebuffer* handle)
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	VkRenderPass* renderPass)
 {
 	assert(device);
+	assert(gBufferAttachments);
+	assert(gBufferAttachmentCount > 0);
+	assert(colorAttachments);
+	assert(colorAttachmentCount > 0);
 	assert(renderPass);
-	assert(attachmentCount > 0);
-	assert(imageViews);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(handle);
 
-	VkFramebufferCreateInfo framebufferCreateInfo = {
-		VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+	size_t gBufferOffset = colorAttachmentCount;
+	size_t depthStencilIndex = colorAttachmentCount + gBufferAttachmentCount;
+	size_t attachmentCount = depthStencilAttachment ?
+		depthStencilIndex + 1 : depthStencilIndex;
+	size_t inputAttachmentCount = depthStencilAttachment ?
+		gBufferAttachmentCount + 1 : gBufferAttachmentCount;
+
+	VkAttachmentDescription* attachmentDescriptions = malloc(
+		attachmentCount * sizeof(VkAttachmentDescription));
+
+	if (!attachmentDescriptions)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	VkAttachmentReference* attachmentReferences = malloc(
+		(colorAttachmentCount + gBufferAttachmentCount +
+		inputAttachmentCount) * sizeof(VkAttachmentReference));
+
+	if (!attachmentReferences)
+	{
+		free(attachmentDescriptions);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	VkAttachmentReference* colorReferences = attachmentReferences;
+	VkAttachmentReference* gBufferReferences =
+		colorReferences + colorAttachmentCount;
+	VkAttachmentReference* inputReferences =
+		gBufferReferences + gBufferAttachmentCount;
+
+	VkAttachmentLoadOp loadOp = useBeginClear ?
+		VK_ATTACHMENT_LOAD_OP_CLEAR :
+		VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+
+	for (size_t i = 0; i < colorAttachmentCount; i++)
+	{
+		VkAttachmentDescription attachmentDescription = {
+			0,
+			colorAttachments[i]->vk.vkFormat,
+			VK_SAMPLE_COUNT_1_BIT,
+			loadOp,
+			VK_ATTACHMENT_STORE_OP_STORE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		};
+		VkAttachmentReference attachmentReference = {
+			(uint32_t)i,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		};
+
+		attachmentDescriptions[i] = attachmentDescription;
+		colorReferences[i] = attachmentReference;
+	}
+
+	// Transient G-buffer content never leaves the tile memory
+	for (size_t i = 0; i < gBufferAttachmentCount; i++)
+	{
+		Image gBufferAttachment = gBufferAttachments[i];
+		uint32_t index = (uint32_t)(gBufferOffset + i);
+
+		VkAttachmentDescription attachmentDescription = {
+			0,
+			gBufferAttachment->vk.vkFormat,
+			VK_SAMPLE_COUNT_1_BIT,
+			loadOp,
+			gBufferAttachment->vk.type & TRANSIENT_ATTACHMENT_IMAGE_TYPE ?
+				VK_ATTACHMENT_STORE_OP_DONT_CARE :
+				VK_ATTACHMENT_STORE_OP_STORE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		};
+		VkAttachmentReference gBufferReference = {
+			index,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		};
+		VkAttachmentReference inputReference = {
+			index,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		};
+
+		attachmentDescriptions[index] = attachmentDescription;
+		gBufferReferences[i] = gBufferReference;
+		inputReferences[i] = inputReference;
+	}
+
+	if (depthStencilAttachment)
+	{
+		ImageFormat format = depthStencilAttachment->vk.format;
+
+		if (!isImageFormatDepthStencil(format))
+		{
+			free(attachmentReferences);
+			free(attachmentDescriptions);
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		}
+
+		bool hasStencil = format != D16_UNORM_IMAGE_FORMAT &&
+			format != D32_SFLOAT_IMAGE_FORMAT;
+		VkAttachmentStoreOp storeOp = depthStencilAttachment->vk.type &
+			TRANSIENT_ATTACHMENT_IMAGE_TYPE ?
+			VK_ATTACHMENT_STORE_OP_DONT_CARE :
+			VK_ATTACHMENT_STORE_OP_STORE;
+
+		VkAttachmentDescription attachmentDescription = {
+			0,
+			depthStencilAttachment->vk.vkFormat,
+			VK_SAMPLE_COUNT_1_BIT,
+			loadOp,
+			storeOp,
+			hasStencil ? loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			hasStencil ? storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+		};
+		VkAttachmentReference inputReference = {
+			(uint32_t)depthStencilIndex,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+		};
+
+		attachmentDescriptions[depthStencilIndex] = attachmentDescription;
+		inputReferences[gBufferAttachmentCount] = inputReference;
+	}
+
+	VkAttachmentReference depthStencilReference = {
+		(uint32_t)depthStencilIndex,
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+	};
+	VkAttachmentReference depthStencilReadReference = {
+		(uint32_t)depthStencilIndex,
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+	};
+
+	// Lighting subpass can use read only depth for the light volumes
+	VkSubpassDescription subpassDescriptions[2] = {
+		{
+			0,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			0,
+			NULL,
+			(uint32_t)gBufferAttachmentCount,
+			gBufferReferences,
+			NULL,
+			depthStencilAttachment ?
+				&depthStencilReference : NULL,
+			0,
+			NULL,
+		},
+		{
+			0,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			(uint32_t)inputAttachmentCount,
+			inputReferences,
+			(uint32_t)colorAttachmentCount,
+			colorReferences,
+			NULL,
+			depthStencilAttachment ?
+				&depthStencilReadReference : NULL,
+			0,
+			NULL,
+		},
+	};
+
+	VkSubpassDependency subpassDependencies[2] = {
+		{
+			0,
+			1,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+			VK_DEPENDENCY_BY_REGION_BIT,
+		},
+		{
+			1,
+			VK_SUBPASS_EXTERNAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_ACCESS_SHADER_READ_BIT,
+			VK_DEPENDENCY_BY_REGION_BIT,
+		},
+	};
+
+	VkRenderPassCreateInfo renderPassCreateInfo = {
+		VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
 		NULL,
 		0,
-		renderPass,
 		(uint32_t)attachmentCount,
-		imageViews,
-		size.x,
-		size.y,
-		1,
+		attachmentDescriptions,
+		2,
+		subpassDescriptions,
+		2,
+		subpassDependencies,
 	};
 
-	VkFramebuffer handleInstance;
+	VkRenderPass renderPassInstance;
 
-	VkResult vkResult = vkCreateFramebuffer(
+	VkResult vkResult = vkCreateRenderPass(
 		device,
-		&framebufferCreateInfo,
+		&renderPassCreateInfo,
 		NULL,
-		&handleInstance);
+		&renderPassInstance);
+
+	free(attachmentReferences);
+	free(attachmentDescriptions);
 
 	if (vkResult != VK_SUCCESS)
 		return vkToMpgxResult(vkResult);
 
-	*handle = handleInstance;
+	*renderPass = renderPassInstance;
 	return SUCCESS_MPGX_RESULT;
 }
 
-inline static void destroyVkFramebuffer(
+inline static void destroyVkRenderPassCache(
 	VkDevice device,
-	Framebuffer framebuffer)
+	VkRenderPassCache renderPassCache)
 {
 	assert(device);
 
-	if (!framebuffer)
+	if (!renderPassCache)
 		return;
 
-	assert(framebuffer->vk.pipelineCount == 0);
-	free(framebuffer->vk.clearAttachments);
+	VkRenderPassEntry* entries = renderPassCache->entries;
+	size_t entryCount = renderPassCache->entryCount;
 
-	if (!framebuffer->vk.isDefault)
+	for (size_t i = 0; i < entryCount; i++)
 	{
-		vkDestroyFramebuffer(
-			device,
-			framebuffer->vk.handle,
-			NULL);
 		vkDestroyRenderPass(
 			device,
-			framebuffer->vk.renderPass,
+			entries[i].renderPass,
 			NULL);
-		free(framebuffer->vk.colorAttachments);
+		free(entries[i].key);
 	}
 
-	free(framebuffer->vk.pipelines);
-	free(framebuffer);
+	free(entries);
+	free(renderPassCache);
 }
-
-inline static MpgxResult createVkDefaultFramebuffer(
-	VkDevice device,
-	VkRenderPass renderPass,
-	VkFramebuffer handle,
-	Window window,
-	Vec2I size,
-	Framebuffer* framebuffer)
+inline static MpgxResult createVkRenderPassCache(
+	VkRenderPassCache* renderPassCache)
 {
-	assert(device);
-	assert(renderPass);
-	assert(handle);
-	assert(window);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(framebuffer);
+	assert(renderPassCache);
 
-	Framebuffer framebufferInstance = calloc(1,
-		sizeof(Framebuffer_T));
+	VkRenderPassCache renderPassCacheInstance = calloc(1,
+		sizeof(VkRenderPassCache_T));
 
-	if (!framebufferInstance)
+	if (!renderPassCacheInstance)
 		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
-	framebufferInstance->vk.window = window;
-	framebufferInstance->vk.colorAttachments = NULL;
-	framebufferInstance->vk.colorAttachmentCount = 1;
-	framebufferInstance->vk.depthStencilAttachment = NULL;
-	framebufferInstance->vk.size = size;
-	framebufferInstance->vk.isDefault = true;
-	framebufferInstance->vk.useBeginClear = true;
-	framebufferInstance->vk.renderPass = renderPass;
-	framebufferInstance->vk.handle = handle;
-#ifndef NDEBUG
-	framebufferInstance->vk.isEnumerating = false;
-#endif
-
-	GraphicsPipeline* pipelines = malloc(
-		sizeof(GraphicsPipeline));
+	VkRenderPassEntry* entries = malloc(
+		sizeof(VkRenderPassEntry));
 
-	if (!pipelines)
+	if (!entries)
 	{
-		destroyVkFramebuffer(device,
-			framebufferInstance);
+		free(renderPassCacheInstance);
 		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 	}
 
-	framebufferInstance->vk.pipelines = pipelines;
-	framebufferInstance->vk.pipelineCapacity = 1;
-	framebufferInstance->vk.pipelineCount = 0;
+	renderPassCacheInstance->entries = entries;
+	renderPassCacheInstance->entryCapacity = 1;
 
-	VkClearAttachment* clearAttachments = malloc(
-		2 * sizeof(VkClearAttachment));
+	*renderPassCache = renderPassCacheInstance;
+	return SUCCESS_MPGX_RESULT;
+}
 
-	if (!clearAttachments)
-	{
-		destroyVkFramebuffer(device,
-			framebufferInstance);
+inline static MpgxResult createVkRenderPassKey(
+	bool isShadow,
+	VkSampleCountFlagBits sampleCount,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	uint8_t** key,
+	size_t* keySize)
+{
+	assert(key);
+	assert(keySize);
+
+	size_t attachmentCount = gBufferAttachmentCount + colorAttachmentCount;
+
+	if (depthStencilAttachment)
+		attachmentCount++;
+
+	// Render pass depends only on the attachment formats and
+	// operations, so it is shared between the different images.
+	size_t size = sizeof(uint8_t) * 4 + sizeof(size_t) * 2 +
+		attachmentCount * (sizeof(VkFormat) + sizeof(uint8_t) * 3);
+
+	uint8_t* keyInstance = malloc(size);
+
+	if (!keyInstance)
 		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-	}
 
-	framebufferInstance->vk.clearAttachments = clearAttachments;
+	uint8_t* data = keyInstance;
 
-	*framebuffer = framebufferInstance;
+	data[0] = (uint8_t)isShadow;
+	data[1] = (uint8_t)sampleCount;
+	data[2] = (uint8_t)useBeginClear;
+	data[3] = (uint8_t)(depthStencilAttachment != NULL);
+	data += sizeof(uint8_t) * 4;
+	memcpy(data, &gBufferAttachmentCount, sizeof(size_t));
+	data += sizeof(size_t);
+	memcpy(data, &colorAttachmentCount, sizeof(size_t));
+	data += sizeof(size_t);
+
+	for (size_t i = 0; i < attachmentCount; i++)
+	{
+		Image image;
+		AttachmentLoadOp loadOp;
+		AttachmentStoreOp storeOp;
+
+		if (i < gBufferAttachmentCount)
+		{
+			image = gBufferAttachments[i];
+			loadOp = getFramebufferLoadOp(NULL, useBeginClear, i);
+			storeOp = getFramebufferStoreOp(NULL, i);
+		}
+		else
+		{
+			size_t index = i - gBufferAttachmentCount;
+
+			image = index < colorAttachmentCount ?
+				colorAttachments[index] : depthStencilAttachment;
+			loadOp = getFramebufferLoadOp(loadOps, useBeginClear, index);
+			storeOp = getFramebufferStoreOp(storeOps, index);
+		}
+
+		memcpy(data, &image->vk.vkFormat, sizeof(VkFormat));
+		data += sizeof(VkFormat);
+		data[0] = (uint8_t)((image->vk.type &
+			TRANSIENT_ATTACHMENT_IMAGE_TYPE) != 0);
+		data[1] = loadOp;
+		data[2] = storeOp;
+		data += sizeof(uint8_t) * 3;
+	}
+
+	*key = keyInstance;
+	*keySize = size;
 	return SUCCESS_MPGX_RESULT;
 }
-inline static MpgxResult createVkFramebuffer(
+inline static MpgxResult getVkCachedRenderPass(
 	VkDevice device,
-	VkRenderPass renderPass,
-	Window window,
-	Vec2I size,
+	VkRenderPassCache renderPassCache,
+	bool isShadow,
+	VkSampleCountFlagBits sampleCount,
 	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	Image depthStencilAttachment,
-	Framebuffer* framebuffer)
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	VkRenderPass* renderPass)
 {
 	assert(device);
+	assert(renderPassCache);
+	assert(!isShadow || depthStencilAttachment);
 	assert(renderPass);
-	assert(window);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(framebuffer);
-	// TODO: assert attachments
-
-	Framebuffer framebufferInstance = calloc(1,
-		sizeof(Framebuffer_T));
-
-	if (!framebufferInstance)
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
-	framebufferInstance->vk.isDefault = false;
-	framebufferInstance->vk.window = window;
-	framebufferInstance->vk.size = size;
-	framebufferInstance->vk.useBeginClear = useBeginClear;
-	framebufferInstance->vk.renderPass = renderPass;
-#ifndef NDEBUG
-	framebufferInstance->vk.isEnumerating = false;
-#endif
+	uint8_t* key;
+	size_t keySize;
+
+	MpgxResult mpgxResult = createVkRenderPassKey(
+		isShadow,
+		sampleCount,
+		useBeginClear,
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		loadOps,
+		storeOps,
+		&key,
+		&keySize);
 
-	size_t attachmentCount = depthStencilAttachment ?
-		colorAttachmentCount + 1 : colorAttachmentCount;
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
 
-	VkImageView* imageViews = malloc(
-		attachmentCount * sizeof(VkImageView));
+	VkRenderPassEntry* entries = renderPassCache->entries;
+	size_t entryCount = renderPassCache->entryCount;
 
-	if (!imageViews)
+	for (size_t i = 0; i < entryCount; i++)
 	{
-		destroyVkFramebuffer(
-			device,
-			framebufferInstance);
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-	}
+		VkRenderPassEntry* entry = &entries[i];
 
-	Image* colorAttachmentArray;
+		if (entry->keySize == keySize &&
+			memcmp(entry->key, key, keySize) == 0)
+		{
+			free(key);
+			*renderPass = entry->renderPass;
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
 
-	if (colorAttachmentCount > 0)
+	if (entryCount == renderPassCache->entryCapacity)
 	{
-		colorAttachmentArray = malloc(
-			colorAttachmentCount * sizeof(Image));
+		size_t capacity = renderPassCache->entryCapacity * 2;
 
-		if (!colorAttachmentArray)
+		entries = realloc(entries,
+			capacity * sizeof(VkRenderPassEntry));
+
+		if (!entries)
 		{
-			free(imageViews);
-			destroyVkFramebuffer(
-				device,
-				framebufferInstance);
+			free(key);
 			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
 
-		for (size_t i = 0; i < colorAttachmentCount; i++)
-		{
-			Image colorAttachment = colorAttachments[i];
-			colorAttachmentArray[i] = colorAttachment;
-			imageViews[i] = colorAttachment->vk.imageView;
-		}
+		renderPassCache->entries = entries;
+		renderPassCache->entryCapacity = capacity;
+	}
+
+	VkRenderPass renderPassInstance;
+
+	if (isShadow)
+	{
+		mpgxResult = createVkShadowRenderPass(
+			device,
+			depthStencilAttachment->vk.vkFormat,
+			useBeginClear,
+			&renderPassInstance);
+	}
+	else if (gBufferAttachmentCount > 0)
+	{
+		mpgxResult = createVkDeferredRenderPass(
+			device,
+			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			&renderPassInstance);
 	}
 	else
 	{
-		colorAttachmentArray = NULL;
+		mpgxResult = createVkGeneralRenderPass(
+			device,
+			sampleCount,
+			useBeginClear,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			loadOps,
+			storeOps,
+			&renderPassInstance);
 	}
 
-	framebufferInstance->vk.colorAttachments = colorAttachmentArray;
-	framebufferInstance->vk.colorAttachmentCount = colorAttachmentCount;
-
-	if (depthStencilAttachment)
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
 	{
-		imageViews[colorAttachmentCount] =
-			depthStencilAttachment->vk.imageView;
+		free(key);
+		return mpgxResult;
 	}
 
-	framebufferInstance->vk.depthStencilAttachment = depthStencilAttachment;
-
-	GraphicsPipeline* pipelines = malloc(
-		sizeof(GraphicsPipeline));
+	VkRenderPassEntry entry = {
+		key,
+		keySize,
+		renderPassInstance,
+	};
 
-	if (!pipelines)
-	{
-		free(imageViews);
-		destroyVkFramebuffer(device,
-			framebufferInstance);
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-	}
+	entries[entryCount] = entry;
+	renderPassCache->entryCount = entryCount + 1;
 
-	framebufferInstance->vk.pipelines = pipelines;
-	framebufferInstance->vk.pipelineCapacity = 1;
-	framebufferInstance->vk.pipelineCount = 0;
+	*renderPass = renderPassInstance;
+	return SUCCESS_MPGX_RESULT;
+}
 
-	VkFramebuffer handle;
+inline static MpgxResult createVkFramebufferHandle(
+	VkDevice device,
+	VkRenderPass renderPass,
+	size_t attachmentCount,
+	VkImageView* imageViews,
+	Vec2I size,
+	VkFramebuffer* handle)
+{
+	assert(device);
+	assert(renderPass);
+	assert(attachmentCount > 0);
+	assert(imageViews);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(handle);
 
-	MpgxResult mpgxResult = createVkFramebufferHandle(
-		device,
+	VkFramebufferCreateInfo framebufferCreateInfo = {
+		VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		NULL,
+		0,
 		renderPass,
-		attachmentCount,
+		(uint32_t)attachmentCount,
 		imageViews,
-		size,
-		&handle);
-
-	free(imageViews);
-
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-	{
-		destroyVkFramebuffer(device,
-			framebufferInstance);
-		return mpgxResult;
-	}
-
-	framebufferInstance->vk.handle = handle;
+		size.x,
+		size.y,
+		1,
+	};
 
-	VkClearAttachment* clearAttachments = malloc(
-		attachmentCount * sizeof(VkClearAttachment));
+	VkFramebuffer handleInstance;
 
-	if (!clearAttachments)
-	{
-		destroyVkFramebuffer(device,
-			framebufferInstance);
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-	}
+	VkResult vkResult = vkCreateFramebuffer(
+		device,
+		&framebufferCreateInfo,
+		NULL,
+		&handleInstance);
 
-	framebufferInstance->vk.clearAttachments = clearAttachments;
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
 
-	*framebuffer = framebufferInstance;
+	*handle = handleInstance;
 	return SUCCESS_MPGX_RESULT;
 }
 
-inline static MpgxResult recreateVkGraphicsPipelineHandle(
+inline static void destroyVkMultisampleAttachments(
 	VkDevice device,
-	VkRenderPass renderPass,
-	GraphicsPipeline graphicsPipeline,
-	size_t colorAttachmentCount,
-	Vec2I framebufferSize,
-	const VkGraphicsPipelineCreateData* createData);
+	VmaAllocator allocator,
+	VkMultisampleAttachment* multisampleAttachments,
+	size_t multisampleAttachmentCount)
+{
+	assert(device);
+	assert(allocator);
 
-inline static MpgxResult setVkFramebufferAttachments(
+	if (!multisampleAttachments)
+		return;
+
+	for (size_t i = 0; i < multisampleAttachmentCount; i++)
+	{
+		VkMultisampleAttachment* attachment =
+			&multisampleAttachments[i];
+
+		vkDestroyImageView(
+			device,
+			attachment->imageView,
+			NULL);
+		vmaDestroyImage(
+			allocator,
+			attachment->image,
+			attachment->allocation);
+	}
+
+	free(multisampleAttachments);
+}
+inline static MpgxResult createVkMultisampleAttachments(
 	VkDevice device,
-	VkRenderPass renderPass,
-	Framebuffer framebuffer,
+	VmaAllocator allocator,
+	VkSampleCountFlagBits sampleCount,
 	Vec2I size,
-	bool useBeginClear,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
-	Image depthStencilAttachment)
+	Image depthStencilAttachment,
+	VkMultisampleAttachment** multisampleAttachments)
 {
 	assert(device);
-	assert(renderPass);
-	assert(framebuffer);
+	assert(allocator);
+	assert(sampleCount > VK_SAMPLE_COUNT_1_BIT);
 	assert(size.x > 0);
 	assert(size.y > 0);
-	// TODO: assert attachments
+	assert(colorAttachments);
+	assert(colorAttachmentCount > 0);
+	assert(multisampleAttachments);
 
 	size_t attachmentCount = depthStencilAttachment ?
 		colorAttachmentCount + 1 : colorAttachmentCount;
 
-	VkImageView* imageViews = malloc(
-		attachmentCount * sizeof(VkImageView));
+	VkMultisampleAttachment* attachmentArray = calloc(
+		attachmentCount, sizeof(VkMultisampleAttachment));
 
-	if (!imageViews)
+	if (!attachmentArray)
 		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
-	Image* colorAttachmentArray;
+	VkImageCreateInfo imageCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		NULL,
+		0,
+		VK_IMAGE_TYPE_2D,
+		VK_FORMAT_UNDEFINED,
+		{ (uint32_t)size.x, (uint32_t)size.y, 1, },
+		1,
+		1,
+		sampleCount,
+		VK_IMAGE_TILING_OPTIMAL,
+		0,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		NULL,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+	VkImageViewCreateInfo imageViewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		NULL,
+		0,
+		NULL,
+		VK_IMAGE_VIEW_TYPE_2D,
+		VK_FORMAT_UNDEFINED,
+		{
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+		},
+		{
+			0,
+			0,
+			1,
+			0,
+			1,
+		},
+	};
 
-	if (colorAttachmentCount > 0)
+	VmaAllocationCreateInfo allocationCreateInfo;
+	memset(&allocationCreateInfo, 0, sizeof(VmaAllocationCreateInfo));
+
+	allocationCreateInfo.flags =
+		VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT |
+		VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+
+	for (size_t i = 0; i < attachmentCount; i++)
 	{
-		// TODO: realloc instead
-		colorAttachmentArray = malloc(
-			colorAttachmentCount * sizeof(Image));
+		Image image = i < colorAttachmentCount ?
+			colorAttachments[i] : depthStencilAttachment;
+		VkMultisampleAttachment* attachment = &attachmentArray[i];
+
+		imageCreateInfo.format = image->vk.vkFormat;
+		imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+			(i < colorAttachmentCount ?
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT :
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+		// Multisampled data is resolved inside the render pass,
+		// so it can stay in the lazily allocated tile memory.
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+
+		VkResult vkResult = vmaCreateImage(
+			allocator,
+			&imageCreateInfo,
+			&allocationCreateInfo,
+			&attachment->image,
+			&attachment->allocation,
+			NULL);
 
-		if (!colorAttachmentArray)
+		if (vkResult != VK_SUCCESS)
 		{
-			free(imageViews);
-			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-		}
+			allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+			vkResult = vmaCreateImage(
+				allocator,
+				&imageCreateInfo,
+				&allocationCreateInfo,
+				&attachment->image,
+				&attachment->allocation,
+				NULL);
 
-		for (size_t i = 0; i < colorAttachmentCount; i++)
-		{
-			Image colorAttachment = colorAttachments[i];
-			colorAttachmentArray[i] = colorAttachment;
-			imageViews[i] = colorAttachment->vk.imageView;
+			if (vkResult != VK_SUCCESS)
+			{
+				destroyVkMultisampleAttachments(
+					device,
+					allocator,
+					attachmentArray,
+					i);
+				return vkToMpgxResult(vkResult);
+			}
 		}
-	}
-	else
-	{
-		colorAttachmentArray = NULL;
-	}
-
-	if (depthStencilAttachment)
-	{
-		imageViews[colorAttachmentCount] =
-			depthStencilAttachment->vk.imageView;
-	}
-
-	VkFramebuffer handle;
 
-	MpgxResult mpgxResult = createVkFramebufferHandle(
-		device,
-		renderPass,
-		attachmentCount,
-		imageViews,
-		size,
-		&handle);
+		imageViewCreateInfo.image = attachment->image;
+		imageViewCreateInfo.format = image->vk.vkFormat;
+		imageViewCreateInfo.subresourceRange.aspectMask = image->vk.vkAspect;
 
-	free(imageViews);
+		vkResult = vkCreateImageView(
+			device,
+			&imageViewCreateInfo,
+			NULL,
+			&attachment->imageView);
 
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-	{
-		free(colorAttachmentArray);
-		return mpgxResult;
+		if (vkResult != VK_SUCCESS)
+		{
+			destroyVkMultisampleAttachments(
+				device,
+				allocator,
+				attachmentArray,
+				i + 1);
+			return vkToMpgxResult(vkResult);
+		}
 	}
 
-	VkClearAttachment* clearAttachments = realloc(
-		framebuffer->vk.clearAttachments,
-		attachmentCount * sizeof(VkClearAttachment));
-
-	if (!clearAttachments)
-	{
-		vkDestroyFramebuffer(
-			device,
-			handle,
-			NULL);
-		free(colorAttachmentArray);
-		return mpgxResult;
-	}
+	*multisampleAttachments = attachmentArray;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static void destroyVkRetiredFramebuffer(
+	VkDevice device,
+	VmaAllocator allocator,
+	const VkRetiredFramebuffer* retiredFramebuffer)
+{
+	assert(device);
+	assert(allocator);
+	assert(retiredFramebuffer);
 
-	GraphicsPipeline* pipelines = framebuffer->vk.pipelines;
-	size_t pipelineCount = framebuffer->vk.pipelineCount;
+	VkPipeline* pipelines = retiredFramebuffer->pipelines;
+	size_t pipelineCount = retiredFramebuffer->pipelineCount;
 
 	for (size_t i = 0; i < pipelineCount; i++)
 	{
-		GraphicsPipeline pipeline = pipelines[i];
-
-		OnGraphicsPipelineResize onResize =
-			getGraphicsPipelineOnResize(pipeline);
-
-		VkGraphicsPipelineCreateData createData;
-		onResize(pipeline, size, &createData);
-
-		mpgxResult = recreateVkGraphicsPipelineHandle(
+		vkDestroyPipeline(
 			device,
-			renderPass,
-			pipeline,
-			colorAttachmentCount,
-			size,
-			&createData);
-
-		if (mpgxResult != SUCCESS_MPGX_RESULT)
-		{
-			vkDestroyFramebuffer(
-				device,
-				handle,
-				NULL);
-			free(colorAttachmentArray);
-			return false;
-		}
+			pipelines[i],
+			NULL);
 	}
 
-	vkDestroyFramebuffer(
+	free(pipelines);
+
+	destroyVkMultisampleAttachments(
 		device,
-		framebuffer->vk.handle,
-		NULL);
-	vkDestroyRenderPass(
+		allocator,
+		retiredFramebuffer->multisampleAttachments,
+		retiredFramebuffer->multisampleAttachmentCount);
+	vkDestroyFramebuffer(
 		device,
-		framebuffer->vk.renderPass,
+		retiredFramebuffer->handle,
 		NULL);
-	free(framebuffer->vk.colorAttachments);
-
-	framebuffer->vk.size = size;
-	framebuffer->vk.useBeginClear = useBeginClear;
-	framebuffer->vk.colorAttachments = colorAttachmentArray;
-	framebuffer->vk.colorAttachmentCount = colorAttachmentCount;
-	framebuffer->vk.depthStencilAttachment = depthStencilAttachment;
-	framebuffer->vk.handle = handle;
-	framebuffer->vk.renderPass = renderPass;
-	framebuffer->vk.clearAttachments = clearAttachments;
-	return SUCCESS_MPGX_RESULT;
 }
 
-inline static void beginVkFramebufferRender(
-	VkCommandBuffer commandBuffer,
-	VkRenderPass renderPass,
-	VkFramebuffer framebuffer,
-	Vec2I size,
-	const FramebufferClear* clearValues,
-	size_t clearValueCount)
+inline static void clearVkFramebufferLibraries(
+	VkDevice device,
+	Framebuffer framebuffer)
 {
-	assert(commandBuffer);
-	assert(renderPass);
+	assert(device);
 	assert(framebuffer);
-	assert(size.x > 0);
-	assert(size.y > 0);
-
-	VkRenderPassBeginInfo renderPassBeginInfo = {
-		VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-		NULL,
-		renderPass,
-		framebuffer,
-		{
-			0, 0,
-			size.x, size.y,
-		},
-		(uint32_t)clearValueCount,
-		(const VkClearValue*)clearValues,
-	};
-
-	vkCmdBeginRenderPass(
-		commandBuffer,
-		&renderPassBeginInfo,
-		VK_SUBPASS_CONTENTS_INLINE);
-}
-inline static void endVkFramebufferRender(
-	VkCommandBuffer commandBuffer)
-{
-	assert(commandBuffer);
-	vkCmdEndRenderPass(commandBuffer);
-}
-
-inline static void clearVkFramebuffer(
-	VkCommandBuffer commandBuffer,
-	Vec2I framebufferSize,
-	bool hasDepthAttachment,
-	bool hasStencilAttachment,
-	VkClearAttachment* vkClearAttachments,
-	const bool* clearAttachments,
-	const FramebufferClear* clearValues,
-	size_t clearValueCount)
-{
-	assert(commandBuffer);
-	assert(framebufferSize.x > 0);
-	assert(framebufferSize.y > 0);
-	assert(clearAttachments);
-	assert(clearValues);
-	assert(clearValueCount > 0);
-
-	size_t clearAttachmentCount = 0;
-
-	size_t colorAttachmentCount =
-		hasDepthAttachment || hasStencilAttachment ?
-		clearValueCount - 1 : clearValueCount;
-
-	for (size_t i = 0; i < colorAttachmentCount; i++)
-	{
-		if (!clearAttachments[i])
-			continue;
-
-		LinearColor value = clearValues[i].color;
-
-		VkClearValue clearValue;
-		clearValue.color.float32[0] = value.r;
-		clearValue.color.float32[1] = value.g;
-		clearValue.color.float32[2] = value.b;
-		clearValue.color.float32[3] = value.a;
-
-		VkClearAttachment clearAttachment = {
-			VK_IMAGE_ASPECT_COLOR_BIT,
-			(uint32_t)i,
-			clearValue,
-		};
 
-		vkClearAttachments[clearAttachmentCount++] = clearAttachment;
-	}
+	VkPipelineLibraryEntry* libraryEntries =
+		framebuffer->vk.libraryEntries;
+	size_t libraryEntryCount = framebuffer->vk.libraryEntryCount;
 
-	if ((hasDepthAttachment | hasStencilAttachment) &
-		clearAttachments[colorAttachmentCount])
+	for (size_t i = 0; i < libraryEntryCount; i++)
 	{
-		DepthStencilClear value =
-			clearValues[colorAttachmentCount].depthStencil;
-
-		VkClearValue clearValue;
-		clearValue.depthStencil.depth = value.depth;
-		clearValue.depthStencil.stencil = value.stencil;
-
-		VkImageAspectFlags aspectMask;
-
-		if (hasDepthAttachment)
-			aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-		if (hasStencilAttachment)
-			aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
-
-		VkClearAttachment clearAttachment = {
-			aspectMask,
-			(uint32_t)colorAttachmentCount,
-			clearValue,
-		};
-
-		vkClearAttachments[clearAttachmentCount++] = clearAttachment;
+		vkDestroyPipeline(
+			device,
+			libraryEntries[i].library,
+			NULL);
+		free(libraryEntries[i].key);
 	}
 
-	VkClearRect clearRect = {
-		{
-			0, 0,
-			framebufferSize.x,
-			framebufferSize.y,
-		},
-		0,
-		1,
-	};
-
-	vkCmdClearAttachments(
-		commandBuffer,
-		(uint32_t)clearAttachmentCount,
-		vkClearAttachments,
-		1,
-		&clearRect);
+	framebuffer->vk.libraryEntryCount = 0;
 }
-#endif
-
-#if MPGX_SUPPORT_OPENGL
-inline static void destroyGlFramebuffer(Framebuffer framebuffer)
+inline static void destroyVkFramebuffer(
+	VkDevice device,
+	VmaAllocator allocator,
+	Framebuffer framebuffer)
 {
+	assert(device);
+	assert(allocator);
+
 	if (!framebuffer)
 		return;
 
-	if (framebuffer->gl.isDefault == false)
+	assert(framebuffer->vk.pipelineCount == 0);
+
+	clearVkFramebufferLibraries(
+		device,
+		framebuffer);
+	free(framebuffer->vk.libraryEntries);
+	free(framebuffer->vk.clearValues);
+	free(framebuffer->vk.clearAttachments);
+
+	if (!framebuffer->vk.isDefault)
 	{
-		makeGlWindowContextCurrent(
-			framebuffer->gl.window);
-		glDeleteFramebuffers(
-			GL_ONE,
-			&framebuffer->gl.handle);
-		assertOpenGL();
-		free(framebuffer->gl.colorAttachments);
+		// Render pass is owned by the window cache
+		vkDestroyFramebuffer(
+			device,
+			framebuffer->vk.handle,
+			NULL);
+		destroyVkMultisampleAttachments(
+			device,
+			allocator,
+			framebuffer->vk.multisampleAttachments,
+			framebuffer->vk.depthStencilAttachment ?
+				framebuffer->vk.colorAttachmentCount + 1 :
+				framebuffer->vk.colorAttachmentCount);
+		free(framebuffer->vk.storeOps);
+		free(framebuffer->vk.loadOps);
+		free(framebuffer->vk.gBufferAttachments);
+		free(framebuffer->vk.colorAttachments);
 	}
 
-	assert(framebuffer->gl.pipelineCount == 0);
-
-	free(framebuffer->gl.pipelines);
+	free(framebuffer->vk.pipelines);
 	free(framebuffer);
 }
 
-inline static MpgxResult createGlDefaultFramebuffer(
+inline static MpgxResult createVkDefaultFramebuffer(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkRenderPass renderPass,
+	VkFramebuffer handle,
 	Window window,
 	Vec2I size,
+	VkSampleCountFlagBits sampleCount,
 	Framebuffer* framebuffer)
 {
+	assert(device);
+	assert(allocator);
+	assert(renderPass);
+	assert(handle);
 	assert(window);
 	assert(size.x > 0);
 	assert(size.y > 0);
@@ -938,46 +1388,1620 @@ inline static MpgxResult createGlDefaultFramebuffer(
 	if (!framebufferInstance)
 		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
-	framebufferInstance->gl.window = window;
-	framebufferInstance->gl.colorAttachments = NULL;
-	framebufferInstance->gl.colorAttachmentCount = 1;
-	framebufferInstance->gl.depthStencilAttachment = NULL;
-	framebufferInstance->gl.size = size;
-	framebufferInstance->gl.isDefault = true;
-	framebufferInstance->gl.useBeginClear = true;
-#ifndef NDEBUG
-	framebufferInstance->gl.isEnumerating = false;
-#endif
+	framebufferInstance->vk.window = window;
+	framebufferInstance->vk.colorAttachments = NULL;
+	framebufferInstance->vk.colorAttachmentCount = 1;
+	framebufferInstance->vk.depthStencilAttachment = NULL;
+	framebufferInstance->vk.size = size;
+	framebufferInstance->vk.isDefault = true;
+	framebufferInstance->vk.useBeginClear = true;
+	framebufferInstance->vk.sampleCount = (uint8_t)sampleCount;
+	framebufferInstance->vk.renderPass = renderPass;
+	framebufferInstance->vk.handle = handle;
+#ifndef NDEBUG
+	framebufferInstance->vk.isEnumerating = false;
+#endif
+
+	GraphicsPipeline* pipelines = malloc(
+		sizeof(GraphicsPipeline));
+
+	if (!pipelines)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.pipelines = pipelines;
+	framebufferInstance->vk.pipelineCapacity = 1;
+	framebufferInstance->vk.pipelineCount = 0;
+
+	VkClearAttachment* clearAttachments = malloc(
+		2 * sizeof(VkClearAttachment));
+
+	if (!clearAttachments)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.clearAttachments = clearAttachments;
+
+	VkClearValue* clearValues = malloc(
+		2 * sizeof(VkClearValue));
+
+	if (!clearValues)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.clearValues = clearValues;
+
+	*framebuffer = framebufferInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkFramebufferImageViews(
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	VkMultisampleAttachment* multisampleAttachments,
+	VkImageView** imageViews,
+	size_t* imageViewCount)
+{
+	assert(imageViews);
+	assert(imageViewCount);
+
+	size_t depthStencilIndex = colorAttachmentCount + gBufferAttachmentCount;
+	size_t attachmentCount = depthStencilAttachment ?
+		depthStencilIndex + 1 : depthStencilIndex;
+	size_t colorOffset = 0;
+
+	// Multisampled attachments go first, followed by the resolve targets
+	if (multisampleAttachments)
+	{
+		assert(gBufferAttachmentCount == 0);
+		colorOffset = attachmentCount;
+		attachmentCount += colorAttachmentCount;
+	}
+
+	VkImageView* imageViewArray = malloc(
+		attachmentCount * sizeof(VkImageView));
+
+	if (!imageViewArray)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	if (multisampleAttachments)
+	{
+		for (size_t i = 0; i < colorOffset; i++)
+			imageViewArray[i] = multisampleAttachments[i].imageView;
+	}
+	else if (depthStencilAttachment)
+	{
+		imageViewArray[depthStencilIndex] =
+			depthStencilAttachment->vk.imageView;
+	}
+
+	for (size_t i = 0; i < colorAttachmentCount; i++)
+	{
+		imageViewArray[colorOffset + i] =
+			colorAttachments[i]->vk.imageView;
+	}
+	for (size_t i = 0; i < gBufferAttachmentCount; i++)
+	{
+		imageViewArray[colorAttachmentCount + i] =
+			gBufferAttachments[i]->vk.imageView;
+	}
+
+	*imageViews = imageViewArray;
+	*imageViewCount = attachmentCount;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkFramebuffer(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkRenderPass renderPass,
+	Window window,
+	Vec2I size,
+	VkSampleCountFlagBits sampleCount,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	Framebuffer* framebuffer)
+{
+	assert(device);
+	assert(allocator);
+	assert(renderPass);
+	assert(window);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(sampleCount == VK_SAMPLE_COUNT_1_BIT ||
+		gBufferAttachmentCount == 0);
+	assert(framebuffer);
+	// TODO: assert attachments
+
+	Framebuffer framebufferInstance = calloc(1,
+		sizeof(Framebuffer_T));
+
+	if (!framebufferInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	framebufferInstance->vk.isDefault = false;
+	framebufferInstance->vk.window = window;
+	framebufferInstance->vk.size = size;
+	framebufferInstance->vk.useBeginClear = useBeginClear;
+	framebufferInstance->vk.sampleCount = (uint8_t)sampleCount;
+	framebufferInstance->vk.renderPass = renderPass;
+#ifndef NDEBUG
+	framebufferInstance->vk.isEnumerating = false;
+#endif
+
+	if (colorAttachmentCount > 0)
+	{
+		Image* colorAttachmentArray = malloc(
+			colorAttachmentCount * sizeof(Image));
+
+		if (!colorAttachmentArray)
+		{
+			destroyVkFramebuffer(
+				device,
+				allocator,
+				framebufferInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+			colorAttachmentArray[i] = colorAttachments[i];
+
+		framebufferInstance->vk.colorAttachments = colorAttachmentArray;
+		framebufferInstance->vk.colorAttachmentCount = colorAttachmentCount;
+	}
+
+	if (gBufferAttachmentCount > 0)
+	{
+		Image* gBufferAttachmentArray = malloc(
+			gBufferAttachmentCount * sizeof(Image));
+
+		if (!gBufferAttachmentArray)
+		{
+			destroyVkFramebuffer(
+				device,
+				allocator,
+				framebufferInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		for (size_t i = 0; i < gBufferAttachmentCount; i++)
+			gBufferAttachmentArray[i] = gBufferAttachments[i];
+
+		framebufferInstance->vk.gBufferAttachments = gBufferAttachmentArray;
+		framebufferInstance->vk.gBufferAttachmentCount = gBufferAttachmentCount;
+	}
+
+	framebufferInstance->vk.depthStencilAttachment = depthStencilAttachment;
+
+	AttachmentLoadOp* loadOpArray;
+	AttachmentStoreOp* storeOpArray;
+
+	bool result = createFramebufferAttachmentOps(
+		loadOps,
+		storeOps,
+		depthStencilAttachment ?
+			colorAttachmentCount + 1 : colorAttachmentCount,
+		&loadOpArray,
+		&storeOpArray);
+
+	if (!result)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.loadOps = loadOpArray;
+	framebufferInstance->vk.storeOps = storeOpArray;
+
+	GraphicsPipeline* pipelines = malloc(
+		sizeof(GraphicsPipeline));
+
+	if (!pipelines)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.pipelines = pipelines;
+	framebufferInstance->vk.pipelineCapacity = 1;
+	framebufferInstance->vk.pipelineCount = 0;
+
+	MpgxResult mpgxResult;
+
+	if (sampleCount > VK_SAMPLE_COUNT_1_BIT)
+	{
+		VkMultisampleAttachment* multisampleAttachments;
+
+		mpgxResult = createVkMultisampleAttachments(
+			device,
+			allocator,
+			sampleCount,
+			size,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			&multisampleAttachments);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyVkFramebuffer(
+				device,
+				allocator,
+				framebufferInstance);
+			return mpgxResult;
+		}
+
+		framebufferInstance->vk.multisampleAttachments =
+			multisampleAttachments;
+	}
+
+	VkImageView* imageViews;
+	size_t attachmentCount;
+
+	mpgxResult = createVkFramebufferImageViews(
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		framebufferInstance->vk.multisampleAttachments,
+		&imageViews,
+		&attachmentCount);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return mpgxResult;
+	}
+
+	VkFramebuffer handle;
+
+	mpgxResult = createVkFramebufferHandle(
+		device,
+		renderPass,
+		attachmentCount,
+		imageViews,
+		size,
+		&handle);
+
+	free(imageViews);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return mpgxResult;
+	}
+
+	framebufferInstance->vk.handle = handle;
+
+	VkClearAttachment* clearAttachments = malloc(
+		attachmentCount * sizeof(VkClearAttachment));
+
+	if (!clearAttachments)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.clearAttachments = clearAttachments;
+
+	VkClearValue* clearValues = malloc(
+		attachmentCount * sizeof(VkClearValue));
+
+	if (!clearValues)
+	{
+		destroyVkFramebuffer(
+			device,
+			allocator,
+			framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->vk.clearValues = clearValues;
+
+	*framebuffer = framebufferInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static MpgxResult recreateVkGraphicsPipelineHandle(
+	VkDevice device,
+	VkRenderPass renderPass,
+	GraphicsPipeline graphicsPipeline,
+	size_t colorAttachmentCount,
+	VkSampleCountFlagBits sampleCount,
+	Vec2I framebufferSize,
+	const VkGraphicsPipelineCreateData* createData,
+	VkPipeline* retiredHandles);
+
+inline static MpgxResult setVkFramebufferAttachments(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkRenderPass renderPass,
+	Framebuffer framebuffer,
+	Vec2I size,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	VkRetiredFramebuffer* retiredFramebuffer)
+{
+	assert(device);
+	assert(allocator);
+	assert(renderPass);
+	assert(framebuffer);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(retiredFramebuffer);
+	// TODO: assert attachments
+
+	memset(retiredFramebuffer, 0, sizeof(VkRetiredFramebuffer));
+
+	AttachmentLoadOp* loadOpArray;
+	AttachmentStoreOp* storeOpArray;
+
+	bool result = createFramebufferAttachmentOps(
+		loadOps,
+		storeOps,
+		depthStencilAttachment ?
+			colorAttachmentCount + 1 : colorAttachmentCount,
+		&loadOpArray,
+		&storeOpArray);
+
+	if (!result)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	Image* colorAttachmentArray;
+
+	if (colorAttachmentCount > 0)
+	{
+		colorAttachmentArray = malloc(
+			colorAttachmentCount * sizeof(Image));
+
+		if (!colorAttachmentArray)
+		{
+			free(storeOpArray);
+			free(loadOpArray);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+			colorAttachmentArray[i] = colorAttachments[i];
+	}
+	else
+	{
+		colorAttachmentArray = NULL;
+	}
+
+	Image* gBufferAttachmentArray;
+
+	if (gBufferAttachmentCount > 0)
+	{
+		gBufferAttachmentArray = malloc(
+			gBufferAttachmentCount * sizeof(Image));
+
+		if (!gBufferAttachmentArray)
+		{
+			free(colorAttachmentArray);
+			free(storeOpArray);
+			free(loadOpArray);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		for (size_t i = 0; i < gBufferAttachmentCount; i++)
+			gBufferAttachmentArray[i] = gBufferAttachments[i];
+	}
+	else
+	{
+		gBufferAttachmentArray = NULL;
+	}
+
+	VkSampleCountFlagBits sampleCount =
+		(VkSampleCountFlagBits)framebuffer->vk.sampleCount;
+	VkMultisampleAttachment* multisampleAttachments = NULL;
+
+	MpgxResult mpgxResult;
+
+	if (sampleCount > VK_SAMPLE_COUNT_1_BIT)
+	{
+		mpgxResult = createVkMultisampleAttachments(
+			device,
+			allocator,
+			sampleCount,
+			size,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			&multisampleAttachments);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			free(gBufferAttachmentArray);
+			free(colorAttachmentArray);
+			free(storeOpArray);
+			free(loadOpArray);
+			return mpgxResult;
+		}
+	}
+
+	size_t multisampleAttachmentCount = depthStencilAttachment ?
+		colorAttachmentCount + 1 : colorAttachmentCount;
+
+	VkImageView* imageViews;
+	size_t attachmentCount;
+
+	mpgxResult = createVkFramebufferImageViews(
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		multisampleAttachments,
+		&imageViews,
+		&attachmentCount);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkMultisampleAttachments(
+			device,
+			allocator,
+			multisampleAttachments,
+			multisampleAttachmentCount);
+		free(gBufferAttachmentArray);
+		free(colorAttachmentArray);
+		free(storeOpArray);
+		free(loadOpArray);
+		return mpgxResult;
+	}
+
+	VkFramebuffer handle;
+
+	mpgxResult = createVkFramebufferHandle(
+		device,
+		renderPass,
+		attachmentCount,
+		imageViews,
+		size,
+		&handle);
+
+	free(imageViews);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkMultisampleAttachments(
+			device,
+			allocator,
+			multisampleAttachments,
+			multisampleAttachmentCount);
+		free(gBufferAttachmentArray);
+		free(colorAttachmentArray);
+		free(storeOpArray);
+		free(loadOpArray);
+		return mpgxResult;
+	}
+
+	GraphicsPipeline* pipelines = framebuffer->vk.pipelines;
+	size_t pipelineCount = framebuffer->vk.pipelineCount;
+	VkPipeline* retiredPipelines;
+
+	if (pipelineCount > 0)
+	{
+		// Pipeline and its fast linked variant are retired
+		retiredPipelines = malloc(
+			pipelineCount * 2 * sizeof(VkPipeline));
+
+		if (!retiredPipelines)
+		{
+			vkDestroyFramebuffer(
+				device,
+				handle,
+				NULL);
+			destroyVkMultisampleAttachments(
+				device,
+				allocator,
+				multisampleAttachments,
+				multisampleAttachmentCount);
+			free(gBufferAttachmentArray);
+			free(colorAttachmentArray);
+			free(storeOpArray);
+			free(loadOpArray);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+	}
+	else
+	{
+		retiredPipelines = NULL;
+	}
+
+	VkClearValue* clearValues = malloc(
+		attachmentCount * sizeof(VkClearValue));
+
+	if (!clearValues)
+	{
+		free(retiredPipelines);
+		vkDestroyFramebuffer(
+			device,
+			handle,
+			NULL);
+		destroyVkMultisampleAttachments(
+			device,
+			allocator,
+			multisampleAttachments,
+			multisampleAttachmentCount);
+		free(gBufferAttachmentArray);
+		free(colorAttachmentArray);
+		free(storeOpArray);
+		free(loadOpArray);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	VkClearAttachment* clearAttachments = realloc(
+		framebuffer->vk.clearAttachments,
+		attachmentCount * sizeof(VkClearAttachment));
+
+	if (!clearAttachments)
+	{
+		free(clearValues);
+		free(retiredPipelines);
+		vkDestroyFramebuffer(
+			device,
+			handle,
+			NULL);
+		destroyVkMultisampleAttachments(
+			device,
+			allocator,
+			multisampleAttachments,
+			multisampleAttachmentCount);
+		free(gBufferAttachmentArray);
+		free(colorAttachmentArray);
+		free(storeOpArray);
+		free(loadOpArray);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebuffer->vk.clearAttachments = clearAttachments;
+	free(framebuffer->vk.clearValues);
+	framebuffer->vk.clearValues = clearValues;
+
+	for (size_t i = 0; i < pipelineCount; i++)
+	{
+		GraphicsPipeline pipeline = pipelines[i];
+
+		OnGraphicsPipelineResize onResize =
+			getGraphicsPipelineOnResize(pipeline);
+
+		VkGraphicsPipelineCreateData createData;
+		onResize(pipeline, size, &createData);
+
+		mpgxResult = recreateVkGraphicsPipelineHandle(
+			device,
+			renderPass,
+			pipeline,
+			getFramebufferSubpassColorCount(
+				colorAttachmentCount,
+				gBufferAttachmentCount,
+				getGraphicsPipelineState(pipeline)->subpassIndex),
+			sampleCount,
+			size,
+			&createData,
+			&retiredPipelines[i * 2]);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			vkDestroyFramebuffer(
+				device,
+				handle,
+				NULL);
+			destroyVkMultisampleAttachments(
+				device,
+				allocator,
+				multisampleAttachments,
+				multisampleAttachmentCount);
+			free(gBufferAttachmentArray);
+			free(colorAttachmentArray);
+			free(storeOpArray);
+			free(loadOpArray);
+
+			// Previous pipelines are already recreated
+			retiredFramebuffer->pipelines = retiredPipelines;
+			retiredFramebuffer->pipelineCount = i * 2;
+			return mpgxResult;
+		}
+	}
+
+	// Old framebuffer is destroyed after the frame fence wait
+	retiredFramebuffer->handle = framebuffer->vk.handle;
+	retiredFramebuffer->multisampleAttachments =
+		framebuffer->vk.multisampleAttachments;
+	retiredFramebuffer->multisampleAttachmentCount =
+		framebuffer->vk.depthStencilAttachment ?
+		framebuffer->vk.colorAttachmentCount + 1 :
+		framebuffer->vk.colorAttachmentCount;
+	retiredFramebuffer->pipelines = retiredPipelines;
+	retiredFramebuffer->pipelineCount = pipelineCount * 2;
+
+	free(framebuffer->vk.storeOps);
+	free(framebuffer->vk.loadOps);
+	free(framebuffer->vk.gBufferAttachments);
+	free(framebuffer->vk.colorAttachments);
+
+	// Libraries are compiled for the old render pass
+	clearVkFramebufferLibraries(
+		device,
+		framebuffer);
+
+	framebuffer->vk.size = size;
+	framebuffer->vk.useBeginClear = useBeginClear;
+	framebuffer->vk.colorAttachments = colorAttachmentArray;
+	framebuffer->vk.colorAttachmentCount = colorAttachmentCount;
+	framebuffer->vk.depthStencilAttachment = depthStencilAttachment;
+	framebuffer->vk.gBufferAttachments = gBufferAttachmentArray;
+	framebuffer->vk.gBufferAttachmentCount = gBufferAttachmentCount;
+	framebuffer->vk.loadOps = loadOpArray;
+	framebuffer->vk.storeOps = storeOpArray;
+	framebuffer->vk.multisampleAttachments = multisampleAttachments;
+	framebuffer->vk.handle = handle;
+	framebuffer->vk.renderPass = renderPass;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static MpgxResult transitVkFramebufferAttachments(
+	VkBarrierBatch barrierBatch,
+	Framebuffer framebuffer)
+{
+	assert(barrierBatch);
+	assert(framebuffer);
+	assert(!framebuffer->vk.isDefault);
+
+	Image* gBufferAttachments = framebuffer->vk.gBufferAttachments;
+	size_t gBufferAttachmentCount = framebuffer->vk.gBufferAttachmentCount;
+	Image* colorAttachments = framebuffer->vk.colorAttachments;
+	size_t colorAttachmentCount = framebuffer->vk.colorAttachmentCount;
+	size_t attachmentCount = colorAttachmentCount + gBufferAttachmentCount;
+	const AttachmentLoadOp* loadOps = framebuffer->vk.loadOps;
+	bool useBeginClear = framebuffer->vk.useBeginClear;
+	Image depthStencilAttachment = framebuffer->vk.depthStencilAttachment;
+	size_t maxBarrierCount = 0;
+
+	for (size_t i = 0; i < attachmentCount; i++)
+	{
+		Image colorAttachment = i < colorAttachmentCount ?
+			colorAttachments[i] :
+			gBufferAttachments[i - colorAttachmentCount];
+		maxBarrierCount += (size_t)colorAttachment->vk.mipCount *
+			colorAttachment->vk.layerCount;
+	}
+
+	if (depthStencilAttachment)
+	{
+		maxBarrierCount += (size_t)depthStencilAttachment->vk.mipCount *
+			depthStencilAttachment->vk.layerCount;
+	}
+
+	// Barriers of all attachments are reserved up front, so a failed
+	// transition does not leave the other attachment states changed.
+	MpgxResult mpgxResult = reserveVkImageBarriers(
+		barrierBatch,
+		maxBarrierCount);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	// Attachment content is discarded, unless
+	// render pass loads the previous values.
+	for (size_t i = 0; i < attachmentCount; i++)
+	{
+		Image colorAttachment;
+		bool discardData;
+
+		if (i < colorAttachmentCount)
+		{
+			colorAttachment = colorAttachments[i];
+			discardData = getFramebufferLoadOp(loadOps,
+				useBeginClear, i) != LOAD_ATTACHMENT_LOAD_OP;
+		}
+		else
+		{
+			colorAttachment = gBufferAttachments[i - colorAttachmentCount];
+			discardData = true;
+		}
+
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			colorAttachment,
+			0,
+			colorAttachment->vk.mipCount,
+			0,
+			colorAttachment->vk.layerCount,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+			VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+			discardData);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+	}
+
+	// Multisampled depth/stencil replaces the attachment
+	if (depthStencilAttachment && !framebuffer->vk.multisampleAttachments)
+	{
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			depthStencilAttachment,
+			0,
+			depthStencilAttachment->vk.mipCount,
+			0,
+			depthStencilAttachment->vk.layerCount,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR |
+			VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR,
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT_KHR |
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR,
+			getFramebufferLoadOp(loadOps, useBeginClear,
+				colorAttachmentCount) != LOAD_ATTACHMENT_LOAD_OP);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+	}
+
+	return SUCCESS_MPGX_RESULT;
+}
+inline static void setVkFramebufferAttachmentStates(
+	Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(!framebuffer->vk.isDefault);
+
+	Image* gBufferAttachments = framebuffer->vk.gBufferAttachments;
+	size_t gBufferAttachmentCount = framebuffer->vk.gBufferAttachmentCount;
+	Image* colorAttachments = framebuffer->vk.colorAttachments;
+	size_t colorAttachmentCount = framebuffer->vk.colorAttachmentCount;
+	size_t attachmentCount = colorAttachmentCount + gBufferAttachmentCount;
+
+	// Render pass external dependency makes
+	// attachment writes visible to the shaders.
+	for (size_t i = 0; i < attachmentCount; i++)
+	{
+		setVkImageState(
+			i < colorAttachmentCount ? colorAttachments[i] :
+				gBufferAttachments[i - colorAttachmentCount],
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+			VK_ACCESS_2_SHADER_READ_BIT_KHR);
+	}
+
+	Image depthStencilAttachment = framebuffer->vk.depthStencilAttachment;
+
+	if (depthStencilAttachment && !framebuffer->vk.multisampleAttachments)
+	{
+		setVkImageState(
+			depthStencilAttachment,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+			VK_ACCESS_2_SHADER_READ_BIT_KHR);
+	}
+}
+inline static VkClearColorValue getVkClearColorValue(
+	Image attachment,
+	LinearColor color)
+{
+	VkClearColorValue clearColorValue;
+
+	// Integer attachments are cleared with the truncated color values
+	if (attachment && attachment->vk.format == R32_SINT_IMAGE_FORMAT)
+	{
+		clearColorValue.int32[0] = (int32_t)color.r;
+		clearColorValue.int32[1] = (int32_t)color.g;
+		clearColorValue.int32[2] = (int32_t)color.b;
+		clearColorValue.int32[3] = (int32_t)color.a;
+	}
+	else if (attachment && isImageFormatInteger(attachment->vk.format))
+	{
+		clearColorValue.uint32[0] = (uint32_t)color.r;
+		clearColorValue.uint32[1] = (uint32_t)color.g;
+		clearColorValue.uint32[2] = (uint32_t)color.b;
+		clearColorValue.uint32[3] = (uint32_t)color.a;
+	}
+	else
+	{
+		clearColorValue.float32[0] = color.r;
+		clearColorValue.float32[1] = color.g;
+		clearColorValue.float32[2] = color.b;
+		clearColorValue.float32[3] = color.a;
+	}
+
+	return clearColorValue;
+}
+inline static void beginVkFramebufferRender(
+	VkCommandBuffer commandBuffer,
+	Framebuffer framebuffer,
+	const FramebufferClear* clearValues,
+	size_t clearValueCount)
+{
+	assert(commandBuffer);
+	assert(framebuffer);
+
+	VkClearValue* vkClearValues = framebuffer->vk.clearValues;
+	Image* colorAttachments = framebuffer->vk.colorAttachments;
+	Image* gBufferAttachments = framebuffer->vk.gBufferAttachments;
+	size_t colorAttachmentCount = framebuffer->vk.colorAttachmentCount;
+	size_t attachmentCount = colorAttachmentCount +
+		framebuffer->vk.gBufferAttachmentCount;
+
+	// Render pass attachments are color, G-buffer and depth stencil
+	for (size_t i = 0; i < clearValueCount; i++)
+	{
+		if (i < attachmentCount)
+		{
+			Image attachment;
+
+			if (!colorAttachments)
+				attachment = NULL;
+			else if (i < colorAttachmentCount)
+				attachment = colorAttachments[i];
+			else
+				attachment = gBufferAttachments[i - colorAttachmentCount];
+
+			vkClearValues[i].color = getVkClearColorValue(
+				attachment,
+				clearValues[i].color);
+		}
+		else
+		{
+			DepthStencilClear value = clearValues[i].depthStencil;
+			vkClearValues[i].depthStencil.depth = value.depth;
+			vkClearValues[i].depthStencil.stencil = value.stencil;
+		}
+	}
+
+	Vec2I size = framebuffer->vk.size;
+
+	VkRenderPassBeginInfo renderPassBeginInfo = {
+		VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+		NULL,
+		framebuffer->vk.renderPass,
+		framebuffer->vk.handle,
+		{
+			0, 0,
+			size.x, size.y,
+		},
+		(uint32_t)clearValueCount,
+		vkClearValues,
+	};
+
+	vkCmdBeginRenderPass(
+		commandBuffer,
+		&renderPassBeginInfo,
+		VK_SUBPASS_CONTENTS_INLINE);
+}
+inline static void nextVkFramebufferSubpass(
+	VkCommandBuffer commandBuffer)
+{
+	assert(commandBuffer);
+
+	vkCmdNextSubpass(
+		commandBuffer,
+		VK_SUBPASS_CONTENTS_INLINE);
+}
+inline static void endVkFramebufferRender(
+	VkCommandBuffer commandBuffer)
+{
+	assert(commandBuffer);
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+inline static void clearVkFramebuffer(
+	VkCommandBuffer commandBuffer,
+	Vec2I framebufferSize,
+	bool hasDepthAttachment,
+	bool hasStencilAttachment,
+	Image* colorAttachments,
+	VkClearAttachment* vkClearAttachments,
+	const bool* clearAttachments,
+	const FramebufferClear* clearValues,
+	size_t clearValueCount)
+{
+	assert(commandBuffer);
+	assert(framebufferSize.x > 0);
+	assert(framebufferSize.y > 0);
+	assert(clearAttachments);
+	assert(clearValues);
+	assert(clearValueCount > 0);
+
+	size_t clearAttachmentCount = 0;
+
+	size_t colorAttachmentCount =
+		hasDepthAttachment || hasStencilAttachment ?
+		clearValueCount - 1 : clearValueCount;
+
+	for (size_t i = 0; i < colorAttachmentCount; i++)
+	{
+		if (!clearAttachments[i])
+			continue;
+
+		VkClearValue clearValue;
+
+		clearValue.color = getVkClearColorValue(
+			colorAttachments ? colorAttachments[i] : NULL,
+			clearValues[i].color);
+
+		VkClearAttachment clearAttachment = {
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			(uint32_t)i,
+			clearValue,
+		};
+
+		vkClearAttachments[clearAttachmentCount++] = clearAttachment;
+	}
+
+	if ((hasDepthAttachment | hasStencilAttachment) &
+		clearAttachments[colorAttachmentCount])
+	{
+		DepthStencilClear value =
+			clearValues[colorAttachmentCount].depthStencil;
+
+		VkClearValue clearValue;
+		clearValue.depthStencil.depth = value.depth;
+		clearValue.depthStencil.stencil = value.stencil;
+
+		VkImageAspectFlags aspectMask;
+
+		if (hasDepthAttachment)
+			aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (hasStencilAttachment)
+			aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+
+		VkClearAttachment clearAttachment = {
+			aspectMask,
+			(uint32_t)colorAttachmentCount,
+			clearValue,
+		};
+
+		vkClearAttachments[clearAttachmentCount++] = clearAttachment;
+	}
+
+	VkClearRect clearRect = {
+		{
+			0, 0,
+			framebufferSize.x,
+			framebufferSize.y,
+		},
+		0,
+		1,
+	};
+
+	vkCmdClearAttachments(
+		commandBuffer,
+		(uint32_t)clearAttachmentCount,
+		vkClearAttachments,
+		1,
+		&clearRect);
+}
+#endif
+
+#if MPGX_SUPPORT_OPENGL
+inline static GLenum getGlDepthStencilAttachment(ImageFormat format)
+{
+	switch (format)
+	{
+	default:
+		abort();
+	case D16_UNORM_IMAGE_FORMAT:
+	case D32_SFLOAT_IMAGE_FORMAT:
+		return GL_DEPTH_ATTACHMENT;
+	case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+	case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+		return GL_DEPTH_STENCIL_ATTACHMENT;
+	}
+}
+inline static void invalidateGlFramebufferAttachment(
+	GLenum target,
+	GLenum attachment)
+{
+	// Lets the tiled GPUs skip attachment load or store
+	if (GLAD_GL_ARB_invalidate_subdata)
+	{
+		glInvalidateFramebuffer(
+			target,
+			GL_ONE,
+			&attachment);
+	}
+}
+inline static uint8_t getGlSampleCount(uint8_t sampleCount)
+{
+	assert(sampleCount > 0);
+
+	GLint maxSampleCount = 1;
+
+	glGetIntegerv(
+		GL_MAX_SAMPLES,
+		&maxSampleCount);
+
+	uint8_t count = 1;
+
+	// Selects highest supported count not above requested
+	while (count * 2 <= sampleCount &&
+		count * 2 <= maxSampleCount)
+	{
+		count *= 2;
+	}
+
+	return count;
+}
+inline static void destroyGlMultisampleFramebufferHandle(
+	GLuint handle,
+	GLuint* renderbuffers,
+	size_t renderbufferCount)
+{
+	glDeleteFramebuffers(
+		GL_ONE,
+		&handle);
+
+	if (renderbuffers)
+	{
+		glDeleteRenderbuffers(
+			(GLsizei)renderbufferCount,
+			renderbuffers);
+		free(renderbuffers);
+	}
+}
+inline static void destroyGlFramebuffer(Framebuffer framebuffer)
+{
+	if (!framebuffer)
+		return;
+
+	if (framebuffer->gl.isDefault == false)
+	{
+		makeGlWindowContextCurrent(
+			framebuffer->gl.window);
+		glDeleteFramebuffers(
+			GL_ONE,
+			&framebuffer->gl.resolveHandle);
+		glDeleteFramebuffers(
+			GL_ONE,
+			&framebuffer->gl.subpassHandle);
+		destroyGlMultisampleFramebufferHandle(
+			framebuffer->gl.handle,
+			framebuffer->gl.renderbuffers,
+			framebuffer->gl.depthStencilAttachment ?
+				framebuffer->gl.colorAttachmentCount + 1 :
+				framebuffer->gl.colorAttachmentCount);
+		assertOpenGL();
+		free(framebuffer->gl.storeOps);
+		free(framebuffer->gl.loadOps);
+		free(framebuffer->gl.gBufferAttachments);
+		free(framebuffer->gl.colorAttachments);
+	}
+
+	assert(framebuffer->gl.pipelineCount == 0);
+
+	free(framebuffer->gl.pipelines);
+	free(framebuffer);
+}
+
+inline static MpgxResult createGlDefaultFramebuffer(
+	Window window,
+	Vec2I size,
+	Framebuffer* framebuffer)
+{
+	assert(window);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(framebuffer);
+
+	Framebuffer framebufferInstance = calloc(1,
+		sizeof(Framebuffer_T));
+
+	if (!framebufferInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	framebufferInstance->gl.window = window;
+	framebufferInstance->gl.colorAttachments = NULL;
+	framebufferInstance->gl.colorAttachmentCount = 1;
+	framebufferInstance->gl.depthStencilAttachment = NULL;
+	framebufferInstance->gl.size = size;
+	framebufferInstance->gl.isDefault = true;
+	framebufferInstance->gl.useBeginClear = true;
+#ifndef NDEBUG
+	framebufferInstance->gl.isEnumerating = false;
+#endif
+
+	// Default framebuffer is multisampled by the context
+	GLint sampleCount = 0;
+
+	glGetIntegerv(
+		GL_SAMPLES,
+		&sampleCount);
+	assertOpenGL();
+
+	framebufferInstance->gl.sampleCount = sampleCount > 1 ?
+		(uint8_t)sampleCount : 1;
+
+	GraphicsPipeline* pipelines = malloc(
+		sizeof(GraphicsPipeline));
+
+	if (!pipelines)
+	{
+		destroyGlFramebuffer(framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	framebufferInstance->gl.pipelines = pipelines;
+	framebufferInstance->gl.pipelineCapacity = 1;
+	framebufferInstance->gl.pipelineCount = 0;
+	framebufferInstance->gl.handle = GL_ZERO;
+
+	*framebuffer = framebufferInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createGlFramebufferHandle(
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	GLuint* handle)
+{
+	assert(handle);
+
+	GLuint handleInstance = GL_ZERO;
+
+	glGenFramebuffers(
+		GL_ONE,
+		&handleInstance);
+	glBindFramebuffer(
+		GL_FRAMEBUFFER,
+		handleInstance);
+
+	if (colorAttachmentCount > 0)
+	{
+		GLenum* drawBuffers = malloc(
+			sizeof(GLenum) * colorAttachmentCount);
+
+		if (!drawBuffers)
+		{
+			glDeleteFramebuffers(
+				GL_ONE,
+				&handleInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+		{
+			Image colorAttachment = colorAttachments[i];
+
+			ImageFormat format = colorAttachment->gl.format;
+			GLenum glAttachment = GL_COLOR_ATTACHMENT0 + (GLenum)i;
+
+			switch (format)
+			{
+			default:
+				free(drawBuffers);
+				glDeleteFramebuffers(
+					GL_ONE,
+					&handleInstance);
+				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			case R8_UNORM_IMAGE_FORMAT:
+			case R8G8B8A8_UNORM_IMAGE_FORMAT:
+			case R8G8B8A8_SRGB_IMAGE_FORMAT:
+			case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
+			case R8G8_UNORM_IMAGE_FORMAT:
+			case R16_SFLOAT_IMAGE_FORMAT:
+			case R16G16_SFLOAT_IMAGE_FORMAT:
+			case R32_SFLOAT_IMAGE_FORMAT:
+			case R32G32B32A32_SFLOAT_IMAGE_FORMAT:
+			case B10G11R11_UFLOAT_IMAGE_FORMAT:
+			case A2B10G10R10_UNORM_IMAGE_FORMAT:
+			case R8_UINT_IMAGE_FORMAT:
+			case R16_UINT_IMAGE_FORMAT:
+			case R32_UINT_IMAGE_FORMAT:
+			case R32_SINT_IMAGE_FORMAT:
+			case R16G16_UINT_IMAGE_FORMAT:
+			case R8G8B8A8_UINT_IMAGE_FORMAT:
+			case R16G16B16A16_UINT_IMAGE_FORMAT:
+			case R32G32B32A32_UINT_IMAGE_FORMAT:
+				glFramebufferTexture2D(
+					GL_FRAMEBUFFER,
+					glAttachment,
+					colorAttachment->gl.glType,
+					colorAttachment->gl.handle,
+					GL_ZERO);
+				break;
+			}
+
+			drawBuffers[i] = glAttachment;
+		}
+
+		glDrawBuffers(
+			(GLsizei)colorAttachmentCount,
+			drawBuffers);
+		free(drawBuffers);
+	}
+	else
+	{
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+
+	if (depthStencilAttachment)
+	{
+		ImageFormat format = depthStencilAttachment->gl.format;
+
+		switch (format)
+		{
+		default:
+			glDeleteFramebuffers(
+				GL_ONE,
+				&handleInstance);
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		case D16_UNORM_IMAGE_FORMAT:
+		case D32_SFLOAT_IMAGE_FORMAT:
+			glFramebufferTexture2D(
+				GL_FRAMEBUFFER,
+				GL_DEPTH_ATTACHMENT,
+				depthStencilAttachment->gl.glType,
+				depthStencilAttachment->gl.handle,
+				GL_ZERO);
+			break;
+		case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+		case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+			glFramebufferTexture2D(
+				GL_FRAMEBUFFER,
+				GL_DEPTH_STENCIL_ATTACHMENT,
+				depthStencilAttachment->gl.glType,
+				depthStencilAttachment->gl.handle,
+				GL_ZERO);
+			break;
+		}
+	}
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+#ifndef NDEBUG
+		const char* statusName;
+
+		switch (status)
+		{
+		default:
+			statusName = "UNKNOWN_STATUS";
+			break;
+		case GL_FRAMEBUFFER_UNDEFINED:
+			statusName = "GL_FRAMEBUFFER_UNDEFINED";
+			break;
+		case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
+			statusName = "GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT";
+			break;
+		case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+			statusName = "GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT";
+			break;
+		case GL_FRAMEBUFFER_UNSUPPORTED:
+			statusName = "GL_FRAMEBUFFER_UNSUPPORTED";
+			break;
+		case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE:
+			statusName = "GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE";
+			break;
+		}
+
+		fprintf(stderr,
+			"OpenGL framebuffer create error: %s\n",
+			statusName);
+#endif
+
+		assertOpenGL();
+		glDeleteFramebuffers(
+			GL_ONE,
+			&handleInstance);
+		return UNKNOWN_ERROR_MPGX_RESULT;
+	}
+
+	GLenum glError = glGetError();
+
+	if (glError != GL_NO_ERROR)
+	{
+		glDeleteFramebuffers(
+			GL_ONE,
+			&handleInstance);
+		return glToMpgxResult(glError);
+	}
+
+	*handle = handleInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createGlMultisampleFramebufferHandle(
+	GLsizei sampleCount,
+	Vec2I size,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	GLuint* handle,
+	GLuint** renderbuffers)
+{
+	assert(sampleCount > 1);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(colorAttachments);
+	assert(colorAttachmentCount > 0);
+	assert(handle);
+	assert(renderbuffers);
+
+	size_t renderbufferCount = depthStencilAttachment ?
+		colorAttachmentCount + 1 : colorAttachmentCount;
+
+	GLenum* drawBuffers = malloc(
+		sizeof(GLenum) * colorAttachmentCount);
+
+	if (!drawBuffers)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	GLuint* renderbufferArray = malloc(
+		sizeof(GLuint) * renderbufferCount);
+
+	if (!renderbufferArray)
+	{
+		free(drawBuffers);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	glGenRenderbuffers(
+		(GLsizei)renderbufferCount,
+		renderbufferArray);
+
+	GLuint handleInstance = GL_ZERO;
+
+	glGenFramebuffers(
+		GL_ONE,
+		&handleInstance);
+	glBindFramebuffer(
+		GL_FRAMEBUFFER,
+		handleInstance);
+
+	for (size_t i = 0; i < renderbufferCount; i++)
+	{
+		Image image = i < colorAttachmentCount ?
+			colorAttachments[i] : depthStencilAttachment;
+
+		GLint glFormat;
+		GLenum dataFormat, dataType;
+
+		bool result = getGlImageFormat(
+			image->gl.format,
+			&glFormat,
+			&dataFormat,
+			&dataType);
+
+		if (!result)
+		{
+			destroyGlMultisampleFramebufferHandle(
+				handleInstance,
+				renderbufferArray,
+				renderbufferCount);
+			free(drawBuffers);
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		}
+
+		glBindRenderbuffer(
+			GL_RENDERBUFFER,
+			renderbufferArray[i]);
+		glRenderbufferStorageMultisample(
+			GL_RENDERBUFFER,
+			sampleCount,
+			(GLenum)glFormat,
+			(GLsizei)size.x,
+			(GLsizei)size.y);
+
+		GLenum glAttachment;
+
+		if (i < colorAttachmentCount)
+		{
+			glAttachment = GL_COLOR_ATTACHMENT0 + (GLenum)i;
+			drawBuffers[i] = glAttachment;
+		}
+		else
+		{
+			glAttachment = dataFormat == GL_DEPTH_STENCIL ?
+				GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		}
+
+		glFramebufferRenderbuffer(
+			GL_FRAMEBUFFER,
+			glAttachment,
+			GL_RENDERBUFFER,
+			renderbufferArray[i]);
+	}
+
+	glDrawBuffers(
+		(GLsizei)colorAttachmentCount,
+		drawBuffers);
+	free(drawBuffers);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	GLenum glError = glGetError();
+
+	if (status != GL_FRAMEBUFFER_COMPLETE || glError != GL_NO_ERROR)
+	{
+		destroyGlMultisampleFramebufferHandle(
+			handleInstance,
+			renderbufferArray,
+			renderbufferCount);
+		return glError != GL_NO_ERROR ?
+			glToMpgxResult(glError) :
+			UNKNOWN_ERROR_MPGX_RESULT;
+	}
+
+	*handle = handleInstance;
+	*renderbuffers = renderbufferArray;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createGlFramebufferHandles(
+	GLsizei sampleCount,
+	Vec2I size,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	GLuint* handle,
+	GLuint* subpassHandle,
+	GLuint* resolveHandle,
+	GLuint** renderbuffers)
+{
+	assert(handle);
+	assert(subpassHandle);
+	assert(resolveHandle);
+	assert(renderbuffers);
+
+	if (sampleCount > 1)
+	{
+		assert(gBufferAttachmentCount == 0);
+
+		// Multisampled renderbuffers are resolved
+		// into the attachment textures at the end.
+		GLuint handleInstance;
+		GLuint* renderbufferArray;
+
+		MpgxResult mpgxResult = createGlMultisampleFramebufferHandle(
+			sampleCount,
+			size,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			&handleInstance,
+			&renderbufferArray);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		GLuint resolveHandleInstance;
+
+		mpgxResult = createGlFramebufferHandle(
+			colorAttachments,
+			colorAttachmentCount,
+			NULL,
+			&resolveHandleInstance);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyGlMultisampleFramebufferHandle(
+				handleInstance,
+				renderbufferArray,
+				depthStencilAttachment ?
+					colorAttachmentCount + 1 :
+					colorAttachmentCount);
+			return mpgxResult;
+		}
+
+		*handle = handleInstance;
+		*subpassHandle = GL_ZERO;
+		*resolveHandle = resolveHandleInstance;
+		*renderbuffers = renderbufferArray;
+		return SUCCESS_MPGX_RESULT;
+	}
+
+	*resolveHandle = GL_ZERO;
+	*renderbuffers = NULL;
+
+	if (gBufferAttachmentCount == 0)
+	{
+		*subpassHandle = GL_ZERO;
+
+		return createGlFramebufferHandle(
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			handle);
+	}
+
+	// Deferred subpasses are emulated with
+	// separate G-buffer and lighting framebuffers.
+	GLuint handleInstance;
+
+	MpgxResult mpgxResult = createGlFramebufferHandle(
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		depthStencilAttachment,
+		&handleInstance);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	GLuint subpassHandleInstance;
 
-	GraphicsPipeline* pipelines = malloc(
-		sizeof(GraphicsPipeline));
+	mpgxResult = createGlFramebufferHandle(
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		&subpassHandleInstance);
 
-	if (!pipelines)
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
 	{
-		destroyGlFramebuffer(framebufferInstance);
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		glDeleteFramebuffers(
+			GL_ONE,
+			&handleInstance);
+		return mpgxResult;
 	}
 
-	framebufferInstance->gl.pipelines = pipelines;
-	framebufferInstance->gl.pipelineCapacity = 1;
-	framebufferInstance->gl.pipelineCount = 0;
-	framebufferInstance->gl.handle = GL_ZERO;
-
-	*framebuffer = framebufferInstance;
+	*handle = handleInstance;
+	*subpassHandle = subpassHandleInstance;
 	return SUCCESS_MPGX_RESULT;
 }
 inline static MpgxResult createGlFramebuffer(
 	Window window,
 	Vec2I size,
+	uint8_t sampleCount,
 	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
 	Framebuffer* framebuffer)
 {
 	assert(window);
 	assert(size.x > 0);
 	assert(size.y > 0);
+	assert(sampleCount == 1 || gBufferAttachmentCount == 0);
 	assert(framebuffer);
 	// TODO: assert attachments
 
@@ -995,25 +3019,9 @@ inline static MpgxResult createGlFramebuffer(
 	framebufferInstance->gl.isEnumerating = false;
 #endif
 
-	makeGlWindowContextCurrent(window);
-
-	GLuint handle = GL_ZERO;
-
-	glGenFramebuffers(
-		GL_ONE,
-		&handle);
-
-	framebufferInstance->gl.handle = handle;
-
-	glBindFramebuffer(
-		GL_FRAMEBUFFER,
-		handle);
-
-	Image* colorAttachmentArray;
-
 	if (colorAttachmentCount > 0)
 	{
-		colorAttachmentArray = malloc(
+		Image* colorAttachmentArray = malloc(
 			colorAttachmentCount * sizeof(Image));
 
 		if (!colorAttachmentArray)
@@ -1022,142 +3030,85 @@ inline static MpgxResult createGlFramebuffer(
 			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
 
-		GLenum* drawBuffers = malloc(
-			sizeof(GLenum) * colorAttachmentCount);
-
-		if (!drawBuffers)
-		{
-			free(colorAttachmentArray);
-			destroyGlFramebuffer(framebufferInstance);
-			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-		}
-
 		for (size_t i = 0; i < colorAttachmentCount; i++)
-		{
-			Image colorAttachment = colorAttachments[i];
-
-			ImageFormat format = colorAttachment->gl.format;
-			GLenum glAttachment = GL_COLOR_ATTACHMENT0 + (GLenum)i;
-
-			switch (format)
-			{
-			default:
-				free(drawBuffers);
-				free(colorAttachmentArray);
-				destroyGlFramebuffer(framebufferInstance);
-				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-			case R8_UNORM_IMAGE_FORMAT:
-			case R8G8B8A8_UNORM_IMAGE_FORMAT:
-			case R8G8B8A8_SRGB_IMAGE_FORMAT:
-			case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
-				glFramebufferTexture2D(
-					GL_FRAMEBUFFER,
-					glAttachment,
-					colorAttachment->gl.glType,
-					colorAttachment->gl.handle,
-					GL_ZERO);
-				break;
-			}
-
-			colorAttachmentArray[i] = colorAttachment;
-			drawBuffers[i] = glAttachment;
-		}
-
-		glDrawBuffers(
-			(GLsizei)colorAttachmentCount,
-			drawBuffers);
-		free(drawBuffers);
-	}
-	else
-	{
-		colorAttachmentArray = NULL;
+			colorAttachmentArray[i] = colorAttachments[i];
 
-		glDrawBuffer(GL_NONE);
-		glReadBuffer(GL_NONE);
+		framebufferInstance->gl.colorAttachments = colorAttachmentArray;
+		framebufferInstance->gl.colorAttachmentCount = colorAttachmentCount;
 	}
 
-	framebufferInstance->gl.colorAttachments = colorAttachmentArray;
-	framebufferInstance->gl.colorAttachmentCount = colorAttachmentCount;
-
-	if (depthStencilAttachment)
+	if (gBufferAttachmentCount > 0)
 	{
-		ImageFormat format = depthStencilAttachment->gl.format;
+		Image* gBufferAttachmentArray = malloc(
+			gBufferAttachmentCount * sizeof(Image));
 
-		switch (format)
+		if (!gBufferAttachmentArray)
 		{
-		default:
 			destroyGlFramebuffer(framebufferInstance);
-			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-		case D16_UNORM_IMAGE_FORMAT:
-		case D32_SFLOAT_IMAGE_FORMAT:
-			glFramebufferTexture2D(
-				GL_FRAMEBUFFER,
-				GL_DEPTH_ATTACHMENT,
-				depthStencilAttachment->gl.glType,
-				depthStencilAttachment->gl.handle,
-				GL_ZERO);
-			break;
-		case D24_UNORM_S8_UINT_IMAGE_FORMAT:
-		case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
-			glFramebufferTexture2D(
-				GL_FRAMEBUFFER,
-				GL_DEPTH_STENCIL_ATTACHMENT,
-				depthStencilAttachment->gl.glType,
-				depthStencilAttachment->gl.handle,
-				GL_ZERO);
-			break;
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
+
+		for (size_t i = 0; i < gBufferAttachmentCount; i++)
+			gBufferAttachmentArray[i] = gBufferAttachments[i];
+
+		framebufferInstance->gl.gBufferAttachments = gBufferAttachmentArray;
+		framebufferInstance->gl.gBufferAttachmentCount = gBufferAttachmentCount;
 	}
 
 	framebufferInstance->gl.depthStencilAttachment = depthStencilAttachment;
 
-	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	AttachmentLoadOp* loadOpArray;
+	AttachmentStoreOp* storeOpArray;
 
-	if (status != GL_FRAMEBUFFER_COMPLETE)
+	bool result = createFramebufferAttachmentOps(
+		loadOps,
+		storeOps,
+		depthStencilAttachment ?
+			colorAttachmentCount + 1 : colorAttachmentCount,
+		&loadOpArray,
+		&storeOpArray);
+
+	if (!result)
 	{
-#ifndef NDEBUG
-		const char* statusName;
+		destroyGlFramebuffer(framebufferInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
 
-		switch (status)
-		{
-		default:
-			statusName = "UNKNOWN_STATUS";
-			break;
-		case GL_FRAMEBUFFER_UNDEFINED:
-			statusName = "GL_FRAMEBUFFER_UNDEFINED";
-			break;
-		case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
-			statusName = "GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT";
-			break;
-		case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
-			statusName = "GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT";
-			break;
-		case GL_FRAMEBUFFER_UNSUPPORTED:
-			statusName = "GL_FRAMEBUFFER_UNSUPPORTED";
-			break;
-		case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE:
-			statusName = "GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE";
-			break;
-		}
+	framebufferInstance->gl.loadOps = loadOpArray;
+	framebufferInstance->gl.storeOps = storeOpArray;
 
-		fprintf(stderr,
-			"OpenGL framebuffer create error: %s\n",
-			statusName);
-#endif
+	makeGlWindowContextCurrent(window);
 
-		assertOpenGL();
-		destroyGlFramebuffer(framebufferInstance);
-		return UNKNOWN_ERROR_MPGX_RESULT;
-	}
+	sampleCount = getGlSampleCount(sampleCount);
+	framebufferInstance->gl.sampleCount = sampleCount;
 
-	GLenum glError = glGetError();
+	GLuint handle, subpassHandle, resolveHandle;
+	GLuint* renderbuffers;
 
-	if (glError != GL_NO_ERROR)
+	MpgxResult mpgxResult = createGlFramebufferHandles(
+		(GLsizei)sampleCount,
+		size,
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		&handle,
+		&subpassHandle,
+		&resolveHandle,
+		&renderbuffers);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
 	{
 		destroyGlFramebuffer(framebufferInstance);
-		return glToMpgxResult(glError);
+		return mpgxResult;
 	}
 
+	framebufferInstance->gl.handle = handle;
+	framebufferInstance->gl.subpassHandle = subpassHandle;
+	framebufferInstance->gl.resolveHandle = resolveHandle;
+	framebufferInstance->gl.renderbuffers = renderbuffers;
+
 	GraphicsPipeline* pipelines = malloc(
 		sizeof(GraphicsPipeline));
 
@@ -1179,15 +3130,33 @@ inline static MpgxResult setGlFramebufferAttachments(
 	Framebuffer framebuffer,
 	Vec2I size,
 	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
-	Image depthStencilAttachment)
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps)
 {
 	assert(framebuffer);
 	assert(size.x > 0);
 	assert(size.y > 0);
 	// TODO: assert attachments
 
+	AttachmentLoadOp* loadOpArray;
+	AttachmentStoreOp* storeOpArray;
+
+	bool result = createFramebufferAttachmentOps(
+		loadOps,
+		storeOps,
+		depthStencilAttachment ?
+			colorAttachmentCount + 1 : colorAttachmentCount,
+		&loadOpArray,
+		&storeOpArray);
+
+	if (!result)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
 	Image* colorAttachmentArray;
 
 	if (colorAttachmentCount > 0)
@@ -1197,7 +3166,11 @@ inline static MpgxResult setGlFramebufferAttachments(
 			colorAttachmentCount * sizeof(Image));
 
 		if (!colorAttachmentArray)
+		{
+			free(storeOpArray);
+			free(loadOpArray);
 			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
 
 		for (size_t i = 0; i < colorAttachmentCount; i++)
 			colorAttachmentArray[i] = colorAttachments[i];
@@ -1207,6 +3180,57 @@ inline static MpgxResult setGlFramebufferAttachments(
 		colorAttachmentArray = NULL;
 	}
 
+	Image* gBufferAttachmentArray;
+
+	if (gBufferAttachmentCount > 0)
+	{
+		gBufferAttachmentArray = malloc(
+			gBufferAttachmentCount * sizeof(Image));
+
+		if (!gBufferAttachmentArray)
+		{
+			free(colorAttachmentArray);
+			free(storeOpArray);
+			free(loadOpArray);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		for (size_t i = 0; i < gBufferAttachmentCount; i++)
+			gBufferAttachmentArray[i] = gBufferAttachments[i];
+	}
+	else
+	{
+		gBufferAttachmentArray = NULL;
+	}
+
+	makeGlWindowContextCurrent(
+		framebuffer->gl.window);
+
+	GLuint handle, subpassHandle, resolveHandle;
+	GLuint* renderbuffers;
+
+	MpgxResult mpgxResult = createGlFramebufferHandles(
+		(GLsizei)framebuffer->gl.sampleCount,
+		size,
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		&handle,
+		&subpassHandle,
+		&resolveHandle,
+		&renderbuffers);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(gBufferAttachmentArray);
+		free(colorAttachmentArray);
+		free(storeOpArray);
+		free(loadOpArray);
+		return mpgxResult;
+	}
+
 	GraphicsPipeline* pipelines = framebuffer->gl.pipelines;
 	size_t pipelineCount = framebuffer->gl.pipelineCount;
 
@@ -1219,6 +3243,23 @@ inline static MpgxResult setGlFramebufferAttachments(
 		onResize(pipeline, size, NULL);
 	}
 
+	glDeleteFramebuffers(
+		GL_ONE,
+		&framebuffer->gl.resolveHandle);
+	glDeleteFramebuffers(
+		GL_ONE,
+		&framebuffer->gl.subpassHandle);
+	destroyGlMultisampleFramebufferHandle(
+		framebuffer->gl.handle,
+		framebuffer->gl.renderbuffers,
+		framebuffer->gl.depthStencilAttachment ?
+			framebuffer->gl.colorAttachmentCount + 1 :
+			framebuffer->gl.colorAttachmentCount);
+	assertOpenGL();
+
+	free(framebuffer->gl.storeOps);
+	free(framebuffer->gl.loadOps);
+	free(framebuffer->gl.gBufferAttachments);
 	free(framebuffer->gl.colorAttachments);
 
 	framebuffer->gl.size = size;
@@ -1226,15 +3267,67 @@ inline static MpgxResult setGlFramebufferAttachments(
 	framebuffer->gl.colorAttachments = colorAttachmentArray;
 	framebuffer->gl.colorAttachmentCount = colorAttachmentCount;
 	framebuffer->gl.depthStencilAttachment = depthStencilAttachment;
+	framebuffer->gl.gBufferAttachments = gBufferAttachmentArray;
+	framebuffer->gl.gBufferAttachmentCount = gBufferAttachmentCount;
+	framebuffer->gl.loadOps = loadOpArray;
+	framebuffer->gl.storeOps = storeOpArray;
+	framebuffer->gl.handle = handle;
+	framebuffer->gl.subpassHandle = subpassHandle;
+	framebuffer->gl.resolveHandle = resolveHandle;
+	framebuffer->gl.renderbuffers = renderbuffers;
 	return SUCCESS_MPGX_RESULT;
 }
 
+inline static void clearGlColorBuffer(
+	Image attachment,
+	GLint drawBuffer,
+	LinearColor color)
+{
+	// Integer attachments are cleared with the truncated color values
+	if (attachment && attachment->gl.format == R32_SINT_IMAGE_FORMAT)
+	{
+		GLint values[4] = {
+			(GLint)color.r,
+			(GLint)color.g,
+			(GLint)color.b,
+			(GLint)color.a,
+		};
+
+		glClearBufferiv(
+			GL_COLOR,
+			drawBuffer,
+			values);
+	}
+	else if (attachment && isImageFormatInteger(attachment->gl.format))
+	{
+		GLuint values[4] = {
+			(GLuint)color.r,
+			(GLuint)color.g,
+			(GLuint)color.b,
+			(GLuint)color.a,
+		};
+
+		glClearBufferuiv(
+			GL_COLOR,
+			drawBuffer,
+			values);
+	}
+	else
+	{
+		glClearBufferfv(
+			GL_COLOR,
+			drawBuffer,
+			(const GLfloat*)&color);
+	}
+}
 inline static void beginGlFramebufferRender(
 	GLuint framebuffer,
 	Vec2I size,
+	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	bool hasDepthAttachment,
 	bool hasStencilAttachment,
+	const AttachmentLoadOp* loadOps,
 	const FramebufferClear* clearValues,
 	size_t clearValueCount)
 {
@@ -1250,6 +3343,31 @@ inline static void beginGlFramebufferRender(
 		(GLsizei)size.y);
 	glDisable(GL_SCISSOR_TEST);
 
+	// Only explicit operations are invalidated,
+	// default framebuffer has no attachment names.
+	if (loadOps)
+	{
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+		{
+			if (loadOps[i] != DONT_CARE_ATTACHMENT_LOAD_OP)
+				continue;
+
+			invalidateGlFramebufferAttachment(
+				GL_FRAMEBUFFER,
+				GL_COLOR_ATTACHMENT0 + (GLenum)i);
+		}
+
+		if ((hasDepthAttachment | hasStencilAttachment) &&
+			loadOps[colorAttachmentCount] == DONT_CARE_ATTACHMENT_LOAD_OP)
+		{
+			invalidateGlFramebufferAttachment(
+				GL_FRAMEBUFFER,
+				hasStencilAttachment ?
+					GL_DEPTH_STENCIL_ATTACHMENT :
+					GL_DEPTH_ATTACHMENT);
+		}
+	}
+
 	if (clearValueCount > 0)
 	{
 		if (colorAttachmentCount > 0)
@@ -1260,14 +3378,18 @@ inline static void beginGlFramebufferRender(
 
 			for (size_t i = 0; i < colorAttachmentCount; i++)
 			{
-				glClearBufferfv(
-					GL_COLOR,
+				if (loadOps && loadOps[i] != CLEAR_ATTACHMENT_LOAD_OP)
+					continue;
+
+				clearGlColorBuffer(
+					colorAttachments ? colorAttachments[i] : NULL,
 					(GLint)i,
-					(const GLfloat*)&clearValues[i].color);
+					clearValues[i].color);
 			}
 		}
 
-		if (hasDepthAttachment | hasStencilAttachment)
+		if ((hasDepthAttachment | hasStencilAttachment) && (!loadOps ||
+			loadOps[colorAttachmentCount] == CLEAR_ATTACHMENT_LOAD_OP))
 		{
 			DepthStencilClear value =
 				clearValues[colorAttachmentCount].depthStencil;
@@ -1306,12 +3428,102 @@ inline static void beginGlFramebufferRender(
 
 	assertOpenGL();
 }
-inline static void endGlFramebufferRender()
+inline static void nextGlFramebufferSubpass(
+	GLuint subpassFramebuffer)
+{
+	glBindFramebuffer(
+		GL_FRAMEBUFFER,
+		subpassFramebuffer);
+	assertOpenGL();
+}
+inline static void endGlFramebufferRender(
+	GLuint framebuffer,
+	GLuint resolveFramebuffer,
+	Vec2I size,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentStoreOp* storeOps)
 {
+	if (resolveFramebuffer != GL_ZERO)
+	{
+		assert(size.x > 0);
+		assert(size.y > 0);
+
+		glBindFramebuffer(
+			GL_READ_FRAMEBUFFER,
+			framebuffer);
+		glBindFramebuffer(
+			GL_DRAW_FRAMEBUFFER,
+			resolveFramebuffer);
+		glDisable(GL_SCISSOR_TEST);
+
+		// Blit resolves only the first draw buffer,
+		// so the attachments are resolved one by one.
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+		{
+			if (storeOps && storeOps[i] == DONT_CARE_ATTACHMENT_STORE_OP)
+				continue;
+
+			GLenum glAttachment = GL_COLOR_ATTACHMENT0 + (GLenum)i;
+
+			glReadBuffer(glAttachment);
+			glDrawBuffers(
+				GL_ONE,
+				&glAttachment);
+			glBlitFramebuffer(
+				0, 0,
+				(GLint)size.x,
+				(GLint)size.y,
+				0, 0,
+				(GLint)size.x,
+				(GLint)size.y,
+				GL_COLOR_BUFFER_BIT,
+				GL_NEAREST);
+		}
+
+		// Multisampled data is not needed after the resolve
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+		{
+			invalidateGlFramebufferAttachment(
+				GL_READ_FRAMEBUFFER,
+				GL_COLOR_ATTACHMENT0 + (GLenum)i);
+		}
+
+		if (depthStencilAttachment)
+		{
+			invalidateGlFramebufferAttachment(
+				GL_READ_FRAMEBUFFER,
+				getGlDepthStencilAttachment(
+				depthStencilAttachment->gl.format));
+		}
+	}
+	else if (storeOps)
+	{
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+		{
+			if (storeOps[i] != DONT_CARE_ATTACHMENT_STORE_OP)
+				continue;
+
+			invalidateGlFramebufferAttachment(
+				GL_FRAMEBUFFER,
+				GL_COLOR_ATTACHMENT0 + (GLenum)i);
+		}
+
+		if (depthStencilAttachment && storeOps[colorAttachmentCount] ==
+			DONT_CARE_ATTACHMENT_STORE_OP)
+		{
+			invalidateGlFramebufferAttachment(
+				GL_FRAMEBUFFER,
+				getGlDepthStencilAttachment(
+				depthStencilAttachment->gl.format));
+		}
+	}
+
 	assertOpenGL();
 }
 inline static void clearGlFramebuffer(
 	Vec2I size,
+	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	bool hasDepthAttachment,
 	bool hasStencilAttachment,
@@ -1343,10 +3555,10 @@ inline static void clearGlFramebuffer(
 				if (!clearAttachments[i])
 					continue;
 
-				glClearBufferfv(
-					GL_COLOR,
+				clearGlColorBuffer(
+					colorAttachments ? colorAttachments[i] : NULL,
 					(GLint)i,
-					(const GLfloat*)&clearValues[i].color);
+					clearValues[i].color);
 			}
 		}
 
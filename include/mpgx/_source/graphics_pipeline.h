@@ -15,6 +15,29 @@
 #pragma once
 #include "mpgx/_source/shader.h"
 #include "mpgx/_source/framebuffer.h"
+#include "mpmt/mutex.h"
+
+#if MPGX_SUPPORT_VULKAN
+#define VK_PIPELINE_LIBRARY_PART_COUNT 4
+#endif
+
+#if MPGX_SUPPORT_OPENGL
+#define GL_PROGRAM_CACHE_EXTENSION ".glbin"
+#define GL_UNIFORM_TABLE_SEED_COUNT 64
+
+typedef struct GlUniformEntry
+{
+	uint64_t hash;
+	GLint value;
+	uint8_t _alignment[4];
+} GlUniformEntry;
+typedef struct GlUniformTable
+{
+	GlUniformEntry* entries;
+	uint64_t seed;
+	size_t mask;
+} GlUniformTable;
+#endif
 
 typedef struct BaseGraphicsPipeline_T
 {
@@ -28,6 +51,10 @@ typedef struct BaseGraphicsPipeline_T
 	Shader* shaders;
 	size_t shaderCount;
 	GraphicsPipelineState state;
+	GraphicsPipeline fallback;
+	size_t dependentCount;
+	bool isReady;
+	MpgxResult compileResult;
 #ifndef NDEBUG
 	char* name;
 #endif
@@ -45,12 +72,21 @@ typedef struct VkGraphicsPipeline_T
 	Shader* shaders;
 	size_t shaderCount;
 	GraphicsPipelineState state;
+	GraphicsPipeline fallback;
+	size_t dependentCount;
+	bool isReady;
+	MpgxResult compileResult;
 #ifndef NDEBUG
 	char* name;
 #endif
 	VkPipelineCache cache;
+	VkSpecializationInfo* specializationInfo;
+	VkReflectedLayout reflectedLayout;
 	VkPipelineLayout layout;
+	VkPipeline libraries[VK_PIPELINE_LIBRARY_PART_COUNT];
+	VkPipeline fastLinkHandle;
 	VkPipeline vkHandle;
+	size_t taskCount;
 } VkGraphicsPipeline_T;
 #endif
 #if MPGX_SUPPORT_OPENGL
@@ -66,6 +102,10 @@ typedef struct GlGraphicsPipeline_T
 	Shader* shaders;
 	size_t shaderCount;
 	GraphicsPipelineState state;
+	GraphicsPipeline fallback;
+	size_t dependentCount;
+	bool isReady;
+	MpgxResult compileResult;
 #ifndef NDEBUG
 	char* name;
 #endif
@@ -81,6 +121,8 @@ typedef struct GlGraphicsPipeline_T
 	GLenum colorBlendOperator;
 	GLenum alphaBlendOperator;
 	GLenum frontFace;
+	GlUniformTable uniformTable;
+	GlUniformTable blockTable;
 } GlGraphicsPipeline_T;
 #endif
 union GraphicsPipeline_T
@@ -95,6 +137,61 @@ union GraphicsPipeline_T
 };
 
 #if MPGX_SUPPORT_VULKAN
+typedef struct VkGraphicsPipelineTask_T
+{
+	VkDevice device;
+	Mutex mutex;
+	Mutex cancelMutex;
+	GraphicsPipeline graphicsPipeline;
+	VkRenderPass renderPass;
+	size_t colorAttachmentCount;
+	VkSampleCountFlagBits sampleCount;
+	Vec2I framebufferSize;
+	VkGraphicsPipelineCreateData createData;
+	OnGraphicsPipelineReady onReady;
+	VkPipeline vkHandle;
+	uint32_t refCount;
+	MpgxResult result;
+	bool isLinkTask;
+	bool isCompleted;
+	bool isCancelled;
+} VkGraphicsPipelineTask_T;
+
+typedef VkGraphicsPipelineTask_T* VkGraphicsPipelineTask;
+
+typedef struct VkGraphicsPipelineCreateInfoData
+{
+	VkPipelineShaderStageCreateInfo* shaderStageCreateInfos;
+	VkPipelineColorBlendAttachmentState* colorBlendAttachmentStates;
+	VkDynamicState dynamicStates[2];
+	VkViewport viewport;
+	VkRect2D scissor;
+	VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo;
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo;
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo;
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo;
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo;
+	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo;
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo;
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo;
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo;
+	VkGraphicsPipelineCreateInfo createInfo;
+} VkGraphicsPipelineCreateInfoData;
+typedef struct VkGraphicsPipelineBatch_T
+{
+	VkDevice device;
+	VkPipelineCache cache;
+	Mutex mutex;
+	const VkGraphicsPipelineCreateInfo* createInfos;
+	VkPipeline* handles;
+	uint32_t createInfoCount;
+	uint32_t refCount;
+	VkResult result;
+	bool isCreated;
+} VkGraphicsPipelineBatch_T;
+
+typedef VkGraphicsPipelineBatch_T* VkGraphicsPipelineBatch;
+
 inline static bool getVkDrawMode(
 	DrawMode drawMode,
 	VkPrimitiveTopology* vkDrawMode)
@@ -301,29 +398,46 @@ inline static bool getVkBlendOperator(
 	}
 }
 
-inline static MpgxResult createVkGraphicsPipelineHandle(
-	VkDevice device,
+inline static void destroyVkGraphicsPipelineCreateInfo(
+	VkGraphicsPipelineCreateInfoData* data)
+{
+	assert(data);
+	free(data->colorBlendAttachmentStates);
+	free(data->shaderStageCreateInfos);
+}
+inline static MpgxResult createVkGraphicsPipelineCreateInfo(
 	VkRenderPass renderPass,
-	VkPipelineCache cache,
 	VkPipelineLayout layout,
 	Shader* shaders,
 	size_t shaderCount,
+	const VkSpecializationInfo* specializationInfo,
 	GraphicsPipelineState state,
 	size_t colorAttachmentCount,
+	VkSampleCountFlagBits sampleCount,
 	Vec2I framebufferSize,
 	const VkGraphicsPipelineCreateData* createData,
-	VkPipeline* handle)
+	VkGraphicsPipelineLibraryFlagsEXT libraryFlags,
+	VkGraphicsPipelineCreateInfoData* data)
 {
-	assert(device);
 	assert(renderPass);
-	assert(cache);
 	assert(layout);
 	assert(shaders);
 	assert(shaderCount > 0);
 	assert(framebufferSize.x > 0);
 	assert(framebufferSize.y > 0);
 	assert(createData);
-	assert(handle);
+	assert(data);
+
+	// Library contains only part of the pipeline state,
+	// monolithic pipeline is created if flags are zero.
+	bool hasVertexInput = libraryFlags == 0 || libraryFlags &
+		VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+	bool hasPreRasterization = libraryFlags == 0 || libraryFlags &
+		VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+	bool hasFragmentShader = libraryFlags == 0 || libraryFlags &
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+	bool hasFragmentOutput = libraryFlags == 0 || libraryFlags &
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
 
 	VkPipelineShaderStageCreateInfo* shaderStageCreateInfos =
 		malloc(shaderCount * sizeof(VkPipelineShaderStageCreateInfo));
@@ -338,15 +452,25 @@ inline static MpgxResult createVkGraphicsPipelineHandle(
 		0,
 		NULL,
 		"main",
-		NULL, // TODO: pass here shader dynamic constants
+		specializationInfo,
 	};
 
+	uint32_t shaderStageCount = 0;
+
 	for (size_t i = 0; i < shaderCount; i++)
 	{
 		Shader shader = shaders[i];
+		bool isFragment = shader->vk.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		if ((isFragment && !hasFragmentShader) ||
+			(!isFragment && !hasPreRasterization))
+		{
+			continue;
+		}
+
 		shaderStageCreateInfo.stage = shader->vk.stage;
 		shaderStageCreateInfo.module = shader->vk.handle;
-		shaderStageCreateInfos[i] = shaderStageCreateInfo;
+		shaderStageCreateInfos[shaderStageCount++] = shaderStageCreateInfo;
 	}
 
 	VkPrimitiveTopology primitiveTopology;
@@ -420,7 +544,7 @@ inline static MpgxResult createVkGraphicsPipelineHandle(
 
 	// TODO: tesselation stage
 
-	VkDynamicState dynamicStates[2];
+	VkDynamicState* dynamicStates = data->dynamicStates;
 	uint32_t dynamicStateCount = 0;
 
 	bool dynamicViewport = state.viewport.z + state.viewport.w == 0;
@@ -433,6 +557,8 @@ inline static MpgxResult createVkGraphicsPipelineHandle(
 	if (dynamicScissor)
 		dynamicStates[dynamicStateCount++] = VK_DYNAMIC_STATE_SCISSOR;
 
+	// Create info is pointing to the data fields,
+	// so data is not moved until pipeline is created.
 	VkViewport viewport = {
 		(float)state.viewport.x,
 		(float)state.viewport.y,
@@ -447,14 +573,18 @@ inline static MpgxResult createVkGraphicsPipelineHandle(
 		(uint32_t)state.scissor.z,
 		(uint32_t)state.scissor.w,
 	};
+
+	data->viewport = viewport;
+	data->scissor = scissor;
+
 	VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
 		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
 		NULL,
 		0,
 		1,
-		dynamicViewport ? NULL : &viewport,
+		dynamicViewport ? NULL : &data->viewport,
 		1,
-		dynamicScissor ? NULL : &scissor,
+		dynamicScissor ? NULL : &data->scissor,
 	};
 
 	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
@@ -473,12 +603,11 @@ inline static MpgxResult createVkGraphicsPipelineHandle(
 		state.lineWidth,
 	};
 
-	// TODO: multisampling
 	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
 		VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
 		NULL,
 		0,
-		VK_SAMPLE_COUNT_1_BIT,
+		sampleCount,
 		VK_FALSE,
 		0.0f,
 		NULL,
@@ -587,269 +716,1212 @@ inline static MpgxResult createVkGraphicsPipelineHandle(
 		dynamicStates,
 	};
 
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+		NULL,
+		libraryFlags,
+	};
+
+	data->shaderStageCreateInfos = shaderStageCreateInfos;
+	data->colorBlendAttachmentStates = colorBlendAttachmentStates;
+	data->vertexInputStateCreateInfo = vertexInputStateCreateInfo;
+	data->inputAssemblyStateCreateInfo = inputAssemblyStateCreateInfo;
+	data->viewportStateCreateInfo = viewportStateCreateInfo;
+	data->rasterizationStateCreateInfo = rasterizationStateCreateInfo;
+	data->multisampleStateCreateInfo = multisampleStateCreateInfo;
+	data->depthStencilStateCreateInfo = depthStencilStateCreateInfo;
+	data->colorBlendStateCreateInfo = colorBlendStateCreateInfo;
+	data->dynamicStateCreateInfo = dynamicStateCreateInfo;
+	data->libraryCreateInfo = libraryCreateInfo;
+
+	bool hasLayout = hasPreRasterization || hasFragmentShader;
+	bool hasMultisample = hasFragmentShader || hasFragmentOutput;
+
 	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
 		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		libraryFlags != 0 ? &data->libraryCreateInfo : NULL,
+		libraryFlags != 0 ? VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+			VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT : 0,
+		shaderStageCount,
+		shaderStageCount > 0 ? shaderStageCreateInfos : NULL,
+		hasVertexInput ? &data->vertexInputStateCreateInfo : NULL,
+		hasVertexInput ? &data->inputAssemblyStateCreateInfo : NULL,
 		NULL,
-		0,
-		(uint32_t)shaderCount,
-		shaderStageCreateInfos,
-		&vertexInputStateCreateInfo,
-		&inputAssemblyStateCreateInfo,
-		NULL,
-		&viewportStateCreateInfo,
-		&rasterizationStateCreateInfo,
-		&multisampleStateCreateInfo,
-		&depthStencilStateCreateInfo,
-		&colorBlendStateCreateInfo,
-		&dynamicStateCreateInfo,
-		layout,
-		renderPass,
-		0,
+		hasPreRasterization ? &data->viewportStateCreateInfo : NULL,
+		hasPreRasterization ? &data->rasterizationStateCreateInfo : NULL,
+		hasMultisample ? &data->multisampleStateCreateInfo : NULL,
+		hasFragmentShader ? &data->depthStencilStateCreateInfo : NULL,
+		hasFragmentOutput ? &data->colorBlendStateCreateInfo : NULL,
+		hasPreRasterization ? &data->dynamicStateCreateInfo : NULL,
+		hasLayout ? layout : VK_NULL_HANDLE,
+		hasVertexInput && libraryFlags != 0 ? VK_NULL_HANDLE : renderPass,
+		hasVertexInput && libraryFlags != 0 ? 0 : state.subpassIndex,
 		NULL,
 		0,
 	};
 
-	VkPipeline handleInstance;
-
-	VkResult vkResult = vkCreateGraphicsPipelines(
-		device,
-		cache,
-		1,
-		&graphicsPipelineCreateInfo,
-		NULL,
-		&handleInstance);
-
-	free(colorBlendAttachmentStates);
-	free(shaderStageCreateInfos);
-
-	if (vkResult != VK_SUCCESS)
-		return vkToMpgxResult(vkResult);
-
-	*handle = handleInstance;
+	data->createInfo = graphicsPipelineCreateInfo;
 	return SUCCESS_MPGX_RESULT;
 }
-inline static MpgxResult recreateVkGraphicsPipelineHandle(
+inline static MpgxResult createVkGraphicsPipelineHandle(
 	VkDevice device,
 	VkRenderPass renderPass,
-	GraphicsPipeline graphicsPipeline,
+	VkPipelineCache cache,
+	VkPipelineLayout layout,
+	Shader* shaders,
+	size_t shaderCount,
+	const VkSpecializationInfo* specializationInfo,
+	GraphicsPipelineState state,
 	size_t colorAttachmentCount,
+	VkSampleCountFlagBits sampleCount,
 	Vec2I framebufferSize,
-	const VkGraphicsPipelineCreateData* createData)
+	const VkGraphicsPipelineCreateData* createData,
+	VkGraphicsPipelineLibraryFlagsEXT libraryFlags,
+	VkPipeline* handle)
 {
 	assert(device);
-	assert(renderPass);
-	assert(graphicsPipeline);
-	assert(framebufferSize.x > 0);
-	assert(framebufferSize.y > 0);
-	assert(createData);
+	assert(cache);
+	assert(handle);
 
-	VkPipeline handle;
+	VkGraphicsPipelineCreateInfoData createInfoData;
 
-	MpgxResult mpgxResult = createVkGraphicsPipelineHandle(
-		device,
+	MpgxResult mpgxResult = createVkGraphicsPipelineCreateInfo(
 		renderPass,
-		graphicsPipeline->vk.cache,
-		graphicsPipeline->vk.layout,
-		graphicsPipeline->vk.shaders,
-		graphicsPipeline->vk.shaderCount,
-		graphicsPipeline->vk.state,
+		layout,
+		shaders,
+		shaderCount,
+		specializationInfo,
+		state,
 		colorAttachmentCount,
+		sampleCount,
 		framebufferSize,
 		createData,
-		&handle);
+		libraryFlags,
+		&createInfoData);
 
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
 		return mpgxResult;
 
-	vkDestroyPipeline(
-		device,
-		graphicsPipeline->vk.vkHandle,
-		NULL);
+	VkPipeline handleInstance;
 
-	graphicsPipeline->vk.vkHandle = handle;
-	return SUCCESS_MPGX_RESULT;
-}
+	VkResult vkResult = vkCreateGraphicsPipelines(
+		device,
+		cache,
+		1,
+		&createInfoData.createInfo,
+		NULL,
+		&handleInstance);
 
-inline static void destroyVkGraphicsPipeline(
-	VkDevice device,
-	GraphicsPipeline graphicsPipeline)
-{
-	assert(device);
+	destroyVkGraphicsPipelineCreateInfo(&createInfoData);
 
-	if (!graphicsPipeline)
-		return;
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
 
-	vkDestroyPipeline(
-		device,
-		graphicsPipeline->vk.vkHandle,
-		NULL);
-	vkDestroyPipelineLayout(
-		device,
-		graphicsPipeline->vk.layout,
-		NULL);
-	vkDestroyPipelineCache(
-		device,
-		graphicsPipeline->vk.cache,
-		NULL);
-	free(graphicsPipeline->vk.shaders);
-#ifndef NDEBUG
-	free(graphicsPipeline->vk.name);
-#endif
-	free(graphicsPipeline);
+	*handle = handleInstance;
+	return SUCCESS_MPGX_RESULT;
 }
-inline static MpgxResult createVkGraphicsPipeline(
-	VkDevice device,
-	const VkGraphicsPipelineCreateData* createData,
-	Framebuffer framebuffer,
-	Window window,
-	const char* name,
-	GraphicsPipelineState state,
-	OnGraphicsPipelineBind onBind,
-	OnGraphicsPipelineUniformsSet onUniformsSet,
-	OnGraphicsPipelineResize onResize,
-	OnGraphicsPipelineDestroy onDestroy,
-	void* handle,
+inline static MpgxResult createVkPipelineLibraryKey(
+	VkGraphicsPipelineLibraryFlagsEXT libraryFlags,
+	VkPipelineLayout layout,
 	Shader* shaders,
 	size_t shaderCount,
-	GraphicsPipeline* graphicsPipeline)
+	const VkSpecializationInfo* specializationInfo,
+	GraphicsPipelineState state,
+	Vec2I framebufferSize,
+	const VkGraphicsPipelineCreateData* createData,
+	uint8_t** key,
+	size_t* keySize)
 {
-	assert(device);
-	assert(createData);
-	assert(framebuffer);
-	assert(window);
-	assert(onResize);
-	assert(onDestroy);
+	assert(layout);
 	assert(shaders);
 	assert(shaderCount > 0);
-	assert(graphicsPipeline);
-
-	GraphicsPipeline graphicsPipelineInstance = calloc(1,
-		sizeof(GraphicsPipeline_T));
-
-	if (!graphicsPipelineInstance)
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	assert(createData);
+	assert(key);
+	assert(keySize);
 
-	graphicsPipelineInstance->vk.framebuffer = framebuffer;
-	graphicsPipelineInstance->vk.window = window;
-	graphicsPipelineInstance->vk.onBind = onBind;
-	graphicsPipelineInstance->vk.onUniformsSet = onUniformsSet;
-	graphicsPipelineInstance->vk.onResize = onResize;
-	graphicsPipelineInstance->vk.onDestroy = onDestroy;
-	graphicsPipelineInstance->vk.handle = handle;
-	graphicsPipelineInstance->vk.state = state;
+	GraphicsPipelineState partState;
+	memset(&partState, 0, sizeof(GraphicsPipelineState));
 
-#ifndef NDEBUG
-	size_t nameLength = strlen(name);
-	char* nameString = malloc((nameLength + 1) * sizeof(char));
+	bool hasShaders = false, isFragment = false;
+	size_t vertexInputSize = 0;
 
-	if (!nameString)
+	// Only state of the library part is compared,
+	// so other parts are shared between the pipelines.
+	switch (libraryFlags)
 	{
-		destroyVkGraphicsPipeline(device,
-			graphicsPipelineInstance);
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	default:
+		abort();
+	case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+		partState.drawMode = state.drawMode;
+		partState.restartPrimitive = state.restartPrimitive;
+		vertexInputSize =
+			createData->vertexBindingDescriptionCount *
+			sizeof(VkVertexInputBindingDescription) +
+			createData->vertexAttributeDescriptionCount *
+			sizeof(VkVertexInputAttributeDescription);
+		break;
+	case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+		partState.polygonMode = state.polygonMode;
+		partState.cullMode = state.cullMode;
+		partState.cullFace = state.cullFace;
+		partState.clockwiseFrontFace = state.clockwiseFrontFace;
+		partState.clampDepth = state.clampDepth;
+		partState.enableDepthBias = state.enableDepthBias;
+		partState.discardRasterizer = state.discardRasterizer;
+		partState.lineWidth = state.lineWidth;
+		partState.viewport = state.viewport;
+		partState.scissor = state.scissor;
+		partState.depthRange = state.depthRange;
+		partState.depthBias = state.depthBias;
+		partState.subpassIndex = state.subpassIndex;
+		hasShaders = true;
+		isFragment = false;
+		break;
+	case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+		partState.depthCompareOperator = state.depthCompareOperator;
+		partState.testDepth = state.testDepth;
+		partState.writeDepth = state.writeDepth;
+		partState.subpassIndex = state.subpassIndex;
+		hasShaders = true;
+		isFragment = true;
+		break;
+	case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+		partState.colorComponentWriteMask = state.colorComponentWriteMask;
+		partState.srcColorBlendFactor = state.srcColorBlendFactor;
+		partState.dstColorBlendFactor = state.dstColorBlendFactor;
+		partState.srcAlphaBlendFactor = state.srcAlphaBlendFactor;
+		partState.dstAlphaBlendFactor = state.dstAlphaBlendFactor;
+		partState.colorBlendOperator = state.colorBlendOperator;
+		partState.alphaBlendOperator = state.alphaBlendOperator;
+		partState.enableBlend = state.enableBlend;
+		partState.blendColor = state.blendColor;
+		partState.subpassIndex = state.subpassIndex;
+		break;
 	}
 
-	memcpy(nameString, name, nameLength);
-	nameString[nameLength] = '\0';
+	size_t shaderKeyCount = 0;
 
-	graphicsPipelineInstance->vk.name = nameString;
-#endif
+	if (hasShaders)
+	{
+		for (size_t i = 0; i < shaderCount; i++)
+		{
+			bool isFragmentShader = shaders[i]->vk.stage ==
+				VK_SHADER_STAGE_FRAGMENT_BIT;
 
-	Shader* pipelineShaders = malloc(
-		shaderCount * sizeof(Shader));
+			if (isFragmentShader == isFragment)
+				shaderKeyCount++;
+		}
+	}
 
-	if (!pipelineShaders)
+	size_t specializationSize = 0;
+
+	if (hasShaders && specializationInfo)
 	{
-		destroyVkGraphicsPipeline(device,
-			graphicsPipelineInstance);
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		specializationSize = specializationInfo->mapEntryCount *
+			sizeof(VkSpecializationMapEntry) + specializationInfo->dataSize;
 	}
 
-	for (size_t i = 0; i < shaderCount; i++)
-		pipelineShaders[i] = shaders[i];
+	size_t size = sizeof(VkGraphicsPipelineLibraryFlagsEXT) +
+		sizeof(GraphicsPipelineState) + sizeof(VkPipelineLayout) +
+		sizeof(Vec2I) + shaderKeyCount * (sizeof(uint64_t) * 2) +
+		specializationSize + vertexInputSize;
 
-	graphicsPipelineInstance->vk.shaders = pipelineShaders;
-	graphicsPipelineInstance->vk.shaderCount = shaderCount;
+	uint8_t* keyInstance = malloc(size);
 
-	VkPipelineCacheCreateInfo cacheCreateInfo = {
-		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
-		NULL,
-		0,
-		0,
-		NULL,
-	};
+	if (!keyInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
-	VkPipelineCache cache;
+	uint8_t* data = keyInstance;
 
-	VkResult vkResult = vkCreatePipelineCache(
-		device,
-		&cacheCreateInfo,
-		NULL,
-		&cache);
+	memcpy(data, &libraryFlags, sizeof(VkGraphicsPipelineLibraryFlagsEXT));
+	data += sizeof(VkGraphicsPipelineLibraryFlagsEXT);
+	memcpy(data, &partState, sizeof(GraphicsPipelineState));
+	data += sizeof(GraphicsPipelineState);
+	memcpy(data, &layout, sizeof(VkPipelineLayout));
+	data += sizeof(VkPipelineLayout);
+	memcpy(data, &framebufferSize, sizeof(Vec2I));
+	data += sizeof(Vec2I);
 
-	if (vkResult != VK_SUCCESS)
+	// Shader code hash is used instead of the module handle,
+	// because destroyed module handle can be reused.
+	for (size_t i = 0; i < shaderCount && shaderKeyCount > 0; i++)
 	{
-		destroyVkGraphicsPipeline(device,
-			graphicsPipelineInstance);
-		return vkToMpgxResult(vkResult);
-	}
+		Shader shader = shaders[i];
+		bool isFragmentShader = shader->vk.stage ==
+			VK_SHADER_STAGE_FRAGMENT_BIT;
 
-	graphicsPipelineInstance->vk.cache = cache;
+		if (isFragmentShader != isFragment)
+			continue;
 
-	VkPipelineLayoutCreateInfo layoutCreateInfo = {
-		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		NULL,
-		0,
-		createData->setLayoutCount,
-		createData->setLayouts,
-		createData->pushConstantRangeCount,
-		createData->pushConstantRanges,
-	};
+		uint64_t shaderSize = shader->vk.size;
+		memcpy(data, &shader->vk.hash, sizeof(uint64_t));
+		data += sizeof(uint64_t);
+		memcpy(data, &shaderSize, sizeof(uint64_t));
+		data += sizeof(uint64_t);
+	}
 
-	VkPipelineLayout layout;
+	if (specializationSize > 0)
+	{
+		size_t mapEntrySize = specializationInfo->mapEntryCount *
+			sizeof(VkSpecializationMapEntry);
 
-	vkResult = vkCreatePipelineLayout(
-		device,
-		&layoutCreateInfo,
-		NULL,
-		&layout);
+		memcpy(data, specializationInfo->pMapEntries, mapEntrySize);
+		data += mapEntrySize;
+		memcpy(data, specializationInfo->pData, specializationInfo->dataSize);
+		data += specializationInfo->dataSize;
+	}
 
-	if (vkResult != VK_SUCCESS)
+	if (vertexInputSize > 0)
 	{
-		destroyVkGraphicsPipeline(device,
-			graphicsPipelineInstance);
-		return vkToMpgxResult(vkResult);
+		size_t bindingSize = createData->vertexBindingDescriptionCount *
+			sizeof(VkVertexInputBindingDescription);
+		size_t attributeSize = createData->vertexAttributeDescriptionCount *
+			sizeof(VkVertexInputAttributeDescription);
+
+		memcpy(data, createData->vertexBindingDescriptions, bindingSize);
+		data += bindingSize;
+		memcpy(data, createData->vertexAttributeDescriptions, attributeSize);
 	}
 
-	graphicsPipelineInstance->vk.layout = layout;
+	*key = keyInstance;
+	*keySize = size;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult getVkGraphicsPipelineLibrary(
+	VkDevice device,
+	VkPipelineCache cache,
+	Framebuffer framebuffer,
+	VkPipelineLayout layout,
+	Shader* shaders,
+	size_t shaderCount,
+	const VkSpecializationInfo* specializationInfo,
+	GraphicsPipelineState state,
+	const VkGraphicsPipelineCreateData* createData,
+	VkGraphicsPipelineLibraryFlagsEXT libraryFlags,
+	VkPipeline* library)
+{
+	assert(device);
+	assert(cache);
+	assert(framebuffer);
+	assert(library);
 
-	VkPipeline vkHandle;
+	uint8_t* key;
+	size_t keySize;
 
-	MpgxResult mpgxResult = createVkGraphicsPipelineHandle(
-		device,
-		framebuffer->vk.renderPass,
-		cache,
+	MpgxResult mpgxResult = createVkPipelineLibraryKey(
+		libraryFlags,
 		layout,
 		shaders,
 		shaderCount,
+		specializationInfo,
 		state,
-		framebuffer->vk.colorAttachmentCount,
 		framebuffer->vk.size,
 		createData,
-		&vkHandle);
+		&key,
+		&keySize);
 
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
-	{
-		destroyVkGraphicsPipeline(device,
-			graphicsPipelineInstance);
 		return mpgxResult;
-	}
 
-	graphicsPipelineInstance->vk.vkHandle = vkHandle;
+	VkPipelineLibraryEntry* libraryEntries =
+		framebuffer->vk.libraryEntries;
+	size_t libraryEntryCount = framebuffer->vk.libraryEntryCount;
 
-	*graphicsPipeline = graphicsPipelineInstance;
-	return SUCCESS_MPGX_RESULT;
-}
+	for (size_t i = 0; i < libraryEntryCount; i++)
+	{
+		VkPipelineLibraryEntry* entry = &libraryEntries[i];
+
+		if (entry->keySize == keySize &&
+			memcmp(entry->key, key, keySize) == 0)
+		{
+			free(key);
+			*library = entry->library;
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
+
+	if (libraryEntryCount == framebuffer->vk.libraryEntryCapacity)
+	{
+		size_t capacity = libraryEntryCount == 0 ?
+			1 : framebuffer->vk.libraryEntryCapacity * 2;
+
+		libraryEntries = realloc(libraryEntries,
+			capacity * sizeof(VkPipelineLibraryEntry));
+
+		if (!libraryEntries)
+		{
+			free(key);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		framebuffer->vk.libraryEntries = libraryEntries;
+		framebuffer->vk.libraryEntryCapacity = capacity;
+	}
+
+	VkPipeline libraryInstance;
+
+	mpgxResult = createVkGraphicsPipelineHandle(
+		device,
+		framebuffer->vk.renderPass,
+		cache,
+		layout,
+		shaders,
+		shaderCount,
+		specializationInfo,
+		state,
+		getFramebufferSubpassColorCount(
+			framebuffer->vk.colorAttachmentCount,
+			framebuffer->vk.gBufferAttachmentCount,
+			state.subpassIndex),
+		(VkSampleCountFlagBits)framebuffer->vk.sampleCount,
+		framebuffer->vk.size,
+		createData,
+		libraryFlags,
+		&libraryInstance);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(key);
+		return mpgxResult;
+	}
+
+	VkPipelineLibraryEntry entry = {
+		key,
+		keySize,
+		libraryInstance,
+	};
+
+	libraryEntries[libraryEntryCount] = entry;
+	framebuffer->vk.libraryEntryCount = libraryEntryCount + 1;
+
+	*library = libraryInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult linkVkGraphicsPipelineLibraries(
+	VkDevice device,
+	VkPipelineCache cache,
+	VkPipelineLayout layout,
+	const VkPipeline* libraries,
+	bool optimize,
+	VkPipeline* handle)
+{
+	assert(device);
+	assert(cache);
+	assert(layout);
+	assert(libraries);
+	assert(handle);
+
+	VkPipelineLibraryCreateInfoKHR libraryCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+		NULL,
+		VK_PIPELINE_LIBRARY_PART_COUNT,
+		libraries,
+	};
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		&libraryCreateInfo,
+		optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0,
+		0,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		layout,
+		VK_NULL_HANDLE,
+		0,
+		NULL,
+		0,
+	};
+
+	VkPipeline handleInstance;
+
+	VkResult vkResult = vkCreateGraphicsPipelines(
+		device,
+		cache,
+		1,
+		&graphicsPipelineCreateInfo,
+		NULL,
+		&handleInstance);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	*handle = handleInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkLinkedGraphicsPipelineHandle(
+	VkDevice device,
+	VkPipelineCache cache,
+	Framebuffer framebuffer,
+	VkPipelineLayout layout,
+	Shader* shaders,
+	size_t shaderCount,
+	const VkSpecializationInfo* specializationInfo,
+	GraphicsPipelineState state,
+	const VkGraphicsPipelineCreateData* createData,
+	VkPipeline* libraries,
+	VkPipeline* handle)
+{
+	assert(libraries);
+	assert(handle);
+
+	static const VkGraphicsPipelineLibraryFlagsEXT libraryParts[
+		VK_PIPELINE_LIBRARY_PART_COUNT] = {
+		VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+	};
+
+	for (size_t i = 0; i < VK_PIPELINE_LIBRARY_PART_COUNT; i++)
+	{
+		MpgxResult mpgxResult = getVkGraphicsPipelineLibrary(
+			device,
+			cache,
+			framebuffer,
+			layout,
+			shaders,
+			shaderCount,
+			specializationInfo,
+			state,
+			createData,
+			libraryParts[i],
+			&libraries[i]);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+	}
+
+	// Fast link skips optimization, optimized
+	// pipeline is linked later by the pipeline task.
+	return linkVkGraphicsPipelineLibraries(
+		device,
+		cache,
+		layout,
+		libraries,
+		false,
+		handle);
+}
+
+inline static void getVkReflectedGraphicsCreateData(
+	VkReflectedLayout reflectedLayout,
+	VkGraphicsPipelineCreateData* createData)
+{
+	assert(reflectedLayout);
+	assert(createData);
+
+	VkGraphicsPipelineCreateData createDataInstance = {
+		reflectedLayout->vertexBindingCount,
+		&reflectedLayout->vertexBinding,
+		reflectedLayout->vertexAttributeCount,
+		reflectedLayout->vertexAttributes,
+		reflectedLayout->setLayoutCount,
+		reflectedLayout->setLayouts,
+		reflectedLayout->pushConstantRangeCount,
+		&reflectedLayout->pushConstantRange,
+		NULL,
+	};
+
+	*createData = createDataInstance;
+}
+inline static MpgxResult recreateVkGraphicsPipelineHandle(
+	VkDevice device,
+	VkRenderPass renderPass,
+	GraphicsPipeline graphicsPipeline,
+	size_t colorAttachmentCount,
+	VkSampleCountFlagBits sampleCount,
+	Vec2I framebufferSize,
+	const VkGraphicsPipelineCreateData* createData,
+	VkPipeline* retiredHandles)
+{
+	assert(device);
+	assert(renderPass);
+	assert(graphicsPipeline);
+	assert(framebufferSize.x > 0);
+	assert(framebufferSize.y > 0);
+	assert(createData);
+
+	VkReflectedLayout reflectedLayout =
+		graphicsPipeline->vk.reflectedLayout;
+	VkGraphicsPipelineCreateData reflectedCreateData;
+
+	// Reflected vertex input does not depend on the resize data
+	if (reflectedLayout)
+	{
+		getVkReflectedGraphicsCreateData(
+			reflectedLayout,
+			&reflectedCreateData);
+		createData = &reflectedCreateData;
+	}
+
+	VkPipeline handle;
+
+	MpgxResult mpgxResult = createVkGraphicsPipelineHandle(
+		device,
+		renderPass,
+		graphicsPipeline->vk.cache,
+		graphicsPipeline->vk.layout,
+		graphicsPipeline->vk.shaders,
+		graphicsPipeline->vk.shaderCount,
+		graphicsPipeline->vk.specializationInfo,
+		graphicsPipeline->vk.state,
+		colorAttachmentCount,
+		sampleCount,
+		framebufferSize,
+		createData,
+		0,
+		&handle);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	// Old handles can still be used by the in-flight frames
+	if (retiredHandles)
+	{
+		retiredHandles[0] = graphicsPipeline->vk.vkHandle;
+		retiredHandles[1] = graphicsPipeline->vk.fastLinkHandle;
+	}
+	else
+	{
+		vkDestroyPipeline(
+			device,
+			graphicsPipeline->vk.fastLinkHandle,
+			NULL);
+		vkDestroyPipeline(
+			device,
+			graphicsPipeline->vk.vkHandle,
+			NULL);
+	}
+
+	// Framebuffer libraries are cleared with the render pass
+	for (size_t i = 0; i < VK_PIPELINE_LIBRARY_PART_COUNT; i++)
+		graphicsPipeline->vk.libraries[i] = VK_NULL_HANDLE;
+
+	graphicsPipeline->vk.fastLinkHandle = VK_NULL_HANDLE;
+	graphicsPipeline->vk.vkHandle = handle;
+	graphicsPipeline->vk.isReady = true;
+	graphicsPipeline->vk.compileResult = SUCCESS_MPGX_RESULT;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static void destroyVkGraphicsPipeline(
+	VkDevice device,
+	GraphicsPipeline graphicsPipeline)
+{
+	assert(device);
+
+	if (!graphicsPipeline)
+		return;
+
+	vkDestroyPipeline(
+		device,
+		graphicsPipeline->vk.fastLinkHandle,
+		NULL);
+	vkDestroyPipeline(
+		device,
+		graphicsPipeline->vk.vkHandle,
+		NULL);
+
+	// Reflected layouts are owned by the window layout cache
+	if (!graphicsPipeline->vk.reflectedLayout)
+	{
+		vkDestroyPipelineLayout(
+			device,
+			graphicsPipeline->vk.layout,
+			NULL);
+	}
+
+	free(graphicsPipeline->vk.specializationInfo);
+	free(graphicsPipeline->vk.shaders);
+#ifndef NDEBUG
+	free(graphicsPipeline->vk.name);
+#endif
+	free(graphicsPipeline);
+}
+inline static MpgxResult createVkGraphicsPipeline(
+	VkDevice device,
+	VkPipelineCache cache,
+	const VkGraphicsPipelineCreateData* createData,
+	VkReflectedLayout reflectedLayout,
+	Framebuffer framebuffer,
+	Window window,
+	const char* name,
+	GraphicsPipelineState state,
+	OnGraphicsPipelineBind onBind,
+	OnGraphicsPipelineUniformsSet onUniformsSet,
+	OnGraphicsPipelineResize onResize,
+	OnGraphicsPipelineDestroy onDestroy,
+	void* handle,
+	Shader* shaders,
+	size_t shaderCount,
+	GraphicsPipeline fallback,
+	bool useAsync,
+	bool useLibrary,
+	GraphicsPipeline* graphicsPipeline)
+{
+	assert(device);
+	assert(cache);
+	assert(createData);
+	assert(framebuffer);
+	assert(window);
+	assert(onResize);
+	assert(onDestroy);
+	assert(shaders);
+	assert(shaderCount > 0);
+	assert(graphicsPipeline);
+
+	GraphicsPipeline graphicsPipelineInstance = calloc(1,
+		sizeof(GraphicsPipeline_T));
+
+	if (!graphicsPipelineInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	graphicsPipelineInstance->vk.framebuffer = framebuffer;
+	graphicsPipelineInstance->vk.window = window;
+	graphicsPipelineInstance->vk.onBind = onBind;
+	graphicsPipelineInstance->vk.onUniformsSet = onUniformsSet;
+	graphicsPipelineInstance->vk.onResize = onResize;
+	graphicsPipelineInstance->vk.onDestroy = onDestroy;
+	graphicsPipelineInstance->vk.handle = handle;
+	graphicsPipelineInstance->vk.state = state;
+	graphicsPipelineInstance->vk.fallback = fallback;
+
+#ifndef NDEBUG
+	size_t nameLength = strlen(name);
+	char* nameString = malloc((nameLength + 1) * sizeof(char));
+
+	if (!nameString)
+	{
+		destroyVkGraphicsPipeline(device,
+			graphicsPipelineInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	memcpy(nameString, name, nameLength);
+	nameString[nameLength] = '\0';
+
+	graphicsPipelineInstance->vk.name = nameString;
+#endif
+
+	Shader* pipelineShaders = malloc(
+		shaderCount * sizeof(Shader));
+
+	if (!pipelineShaders)
+	{
+		destroyVkGraphicsPipeline(device,
+			graphicsPipelineInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	for (size_t i = 0; i < shaderCount; i++)
+		pipelineShaders[i] = shaders[i];
+
+	graphicsPipelineInstance->vk.shaders = pipelineShaders;
+	graphicsPipelineInstance->vk.shaderCount = shaderCount;
+
+	graphicsPipelineInstance->vk.cache = cache;
+
+	VkSpecializationInfo* specializationInfo;
+
+	MpgxResult mpgxResult = createVkSpecializationInfo(
+		createData->specializationInfo,
+		&specializationInfo);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkGraphicsPipeline(device,
+			graphicsPipelineInstance);
+		return mpgxResult;
+	}
+
+	graphicsPipelineInstance->vk.specializationInfo = specializationInfo;
+	graphicsPipelineInstance->vk.reflectedLayout = reflectedLayout;
+
+	VkPipelineLayout layout;
+
+	if (reflectedLayout)
+	{
+		layout = reflectedLayout->layout;
+	}
+	else
+	{
+		VkPipelineLayoutCreateInfo layoutCreateInfo = {
+			VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			NULL,
+			0,
+			createData->setLayoutCount,
+			createData->setLayouts,
+			createData->pushConstantRangeCount,
+			createData->pushConstantRanges,
+		};
+
+		VkResult vkResult = vkCreatePipelineLayout(
+			device,
+			&layoutCreateInfo,
+			NULL,
+			&layout);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			destroyVkGraphicsPipeline(device,
+				graphicsPipelineInstance);
+			return vkToMpgxResult(vkResult);
+		}
+	}
+
+	graphicsPipelineInstance->vk.layout = layout;
+
+	// Handle is created later by the pipeline task
+	if (useAsync)
+	{
+		*graphicsPipeline = graphicsPipelineInstance;
+		return SUCCESS_MPGX_RESULT;
+	}
+
+	VkPipeline vkHandle;
+
+	if (useLibrary)
+	{
+		mpgxResult = createVkLinkedGraphicsPipelineHandle(
+			device,
+			cache,
+			framebuffer,
+			layout,
+			shaders,
+			shaderCount,
+			specializationInfo,
+			state,
+			createData,
+			graphicsPipelineInstance->vk.libraries,
+			&vkHandle);
+	}
+	else
+	{
+		mpgxResult = createVkGraphicsPipelineHandle(
+			device,
+			framebuffer->vk.renderPass,
+			cache,
+			layout,
+			shaders,
+			shaderCount,
+			specializationInfo,
+			state,
+			getFramebufferSubpassColorCount(
+				framebuffer->vk.colorAttachmentCount,
+				framebuffer->vk.gBufferAttachmentCount,
+				state.subpassIndex),
+			(VkSampleCountFlagBits)framebuffer->vk.sampleCount,
+			framebuffer->vk.size,
+			createData,
+			0,
+			&vkHandle);
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkGraphicsPipeline(device,
+			graphicsPipelineInstance);
+		return mpgxResult;
+	}
+
+	graphicsPipelineInstance->vk.vkHandle = vkHandle;
+	graphicsPipelineInstance->vk.isReady = true;
+
+	*graphicsPipeline = graphicsPipelineInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static MpgxResult createVkGraphicsPipelineBatch(
+	VkDevice device,
+	VkPipelineCache cache,
+	const VkGraphicsPipelineCreateInfo* createInfos,
+	VkPipeline* handles,
+	uint32_t createInfoCount,
+	VkGraphicsPipelineBatch* batch)
+{
+	assert(device);
+	assert(createInfos);
+	assert(handles);
+	assert(createInfoCount > 0);
+	assert(batch);
+
+	VkGraphicsPipelineBatch batchInstance = calloc(1,
+		sizeof(VkGraphicsPipelineBatch_T));
+
+	if (!batchInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	Mutex mutex = createMutex();
+
+	if (!mutex)
+	{
+		free(batchInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	batchInstance->device = device;
+	batchInstance->cache = cache;
+	batchInstance->mutex = mutex;
+	batchInstance->createInfos = createInfos;
+	batchInstance->handles = handles;
+	batchInstance->createInfoCount = createInfoCount;
+	batchInstance->refCount = 1;
+	batchInstance->result = VK_SUCCESS;
+	batchInstance->isCreated = false;
+
+	*batch = batchInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
+// Creates batch pipelines if nobody did it yet, and releases the reference.
+// Pipeline thread and waiting thread both hold a reference,
+// because pool task can start after the waiting thread returned.
+inline static VkResult runVkGraphicsPipelineBatch(
+	VkGraphicsPipelineBatch batch)
+{
+	assert(batch);
+
+	lockMutex(batch->mutex);
+
+	if (!batch->isCreated)
+	{
+		// Each batch writes only to its own part of the handle array
+		batch->result = vkCreateGraphicsPipelines(
+			batch->device,
+			batch->cache,
+			batch->createInfoCount,
+			batch->createInfos,
+			NULL,
+			batch->handles);
+		batch->isCreated = true;
+	}
+
+	VkResult result = batch->result;
+	bool isReleased = --batch->refCount == 0;
+
+	unlockMutex(batch->mutex);
+
+	if (isReleased)
+	{
+		destroyMutex(batch->mutex);
+		free(batch);
+	}
+
+	return result;
+}
+inline static void onVkGraphicsPipelineBatch(void* argument)
+{
+	assert(argument);
+	runVkGraphicsPipelineBatch((VkGraphicsPipelineBatch)argument);
+}
+
+inline static void destroyVkGraphicsPipelineTask(
+	VkGraphicsPipelineTask task)
+{
+	if (!task)
+		return;
+
+	destroyMutex(task->cancelMutex);
+	free(task);
+}
+inline static MpgxResult createVkGraphicsPipelineTask(
+	VkDevice device,
+	Mutex mutex,
+	GraphicsPipeline graphicsPipeline,
+	const VkGraphicsPipelineCreateData* createData,
+	OnGraphicsPipelineReady onReady,
+	VkGraphicsPipelineTask* task)
+{
+	assert(device);
+	assert(mutex);
+	assert(graphicsPipeline);
+	assert(createData);
+	assert(task);
+
+	size_t bindingSize = createData->vertexBindingDescriptionCount *
+		sizeof(VkVertexInputBindingDescription);
+	size_t attributeSize = createData->vertexAttributeDescriptionCount *
+		sizeof(VkVertexInputAttributeDescription);
+	size_t setLayoutSize = createData->setLayoutCount *
+		sizeof(VkDescriptorSetLayout);
+	size_t pushConstantSize = createData->pushConstantRangeCount *
+		sizeof(VkPushConstantRange);
+
+	// Create data arrays are copied next to the task,
+	// because caller owned arrays can be freed before compilation.
+	VkGraphicsPipelineTask taskInstance = malloc(
+		sizeof(VkGraphicsPipelineTask_T) + bindingSize +
+		attributeSize + setLayoutSize + pushConstantSize);
+
+	if (!taskInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	Mutex cancelMutex = createMutex();
+
+	if (!cancelMutex)
+	{
+		free(taskInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	uint8_t* data = (uint8_t*)taskInstance +
+		sizeof(VkGraphicsPipelineTask_T);
+
+	VkGraphicsPipelineCreateData taskCreateData = *createData;
+	taskCreateData.specializationInfo = graphicsPipeline->vk.specializationInfo;
+
+	// Arrays are ordered by the element alignment. Task contains a
+	// handle, so its size is a multiple of the handle alignment,
+	// and other arrays have 4 byte elements after the handles.
+	if (setLayoutSize > 0)
+	{
+		memcpy(data, createData->setLayouts, setLayoutSize);
+		taskCreateData.setLayouts = (const VkDescriptorSetLayout*)data;
+		data += setLayoutSize;
+	}
+	if (bindingSize > 0)
+	{
+		memcpy(data, createData->vertexBindingDescriptions, bindingSize);
+		taskCreateData.vertexBindingDescriptions =
+			(const VkVertexInputBindingDescription*)data;
+		data += bindingSize;
+	}
+	if (attributeSize > 0)
+	{
+		memcpy(data, createData->vertexAttributeDescriptions, attributeSize);
+		taskCreateData.vertexAttributeDescriptions =
+			(const VkVertexInputAttributeDescription*)data;
+		data += attributeSize;
+	}
+	if (pushConstantSize > 0)
+	{
+		memcpy(data, createData->pushConstantRanges, pushConstantSize);
+		taskCreateData.pushConstantRanges = (const VkPushConstantRange*)data;
+	}
+
+	Framebuffer framebuffer = graphicsPipeline->vk.framebuffer;
+
+	taskInstance->device = device;
+	taskInstance->mutex = mutex;
+	taskInstance->cancelMutex = cancelMutex;
+	taskInstance->graphicsPipeline = graphicsPipeline;
+	taskInstance->renderPass = framebuffer->vk.renderPass;
+	taskInstance->colorAttachmentCount = getFramebufferSubpassColorCount(
+		framebuffer->vk.colorAttachmentCount,
+		framebuffer->vk.gBufferAttachmentCount,
+		graphicsPipeline->vk.state.subpassIndex);
+	taskInstance->sampleCount =
+		(VkSampleCountFlagBits)framebuffer->vk.sampleCount;
+	taskInstance->framebufferSize = framebuffer->vk.size;
+	taskInstance->createData = taskCreateData;
+	taskInstance->onReady = onReady;
+	taskInstance->vkHandle = NULL;
+	taskInstance->refCount = 2;
+	taskInstance->result = UNKNOWN_ERROR_MPGX_RESULT;
+	taskInstance->isLinkTask = false;
+	taskInstance->isCompleted = false;
+	taskInstance->isCancelled = false;
+
+	*task = taskInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkGraphicsPipelineLinkTask(
+	VkDevice device,
+	Mutex mutex,
+	GraphicsPipeline graphicsPipeline,
+	VkGraphicsPipelineTask* task)
+{
+	assert(device);
+	assert(mutex);
+	assert(graphicsPipeline);
+	assert(graphicsPipeline->vk.libraries[0]);
+	assert(task);
+
+	VkGraphicsPipelineTask taskInstance = calloc(1,
+		sizeof(VkGraphicsPipelineTask_T));
+
+	if (!taskInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	Mutex cancelMutex = createMutex();
+
+	if (!cancelMutex)
+	{
+		free(taskInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	Framebuffer framebuffer = graphicsPipeline->vk.framebuffer;
+
+	taskInstance->device = device;
+	taskInstance->mutex = mutex;
+	taskInstance->cancelMutex = cancelMutex;
+	taskInstance->graphicsPipeline = graphicsPipeline;
+	taskInstance->renderPass = framebuffer->vk.renderPass;
+	taskInstance->colorAttachmentCount = getFramebufferSubpassColorCount(
+		framebuffer->vk.colorAttachmentCount,
+		framebuffer->vk.gBufferAttachmentCount,
+		graphicsPipeline->vk.state.subpassIndex);
+	taskInstance->sampleCount =
+		(VkSampleCountFlagBits)framebuffer->vk.sampleCount;
+	taskInstance->framebufferSize = framebuffer->vk.size;
+	taskInstance->onReady = NULL;
+	taskInstance->vkHandle = NULL;
+	taskInstance->refCount = 2;
+	taskInstance->result = UNKNOWN_ERROR_MPGX_RESULT;
+	taskInstance->isLinkTask = true;
+	taskInstance->isCompleted = false;
+	taskInstance->isCancelled = false;
+
+	*task = taskInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+// Releases task reference of the pipeline thread or the task array
+inline static void releaseVkGraphicsPipelineTask(
+	VkGraphicsPipelineTask task)
+{
+	assert(task);
+
+	lockMutex(task->cancelMutex);
+	bool isReleased = --task->refCount == 0;
+	unlockMutex(task->cancelMutex);
+
+	if (isReleased)
+		destroyVkGraphicsPipelineTask(task);
+}
+inline static void onVkGraphicsPipelineTask(void* argument)
+{
+	assert(argument);
+
+	VkGraphicsPipelineTask task = (VkGraphicsPipelineTask)argument;
+
+	// Cancel mutex is held while the pipeline is read,
+	// cancelled task pipeline can be already destroyed.
+	lockMutex(task->cancelMutex);
+
+	if (task->isCancelled)
+	{
+		bool isReleased = --task->refCount == 0;
+		unlockMutex(task->cancelMutex);
+
+		if (isReleased)
+			destroyVkGraphicsPipelineTask(task);
+		return;
+	}
+
+	GraphicsPipeline graphicsPipeline = task->graphicsPipeline;
+
+	VkPipeline vkHandle = NULL;
+	MpgxResult mpgxResult;
+
+	if (task->isLinkTask)
+	{
+		mpgxResult = linkVkGraphicsPipelineLibraries(
+			task->device,
+			graphicsPipeline->vk.cache,
+			graphicsPipeline->vk.layout,
+			graphicsPipeline->vk.libraries,
+			true,
+			&vkHandle);
+	}
+	else
+	{
+		mpgxResult = createVkGraphicsPipelineHandle(
+			task->device,
+			task->renderPass,
+			graphicsPipeline->vk.cache,
+			graphicsPipeline->vk.layout,
+			graphicsPipeline->vk.shaders,
+			graphicsPipeline->vk.shaderCount,
+			graphicsPipeline->vk.specializationInfo,
+			graphicsPipeline->vk.state,
+			task->colorAttachmentCount,
+			task->sampleCount,
+			task->framebufferSize,
+			&task->createData,
+			0,
+			&vkHandle);
+	}
+
+	Mutex mutex = task->mutex;
+
+	lockMutex(mutex);
+	task->vkHandle = vkHandle;
+	task->result = mpgxResult;
+	task->isCompleted = true;
+	unlockMutex(mutex);
+
+	bool isReleased = --task->refCount == 0;
+	unlockMutex(task->cancelMutex);
+
+	if (isReleased)
+		destroyVkGraphicsPipelineTask(task);
+}
+// Waits only for the running compilation of this task,
+// returns compiled handle if task was already completed.
+inline static VkPipeline cancelVkGraphicsPipelineTask(
+	VkGraphicsPipelineTask task)
+{
+	assert(task);
+
+	lockMutex(task->cancelMutex);
+	task->isCancelled = true;
+
+	VkPipeline vkHandle = task->vkHandle;
+	task->vkHandle = NULL;
+
+	bool isReleased = --task->refCount == 0;
+	unlockMutex(task->cancelMutex);
+
+	if (isReleased)
+		destroyVkGraphicsPipelineTask(task);
+	return vkHandle;
+}
+inline static bool completeVkGraphicsPipelineTask(
+	VkGraphicsPipelineTask task)
+{
+	assert(task);
+
+	Mutex mutex = task->mutex;
+
+	lockMutex(mutex);
+	bool isCompleted = task->isCompleted;
+	unlockMutex(mutex);
+
+	if (!isCompleted)
+		return false;
+
+	GraphicsPipeline graphicsPipeline = task->graphicsPipeline;
+	graphicsPipeline->vk.taskCount--;
+
+	if (task->result == SUCCESS_MPGX_RESULT)
+	{
+		// Fast linked handle can still be used by the recorded
+		// command buffers, so it is destroyed with the pipeline.
+		if (task->isLinkTask)
+		{
+			graphicsPipeline->vk.fastLinkHandle =
+				graphicsPipeline->vk.vkHandle;
+		}
+
+		graphicsPipeline->vk.vkHandle = task->vkHandle;
+		graphicsPipeline->vk.isReady = true;
+	}
+	else if (!task->isLinkTask)
+	{
+		// Fast linked pipeline is still used if optimized link failed
+		graphicsPipeline->vk.compileResult = task->result;
+	}
+
+	return true;
+}
 
 inline static void bindVkGraphicsPipeline(
 	VkCommandBuffer commandBuffer,
@@ -937,111 +2009,582 @@ inline static bool getGlCullMode(
 	assert(cullMode < CULL_MODE_COUNT);
 	assert(glCullMode);
 
-	if (cullMode == FRONT_CULL_MODE)
+	if (cullMode == FRONT_CULL_MODE)
+	{
+		*glCullMode = GL_FRONT;
+		return true;
+	}
+	else if (cullMode == BACK_CULL_MODE)
+	{
+		*glCullMode = GL_BACK;
+		return true;
+	}
+	else if (cullMode == FRONT_AND_BACK_CULL_MODE)
+	{
+		*glCullMode = GL_FRONT_AND_BACK;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+inline static bool getGlBlendFactor(
+	BlendFactor blendFactor,
+	GLenum* glBlendFactor)
+{
+	assert(blendFactor < BLEND_FACTOR_COUNT);
+	assert(glBlendFactor);
+
+	switch (blendFactor)
+	{
+	default:
+		return false;
+	case ZERO_BLEND_FACTOR:
+		*glBlendFactor = GL_ZERO;
+		return true;
+	case ONE_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE;
+		return true;
+	case SOURCE_COLOR_BLEND_FACTOR:
+		*glBlendFactor = GL_SRC_COLOR;
+		return true;
+	case ONE_MINUS_SOURCE_COLOR_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE_MINUS_SRC_COLOR;
+		return true;
+	case DESTINATION_COLOR_BLEND_FACTOR:
+		*glBlendFactor = GL_DST_COLOR;
+		return true;
+	case ONE_MINUS_DESTINATION_COLOR_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE_MINUS_DST_COLOR;
+		return true;
+	case SOURCE_ALPHA_BLEND_FACTOR:
+		*glBlendFactor = GL_SRC_ALPHA;
+		return true;
+	case ONE_MINUS_SOURCE_ALPHA_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE_MINUS_SRC_ALPHA;
+		return true;
+	case DESTINATION_ALPHA_BLEND_FACTOR:
+		*glBlendFactor = GL_DST_ALPHA;
+		return true;
+	case ONE_MINUS_DESTINATION_ALPHA_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE_MINUS_DST_ALPHA;
+		return true;
+	case CONSTANT_COLOR_BLEND_FACTOR:
+		*glBlendFactor = GL_CONSTANT_COLOR;
+		return true;
+	case ONE_MINUS_CONSTANT_COLOR_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE_MINUS_CONSTANT_COLOR;
+		return true;
+	case CONSTANT_ALPHA_BLEND_FACTOR:
+		*glBlendFactor = GL_CONSTANT_ALPHA;
+		return true;
+	case ONE_MINUS_CONSTANT_ALPHA_BLEND_FACTOR:
+		*glBlendFactor = GL_ONE_MINUS_CONSTANT_ALPHA;
+		return true;
+	case SOURCE_ALPHA_SATURATE_BLEND_FACTOR:
+		*glBlendFactor = GL_SRC_ALPHA_SATURATE;
+		return true;
+	}
+}
+inline static bool getGlBlendOperator(
+	BlendOperator blendOperator,
+	GLenum* glBlendOperator)
+{
+	assert(blendOperator < BLEND_OPERATOR_COUNT);
+	assert(glBlendOperator);
+
+	switch (blendOperator)
+	{
+	default:
+		return false;
+	case ADD_BLEND_OPERATOR:
+		*glBlendOperator = GL_FUNC_ADD;
+		return true;
+	case SUBTRACT_BLEND_OPERATOR:
+		*glBlendOperator = GL_FUNC_SUBTRACT;
+		return true;
+	case REVERSE_SUBTRACT_BLEND_OPERATOR:
+		*glBlendOperator = GL_FUNC_REVERSE_SUBTRACT;
+		return true;
+	case MIN_BLEND_OPERATOR:
+		*glBlendOperator = GL_MIN;
+		return true;
+	case MAX_BLEND_OPERATOR:
+		*glBlendOperator = GL_MAX;
+		return true;
+	}
+}
+
+inline static char* createGlProgramCachePath(
+	const char* cacheDirectory,
+	Shader* shaders,
+	size_t shaderCount)
+{
+	assert(cacheDirectory);
+	assert(shaders);
+	assert(shaderCount > 0);
+
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* version = (const char*)glGetString(GL_VERSION);
+
+	if (!renderer || !version)
+		return NULL;
+
+	// Driver update or different GPU changes the file name,
+	// so binaries from the other drivers are never loaded.
+	XXH64_CONTEXT hashContext;
+	xxh64_init(&hashContext, 0);
+
+	for (size_t i = 0; i < shaderCount; i++)
+	{
+		xxh64_update(
+			&hashContext,
+			(const uint8_t*)&shaders[i]->gl.hash,
+			sizeof(uint64_t));
+	}
+
+	xxh64_update(
+		&hashContext,
+		(const uint8_t*)renderer,
+		strlen(renderer));
+	xxh64_update(
+		&hashContext,
+		(const uint8_t*)version,
+		strlen(version));
+
+	uint64_t hash = xxh64_final(&hashContext);
+
+	size_t directoryLength = strlen(cacheDirectory);
+	size_t extensionLength = strlen(GL_PROGRAM_CACHE_EXTENSION);
+
+	char* path = malloc((directoryLength + 1 +
+		sizeof(uint64_t) * 2 + extensionLength + 1) * sizeof(char));
+
+	if (!path)
+		return NULL;
+
+	memcpy(path, cacheDirectory, directoryLength);
+
+	char* name = path + directoryLength;
+	*name++ = '/';
+
+	const char* hexDigits = "0123456789abcdef";
+
+	for (int i = 60; i >= 0; i -= 4)
+		*name++ = hexDigits[(hash >> i) & 0x0F];
+
+	memcpy(name, GL_PROGRAM_CACHE_EXTENSION, extensionLength);
+	name[extensionLength] = '\0';
+	return path;
+}
+inline static bool loadGlProgramBinary(
+	GLuint program,
+	const char* filePath)
+{
+	assert(program);
+	assert(filePath);
+
+	FILE* file = fopen(filePath, "rb");
+
+	if (!file)
+		return false;
+
+	uint32_t header[2];
+
+	if (fread(header, sizeof(uint32_t), 2, file) != 2 ||
+		header[1] == 0)
+	{
+		fclose(file);
+		return false;
+	}
+
+	size_t size = header[1];
+	void* binary = malloc(size);
+
+	if (!binary)
+	{
+		fclose(file);
+		return false;
+	}
+
+	if (fread(binary, sizeof(uint8_t), size, file) != size)
+	{
+		free(binary);
+		fclose(file);
+		return false;
+	}
+
+	fclose(file);
+
+	glProgramBinary(
+		program,
+		(GLenum)header[0],
+		binary,
+		(GLsizei)size);
+	free(binary);
+
+	GLint linkStatus;
+
+	glGetProgramiv(
+		program,
+		GL_LINK_STATUS,
+		&linkStatus);
+
+	// Driver rejects binary if it was changed
+	if (linkStatus == GL_FALSE)
+	{
+		glGetError();
+		return false;
+	}
+
+	return true;
+}
+inline static void storeGlProgramBinary(
+	GLuint program,
+	const char* filePath)
+{
+	assert(program);
+	assert(filePath);
+
+	GLint length = 0;
+
+	glGetProgramiv(
+		program,
+		GL_PROGRAM_BINARY_LENGTH,
+		&length);
+
+	if (length <= 0)
+		return;
+
+	void* binary = malloc(length);
+
+	if (!binary)
+		return;
+
+	GLenum binaryFormat;
+
+	glGetProgramBinary(
+		program,
+		length,
+		&length,
+		&binaryFormat,
+		binary);
+
+	if (glGetError() != GL_NO_ERROR || length <= 0)
 	{
-		*glCullMode = GL_FRONT;
-		return true;
+		free(binary);
+		return;
 	}
-	else if (cullMode == BACK_CULL_MODE)
+
+	// Binary is written to the temporary file and renamed,
+	// so interrupted write does not leave a truncated binary.
+	size_t pathLength = strlen(filePath);
+	char* tempPath = malloc(pathLength + 5);
+
+	if (!tempPath)
 	{
-		*glCullMode = GL_BACK;
-		return true;
+		free(binary);
+		return;
 	}
-	else if (cullMode == FRONT_AND_BACK_CULL_MODE)
+
+	memcpy(tempPath, filePath, pathLength);
+	memcpy(tempPath + pathLength, ".tmp", 5);
+
+	FILE* file = fopen(tempPath, "wb");
+
+	if (!file)
 	{
-		*glCullMode = GL_FRONT_AND_BACK;
-		return true;
+		free(tempPath);
+		free(binary);
+		return;
 	}
-	else
+
+	uint32_t header[2] = {
+		(uint32_t)binaryFormat,
+		(uint32_t)length,
+	};
+
+	bool isWritten =
+		fwrite(header, sizeof(uint32_t), 2, file) == 2 &&
+		fwrite(binary, sizeof(uint8_t), length, file) == (size_t)length;
+
+	isWritten &= fclose(file) == 0;
+	free(binary);
+
+	if (isWritten && rename(tempPath, filePath) != 0)
 	{
-		return false;
+		// Rename does not replace existing file on Windows
+		remove(filePath);
+		isWritten = rename(tempPath, filePath) == 0;
 	}
+
+	if (!isWritten)
+		remove(tempPath);
+
+	free(tempPath);
 }
-inline static bool getGlBlendFactor(
-	BlendFactor blendFactor,
-	GLenum* glBlendFactor)
+inline static bool isGlProgramBinarySupported()
 {
-	assert(blendFactor < BLEND_FACTOR_COUNT);
-	assert(glBlendFactor);
+	if (!GLAD_GL_ARB_get_program_binary)
+		return false;
 
-	switch (blendFactor)
-	{
-	default:
+	GLint formatCount = 0;
+
+	glGetIntegerv(
+		GL_NUM_PROGRAM_BINARY_FORMATS,
+		&formatCount);
+	return formatCount > 0;
+}
+inline static uint64_t getGlUniformHash(const char* name)
+{
+	assert(name);
+
+	return xxh64(
+		(const uint8_t*)name,
+		strlen(name),
+		0);
+}
+inline static size_t getGlUniformTableIndex(
+	uint64_t hash,
+	uint64_t seed,
+	size_t mask)
+{
+	uint64_t value = (hash ^ seed) * 0x9E3779B97F4A7C15ULL;
+	return (size_t)(value >> 32) & mask;
+}
+inline static bool findGlUniformTableValue(
+	const GlUniformTable* table,
+	uint64_t hash,
+	GLint* value)
+{
+	assert(table);
+	assert(value);
+
+	if (!table->entries)
 		return false;
-	case ZERO_BLEND_FACTOR:
-		*glBlendFactor = GL_ZERO;
-		return true;
-	case ONE_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE;
-		return true;
-	case SOURCE_COLOR_BLEND_FACTOR:
-		*glBlendFactor = GL_SRC_COLOR;
-		return true;
-	case ONE_MINUS_SOURCE_COLOR_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE_MINUS_SRC_COLOR;
-		return true;
-	case DESTINATION_COLOR_BLEND_FACTOR:
-		*glBlendFactor = GL_DST_COLOR;
-		return true;
-	case ONE_MINUS_DESTINATION_COLOR_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE_MINUS_DST_COLOR;
-		return true;
-	case SOURCE_ALPHA_BLEND_FACTOR:
-		*glBlendFactor = GL_SRC_ALPHA;
-		return true;
-	case ONE_MINUS_SOURCE_ALPHA_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE_MINUS_SRC_ALPHA;
-		return true;
-	case DESTINATION_ALPHA_BLEND_FACTOR:
-		*glBlendFactor = GL_DST_ALPHA;
-		return true;
-	case ONE_MINUS_DESTINATION_ALPHA_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE_MINUS_DST_ALPHA;
-		return true;
-	case CONSTANT_COLOR_BLEND_FACTOR:
-		*glBlendFactor = GL_CONSTANT_COLOR;
-		return true;
-	case ONE_MINUS_CONSTANT_COLOR_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE_MINUS_CONSTANT_COLOR;
-		return true;
-	case CONSTANT_ALPHA_BLEND_FACTOR:
-		*glBlendFactor = GL_CONSTANT_ALPHA;
-		return true;
-	case ONE_MINUS_CONSTANT_ALPHA_BLEND_FACTOR:
-		*glBlendFactor = GL_ONE_MINUS_CONSTANT_ALPHA;
-		return true;
-	case SOURCE_ALPHA_SATURATE_BLEND_FACTOR:
-		*glBlendFactor = GL_SRC_ALPHA_SATURATE;
-		return true;
+
+	size_t index = getGlUniformTableIndex(
+		hash,
+		table->seed,
+		table->mask);
+	const GlUniformEntry* entry = &table->entries[index];
+
+	if (entry->hash != hash || entry->value == -1)
+		return false;
+
+	*value = entry->value;
+	return true;
+}
+inline static MpgxResult createGlUniformTable(
+	const GlUniformEntry* entries,
+	size_t entryCount,
+	GlUniformTable* table)
+{
+	assert(table);
+
+	table->entries = NULL;
+	table->seed = 0;
+	table->mask = 0;
+
+	if (entryCount == 0)
+		return SUCCESS_MPGX_RESULT;
+
+	size_t size = 1;
+
+	while (size < entryCount * 2)
+		size *= 2;
+
+	GlUniformEntry* tableEntries = NULL;
+
+	// Seed is searched until every name has its own slot,
+	// so lookup is a single compare without probing.
+	while (true)
+	{
+		GlUniformEntry* newEntries = realloc(tableEntries,
+			size * sizeof(GlUniformEntry));
+
+		if (!newEntries)
+		{
+			free(tableEntries);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		tableEntries = newEntries;
+
+		for (uint64_t seed = 0; seed < GL_UNIFORM_TABLE_SEED_COUNT; seed++)
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				tableEntries[i].hash = 0;
+				tableEntries[i].value = -1;
+			}
+
+			size_t mask = size - 1;
+			bool isCollided = false;
+
+			for (size_t i = 0; i < entryCount; i++)
+			{
+				GlUniformEntry entry = entries[i];
+
+				size_t index = getGlUniformTableIndex(
+					entry.hash,
+					seed,
+					mask);
+				GlUniformEntry* tableEntry = &tableEntries[index];
+
+				if (tableEntry->value != -1)
+				{
+					// The same name can be reported twice for arrays
+					if (tableEntry->hash == entry.hash)
+						continue;
+
+					isCollided = true;
+					break;
+				}
+
+				*tableEntry = entry;
+			}
+
+			if (!isCollided)
+			{
+				table->entries = tableEntries;
+				table->seed = seed;
+				table->mask = mask;
+				return SUCCESS_MPGX_RESULT;
+			}
+		}
+
+		size *= 2;
 	}
 }
-inline static bool getGlBlendOperator(
-	BlendOperator blendOperator,
-	GLenum* glBlendOperator)
+inline static void destroyGlUniformTable(GlUniformTable* table)
 {
-	assert(blendOperator < BLEND_OPERATOR_COUNT);
-	assert(glBlendOperator);
+	assert(table);
+	free(table->entries);
+}
+inline static MpgxResult createGlUniformTables(
+	GLuint program,
+	GlUniformTable* uniformTable,
+	GlUniformTable* blockTable)
+{
+	assert(program != GL_ZERO);
+	assert(uniformTable);
+	assert(blockTable);
 
-	switch (blendOperator)
+	GLint uniformCount = 0, blockCount = 0;
+	GLint uniformLength = 0, blockLength = 0;
+
+	glGetProgramiv(
+		program,
+		GL_ACTIVE_UNIFORMS,
+		&uniformCount);
+	glGetProgramiv(
+		program,
+		GL_ACTIVE_UNIFORM_MAX_LENGTH,
+		&uniformLength);
+	glGetProgramiv(
+		program,
+		GL_ACTIVE_UNIFORM_BLOCKS,
+		&blockCount);
+	glGetProgramiv(
+		program,
+		GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH,
+		&blockLength);
+
+	size_t nameLength = (size_t)(uniformLength > blockLength ?
+		uniformLength : blockLength) + 1;
+	size_t entryCount = (size_t)(uniformCount * 2 + blockCount);
+
+	uint8_t* data = malloc(nameLength * sizeof(char) +
+		entryCount * sizeof(GlUniformEntry));
+
+	if (!data)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	GlUniformEntry* entries = (GlUniformEntry*)data;
+	char* name = (char*)(entries + entryCount);
+	size_t count = 0;
+
+	for (GLint i = 0; i < uniformCount; i++)
 	{
-	default:
-		return false;
-	case ADD_BLEND_OPERATOR:
-		*glBlendOperator = GL_FUNC_ADD;
-		return true;
-	case SUBTRACT_BLEND_OPERATOR:
-		*glBlendOperator = GL_FUNC_SUBTRACT;
-		return true;
-	case REVERSE_SUBTRACT_BLEND_OPERATOR:
-		*glBlendOperator = GL_FUNC_REVERSE_SUBTRACT;
-		return true;
-	case MIN_BLEND_OPERATOR:
-		*glBlendOperator = GL_MIN;
-		return true;
-	case MAX_BLEND_OPERATOR:
-		*glBlendOperator = GL_MAX;
-		return true;
+		GLsizei length = 0;
+
+		glGetActiveUniformName(
+			program,
+			(GLuint)i,
+			(GLsizei)nameLength,
+			&length,
+			name);
+
+		// Block members have no location
+		GLint location = glGetUniformLocation(
+			program,
+			name);
+
+		if (location == -1)
+			continue;
+
+		GlUniformEntry entry;
+		memset(&entry, 0, sizeof(GlUniformEntry));
+		entry.hash = getGlUniformHash(name);
+		entry.value = location;
+		entries[count++] = entry;
+
+		// Arrays are reported as "name[0]",
+		// but looked up without the index.
+		if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+		{
+			name[length - 3] = '\0';
+			entry.hash = getGlUniformHash(name);
+			entries[count++] = entry;
+		}
+	}
+
+	MpgxResult mpgxResult = createGlUniformTable(
+		entries,
+		count,
+		uniformTable);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(data);
+		return mpgxResult;
+	}
+
+	count = 0;
+
+	for (GLint i = 0; i < blockCount; i++)
+	{
+		glGetActiveUniformBlockName(
+			program,
+			(GLuint)i,
+			(GLsizei)nameLength,
+			NULL,
+			name);
+
+		GlUniformEntry entry;
+		memset(&entry, 0, sizeof(GlUniformEntry));
+		entry.hash = getGlUniformHash(name);
+		entry.value = i;
+		entries[count++] = entry;
+	}
+
+	mpgxResult = createGlUniformTable(
+		entries,
+		count,
+		blockTable);
+
+	free(data);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyGlUniformTable(uniformTable);
+		uniformTable->entries = NULL;
+		return mpgxResult;
 	}
+
+	return SUCCESS_MPGX_RESULT;
 }
 
 inline static void destroyGlGraphicsPipeline(GraphicsPipeline graphicsPipeline)
@@ -1055,6 +2598,8 @@ inline static void destroyGlGraphicsPipeline(GraphicsPipeline graphicsPipeline)
 	glDeleteProgram(graphicsPipeline->gl.glHandle);
 	assertOpenGL();
 
+	destroyGlUniformTable(&graphicsPipeline->gl.blockTable);
+	destroyGlUniformTable(&graphicsPipeline->gl.uniformTable);
 	free(graphicsPipeline->gl.shaders);
 #ifndef NDEBUG
 	free(graphicsPipeline->gl.name);
@@ -1073,6 +2618,7 @@ inline static MpgxResult createGlGraphicsPipeline(
 	void* handle,
 	Shader* shaders,
 	size_t shaderCount,
+	const char* cacheDirectory,
 	GraphicsPipeline* graphicsPipeline)
 {
 	assert(framebuffer);
@@ -1097,6 +2643,8 @@ inline static MpgxResult createGlGraphicsPipeline(
 	graphicsPipelineInstance->gl.onDestroy = onDestroy;
 	graphicsPipelineInstance->gl.handle = handle;
 	graphicsPipelineInstance->gl.state = state;
+	graphicsPipelineInstance->gl.fallback = NULL;
+	graphicsPipelineInstance->gl.isReady = true;
 
 #ifndef NDEBUG
 	size_t nameLength = strlen(name);
@@ -1192,14 +2740,63 @@ inline static MpgxResult createGlGraphicsPipeline(
 	graphicsPipelineInstance->gl.frontFace =
 		state.clockwiseFrontFace ? GL_CW : GL_CCW;
 
+	for (size_t i = 0; i < shaderCount; i++)
+		pipelineShaders[i] = shaders[i];
+
 	makeGlWindowContextCurrent(window);
 
 	GLuint glHandle = glCreateProgram();
 	graphicsPipelineInstance->gl.glHandle = glHandle;
 
+	char* cachePath = NULL;
+
+	if (cacheDirectory && isGlProgramBinarySupported())
+	{
+		cachePath = createGlProgramCachePath(
+			cacheDirectory,
+			shaders,
+			shaderCount);
+
+		if (cachePath && loadGlProgramBinary(glHandle, cachePath))
+		{
+			free(cachePath);
+
+			MpgxResult mpgxResult = createGlUniformTables(
+				glHandle,
+				&graphicsPipelineInstance->gl.uniformTable,
+				&graphicsPipelineInstance->gl.blockTable);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				destroyGlGraphicsPipeline(graphicsPipelineInstance);
+				return mpgxResult;
+			}
+
+			*graphicsPipeline = graphicsPipelineInstance;
+			return SUCCESS_MPGX_RESULT;
+		}
+
+		glProgramParameteri(
+			glHandle,
+			GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+			GL_TRUE);
+	}
+
 	for (size_t i = 0; i < shaderCount; i++)
 	{
-		Shader shader = pipelineShaders[i] = shaders[i];
+		Shader shader = shaders[i];
+
+		if (shader->gl.handle == GL_ZERO)
+		{
+			MpgxResult mpgxResult = compileGlShader(shader);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				free(cachePath);
+				destroyGlGraphicsPipeline(graphicsPipelineInstance);
+				return mpgxResult;
+			}
+		}
 
 		glAttachShader(
 			glHandle,
@@ -1237,6 +2834,7 @@ inline static MpgxResult createGlGraphicsPipeline(
 
 			if (!infoLog)
 			{
+				free(cachePath);
 				destroyGlGraphicsPipeline(graphicsPipelineInstance);
 				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 			}
@@ -1254,10 +2852,28 @@ inline static MpgxResult createGlGraphicsPipeline(
 		}
 
 		assertOpenGL();
+		free(cachePath);
 		destroyGlGraphicsPipeline(graphicsPipelineInstance);
 		return BAD_SHADER_CODE_MPGX_RESULT;
 	}
 
+	if (cachePath)
+	{
+		storeGlProgramBinary(glHandle, cachePath);
+		free(cachePath);
+	}
+
+	MpgxResult mpgxResult = createGlUniformTables(
+		glHandle,
+		&graphicsPipelineInstance->gl.uniformTable,
+		&graphicsPipelineInstance->gl.blockTable);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyGlGraphicsPipeline(graphicsPipelineInstance);
+		return mpgxResult;
+	}
+
 	GLenum glError = glGetError();
 
 	if (glError != GL_NO_ERROR)
@@ -1456,4 +3072,38 @@ inline static GLuint getGlUniformBlockIndex(
 	*blockIndex = uniformBlockIndex;
 	return true;
 }
+inline static bool getGlUniformLocationByHash(
+	GraphicsPipeline graphicsPipeline,
+	uint64_t hash,
+	GLint* location)
+{
+	assert(graphicsPipeline);
+	assert(location);
+
+	return findGlUniformTableValue(
+		&graphicsPipeline->gl.uniformTable,
+		hash,
+		location);
+}
+inline static bool getGlUniformBlockIndexByHash(
+	GraphicsPipeline graphicsPipeline,
+	uint64_t hash,
+	GLuint* blockIndex)
+{
+	assert(graphicsPipeline);
+	assert(blockIndex);
+
+	GLint value;
+
+	if (!findGlUniformTableValue(
+		&graphicsPipeline->gl.blockTable,
+		hash,
+		&value))
+	{
+		return false;
+	}
+
+	*blockIndex = (GLuint)value;
+	return true;
+}
 #endif
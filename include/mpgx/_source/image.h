@@ -16,6 +16,34 @@
 #include "mpgx/_source/buffer.h"
 #include <assert.h>
 
+typedef struct ImageStream_T
+{
+	const void** data;
+	size_t residentSize;
+	uint32_t updateIndex;
+	float priority;
+	uint8_t residentMip;
+	uint8_t requestedMip;
+	uint8_t uploadMip;
+	uint8_t blockSize;
+	bool isFilled;
+	bool isFilterLinear;
+	uint8_t _alignment[2];
+} ImageStream_T;
+
+typedef ImageStream_T* ImageStream;
+
+typedef struct ImageSparse_T
+{
+	Vec3I pageSize;
+	size_t pageCount;
+	size_t committedPageCount;
+	uint8_t tailMip;
+	uint8_t _alignment[7];
+} ImageSparse_T;
+
+typedef ImageSparse_T* ImageSparse;
+
 typedef struct BaseImage_T
 {
 	Window window;
@@ -26,8 +54,29 @@ typedef struct BaseImage_T
 	bool isConstant;
 	uint32_t mipCount;
 	uint32_t layerCount;
+	ImageStream stream;
+	ImageSparse sparse;
+	Image aliasBase;
+	size_t aliasCount;
 } BaseImage_T;
 #if MPGX_SUPPORT_VULKAN
+typedef struct VkImageState
+{
+	VkImageLayout layout;
+	VkPipelineStageFlags2KHR stageMask;
+	VkAccessFlags2KHR accessMask;
+} VkImageState;
+typedef struct VkRetiredImagePages
+{
+	Image image;
+	VkSparseImageMemoryBind* binds;
+	VmaAllocation* allocations;
+	size_t* pageIndices;
+	uint32_t pageCount;
+	uint32_t frameIndex;
+	bool isUnbound;
+	uint8_t _alignment[7];
+} VkRetiredImagePages;
 typedef struct VkImage_T
 {
 	Window window;
@@ -38,6 +87,10 @@ typedef struct VkImage_T
 	bool isConstant;
 	uint32_t mipCount;
 	uint32_t layerCount;
+	ImageStream stream;
+	ImageSparse sparse;
+	Image aliasBase;
+	size_t aliasCount;
 	VkFormat vkFormat;
 	VkImageAspectFlagBits vkAspect;
 	VkImage handle;
@@ -45,6 +98,12 @@ typedef struct VkImage_T
 	VkImageView imageView;
 	VkBuffer stagingBuffer;
 	VmaAllocation stagingAllocation;
+	VmaAllocation* sparsePages;
+	VmaAllocation sparseTailAllocation;
+	VkImageState* states;
+	Image activeAlias;
+	VkPipelineStageFlags2KHR aliasStageMask;
+	VkAccessFlags2KHR aliasAccessMask;
 	uint8_t sizeMultiplier;
 } VkImage_T;
 #endif
@@ -59,10 +118,15 @@ typedef struct GlImage_T
 	bool isConstant;
 	uint32_t mipCount;
 	uint32_t layerCount;
+	ImageStream stream;
+	ImageSparse sparse;
+	Image aliasBase;
+	size_t aliasCount;
 	GLenum glType;
 	GLenum dataType;
 	GLenum dataFormat;
 	GLuint handle;
+	bool* sparsePages;
 } GlImage_T;
 #endif
 union Image_T
@@ -76,7 +140,754 @@ union Image_T
 #endif
 };
 
+inline static bool isImageFormatCompressed(ImageFormat format)
+{
+	return format >= BC1_RGB_UNORM_IMAGE_FORMAT &&
+		format <= ASTC_12X12_SRGB_IMAGE_FORMAT;
+}
+inline static bool isImageFormatDepthStencil(ImageFormat format)
+{
+	return format >= D16_UNORM_IMAGE_FORMAT &&
+		format <= D32_SFLOAT_S8_UINT_IMAGE_FORMAT;
+}
+inline static bool isImageFormatInteger(ImageFormat format)
+{
+	return format >= R8_UINT_IMAGE_FORMAT &&
+		format <= R32G32B32A32_UINT_IMAGE_FORMAT;
+}
+inline static Vec2I getImageFormatBlockExtent(ImageFormat format)
+{
+	assert(format < IMAGE_FORMAT_COUNT);
+
+	switch (format)
+	{
+	default:
+		return isImageFormatCompressed(format) ?
+			vec2I(4, 4) : vec2I(1, 1);
+	case ASTC_4X4_UNORM_IMAGE_FORMAT:
+		return vec2I(4, 4);
+	case ASTC_4X4_SRGB_IMAGE_FORMAT:
+		return vec2I(4, 4);
+	case ASTC_5X4_UNORM_IMAGE_FORMAT:
+		return vec2I(5, 4);
+	case ASTC_5X4_SRGB_IMAGE_FORMAT:
+		return vec2I(5, 4);
+	case ASTC_5X5_UNORM_IMAGE_FORMAT:
+		return vec2I(5, 5);
+	case ASTC_5X5_SRGB_IMAGE_FORMAT:
+		return vec2I(5, 5);
+	case ASTC_6X5_UNORM_IMAGE_FORMAT:
+		return vec2I(6, 5);
+	case ASTC_6X5_SRGB_IMAGE_FORMAT:
+		return vec2I(6, 5);
+	case ASTC_6X6_UNORM_IMAGE_FORMAT:
+		return vec2I(6, 6);
+	case ASTC_6X6_SRGB_IMAGE_FORMAT:
+		return vec2I(6, 6);
+	case ASTC_8X5_UNORM_IMAGE_FORMAT:
+		return vec2I(8, 5);
+	case ASTC_8X5_SRGB_IMAGE_FORMAT:
+		return vec2I(8, 5);
+	case ASTC_8X6_UNORM_IMAGE_FORMAT:
+		return vec2I(8, 6);
+	case ASTC_8X6_SRGB_IMAGE_FORMAT:
+		return vec2I(8, 6);
+	case ASTC_8X8_UNORM_IMAGE_FORMAT:
+		return vec2I(8, 8);
+	case ASTC_8X8_SRGB_IMAGE_FORMAT:
+		return vec2I(8, 8);
+	case ASTC_10X5_UNORM_IMAGE_FORMAT:
+		return vec2I(10, 5);
+	case ASTC_10X5_SRGB_IMAGE_FORMAT:
+		return vec2I(10, 5);
+	case ASTC_10X6_UNORM_IMAGE_FORMAT:
+		return vec2I(10, 6);
+	case ASTC_10X6_SRGB_IMAGE_FORMAT:
+		return vec2I(10, 6);
+	case ASTC_10X8_UNORM_IMAGE_FORMAT:
+		return vec2I(10, 8);
+	case ASTC_10X8_SRGB_IMAGE_FORMAT:
+		return vec2I(10, 8);
+	case ASTC_10X10_UNORM_IMAGE_FORMAT:
+		return vec2I(10, 10);
+	case ASTC_10X10_SRGB_IMAGE_FORMAT:
+		return vec2I(10, 10);
+	case ASTC_12X10_UNORM_IMAGE_FORMAT:
+		return vec2I(12, 10);
+	case ASTC_12X10_SRGB_IMAGE_FORMAT:
+		return vec2I(12, 10);
+	case ASTC_12X12_UNORM_IMAGE_FORMAT:
+		return vec2I(12, 12);
+	case ASTC_12X12_SRGB_IMAGE_FORMAT:
+		return vec2I(12, 12);
+	}
+}
+inline static size_t calcImageDataSize(
+	Vec3I size,
+	Vec2I blockExtent,
+	uint8_t blockSize,
+	uint32_t layerCount)
+{
+	// Partial blocks on the image edge are stored as the whole ones
+	size_t blockCountX = (size_t)(size.x + blockExtent.x - 1) / blockExtent.x;
+	size_t blockCountY = (size_t)(size.y + blockExtent.y - 1) / blockExtent.y;
+	return blockCountX * blockCountY * size.z * layerCount * blockSize;
+}
+inline static Vec3I getImageMipSize(
+	Vec3I size,
+	uint8_t mipLevel)
+{
+	// Mip size is never less than one pixel
+	size.x = max(size.x >> mipLevel, 1);
+	size.y = max(size.y >> mipLevel, 1);
+	size.z = max(size.z >> mipLevel, 1);
+	return size;
+}
+inline static size_t calcImageStreamSize(
+	Image image,
+	uint8_t baseMip,
+	uint8_t endMip)
+{
+	assert(image);
+	assert(image->base.stream);
+	assert(baseMip <= endMip);
+	assert(endMip <= image->base.mipCount);
+
+	Vec2I blockExtent = getImageFormatBlockExtent(image->base.format);
+	uint8_t blockSize = image->base.stream->blockSize;
+	size_t streamSize = 0;
+
+	for (uint8_t i = baseMip; i < endMip; i++)
+	{
+		streamSize += calcImageDataSize(
+			getImageMipSize(image->base.size, i),
+			blockExtent,
+			blockSize,
+			image->base.layerCount);
+	}
+
+	return streamSize;
+}
+inline static Vec3I getImagePageCount(
+	Vec3I size,
+	Vec3I pageSize)
+{
+	// Partial pages on the image edge are committed as the whole ones
+	size.x = (size.x + pageSize.x - 1) / pageSize.x;
+	size.y = (size.y + pageSize.y - 1) / pageSize.y;
+	size.z = (size.z + pageSize.z - 1) / pageSize.z;
+	return size;
+}
+inline static size_t getImagePageIndex(
+	Image image,
+	uint8_t mipLevel,
+	Vec3I page)
+{
+	assert(image);
+	assert(image->base.sparse);
+	assert(mipLevel <= image->base.sparse->tailMip);
+
+	Vec3I pageSize = image->base.sparse->pageSize;
+	size_t pageIndex = 0;
+
+	// Page table levels are stored one after another
+	for (uint8_t i = 0; i < mipLevel; i++)
+	{
+		Vec3I pageCount = getImagePageCount(
+			getImageMipSize(image->base.size, i),
+			pageSize);
+		pageIndex += (size_t)pageCount.x * pageCount.y * pageCount.z;
+	}
+
+	Vec3I pageCount = getImagePageCount(
+		getImageMipSize(image->base.size, mipLevel),
+		pageSize);
+
+	assert(page.x >= 0 && page.x < pageCount.x);
+	assert(page.y >= 0 && page.y < pageCount.y);
+	assert(page.z >= 0 && page.z < pageCount.z);
+
+	return pageIndex + ((size_t)page.z * pageCount.y +
+		page.y) * pageCount.x + page.x;
+}
+
 #if MPGX_SUPPORT_VULKAN
+inline static bool getVkImageType(
+	ImageDimension dimension,
+	uint32_t layerCount,
+	VkImageType* vkType,
+	VkImageViewType* vkViewType)
+{
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(layerCount > 0);
+	assert(vkType);
+	assert(vkViewType);
+
+	if (dimension == IMAGE_1D)
+	{
+		*vkType = VK_IMAGE_TYPE_1D;
+		*vkViewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D;
+		return true;
+	}
+	else if (dimension == IMAGE_2D)
+	{
+		*vkType = VK_IMAGE_TYPE_2D;
+		*vkViewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+		return true;
+	}
+	else if (dimension == IMAGE_3D)
+	{
+		*vkType = VK_IMAGE_TYPE_3D;
+		*vkViewType = VK_IMAGE_VIEW_TYPE_3D;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+inline static bool getVkImageFormat(
+	ImageFormat format,
+	VkFormat* vkFormat,
+	VkImageAspectFlags* vkAspect,
+	uint8_t* sizeMultiplier)
+{
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(vkFormat);
+	assert(vkAspect);
+	assert(sizeMultiplier);
+
+	switch (format)
+	{
+	default:
+		return false;
+	case R8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8_UNORM;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 1;
+		return true;
+	case R8_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8_SRGB;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 1;
+		return true;
+	case R8G8B8A8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8G8B8A8_UNORM;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R8G8B8A8_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8G8B8A8_SRGB;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case R8G8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8G8_UNORM;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 2;
+		return true;
+	case R16_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R16_SFLOAT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 2;
+		return true;
+	case R16G16_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R16G16_SFLOAT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R32_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R32_SFLOAT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R32G32B32A32_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case B10G11R11_UFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case A2B10G10R10_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R8_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 1;
+		return true;
+	case R16_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R16_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 2;
+		return true;
+	case R32_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R32_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R32_SINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R32_SINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R16G16_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R16G16_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R8G8B8A8_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R8G8B8A8_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case R16G16B16A16_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R16G16B16A16_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case R32G32B32A32_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_R32G32B32A32_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case D16_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_D16_UNORM;
+		*vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		*sizeMultiplier = 2;
+		return true;
+	case D32_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_D32_SFLOAT;
+		*vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case D16_UNORM_S8_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_D16_UNORM_S8_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		*sizeMultiplier = 3; // TODO: correct?
+		return true;
+	case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_D24_UNORM_S8_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		*sizeMultiplier = 4;
+		return true;
+	case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_D32_SFLOAT_S8_UINT;
+		*vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		*sizeMultiplier = 5; // TODO: correct?
+		return true;
+	case BC1_RGB_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case BC1_RGB_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case BC1_RGBA_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case BC1_RGBA_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case BC2_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC2_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC2_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC2_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC3_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC3_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC3_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC3_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC4_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC4_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case BC4_SNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC4_SNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case BC5_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC5_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC5_SNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC5_SNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC6H_UFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC6H_UFLOAT_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC6H_SFLOAT_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC6H_SFLOAT_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC7_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC7_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case BC7_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_BC7_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ETC2_R8G8B8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case ETC2_R8G8B8_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case ETC2_R8G8B8A1_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case ETC2_R8G8B8A1_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case ETC2_R8G8B8A8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ETC2_R8G8B8A8_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case EAC_R11_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_EAC_R11_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case EAC_R11_SNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_EAC_R11_SNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 8;
+		return true;
+	case EAC_R11G11_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_EAC_R11G11_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case EAC_R11G11_SNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_EAC_R11G11_SNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_4X4_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_4X4_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_4x4_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_5X4_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_5x4_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_5X4_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_5x4_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_5X5_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_5x5_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_5X5_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_5x5_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_6X5_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_6x5_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_6X5_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_6x5_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_6X6_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_6x6_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_6X6_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_6x6_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_8X5_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_8x5_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_8X5_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_8x5_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_8X6_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_8x6_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_8X6_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_8x6_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_8X8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_8x8_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_8X8_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_8x8_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X5_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x5_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X5_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x5_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X6_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x6_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X6_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x6_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X8_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x8_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X8_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x8_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X10_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x10_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_10X10_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_10x10_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_12X10_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_12x10_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_12X10_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_12x10_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_12X12_UNORM_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_12x12_UNORM_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	case ASTC_12X12_SRGB_IMAGE_FORMAT:
+		*vkFormat = VK_FORMAT_ASTC_12x12_SRGB_BLOCK;
+		*vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		*sizeMultiplier = 16;
+		return true;
+	}
+}
+inline static VkImageUsageFlags getVkImageUsage(
+	ImageType type,
+	bool hasData)
+{
+	VkImageUsageFlags vkUsage = 0;
+
+	if (type & SAMPLED_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+	if (type & COLOR_ATTACHMENT_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	if (type & DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	if (type & STORAGE_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
+	if (type & TRANSFER_SOURCE_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	if ((type & TRANSFER_DESTINATION_IMAGE_TYPE) || hasData)
+		vkUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	if (type & TRANSIENT_ATTACHMENT_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+	if (type & INPUT_ATTACHMENT_IMAGE_TYPE)
+		vkUsage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+	return vkUsage;
+}
+inline static VkImageTiling getVkImageTiling(
+	ImageFormat format,
+	bool isConstant)
+{
+	// Compressed formats are rarely supported with linear tiling,
+	// their data is always written through the staging buffer.
+	return isConstant || isImageFormatCompressed(format) ?
+		VK_IMAGE_TILING_OPTIMAL : VK_IMAGE_TILING_LINEAR;
+}
+inline static bool isVkImageFormatSupported(
+	VkPhysicalDevice physicalDevice,
+	ImageType type,
+	ImageFormat format,
+	bool isConstant)
+{
+	assert(physicalDevice);
+	assert(type > 0);
+	assert(format < IMAGE_FORMAT_COUNT);
+
+	VkFormat vkFormat;
+	VkImageAspectFlags vkAspect;
+	uint8_t sizeMultiplier;
+
+	if (!getVkImageFormat(
+		format,
+		&vkFormat,
+		&vkAspect,
+		&sizeMultiplier))
+	{
+		return false;
+	}
+
+	VkFormatProperties properties;
+
+	vkGetPhysicalDeviceFormatProperties(
+		physicalDevice,
+		vkFormat,
+		&properties);
+
+	VkFormatFeatureFlags features = getVkImageTiling(format, isConstant) ==
+		VK_IMAGE_TILING_OPTIMAL ? properties.optimalTilingFeatures :
+		properties.linearTilingFeatures;
+	VkFormatFeatureFlags requiredFeatures = 0;
+
+	if (type & SAMPLED_IMAGE_TYPE)
+		requiredFeatures |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+	if (type & COLOR_ATTACHMENT_IMAGE_TYPE)
+		requiredFeatures |= VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+	if (type & DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)
+		requiredFeatures |= VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	if (type & STORAGE_IMAGE_TYPE)
+		requiredFeatures |= VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+	if (type & TRANSFER_SOURCE_IMAGE_TYPE)
+		requiredFeatures |= VK_FORMAT_FEATURE_TRANSFER_SRC_BIT;
+	if (type & TRANSFER_DESTINATION_IMAGE_TYPE)
+		requiredFeatures |= VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+
+	return (features & requiredFeatures) == requiredFeatures;
+}
+inline static bool getVkImageMipmapFilter(
+	VkPhysicalDevice physicalDevice,
+	ImageFormat format,
+	VkFilter* filter)
+{
+	assert(physicalDevice);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(filter);
+
+	VkFormat vkFormat;
+	VkImageAspectFlags vkAspect;
+	uint8_t sizeMultiplier;
+
+	if (!getVkImageFormat(
+		format,
+		&vkFormat,
+		&vkAspect,
+		&sizeMultiplier))
+	{
+		return false;
+	}
+
+	VkFormatProperties properties;
+
+	vkGetPhysicalDeviceFormatProperties(
+		physicalDevice,
+		vkFormat,
+		&properties);
+
+	// Mipmaps are generated by the blit cascade,
+	// compressed formats can not be a blit destination.
+	VkFormatFeatureFlags features = properties.optimalTilingFeatures;
+
+	if (!(features & VK_FORMAT_FEATURE_BLIT_SRC_BIT) ||
+		!(features & VK_FORMAT_FEATURE_BLIT_DST_BIT))
+	{
+		return false;
+	}
+
+	// Fall back to the nearest filter for the formats
+	// which do not support linear filtering. (depth, integer)
+	*filter = features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT ?
+		VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+	return true;
+}
+
 inline static void destroyVkImage(
 	VkDevice device,
 	VmaAllocator allocator,
@@ -100,101 +911,462 @@ inline static void destroyVkImage(
 		allocator,
 		image->vk.handle,
 		image->vk.allocation);
+
+	VmaAllocation* sparsePages = image->vk.sparsePages;
+
+	if (sparsePages)
+	{
+		size_t pageCount = image->vk.sparse->pageCount;
+
+		for (size_t i = 0; i < pageCount; i++)
+		{
+			if (sparsePages[i])
+				vmaFreeMemory(allocator, sparsePages[i]);
+		}
+
+		free(sparsePages);
+	}
+
+	if (image->vk.sparseTailAllocation)
+	{
+		vmaFreeMemory(
+			allocator,
+			image->vk.sparseTailAllocation);
+	}
+
+	free(image->vk.states);
+	free(image->vk.sparse);
+	free(image->vk.stream);
 	free(image);
 }
-inline static MpgxResult fillVkImage(
-	VkDevice device,
-	VmaAllocator allocator,
-	VkQueue transferQueue,
-	VkCommandBuffer transferCommandBuffer,
-	VkFence transferFence,
-	VkBuffer stagingBuffer,
-	VmaAllocation stagingAllocation,
-	const void** data,
-	Vec3I size,
+inline static MpgxResult transitVkImage(
+	VkBarrierBatch barrierBatch,
+	Image image,
+	uint32_t baseMip,
 	uint32_t mipCount,
+	uint32_t baseLayer,
 	uint32_t layerCount,
-	VkImageAspectFlags vkAspect,
-	VkDeviceSize bufferSize,
-	uint8_t sizeMultiplier,
-	VkImage handle)
+	VkImageLayout layout,
+	VkPipelineStageFlags2KHR stageMask,
+	VkAccessFlags2KHR accessMask,
+	bool discardData)
 {
-	assert(device);
-	assert(allocator);
-	assert(transferQueue);
-	assert(transferCommandBuffer);
-	assert(transferFence);
-	assert(stagingBuffer);
-	assert(stagingAllocation);
-	assert(data);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(size.z > 0);
+	assert(barrierBatch);
+	assert(image);
 	assert(mipCount > 0);
 	assert(layerCount > 0);
-	assert(bufferSize > 0);
-	assert(sizeMultiplier > 0);
-	assert(handle);
-	assert(mipCount <= calcMipLevelCount(size));
+	assert(baseMip + mipCount <= image->vk.mipCount);
+	assert(baseLayer + layerCount <= image->vk.layerCount);
+	assert(layout != VK_IMAGE_LAYOUT_UNDEFINED);
 
-	VkCommandBufferBeginInfo commandBufferBeginInfo = {
-		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		NULL,
-		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-		NULL,
-	};
+	VkImageState* states = image->vk.states;
+	uint32_t imageLayerCount = image->vk.layerCount;
+	uint32_t endLayer = baseLayer + layerCount;
+	bool isWrite = (accessMask & VK_ACCESS_WRITE_MASK) != 0;
+	size_t maxBarrierCount = 0;
 
-	VkResult vkResult = vkBeginCommandBuffer(
-		transferCommandBuffer,
-		&commandBufferBeginInfo);
+	// Memory owner keeps the hazard state of all its aliases
+	Image memoryImage = image->vk.aliasBase ?
+		image->vk.aliasBase : image;
 
-	if (vkResult != VK_SUCCESS)
-		return vkToMpgxResult(vkResult);
+	if (memoryImage->vk.activeAlias != image)
+	{
+		// Previous alias overwrote the memory, so the content
+		// is discarded and the next barriers wait for its accesses.
+		VkImageState aliasState = {
+			VK_IMAGE_LAYOUT_UNDEFINED,
+			memoryImage->vk.aliasStageMask,
+			memoryImage->vk.aliasAccessMask,
+		};
+
+		size_t stateCount = (size_t)image->vk.mipCount * imageLayerCount;
+
+		for (size_t i = 0; i < stateCount; i++)
+			states[i] = aliasState;
+
+		memoryImage->vk.activeAlias = image;
+	}
+
+	// Capacity is reserved before the tracked states
+	// are changed, so adding a barrier can not fail.
+	for (uint32_t i = baseMip; i < baseMip + mipCount; i++)
+	{
+		const VkImageState* mipStates = states + (size_t)i * imageLayerCount;
+
+		for (uint32_t j = baseLayer; j < endLayer; j++)
+		{
+			if (j == baseLayer ||
+				mipStates[j].layout != mipStates[j - 1].layout ||
+				mipStates[j].stageMask != mipStates[j - 1].stageMask ||
+				mipStates[j].accessMask != mipStates[j - 1].accessMask)
+			{
+				maxBarrierCount++;
+			}
+		}
+	}
+
+	MpgxResult mpgxResult = reserveVkImageBarriers(
+		barrierBatch,
+		maxBarrierCount);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
 
-	VkImageMemoryBarrier imageMemoryBarrier = {
-		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+	VkImageMemoryBarrier2KHR imageBarrier = {
+		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
 		NULL,
-		VK_ACCESS_NONE_KHR,
-		VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_NONE_KHR,
+		VK_ACCESS_2_NONE_KHR,
+		stageMask,
+		accessMask,
 		VK_IMAGE_LAYOUT_UNDEFINED,
-		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		layout,
 		VK_QUEUE_FAMILY_IGNORED,
 		VK_QUEUE_FAMILY_IGNORED,
-		handle,
+		image->vk.handle,
 		{
-			vkAspect,
+			image->vk.vkAspect,
+			0,
+			1,
 			0,
-			mipCount,
 			0,
-			layerCount,
 		},
 	};
 
-	vkCmdPipelineBarrier(
-		transferCommandBuffer,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		VK_PIPELINE_STAGE_TRANSFER_BIT,
-		0,
-		0,
-		NULL,
-		0,
-		NULL,
-		1,
-		&imageMemoryBarrier);
+	for (uint32_t i = baseMip; i < baseMip + mipCount; i++)
+	{
+		VkImageState* mipStates = states + (size_t)i * imageLayerCount;
+		uint32_t layer = baseLayer;
 
-	void* mapData;
+		while (layer < endLayer)
+		{
+			VkImageState state = mipStates[layer];
+			uint32_t runCount = 1;
 
-	MpgxResult mpgxResult = mapVkBuffer(
-		allocator,
-		stagingAllocation,
-		CPU_ONLY_BUFFER_USAGE,
-		bufferSize,
-		0,
-		&mapData);
+			// Neighbour layers with the same state share one barrier
+			while (layer + runCount < endLayer &&
+				mipStates[layer + runCount].layout == state.layout &&
+				mipStates[layer + runCount].stageMask == state.stageMask &&
+				mipStates[layer + runCount].accessMask == state.accessMask)
+			{
+				runCount++;
+			}
 
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-	{
-		vkEndCommandBuffer(transferCommandBuffer);
+			VkImageState newState = {
+				layout,
+				stageMask,
+				accessMask,
+			};
+
+			bool isSkipped = false;
+
+			if (state.layout == layout)
+			{
+				if (state.stageMask == VK_PIPELINE_STAGE_2_NONE_KHR)
+				{
+					// Previous accesses were waited by the host
+					isSkipped = true;
+				}
+				else if (!isWrite && !(state.accessMask & VK_ACCESS_WRITE_MASK) &&
+					(state.stageMask & stageMask) == stageMask &&
+					(state.accessMask & accessMask) == accessMask)
+				{
+					// Already visible reads do not need another barrier
+					isSkipped = true;
+					newState = state;
+				}
+			}
+
+			// Same transition is already recorded into this batch
+			if (!isSkipped &&
+				state.layout == layout &&
+				state.stageMask == stageMask &&
+				state.accessMask == accessMask &&
+				isVkImageBarrierPending(
+					barrierBatch,
+					image->vk.handle,
+					i,
+					layer,
+					runCount))
+			{
+				isSkipped = true;
+			}
+
+			if (!isSkipped)
+			{
+				imageBarrier.srcStageMask = state.stageMask;
+				imageBarrier.srcAccessMask = state.accessMask & VK_ACCESS_WRITE_MASK;
+				imageBarrier.oldLayout = discardData ?
+					VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+				imageBarrier.subresourceRange.baseMipLevel = i;
+				imageBarrier.subresourceRange.baseArrayLayer = layer;
+				imageBarrier.subresourceRange.layerCount = runCount;
+
+				size_t barrierCount = barrierBatch->imageBarrierCount;
+
+				VkImageMemoryBarrier2KHR* lastBarrier = barrierCount > 0 ?
+					&barrierBatch->imageBarriers[barrierCount - 1] : NULL;
+
+				// Same transition of the next mip level extends the last barrier
+				if (lastBarrier &&
+					lastBarrier->image == imageBarrier.image &&
+					lastBarrier->srcStageMask == imageBarrier.srcStageMask &&
+					lastBarrier->srcAccessMask == imageBarrier.srcAccessMask &&
+					lastBarrier->dstStageMask == imageBarrier.dstStageMask &&
+					lastBarrier->dstAccessMask == imageBarrier.dstAccessMask &&
+					lastBarrier->oldLayout == imageBarrier.oldLayout &&
+					lastBarrier->newLayout == imageBarrier.newLayout &&
+					lastBarrier->subresourceRange.baseArrayLayer == layer &&
+					lastBarrier->subresourceRange.layerCount == runCount &&
+					lastBarrier->subresourceRange.baseMipLevel +
+					lastBarrier->subresourceRange.levelCount == i)
+				{
+					lastBarrier->subresourceRange.levelCount++;
+				}
+				else
+				{
+					mpgxResult = addVkImageBarrier(
+						barrierBatch,
+						&imageBarrier);
+					assert(mpgxResult == SUCCESS_MPGX_RESULT);
+				}
+			}
+
+			for (uint32_t j = 0; j < runCount; j++)
+				mipStates[layer + j] = newState;
+
+			layer += runCount;
+		}
+	}
+
+	memoryImage->vk.aliasStageMask |= stageMask;
+	memoryImage->vk.aliasAccessMask |= accessMask;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static void setVkImageState(
+	Image image,
+	VkImageLayout layout,
+	VkPipelineStageFlags2KHR stageMask,
+	VkAccessFlags2KHR accessMask)
+{
+	assert(image);
+
+	VkImageState state = {
+		layout,
+		stageMask,
+		accessMask,
+	};
+
+	VkImageState* states = image->vk.states;
+	size_t stateCount = (size_t)image->vk.mipCount * image->vk.layerCount;
+
+	for (size_t i = 0; i < stateCount; i++)
+		states[i] = state;
+
+	Image memoryImage = image->vk.aliasBase ?
+		image->vk.aliasBase : image;
+
+	memoryImage->vk.activeAlias = image;
+	memoryImage->vk.aliasStageMask |= stageMask;
+	memoryImage->vk.aliasAccessMask |= accessMask;
+}
+inline static MpgxResult generateVkImageMipmap(
+	VkCommandBuffer commandBuffer,
+	VkBarrierBatch barrierBatch,
+	Image image,
+	VkFilter filter)
+{
+	assert(commandBuffer);
+	assert(barrierBatch);
+	assert(image);
+
+	VkImage handle = image->vk.handle;
+	VkImageAspectFlags vkAspect = image->vk.vkAspect;
+	uint32_t mipCount = image->vk.mipCount;
+	uint32_t layerCount = image->vk.layerCount;
+	Vec3I mipSize = image->vk.size;
+
+	for (uint32_t i = 1; i < mipCount; i++)
+	{
+		// Both transitions are reserved up front, so the second
+		// one can not fail after the first one changed the states.
+		MpgxResult mpgxResult = reserveVkImageBarriers(
+			barrierBatch,
+			(size_t)layerCount * 2);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		// Previous level is read, next one is fully overwritten
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			image,
+			i - 1,
+			1,
+			0,
+			layerCount,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+			VK_ACCESS_2_TRANSFER_READ_BIT_KHR,
+			false);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			image,
+			i,
+			1,
+			0,
+			layerCount,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+			VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+			true);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		flushVkBarrierBatch(
+			commandBuffer,
+			barrierBatch);
+
+		Vec3I nextSize = mipSize;
+		if (nextSize.x > 1) nextSize.x /= 2;
+		if (nextSize.y > 1) nextSize.y /= 2;
+		if (nextSize.z > 1) nextSize.z /= 2;
+
+		VkImageBlit imageBlit = {
+			{
+				vkAspect,
+				i - 1,
+				0,
+				layerCount,
+			},
+			{
+				{ 0, 0, 0, },
+				{ mipSize.x, mipSize.y, mipSize.z, },
+			},
+			{
+				vkAspect,
+				i,
+				0,
+				layerCount,
+			},
+			{
+				{ 0, 0, 0, },
+				{ nextSize.x, nextSize.y, nextSize.z, },
+			},
+		};
+
+		vkCmdBlitImage(
+			commandBuffer,
+			handle,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			handle,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1,
+			&imageBlit,
+			filter);
+
+		mipSize = nextSize;
+	}
+
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult fillVkImage(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkQueue transferQueue,
+	VkCommandBuffer transferCommandBuffer,
+	VkFence transferFence,
+	VkBarrierBatch barrierBatch,
+	VkBuffer stagingBuffer,
+	VmaAllocation stagingAllocation,
+	const void** data,
+	Vec3I size,
+	uint32_t mipCount,
+	uint32_t layerCount,
+	VkImageAspectFlags vkAspect,
+	VkDeviceSize bufferSize,
+	uint8_t sizeMultiplier,
+	Vec2I blockExtent,
+	bool generateMipmap,
+	VkFilter mipmapFilter,
+	Image image)
+{
+	assert(device);
+	assert(allocator);
+	assert(transferQueue);
+	assert(transferCommandBuffer);
+	assert(transferFence);
+	assert(barrierBatch);
+	assert(stagingBuffer);
+	assert(stagingAllocation);
+	assert(data);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(layerCount > 0);
+	assert(bufferSize > 0);
+	assert(sizeMultiplier > 0);
+	assert(image);
+	assert(mipCount <= calcMipLevelCount(size));
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		NULL,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		NULL,
+	};
+
+	VkResult vkResult = vkBeginCommandBuffer(
+		transferCommandBuffer,
+		&commandBufferBeginInfo);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	// Image is filled from scratch, previous content is discarded.
+	// Generated mipmap levels are transitioned during the generation.
+	MpgxResult mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
+		0,
+		generateMipmap ? 1 : mipCount,
+		0,
+		layerCount,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+		true);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		vkEndCommandBuffer(transferCommandBuffer);
+		return mpgxResult;
+	}
+
+	flushVkBarrierBatch(
+		transferCommandBuffer,
+		barrierBatch);
+
+	VkImage handle = image->vk.handle;
+	void* mapData;
+
+	mpgxResult = mapVkBuffer(
+		allocator,
+		stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		bufferSize,
+		0,
+		&mapData);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		vkEndCommandBuffer(transferCommandBuffer);
 		return mpgxResult;
 	}
 
@@ -202,13 +1374,18 @@ inline static MpgxResult fillVkImage(
 	Vec3I mipSize = size;
 	size_t mipBufferSize = 0;
 
-	for (uint32_t i = 0; i < mipCount; i++)
+	// Generated mipmap data array contains only the base level
+	uint32_t dataMipCount = generateMipmap ? 1 : mipCount;
+
+	for (uint32_t i = 0; i < dataMipCount; i++)
 	{
 		const uint8_t* array = (const uint8_t*)data[i];
 
-		size_t copySize = (size_t)
-			mipSize.x * mipSize.y * mipSize.z *
-			layerCount * sizeMultiplier;
+		size_t copySize = calcImageDataSize(
+			mipSize,
+			blockExtent,
+			sizeMultiplier,
+			layerCount);
 
 		if (array)
 		{
@@ -249,22 +1426,43 @@ inline static MpgxResult fillVkImage(
 		if (mipSize.z > 1) mipSize.z /= 2;
 	}
 
-	imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-	imageMemoryBarrier.dstAccessMask = VK_ACCESS_NONE_KHR;
-	imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-	imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	if (generateMipmap)
+	{
+		mpgxResult = generateVkImageMipmap(
+			transferCommandBuffer,
+			barrierBatch,
+			image,
+			mipmapFilter);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			vkEndCommandBuffer(transferCommandBuffer);
+			return mpgxResult;
+		}
+	}
 
-	vkCmdPipelineBarrier(
-		transferCommandBuffer,
-		VK_PIPELINE_STAGE_TRANSFER_BIT,
-		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+	// Submission is waited by the host, so no stages are waited
+	mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
 		0,
+		mipCount,
 		0,
-		NULL,
-		0,
-		NULL,
-		1,
-		&imageMemoryBarrier);
+		layerCount,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_2_NONE_KHR,
+		VK_ACCESS_2_NONE_KHR,
+		false);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		vkEndCommandBuffer(transferCommandBuffer);
+		return mpgxResult;
+	}
+
+	flushVkBarrierBatch(
+		transferCommandBuffer,
+		barrierBatch);
 
 	mpgxResult = unmapVkBuffer(
 		allocator,
@@ -296,6 +1494,7 @@ inline static MpgxResult createVkImage(
 	VkQueue transferQueue,
 	VkCommandBuffer transferCommandBuffer,
 	VkFence transferFence,
+	VkBarrierBatch barrierBatch,
 	VkBuffer* stagingBuffer,
 	VmaAllocation* stagingAllocation,
 	size_t* stagingSize,
@@ -307,6 +1506,8 @@ inline static MpgxResult createVkImage(
 	Vec3I size,
 	uint32_t mipCount,
 	uint32_t layerCount,
+	bool generateMipmap,
+	VkFilter mipmapFilter,
 	bool isConstant,
 	Image* image)
 {
@@ -315,6 +1516,7 @@ inline static MpgxResult createVkImage(
 	assert(transferQueue);
 	assert(transferCommandBuffer);
 	assert(transferFence);
+	assert(barrierBatch);
 	assert(stagingBuffer);
 	assert(stagingAllocation);
 	assert(stagingSize);
@@ -328,6 +1530,7 @@ inline static MpgxResult createVkImage(
 	assert(mipCount > 0);
 	assert(layerCount > 0);
 	assert(mipCount <= calcMipLevelCount(size));
+	assert(!generateMipmap || data);
 	assert(image);
 
 	Image imageInstance = calloc(1, sizeof(Image_T));
@@ -344,112 +1547,56 @@ inline static MpgxResult createVkImage(
 	imageInstance->vk.mipCount = mipCount;
 	imageInstance->vk.layerCount = layerCount;
 
-	VkImageType vkType;
-	VkImageViewType vkViewType;
+	// All subresources start in the undefined layout
+	VkImageState* states = calloc(
+		(size_t)mipCount * layerCount,
+		sizeof(VkImageState));
 
-	if (dimension == IMAGE_1D)
-	{
-		vkType = VK_IMAGE_TYPE_1D;
-		vkViewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D;
-	}
-	else if (dimension == IMAGE_2D)
-	{
-		vkType = VK_IMAGE_TYPE_2D;
-		vkViewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
-	}
-	else if (dimension == IMAGE_3D)
-	{
-		vkType = VK_IMAGE_TYPE_3D;
-		vkViewType = VK_IMAGE_VIEW_TYPE_3D;
-	}
-	else
+	if (!states)
 	{
 		destroyVkImage(
 			device,
 			allocator,
 			imageInstance);
-		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 	}
 
+	imageInstance->vk.states = states;
+
+	VkImageType vkType;
+	VkImageViewType vkViewType;
 	VkFormat vkFormat;
 	VkImageAspectFlags vkAspect;
 	uint8_t sizeMultiplier;
 
-	VkImageUsageFlagBits vkUsage = 0;
-
-	if (type & SAMPLED_IMAGE_TYPE)
-		vkUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
-	if (type & COLOR_ATTACHMENT_IMAGE_TYPE)
-		vkUsage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-	if (type & DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)
-		vkUsage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-	if (type & STORAGE_IMAGE_TYPE)
-		vkUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
-	if (type & TRANSFER_SOURCE_IMAGE_TYPE)
-		vkUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-	if ((type & TRANSFER_DESTINATION_IMAGE_TYPE) || data)
-		vkUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	bool result = getVkImageType(
+		dimension,
+		layerCount,
+		&vkType,
+		&vkViewType);
+	result &= getVkImageFormat(
+		format,
+		&vkFormat,
+		&vkAspect,
+		&sizeMultiplier);
 
-	switch (format)
+	if (!result)
 	{
-	default:
 		destroyVkImage(
 			device,
 			allocator,
 			imageInstance);
 		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-	case R8_UNORM_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_R8_UNORM;
-		vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
-		sizeMultiplier = 1;
-		break;
-	case R8_SRGB_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_R8_SRGB;
-		vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
-		sizeMultiplier = 1;
-		break;
-	case R8G8B8A8_UNORM_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_R8G8B8A8_UNORM;
-		vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
-		sizeMultiplier = 4;
-		break;
-	case R8G8B8A8_SRGB_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_R8G8B8A8_SRGB;
-		vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
-		sizeMultiplier = 4;
-		break;
-	case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
-		vkAspect = VK_IMAGE_ASPECT_COLOR_BIT;
-		sizeMultiplier = 8;
-		break;
-	case D16_UNORM_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_D16_UNORM;
-		vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-		sizeMultiplier = 2;
-		break;
-	case D32_SFLOAT_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_D32_SFLOAT;
-		vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-		sizeMultiplier = 4;
-		break;
-	case D16_UNORM_S8_UINT_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_D16_UNORM_S8_UINT;
-		vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-		sizeMultiplier = 3; // TODO: correct?
-		break;
-	case D24_UNORM_S8_UINT_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_D24_UNORM_S8_UINT;
-		vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-		sizeMultiplier = 4;
-		break;
-	case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
-		vkFormat = VK_FORMAT_D32_SFLOAT_S8_UINT;
-		vkAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-		sizeMultiplier = 5; // TODO: correct?
-		break;
 	}
 
+	VkImageUsageFlags vkUsage = getVkImageUsage(
+		type,
+		data != NULL);
+
+	// Mip levels are blitted from the previous ones
+	if (generateMipmap)
+		vkUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
 	imageInstance->vk.vkFormat = vkFormat;
 	imageInstance->vk.vkAspect = vkAspect;
 	imageInstance->vk.sizeMultiplier = sizeMultiplier;
@@ -464,7 +1611,8 @@ inline static MpgxResult createVkImage(
 		mipCount,
 		layerCount,
 		VK_SAMPLE_COUNT_1_BIT,
-		isConstant ? VK_IMAGE_TILING_OPTIMAL : VK_IMAGE_TILING_LINEAR,
+		generateMipmap ? VK_IMAGE_TILING_OPTIMAL :
+			getVkImageTiling(format, isConstant),
 		vkUsage,
 		VK_SHARING_MODE_EXCLUSIVE,
 		0,
@@ -477,7 +1625,6 @@ inline static MpgxResult createVkImage(
 
 	allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
 	allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-	// TODO: VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED on mobiles
 
 	if (type & COLOR_ATTACHMENT_IMAGE_TYPE ||
 		type & DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)
@@ -487,14 +1634,39 @@ inline static MpgxResult createVkImage(
 
 	VkImage handle;
 	VmaAllocation allocation;
+	VkResult vkResult;
 
-	VkResult vkResult = vmaCreateImage(
-		allocator,
-		&imageCreateInfo,
-		&allocationCreateInfo,
-		&handle,
-		&allocation,
-		NULL);
+	// Lazily allocated memory is available only on tiled GPUs,
+	// other devices fall back to the regular device memory.
+	if (type & TRANSIENT_ATTACHMENT_IMAGE_TYPE)
+	{
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+
+		vkResult = vmaCreateImage(
+			allocator,
+			&imageCreateInfo,
+			&allocationCreateInfo,
+			&handle,
+			&allocation,
+			NULL);
+
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+	}
+	else
+	{
+		vkResult = VK_ERROR_FEATURE_NOT_PRESENT;
+	}
+
+	if (vkResult != VK_SUCCESS)
+	{
+		vkResult = vmaCreateImage(
+			allocator,
+			&imageCreateInfo,
+			&allocationCreateInfo,
+			&handle,
+			&allocation,
+			NULL);
+	}
 
 	if (vkResult != VK_SUCCESS)
 	{
@@ -549,14 +1721,25 @@ inline static MpgxResult createVkImage(
 
 	imageInstance->vk.imageView = imageView;
 
+	// Transient attachment content never leaves the render pass
+	if (type & TRANSIENT_ATTACHMENT_IMAGE_TYPE)
+	{
+		*image = imageInstance;
+		return SUCCESS_MPGX_RESULT;
+	}
+
+	Vec2I blockExtent = getImageFormatBlockExtent(format);
+	uint32_t dataMipCount = generateMipmap ? 1 : mipCount;
 	VkDeviceSize bufferSize = 0;
 	Vec3I mipSize = size;
 
-	for (uint32_t i = 0; i < mipCount; i++)
+	for (uint32_t i = 0; i < dataMipCount; i++)
 	{
-		bufferSize += (VkDeviceSize)
-			mipSize.x * mipSize.y * mipSize.z *
-			layerCount * sizeMultiplier;
+		bufferSize += (VkDeviceSize)calcImageDataSize(
+			mipSize,
+			blockExtent,
+			sizeMultiplier,
+			layerCount);
 		if (mipSize.x > 1) mipSize.x /= 2;
 		if (mipSize.y > 1) mipSize.y /= 2;
 		if (mipSize.z > 1) mipSize.z /= 2;
@@ -649,6 +1832,7 @@ inline static MpgxResult createVkImage(
 			transferQueue,
 			transferCommandBuffer,
 			transferFence,
+			barrierBatch,
 			stagingBufferInstance,
 			stagingAllocationInstance,
 			data,
@@ -658,7 +1842,10 @@ inline static MpgxResult createVkImage(
 			vkAspect,
 			bufferSize,
 			sizeMultiplier,
-			handle);
+			blockExtent,
+			generateMipmap,
+			mipmapFilter,
+			imageInstance);
 
 		if (mpgxResult != SUCCESS_MPGX_RESULT)
 		{
@@ -673,7 +1860,213 @@ inline static MpgxResult createVkImage(
 	*image = imageInstance;
 	return SUCCESS_MPGX_RESULT;
 }
-
+inline static MpgxResult createVkAliasImage(
+	VkDevice device,
+	VmaAllocator allocator,
+	Image baseImage,
+	ImageType type,
+	ImageFormat format,
+	Vec3I size,
+	Image* image)
+{
+	assert(device);
+	assert(allocator);
+	assert(baseImage);
+	assert(baseImage->vk.allocation);
+	assert(type > 0);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(image);
+
+	Image imageInstance = calloc(1, sizeof(Image_T));
+
+	if (!imageInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	ImageDimension dimension = baseImage->vk.dimension;
+
+	imageInstance->vk.window = baseImage->vk.window;
+	imageInstance->vk.size = size;
+	imageInstance->vk.type = type;
+	imageInstance->vk.dimension = dimension;
+	imageInstance->vk.format = format;
+	imageInstance->vk.isConstant = true;
+	imageInstance->vk.mipCount = 1;
+	imageInstance->vk.layerCount = 1;
+
+	// All subresources start in the undefined layout
+	VkImageState* states = calloc(
+		1,
+		sizeof(VkImageState));
+
+	if (!states)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	imageInstance->vk.states = states;
+
+	VkImageType vkType;
+	VkImageViewType vkViewType;
+	VkFormat vkFormat;
+	VkImageAspectFlags vkAspect;
+	uint8_t sizeMultiplier;
+
+	bool result = getVkImageType(
+		dimension,
+		1,
+		&vkType,
+		&vkViewType);
+	result &= getVkImageFormat(
+		format,
+		&vkFormat,
+		&vkAspect,
+		&sizeMultiplier);
+
+	if (!result)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+	}
+
+	imageInstance->vk.vkFormat = vkFormat;
+	imageInstance->vk.vkAspect = vkAspect;
+	imageInstance->vk.sizeMultiplier = sizeMultiplier;
+
+	VkImageCreateInfo imageCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		NULL,
+		0,
+		vkType,
+		vkFormat,
+		{ size.x, size.y, size.z, },
+		1,
+		1,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_IMAGE_TILING_OPTIMAL,
+		getVkImageUsage(type, false),
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		NULL,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+
+	VkImage handle;
+
+	VkResult vkResult = vkCreateImage(
+		device,
+		&imageCreateInfo,
+		NULL,
+		&handle);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return vkToMpgxResult(vkResult);
+	}
+
+	// Alias image does not own the memory,
+	// so allocation stays NULL and only image is destroyed.
+	imageInstance->vk.handle = handle;
+
+	VkMemoryRequirements memoryRequirements;
+
+	vkGetImageMemoryRequirements(
+		device,
+		handle,
+		&memoryRequirements);
+
+	VmaAllocation allocation = baseImage->vk.allocation;
+	VmaAllocationInfo allocationInfo;
+
+	vmaGetAllocationInfo(
+		allocator,
+		allocation,
+		&allocationInfo);
+
+	// Alias is bound at the start of the base image allocation
+	if (allocationInfo.offset % memoryRequirements.alignment != 0 ||
+		memoryRequirements.size > allocationInfo.size ||
+		!(memoryRequirements.memoryTypeBits & (1u << allocationInfo.memoryType)))
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return BAD_VALUE_MPGX_RESULT;
+	}
+
+	vkResult = vmaBindImageMemory(
+		allocator,
+		allocation,
+		handle);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return vkToMpgxResult(vkResult);
+	}
+
+	VkImageViewCreateInfo imageViewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		NULL,
+		0,
+		handle,
+		vkViewType,
+		vkFormat,
+		{
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+		},
+		{
+			vkAspect,
+			0,
+			1,
+			0,
+			1,
+		},
+	};
+
+	VkImageView imageView;
+
+	vkResult = vkCreateImageView(
+		device,
+		&imageViewCreateInfo,
+		NULL,
+		&imageView);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return vkToMpgxResult(vkResult);
+	}
+
+	imageInstance->vk.imageView = imageView;
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
 // TODO: add separated array layer setter
 inline static MpgxResult setVkImageData(
 	VkDevice device,
@@ -681,17 +2074,21 @@ inline static MpgxResult setVkImageData(
 	VkQueue transferQueue,
 	VkCommandBuffer transferCommandBuffer,
 	VkFence transferFence,
+	VkBarrierBatch barrierBatch,
 	Image image,
 	const void* data,
 	Vec3I size,
 	Vec3I offset,
-	uint8_t mipLevel)
+	uint8_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount)
 {
 	assert(device);
 	assert(allocator);
 	assert(transferQueue);
 	assert(transferCommandBuffer);
 	assert(transferFence);
+	assert(barrierBatch);
 	assert(image);
 	assert(data);
 	assert(size.x > 0);
@@ -701,12 +2098,18 @@ inline static MpgxResult setVkImageData(
 	assert(offset.y >= 0);
 	assert(offset.z >= 0);
 	assert(mipLevel < image->vk.mipCount);
+	assert(layerCount > 0);
+	assert(baseLayer + layerCount <= image->vk.layerCount);
 
-	// TODO: properly add staging buffer image data offset
-	assert(offset.x == 0 && offset.y == 0 && offset.z == 0);
+	Vec2I blockExtent = getImageFormatBlockExtent(image->vk.format);
 
-	size_t dataSize = (size_t)size.x * size.y * size.z *
-		image->vk.layerCount * image->vk.sizeMultiplier;
+	// Staging buffer is large enough for the whole base level,
+	// region data is tightly packed from its beginning.
+	size_t dataSize = calcImageDataSize(
+		size,
+		blockExtent,
+		image->vk.sizeMultiplier,
+		layerCount);
 
 	MpgxResult mpgxResult = setVkBufferData(
 		allocator,
@@ -732,41 +2135,31 @@ inline static MpgxResult setVkImageData(
 	if (vkResult != VK_SUCCESS)
 		return vkToMpgxResult(vkResult);
 
-	VkImage handle = image->vk.handle;
-	VkImageAspectFlagBits aspect = image->vk.vkAspect;
-	uint32_t mipCount = image->vk.mipCount;
-	uint32_t layerCount = image->vk.layerCount;
-
-	VkImageMemoryBarrier imageMemoryBarrier = {
-		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-		NULL,
-		VK_ACCESS_NONE_KHR,
-		VK_ACCESS_TRANSFER_WRITE_BIT,
-		VK_IMAGE_LAYOUT_UNDEFINED,
+	// Only the updated subresources are transitioned, keeping the rest
+	mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
+		mipLevel,
+		1,
+		baseLayer,
+		layerCount,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		VK_QUEUE_FAMILY_IGNORED,
-		VK_QUEUE_FAMILY_IGNORED,
-		handle,
-		{
-			aspect,
-			mipLevel, // TODO: correct?
-			1,
-			0,
-			layerCount,
-		},
-	};
+		VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+		false);
 
-	vkCmdPipelineBarrier(
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		vkEndCommandBuffer(transferCommandBuffer);
+		return mpgxResult;
+	}
+
+	flushVkBarrierBatch(
 		transferCommandBuffer,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		VK_PIPELINE_STAGE_TRANSFER_BIT,
-		0,
-		0,
-		NULL,
-		0,
-		NULL,
-		1,
-		&imageMemoryBarrier);
+		barrierBatch);
+
+	VkImage handle = image->vk.handle;
+	VkImageAspectFlagBits aspect = image->vk.vkAspect;
 
 	VkBufferImageCopy bufferImageCopy = {
 		0,
@@ -775,7 +2168,7 @@ inline static MpgxResult setVkImageData(
 		{
 			aspect,
 			mipLevel,
-			0,
+			baseLayer,
 			layerCount,
 		},
 		{
@@ -796,22 +2189,29 @@ inline static MpgxResult setVkImageData(
 		1,
 		&bufferImageCopy);
 
-	imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-	imageMemoryBarrier.dstAccessMask = VK_ACCESS_NONE;
-	imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-	imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-	vkCmdPipelineBarrier(
-		transferCommandBuffer,
-		VK_PIPELINE_STAGE_TRANSFER_BIT,
-		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-		0,
+	// Whole image is transitioned back, so subresources which
+	// were never written also end up in the sampled layout.
+	mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
 		0,
-		NULL,
+		image->vk.mipCount,
 		0,
-		NULL,
-		1,
-		&imageMemoryBarrier);
+		image->vk.layerCount,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_2_NONE_KHR,
+		VK_ACCESS_2_NONE_KHR,
+		false);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		vkEndCommandBuffer(transferCommandBuffer);
+		return mpgxResult;
+	}
+
+	flushVkBarrierBatch(
+		transferCommandBuffer,
+		barrierBatch);
 
 	mpgxResult = endSubmitWaitVkCommandBuffer(
 		device,
@@ -822,40 +2222,2451 @@ inline static MpgxResult setVkImageData(
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
 		return mpgxResult;
 
-	return SUCCESS_MPGX_RESULT;
-}
-#endif
+	return SUCCESS_MPGX_RESULT;
+}
+inline static bool isVkImageDataInfoDuplicate(
+	const ImageDataInfo* infos,
+	size_t index)
+{
+	assert(infos);
+
+	Image image = infos[index].image;
+
+	for (size_t i = 0; i < index; i++)
+	{
+		if (infos[i].image == image)
+			return true;
+	}
+
+	return false;
+}
+inline static MpgxResult setVkImagesData(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkQueue transferQueue,
+	VkCommandBuffer transferCommandBuffer,
+	VkFence transferFence,
+	VkBarrierBatch barrierBatch,
+	VkBuffer* stagingBuffer,
+	VmaAllocation* stagingAllocation,
+	size_t* stagingSize,
+	const ImageDataInfo* infos,
+	size_t infoCount)
+{
+	assert(device);
+	assert(allocator);
+	assert(transferQueue);
+	assert(transferCommandBuffer);
+	assert(transferFence);
+	assert(barrierBatch);
+	assert(stagingBuffer);
+	assert(stagingAllocation);
+	assert(stagingSize);
+	assert(infos);
+	assert(infoCount > 0);
+
+	size_t* stagingOffsets = malloc(
+		infoCount * sizeof(size_t));
+
+	if (!stagingOffsets)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	size_t stagingDataSize = 0;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		const ImageDataInfo* info = &infos[i];
+		Image image = info->image;
+
+		assert(image);
+		assert(info->data);
+		assert(info->mipLevel < image->vk.mipCount);
+		assert(info->layerCount > 0);
+		assert(info->baseLayer + info->layerCount <= image->vk.layerCount);
+		assert(image->vk.window == infos[0].image->vk.window);
+
+#ifndef NDEBUG
+		// Copies of one submission are not ordered between each other
+		for (size_t j = 0; j < i; j++)
+		{
+			const ImageDataInfo* other = &infos[j];
+
+			assert(other->image != image ||
+				other->mipLevel != info->mipLevel ||
+				other->baseLayer >= info->baseLayer + info->layerCount ||
+				info->baseLayer >= other->baseLayer + other->layerCount ||
+				other->offset.x >= info->offset.x + info->size.x ||
+				info->offset.x >= other->offset.x + other->size.x ||
+				other->offset.y >= info->offset.y + info->size.y ||
+				info->offset.y >= other->offset.y + other->size.y ||
+				other->offset.z >= info->offset.z + info->size.z ||
+				info->offset.z >= other->offset.z + other->size.z);
+		}
+#endif
+
+		// Buffer offset should be aligned to the
+		// texel block size and to the 4 bytes.
+		stagingDataSize = alignVkMemory(stagingDataSize, 16);
+		stagingOffsets[i] = stagingDataSize;
+
+		stagingDataSize += calcImageDataSize(
+			info->size,
+			getImageFormatBlockExtent(image->vk.format),
+			image->vk.sizeMultiplier,
+			info->layerCount);
+	}
+
+	MpgxResult mpgxResult = reserveVkStagingBuffer(
+		allocator,
+		stagingDataSize,
+		stagingBuffer,
+		stagingAllocation,
+		stagingSize);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	void* mapData;
+
+	mpgxResult = mapVkBuffer(
+		allocator,
+		*stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		stagingDataSize,
+		0,
+		&mapData);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	uint8_t* map = (uint8_t*)mapData;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		const ImageDataInfo* info = &infos[i];
+		Image image = info->image;
+
+		size_t dataSize = calcImageDataSize(
+			info->size,
+			getImageFormatBlockExtent(image->vk.format),
+			image->vk.sizeMultiplier,
+			info->layerCount);
+		memcpy(map + stagingOffsets[i], info->data, dataSize);
+	}
+
+	mpgxResult = unmapVkBuffer(
+		allocator,
+		*stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		stagingDataSize,
+		0);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	size_t maxBarrierCount = 0;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		Image image = infos[i].image;
+
+		if (isVkImageDataInfoDuplicate(infos, i))
+			continue;
+
+		maxBarrierCount += (size_t)image->vk.mipCount *
+			image->vk.layerCount;
+	}
+
+	// Barriers of all images are reserved up front, so a failed
+	// transition does not leave the other image states changed.
+	mpgxResult = reserveVkImageBarriers(
+		barrierBatch,
+		maxBarrierCount);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stagingOffsets);
+		return mpgxResult;
+	}
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		NULL,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		NULL,
+	};
+
+	VkResult vkResult = vkBeginCommandBuffer(
+		transferCommandBuffer,
+		&commandBufferBeginInfo);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		free(stagingOffsets);
+		return vkToMpgxResult(vkResult);
+	}
+
+	// Barriers of all written subresources are recorded at once,
+	// one barrier range for each image written by several entries.
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		Image image = infos[i].image;
+
+		if (isVkImageDataInfoDuplicate(infos, i))
+			continue;
+
+		uint32_t baseMip = infos[i].mipLevel;
+		uint32_t endMip = baseMip + 1;
+		uint32_t baseLayer = infos[i].baseLayer;
+		uint32_t endLayer = baseLayer + infos[i].layerCount;
+
+		for (size_t j = i + 1; j < infoCount; j++)
+		{
+			const ImageDataInfo* info = &infos[j];
+
+			if (info->image != image)
+				continue;
+
+			if (info->mipLevel < baseMip)
+				baseMip = info->mipLevel;
+			if (info->mipLevel + 1u > endMip)
+				endMip = info->mipLevel + 1u;
+			if (info->baseLayer < baseLayer)
+				baseLayer = info->baseLayer;
+			if (info->baseLayer + info->layerCount > endLayer)
+				endLayer = info->baseLayer + info->layerCount;
+		}
+
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			image,
+			baseMip,
+			endMip - baseMip,
+			baseLayer,
+			endLayer - baseLayer,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+			VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+			false);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			vkEndCommandBuffer(transferCommandBuffer);
+			free(stagingOffsets);
+			return mpgxResult;
+		}
+	}
+
+	flushVkBarrierBatch(
+		transferCommandBuffer,
+		barrierBatch);
+
+	VkBuffer stagingBufferInstance = *stagingBuffer;
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		const ImageDataInfo* info = &infos[i];
+		Image image = info->image;
+
+		VkBufferImageCopy bufferImageCopy = {
+			stagingOffsets[i],
+			0,
+			0,
+			{
+				image->vk.vkAspect,
+				info->mipLevel,
+				info->baseLayer,
+				info->layerCount,
+			},
+			{
+				(int32_t)info->offset.x,
+				(int32_t)info->offset.y,
+				(int32_t)info->offset.z,
+			},
+			{
+				info->size.x,
+				info->size.y,
+				info->size.z,
+			}
+		};
+
+		vkCmdCopyBufferToImage(
+			transferCommandBuffer,
+			stagingBufferInstance,
+			image->vk.handle,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1,
+			&bufferImageCopy);
+	}
+
+	free(stagingOffsets);
+
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		Image image = infos[i].image;
+
+		if (isVkImageDataInfoDuplicate(infos, i))
+			continue;
+
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			image,
+			0,
+			image->vk.mipCount,
+			0,
+			image->vk.layerCount,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_2_NONE_KHR,
+			VK_ACCESS_2_NONE_KHR,
+			false);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			vkEndCommandBuffer(transferCommandBuffer);
+			return mpgxResult;
+		}
+	}
+
+	flushVkBarrierBatch(
+		transferCommandBuffer,
+		barrierBatch);
+
+	mpgxResult = endSubmitWaitVkCommandBuffer(
+		device,
+		transferQueue,
+		transferFence,
+		transferCommandBuffer);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static size_t calcVkImageStreamDataSize(
+	Image image,
+	uint8_t baseMip,
+	uint8_t endMip)
+{
+	assert(image);
+	assert(baseMip < endMip);
+	assert(endMip <= image->vk.mipCount);
+
+	Vec2I blockExtent = getImageFormatBlockExtent(image->vk.format);
+	size_t dataSize = 0;
+
+	for (uint8_t i = baseMip; i < endMip; i++)
+	{
+		// Buffer offset should be aligned to the
+		// texel block size and to the 4 bytes.
+		dataSize = alignVkMemory(dataSize, 16);
+
+		dataSize += calcImageDataSize(
+			getImageMipSize(image->vk.size, i),
+			blockExtent,
+			image->vk.sizeMultiplier,
+			image->vk.layerCount);
+	}
+
+	return dataSize;
+}
+inline static MpgxResult recordVkImageStreamUpload(
+	VkCommandBuffer commandBuffer,
+	VkBarrierBatch barrierBatch,
+	VkBuffer stagingBuffer,
+	uint8_t* stagingMap,
+	VkDeviceSize stagingOffset,
+	Image image,
+	uint8_t baseMip,
+	uint8_t endMip)
+{
+	assert(commandBuffer);
+	assert(barrierBatch);
+	assert(stagingBuffer);
+	assert(stagingMap);
+	assert(image);
+	assert(image->vk.stream);
+	assert(baseMip < endMip);
+	assert(endMip <= image->vk.mipCount);
+
+	ImageStream stream = image->vk.stream;
+	VkImage handle = image->vk.handle;
+	VkImageAspectFlags vkAspect = image->vk.vkAspect;
+	uint32_t layerCount = image->vk.layerCount;
+	Vec2I blockExtent = getImageFormatBlockExtent(image->vk.format);
+	bool isUpscaled = baseMip > 0 && stream->isFilled;
+
+	// Uploaded levels and the not resident finer levels
+	// are overwritten, coarser levels are left untouched.
+	uint8_t writeMip = isUpscaled ? 0 : baseMip;
+
+	MpgxResult mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
+		writeMip,
+		endMip - writeMip,
+		0,
+		layerCount,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+		true);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	flushVkBarrierBatch(
+		commandBuffer,
+		barrierBatch);
+
+	VkDeviceSize bufferOffset = stagingOffset;
+
+	for (uint8_t i = baseMip; i < endMip; i++)
+	{
+		Vec3I mipSize = getImageMipSize(image->vk.size, i);
+
+		size_t dataSize = calcImageDataSize(
+			mipSize,
+			blockExtent,
+			image->vk.sizeMultiplier,
+			layerCount);
+
+		bufferOffset = alignVkMemory(bufferOffset, 16);
+		memcpy(stagingMap + bufferOffset, stream->data[i], dataSize);
+
+		VkBufferImageCopy bufferImageCopy = {
+			bufferOffset,
+			0,
+			0,
+			{
+				vkAspect,
+				i,
+				0,
+				layerCount,
+			},
+			{
+				0, 0, 0,
+			},
+			{
+				mipSize.x,
+				mipSize.y,
+				mipSize.z
+			}
+		};
+
+		vkCmdCopyBufferToImage(
+			commandBuffer,
+			stagingBuffer,
+			handle,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1,
+			&bufferImageCopy);
+
+		bufferOffset += dataSize;
+	}
+
+	if (isUpscaled)
+	{
+		mpgxResult = transitVkImage(
+			barrierBatch,
+			image,
+			baseMip,
+			1,
+			0,
+			layerCount,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+			VK_ACCESS_2_TRANSFER_READ_BIT_KHR,
+			false);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		flushVkBarrierBatch(
+			commandBuffer,
+			barrierBatch);
+
+		Vec3I baseSize = getImageMipSize(image->vk.size, baseMip);
+
+		// Not resident levels are upscaled from the finest
+		// resident one, so sampling them never reads garbage.
+		for (uint8_t i = 0; i < baseMip; i++)
+		{
+			Vec3I mipSize = getImageMipSize(image->vk.size, i);
+
+			VkImageBlit imageBlit = {
+				{
+					vkAspect,
+					baseMip,
+					0,
+					layerCount,
+				},
+				{
+					{ 0, 0, 0, },
+					{ baseSize.x, baseSize.y, baseSize.z, },
+				},
+				{
+					vkAspect,
+					i,
+					0,
+					layerCount,
+				},
+				{
+					{ 0, 0, 0, },
+					{ mipSize.x, mipSize.y, mipSize.z, },
+				},
+			};
+
+			vkCmdBlitImage(
+				commandBuffer,
+				handle,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				handle,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1,
+				&imageBlit,
+				stream->isFilterLinear ?
+					VK_FILTER_LINEAR : VK_FILTER_NEAREST);
+		}
+	}
+
+	// Whole chain is returned to the sampled layout, including
+	// the levels which were never written before.
+	mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
+		0,
+		image->vk.mipCount,
+		0,
+		layerCount,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR,
+		VK_ACCESS_2_SHADER_READ_BIT_KHR,
+		false);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	flushVkBarrierBatch(
+		commandBuffer,
+		barrierBatch);
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkStreamingImage(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkQueue graphicsQueue,
+	VkCommandBuffer graphicsCommandBuffer,
+	VkFence transferFence,
+	VkBarrierBatch barrierBatch,
+	VkBuffer* stagingBuffer,
+	VmaAllocation* stagingAllocation,
+	size_t* stagingSize,
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint8_t mipCount,
+	uint8_t residentMipCount,
+	bool isFilled,
+	VkFilter fillFilter,
+	Image* image)
+{
+	assert(device);
+	assert(allocator);
+	assert(graphicsQueue);
+	assert(graphicsCommandBuffer);
+	assert(transferFence);
+	assert(barrierBatch);
+	assert(stagingBuffer);
+	assert(stagingAllocation);
+	assert(stagingSize);
+	assert(window);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(data);
+	assert(mipCount > 0);
+	assert(residentMipCount > 0);
+	assert(residentMipCount <= mipCount);
+	assert(image);
+
+	Image imageInstance;
+
+	// Image memory is allocated for the whole mip chain,
+	// levels are only uploaded when they become resident.
+	MpgxResult mpgxResult = createVkImage(
+		device,
+		allocator,
+		graphicsQueue,
+		graphicsCommandBuffer,
+		transferFence,
+		barrierBatch,
+		stagingBuffer,
+		stagingAllocation,
+		stagingSize,
+		window,
+		SAMPLED_IMAGE_TYPE |
+		TRANSFER_SOURCE_IMAGE_TYPE |
+		TRANSFER_DESTINATION_IMAGE_TYPE,
+		dimension,
+		format,
+		NULL,
+		size,
+		mipCount,
+		1,
+		false,
+		fillFilter,
+		true,
+		&imageInstance);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	ImageStream stream = calloc(1,
+		sizeof(ImageStream_T) + mipCount * sizeof(const void*));
+
+	if (!stream)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	imageInstance->vk.stream = stream;
+
+	// Level data array is stored right after the stream
+	stream->data = (const void**)(stream + 1);
+
+	for (uint8_t i = 0; i < mipCount; i++)
+		stream->data[i] = data[i];
+
+	uint8_t residentMip = (uint8_t)(mipCount - residentMipCount);
+
+	stream->priority = 0.0f;
+	stream->residentMip = residentMip;
+	stream->requestedMip = residentMip;
+	stream->uploadMip = residentMip;
+	stream->blockSize = imageInstance->vk.sizeMultiplier;
+	stream->isFilled = isFilled;
+	stream->isFilterLinear = fillFilter == VK_FILTER_LINEAR;
+
+	size_t dataSize = calcVkImageStreamDataSize(
+		imageInstance,
+		residentMip,
+		mipCount);
+
+	mpgxResult = reserveVkStagingBuffer(
+		allocator,
+		dataSize,
+		stagingBuffer,
+		stagingAllocation,
+		stagingSize);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return mpgxResult;
+	}
+
+	void* mapData;
+
+	mpgxResult = mapVkBuffer(
+		allocator,
+		*stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		dataSize,
+		0,
+		&mapData);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return mpgxResult;
+	}
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		NULL,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		NULL,
+	};
+
+	VkResult vkResult = vkBeginCommandBuffer(
+		graphicsCommandBuffer,
+		&commandBufferBeginInfo);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		unmapVkBuffer(
+			allocator,
+			*stagingAllocation,
+			CPU_ONLY_BUFFER_USAGE,
+			dataSize,
+			0);
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return vkToMpgxResult(vkResult);
+	}
+
+	MpgxResult uploadResult = recordVkImageStreamUpload(
+		graphicsCommandBuffer,
+		barrierBatch,
+		*stagingBuffer,
+		(uint8_t*)mapData,
+		0,
+		imageInstance,
+		residentMip,
+		mipCount);
+
+	mpgxResult = unmapVkBuffer(
+		allocator,
+		*stagingAllocation,
+		CPU_ONLY_BUFFER_USAGE,
+		dataSize,
+		0);
+
+	if (uploadResult != SUCCESS_MPGX_RESULT)
+		mpgxResult = uploadResult;
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		vkEndCommandBuffer(graphicsCommandBuffer);
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return mpgxResult;
+	}
+
+	mpgxResult = endSubmitWaitVkCommandBuffer(
+		device,
+		graphicsQueue,
+		transferFence,
+		graphicsCommandBuffer);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return mpgxResult;
+	}
+
+	stream->residentSize = calcImageStreamSize(
+		imageInstance,
+		residentMip,
+		mipCount);
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkSparseImage(
+	VkDevice device,
+	VmaAllocator allocator,
+	VkPhysicalDevice physicalDevice,
+	VkQueue sparseQueue,
+	VkFence transferFence,
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	Vec3I size,
+	uint8_t mipCount,
+	Image* image)
+{
+	assert(device);
+	assert(allocator);
+	assert(physicalDevice);
+	assert(sparseQueue);
+	assert(transferFence);
+	assert(window);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(mipCount <= calcMipLevelCount(size));
+	assert(image);
+
+	VkImageType vkType;
+	VkImageViewType vkViewType;
+	VkFormat vkFormat;
+	VkImageAspectFlags vkAspect;
+	uint8_t sizeMultiplier;
+
+	bool result = getVkImageType(
+		dimension,
+		1,
+		&vkType,
+		&vkViewType);
+	result &= getVkImageFormat(
+		format,
+		&vkFormat,
+		&vkAspect,
+		&sizeMultiplier);
+
+	if (!result)
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+	VkImageUsageFlags vkUsage =
+		VK_IMAGE_USAGE_SAMPLED_BIT |
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+	// Sparse residency support depends on the exact image parameters
+	uint32_t formatPropertyCount = 0;
+
+	vkGetPhysicalDeviceSparseImageFormatProperties(
+		physicalDevice,
+		vkFormat,
+		vkType,
+		VK_SAMPLE_COUNT_1_BIT,
+		vkUsage,
+		VK_IMAGE_TILING_OPTIMAL,
+		&formatPropertyCount,
+		NULL);
+
+	if (formatPropertyCount == 0)
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+	Image imageInstance = calloc(1, sizeof(Image_T));
+
+	if (!imageInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	imageInstance->vk.window = window;
+	imageInstance->vk.size = size;
+	imageInstance->vk.type = SAMPLED_IMAGE_TYPE | TRANSFER_DESTINATION_IMAGE_TYPE;
+	imageInstance->vk.dimension = dimension;
+	imageInstance->vk.format = format;
+	imageInstance->vk.isConstant = false;
+	imageInstance->vk.mipCount = mipCount;
+	imageInstance->vk.layerCount = 1;
+	imageInstance->vk.vkFormat = vkFormat;
+	imageInstance->vk.vkAspect = vkAspect;
+	imageInstance->vk.sizeMultiplier = sizeMultiplier;
+
+	// All subresources start in the undefined layout
+	VkImageState* states = calloc(
+		mipCount,
+		sizeof(VkImageState));
+
+	if (!states)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	imageInstance->vk.states = states;
+
+	VkImageCreateInfo imageCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		NULL,
+		VK_IMAGE_CREATE_SPARSE_BINDING_BIT |
+		VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT,
+		vkType,
+		vkFormat,
+		{ size.x, size.y, size.z, },
+		mipCount,
+		1,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_IMAGE_TILING_OPTIMAL,
+		vkUsage,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		NULL,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+
+	// Sparse image memory is bound later page by page
+	VkImage handle;
+
+	VkResult vkResult = vkCreateImage(
+		device,
+		&imageCreateInfo,
+		NULL,
+		&handle);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return vkToMpgxResult(vkResult);
+	}
+
+	imageInstance->vk.handle = handle;
+
+	VkMemoryRequirements memoryRequirements;
+
+	vkGetImageMemoryRequirements(
+		device,
+		handle,
+		&memoryRequirements);
+
+	uint32_t requirementCount = 0;
+
+	vkGetImageSparseMemoryRequirements(
+		device,
+		handle,
+		&requirementCount,
+		NULL);
+
+	VkSparseImageMemoryRequirements* sparseRequirements = malloc(
+		requirementCount * sizeof(VkSparseImageMemoryRequirements));
+
+	if (!sparseRequirements)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	vkGetImageSparseMemoryRequirements(
+		device,
+		handle,
+		&requirementCount,
+		sparseRequirements);
+
+	VkSparseImageMemoryRequirements sparseRequirement;
+	bool isFound = false;
+
+	for (uint32_t i = 0; i < requirementCount; i++)
+	{
+		if (sparseRequirements[i].formatProperties.aspectMask & vkAspect)
+		{
+			sparseRequirement = sparseRequirements[i];
+			isFound = true;
+			break;
+		}
+	}
+
+	free(sparseRequirements);
+
+	if (!isFound)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+	}
+
+	ImageSparse sparse = calloc(1, sizeof(ImageSparse_T));
+
+	if (!sparse)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	imageInstance->vk.sparse = sparse;
+
+	VkExtent3D imageGranularity =
+		sparseRequirement.formatProperties.imageGranularity;
+	uint8_t tailMip = (uint8_t)min(
+		sparseRequirement.imageMipTailFirstLod, mipCount);
+
+	sparse->pageSize = vec3I(
+		(cmmt_int_t)imageGranularity.width,
+		(cmmt_int_t)imageGranularity.height,
+		(cmmt_int_t)imageGranularity.depth);
+	sparse->tailMip = tailMip;
+	sparse->pageCount = getImagePageIndex(
+		imageInstance,
+		tailMip,
+		vec3I(0, 0, 0));
+
+	if (sparse->pageCount > 0)
+	{
+		VmaAllocation* sparsePages = calloc(
+			sparse->pageCount, sizeof(VmaAllocation));
+
+		if (!sparsePages)
+		{
+			destroyVkImage(
+				device,
+				allocator,
+				imageInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		imageInstance->vk.sparsePages = sparsePages;
+	}
+
+	VkDeviceSize tailSize = sparseRequirement.imageMipTailSize;
+
+	// Mip tail is too small for the pages, so it is always resident
+	if (tailMip < mipCount && tailSize > 0)
+	{
+		VkMemoryRequirements tailRequirements = memoryRequirements;
+		tailRequirements.size = tailSize;
+
+		VmaAllocationCreateInfo allocationCreateInfo;
+		memset(&allocationCreateInfo, 0, sizeof(VmaAllocationCreateInfo));
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+		VmaAllocation tailAllocation;
+		VmaAllocationInfo allocationInfo;
+
+		vkResult = vmaAllocateMemory(
+			allocator,
+			&tailRequirements,
+			&allocationCreateInfo,
+			&tailAllocation,
+			&allocationInfo);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			destroyVkImage(
+				device,
+				allocator,
+				imageInstance);
+			return vkToMpgxResult(vkResult);
+		}
+
+		imageInstance->vk.sparseTailAllocation = tailAllocation;
+
+		VkSparseMemoryBind sparseMemoryBind = {
+			sparseRequirement.imageMipTailOffset,
+			tailSize,
+			allocationInfo.deviceMemory,
+			allocationInfo.offset,
+			0,
+		};
+		VkSparseImageOpaqueMemoryBindInfo opaqueMemoryBindInfo = {
+			handle,
+			1,
+			&sparseMemoryBind,
+		};
+		VkBindSparseInfo bindSparseInfo = {
+			VK_STRUCTURE_TYPE_BIND_SPARSE_INFO,
+			NULL,
+			0,
+			NULL,
+			0,
+			NULL,
+			1,
+			&opaqueMemoryBindInfo,
+			0,
+			NULL,
+			0,
+			NULL,
+		};
+
+		MpgxResult mpgxResult = bindSparseWaitVkQueue(
+			device,
+			sparseQueue,
+			transferFence,
+			&bindSparseInfo);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyVkImage(
+				device,
+				allocator,
+				imageInstance);
+			return mpgxResult;
+		}
+	}
+
+	VkImageViewCreateInfo imageViewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		NULL,
+		0,
+		handle,
+		vkViewType,
+		vkFormat,
+		{
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+		},
+		{
+			vkAspect,
+			0,
+			mipCount,
+			0,
+			1,
+		},
+	};
+
+	VkImageView imageView;
+
+	vkResult = vkCreateImageView(
+		device,
+		&imageViewCreateInfo,
+		NULL,
+		&imageView);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkImage(
+			device,
+			allocator,
+			imageInstance);
+		return vkToMpgxResult(vkResult);
+	}
+
+	imageInstance->vk.imageView = imageView;
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static VkSparseImageMemoryBind getVkImagePageBind(
+	Image image,
+	const ImagePage* page,
+	VkDeviceMemory memory,
+	VkDeviceSize memoryOffset)
+{
+	assert(image);
+	assert(image->vk.sparse);
+	assert(page);
+
+	Vec3I pageSize = image->vk.sparse->pageSize;
+	Vec3I mipSize = getImageMipSize(image->vk.size, page->mipLevel);
+	Vec3I offset = mulVec3I(page->offset, pageSize);
+
+	// Edge pages are clamped to the mip level extent
+	VkSparseImageMemoryBind sparseImageMemoryBind = {
+		{
+			image->vk.vkAspect,
+			page->mipLevel,
+			0,
+		},
+		{
+			offset.x,
+			offset.y,
+			offset.z,
+		},
+		{
+			min(pageSize.x, mipSize.x - offset.x),
+			min(pageSize.y, mipSize.y - offset.y),
+			min(pageSize.z, mipSize.z - offset.z),
+		},
+		memory,
+		memoryOffset,
+		0,
+	};
+
+	return sparseImageMemoryBind;
+}
+inline static void freeVkImagePages(
+	VmaAllocator allocator,
+	Image image,
+	const size_t* pageIndices,
+	uint32_t pageCount)
+{
+	assert(allocator);
+	assert(image);
+	assert(image->vk.sparse);
+	assert(pageIndices);
+
+	VmaAllocation* sparsePages = image->vk.sparsePages;
+
+	for (uint32_t i = 0; i < pageCount; i++)
+	{
+		size_t pageIndex = pageIndices[i];
+		vmaFreeMemory(allocator, sparsePages[pageIndex]);
+		sparsePages[pageIndex] = NULL;
+	}
+}
+inline static MpgxResult allocateVkImagePages(
+	VkDevice device,
+	VmaAllocator allocator,
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount,
+	VkSparseImageMemoryBind** binds,
+	size_t** pageIndices,
+	uint32_t* bindCount)
+{
+	assert(device);
+	assert(allocator);
+	assert(image);
+	assert(image->vk.sparse);
+	assert(pages);
+	assert(pageCount > 0);
+	assert(binds);
+	assert(pageIndices);
+	assert(bindCount);
+
+	VmaAllocation* sparsePages = image->vk.sparsePages;
+
+	VkSparseImageMemoryBind* sparseImageMemoryBinds = malloc(
+		pageCount * sizeof(VkSparseImageMemoryBind));
+
+	if (!sparseImageMemoryBinds)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	size_t* bindPageIndices = malloc(
+		pageCount * sizeof(size_t));
+
+	if (!bindPageIndices)
+	{
+		free(sparseImageMemoryBinds);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	VkMemoryRequirements pageRequirements;
+
+	vkGetImageMemoryRequirements(
+		device,
+		image->vk.handle,
+		&pageRequirements);
+
+	// Sparse block size is reported as the memory alignment
+	pageRequirements.size = pageRequirements.alignment;
+
+	VmaAllocationCreateInfo allocationCreateInfo;
+	memset(&allocationCreateInfo, 0, sizeof(VmaAllocationCreateInfo));
+	allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	uint32_t count = 0;
+
+	for (size_t i = 0; i < pageCount; i++)
+	{
+		const ImagePage* page = &pages[i];
+
+		size_t pageIndex = getImagePageIndex(
+			image,
+			page->mipLevel,
+			page->offset);
+
+		// Already committed pages are skipped
+		if (sparsePages[pageIndex])
+			continue;
+
+		VmaAllocation allocation;
+		VmaAllocationInfo allocationInfo;
+
+		VkResult vkResult = vmaAllocateMemory(
+			allocator,
+			&pageRequirements,
+			&allocationCreateInfo,
+			&allocation,
+			&allocationInfo);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			freeVkImagePages(
+				allocator,
+				image,
+				bindPageIndices,
+				count);
+			free(bindPageIndices);
+			free(sparseImageMemoryBinds);
+			return vkToMpgxResult(vkResult);
+		}
+
+		sparsePages[pageIndex] = allocation;
+
+		sparseImageMemoryBinds[count] = getVkImagePageBind(
+			image,
+			page,
+			allocationInfo.deviceMemory,
+			allocationInfo.offset);
+		bindPageIndices[count++] = pageIndex;
+	}
+
+	*binds = sparseImageMemoryBinds;
+	*pageIndices = bindPageIndices;
+	*bindCount = count;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult retireVkImagePages(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount,
+	VkRetiredImagePages* retiredPages)
+{
+	assert(image);
+	assert(image->vk.sparse);
+	assert(pages);
+	assert(pageCount > 0);
+	assert(retiredPages);
+
+	VmaAllocation* sparsePages = image->vk.sparsePages;
+
+	VkSparseImageMemoryBind* sparseImageMemoryBinds = malloc(
+		pageCount * sizeof(VkSparseImageMemoryBind));
+
+	if (!sparseImageMemoryBinds)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	VmaAllocation* allocations = malloc(
+		pageCount * sizeof(VmaAllocation));
+
+	if (!allocations)
+	{
+		free(sparseImageMemoryBinds);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	size_t* pageIndices = malloc(
+		pageCount * sizeof(size_t));
+
+	if (!pageIndices)
+	{
+		free(allocations);
+		free(sparseImageMemoryBinds);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	uint32_t count = 0;
+
+	for (size_t i = 0; i < pageCount; i++)
+	{
+		const ImagePage* page = &pages[i];
+
+		size_t pageIndex = getImagePageIndex(
+			image,
+			page->mipLevel,
+			page->offset);
+
+		// Already decommitted pages are skipped
+		if (!sparsePages[pageIndex])
+			continue;
+
+		allocations[count] = sparsePages[pageIndex];
+		sparsePages[pageIndex] = NULL;
+
+		sparseImageMemoryBinds[count] = getVkImagePageBind(
+			image,
+			page,
+			VK_NULL_HANDLE,
+			0);
+		pageIndices[count++] = pageIndex;
+	}
+
+	image->vk.sparse->committedPageCount -= count;
+
+	retiredPages->image = image;
+	retiredPages->binds = sparseImageMemoryBinds;
+	retiredPages->allocations = allocations;
+	retiredPages->pageIndices = pageIndices;
+	retiredPages->pageCount = count;
+	retiredPages->frameIndex = 0;
+	retiredPages->isUnbound = false;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static void destroyVkRetiredImagePages(
+	VmaAllocator allocator,
+	const VkRetiredImagePages* retiredPages)
+{
+	assert(allocator);
+	assert(retiredPages);
+
+	VmaAllocation* allocations = retiredPages->allocations;
+	uint32_t pageCount = retiredPages->pageCount;
+
+	for (uint32_t i = 0; i < pageCount; i++)
+		vmaFreeMemory(allocator, allocations[i]);
+
+	free(retiredPages->pageIndices);
+	free(allocations);
+	free(retiredPages->binds);
+}
+inline static MpgxResult createVkReadbackBuffer(
+	VmaAllocator allocator,
+	size_t size,
+	VkBuffer* buffer,
+	VmaAllocation* allocation)
+{
+	assert(allocator);
+	assert(size > 0);
+	assert(buffer);
+	assert(allocation);
+
+	VkBufferCreateInfo bufferCreateInfo = {
+		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		NULL,
+		0,
+		size,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		NULL,
+	};
+
+	VmaAllocationCreateInfo allocationCreateInfo;
+	memset(&allocationCreateInfo, 0, sizeof(VmaAllocationCreateInfo));
+
+	allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+	allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+
+	VkResult vkResult = vmaCreateBuffer(
+		allocator,
+		&bufferCreateInfo,
+		&allocationCreateInfo,
+		buffer,
+		allocation,
+		NULL);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult recordVkImageReadback(
+	VkCommandBuffer commandBuffer,
+	VkBarrierBatch barrierBatch,
+	VkBuffer buffer,
+	Image image,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount)
+{
+	assert(commandBuffer);
+	assert(barrierBatch);
+	assert(buffer);
+	assert(image);
+	assert(mipLevel < image->vk.mipCount);
+	assert(layerCount > 0);
+	assert(baseLayer + layerCount <= image->vk.layerCount);
+
+	// Tracked state waits for the attachment or transfer writes
+	MpgxResult mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
+		mipLevel,
+		1,
+		baseLayer,
+		layerCount,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+		VK_ACCESS_2_TRANSFER_READ_BIT_KHR,
+		false);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	flushVkBarrierBatch(
+		commandBuffer,
+		barrierBatch);
+
+	VkImageAspectFlags vkAspect = image->vk.vkAspect;
+
+	VkBufferImageCopy bufferImageCopy = {
+		0,
+		0,
+		0,
+		{
+			vkAspect,
+			mipLevel,
+			baseLayer,
+			layerCount,
+		},
+		{
+			(int32_t)offset.x,
+			(int32_t)offset.y,
+			(int32_t)offset.z,
+		},
+		{
+			size.x,
+			size.y,
+			size.z,
+		}
+	};
+
+	vkCmdCopyImageToBuffer(
+		commandBuffer,
+		image->vk.handle,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		buffer,
+		1,
+		&bufferImageCopy);
+
+	// Copied data is read by the host after the frame fence
+	VkBufferMemoryBarrier bufferMemoryBarrier = {
+		VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		NULL,
+		VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_ACCESS_HOST_READ_BIT,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		buffer,
+		0,
+		VK_WHOLE_SIZE,
+	};
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_HOST_BIT,
+		0,
+		0,
+		NULL,
+		1,
+		&bufferMemoryBarrier,
+		0,
+		NULL);
+
+	// Descriptor sets expect sampled images in the shader read layout
+	mpgxResult = transitVkImage(
+		barrierBatch,
+		image,
+		mipLevel,
+		1,
+		baseLayer,
+		layerCount,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR,
+		VK_ACCESS_2_SHADER_READ_BIT_KHR,
+		false);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	flushVkBarrierBatch(
+		commandBuffer,
+		barrierBatch);
+	return SUCCESS_MPGX_RESULT;
+}
+#endif
+
+#if MPGX_SUPPORT_OPENGL
+inline static uint8_t getGlImageFormatBlockSize(ImageFormat format)
+{
+	assert(isImageFormatCompressed(format));
+
+	switch (format)
+	{
+	default:
+		return 16;
+	case BC1_RGB_UNORM_IMAGE_FORMAT:
+	case BC1_RGB_SRGB_IMAGE_FORMAT:
+	case BC1_RGBA_UNORM_IMAGE_FORMAT:
+	case BC1_RGBA_SRGB_IMAGE_FORMAT:
+	case BC4_UNORM_IMAGE_FORMAT:
+	case BC4_SNORM_IMAGE_FORMAT:
+	case ETC2_R8G8B8_UNORM_IMAGE_FORMAT:
+	case ETC2_R8G8B8_SRGB_IMAGE_FORMAT:
+	case ETC2_R8G8B8A1_UNORM_IMAGE_FORMAT:
+	case ETC2_R8G8B8A1_SRGB_IMAGE_FORMAT:
+	case EAC_R11_UNORM_IMAGE_FORMAT:
+	case EAC_R11_SNORM_IMAGE_FORMAT:
+		return 8;
+	}
+}
+inline static void destroyGlImage(
+	Image image)
+{
+	if (!image)
+		return;
+
+	makeGlWindowContextCurrent(
+		image->gl.window);
+
+	glDeleteTextures(
+		GL_ONE,
+		&image->gl.handle);
+	assertOpenGL();
+
+	free(image->gl.sparsePages);
+	free(image->gl.sparse);
+	free(image->gl.stream);
+	free(image);
+}
+inline static bool isGlImageFormatSupported(
+	ImageType type,
+	ImageFormat format)
+{
+	assert(type > 0);
+	assert(format < IMAGE_FORMAT_COUNT);
+
+	if (!(type & SAMPLED_IMAGE_TYPE) &&
+		!(type & COLOR_ATTACHMENT_IMAGE_TYPE) &&
+		!(type & DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE))
+	{
+		return false;
+	}
+
+	// Compressed images can only be sampled
+	if (isImageFormatCompressed(format) &&
+		(type & (COLOR_ATTACHMENT_IMAGE_TYPE |
+		DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)))
+	{
+		return false;
+	}
+
+	switch (format)
+	{
+	default:
+		return true;
+	case R8_SRGB_IMAGE_FORMAT:
+	case D16_UNORM_S8_UINT_IMAGE_FORMAT:
+		return false;
+	case BC1_RGB_UNORM_IMAGE_FORMAT:
+	case BC1_RGBA_UNORM_IMAGE_FORMAT:
+	case BC2_UNORM_IMAGE_FORMAT:
+	case BC3_UNORM_IMAGE_FORMAT:
+		return GLAD_GL_EXT_texture_compression_s3tc;
+	case BC1_RGB_SRGB_IMAGE_FORMAT:
+	case BC1_RGBA_SRGB_IMAGE_FORMAT:
+	case BC2_SRGB_IMAGE_FORMAT:
+	case BC3_SRGB_IMAGE_FORMAT:
+		return GLAD_GL_EXT_texture_compression_s3tc &&
+			GLAD_GL_EXT_texture_sRGB;
+	case BC6H_UFLOAT_IMAGE_FORMAT:
+	case BC6H_SFLOAT_IMAGE_FORMAT:
+	case BC7_UNORM_IMAGE_FORMAT:
+	case BC7_SRGB_IMAGE_FORMAT:
+		return GLAD_GL_ARB_texture_compression_bptc;
+	case ETC2_R8G8B8_UNORM_IMAGE_FORMAT:
+	case ETC2_R8G8B8_SRGB_IMAGE_FORMAT:
+	case ETC2_R8G8B8A1_UNORM_IMAGE_FORMAT:
+	case ETC2_R8G8B8A1_SRGB_IMAGE_FORMAT:
+	case ETC2_R8G8B8A8_UNORM_IMAGE_FORMAT:
+	case ETC2_R8G8B8A8_SRGB_IMAGE_FORMAT:
+	case EAC_R11_UNORM_IMAGE_FORMAT:
+	case EAC_R11_SNORM_IMAGE_FORMAT:
+	case EAC_R11G11_UNORM_IMAGE_FORMAT:
+	case EAC_R11G11_SNORM_IMAGE_FORMAT:
+		return GLAD_GL_ARB_ES3_compatibility;
+	case ASTC_4X4_UNORM_IMAGE_FORMAT:
+	case ASTC_4X4_SRGB_IMAGE_FORMAT:
+	case ASTC_5X4_UNORM_IMAGE_FORMAT:
+	case ASTC_5X4_SRGB_IMAGE_FORMAT:
+	case ASTC_5X5_UNORM_IMAGE_FORMAT:
+	case ASTC_5X5_SRGB_IMAGE_FORMAT:
+	case ASTC_6X5_UNORM_IMAGE_FORMAT:
+	case ASTC_6X5_SRGB_IMAGE_FORMAT:
+	case ASTC_6X6_UNORM_IMAGE_FORMAT:
+	case ASTC_6X6_SRGB_IMAGE_FORMAT:
+	case ASTC_8X5_UNORM_IMAGE_FORMAT:
+	case ASTC_8X5_SRGB_IMAGE_FORMAT:
+	case ASTC_8X6_UNORM_IMAGE_FORMAT:
+	case ASTC_8X6_SRGB_IMAGE_FORMAT:
+	case ASTC_8X8_UNORM_IMAGE_FORMAT:
+	case ASTC_8X8_SRGB_IMAGE_FORMAT:
+	case ASTC_10X5_UNORM_IMAGE_FORMAT:
+	case ASTC_10X5_SRGB_IMAGE_FORMAT:
+	case ASTC_10X6_UNORM_IMAGE_FORMAT:
+	case ASTC_10X6_SRGB_IMAGE_FORMAT:
+	case ASTC_10X8_UNORM_IMAGE_FORMAT:
+	case ASTC_10X8_SRGB_IMAGE_FORMAT:
+	case ASTC_10X10_UNORM_IMAGE_FORMAT:
+	case ASTC_10X10_SRGB_IMAGE_FORMAT:
+	case ASTC_12X10_UNORM_IMAGE_FORMAT:
+	case ASTC_12X10_SRGB_IMAGE_FORMAT:
+	case ASTC_12X12_UNORM_IMAGE_FORMAT:
+	case ASTC_12X12_SRGB_IMAGE_FORMAT:
+		return GLAD_GL_KHR_texture_compression_astc_ldr;
+	}
+}
+
+inline static bool getGlImageFormat(
+	ImageFormat format,
+	GLint* glFormat,
+	GLenum* dataFormat,
+	GLenum* dataType)
+{
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(glFormat);
+	assert(dataFormat);
+	assert(dataType);
+
+	switch (format)
+	{
+	default:
+		return false;
+	case R8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_R8;
+		*dataFormat = GL_RED;
+		*dataType = GL_UNSIGNED_BYTE;
+		return true;
+	case R8G8B8A8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_RGBA8;
+		*dataFormat = GL_RGBA;
+		*dataType = GL_UNSIGNED_BYTE;
+		return true;
+	case R8G8B8A8_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_SRGB8_ALPHA8;
+		*dataFormat = GL_RGBA;
+		*dataType = GL_UNSIGNED_BYTE;
+		return true;
+	case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_RGBA16F;
+		*dataFormat = GL_RGBA;
+		*dataType = GL_FLOAT;
+		return true;
+	case R8G8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_RG8;
+		*dataFormat = GL_RG;
+		*dataType = GL_UNSIGNED_BYTE;
+		return true;
+	case R16_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_R16F;
+		*dataFormat = GL_RED;
+		*dataType = GL_HALF_FLOAT;
+		return true;
+	case R16G16_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_RG16F;
+		*dataFormat = GL_RG;
+		*dataType = GL_HALF_FLOAT;
+		return true;
+	case R32_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_R32F;
+		*dataFormat = GL_RED;
+		*dataType = GL_FLOAT;
+		return true;
+	case R32G32B32A32_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_RGBA32F;
+		*dataFormat = GL_RGBA;
+		*dataType = GL_FLOAT;
+		return true;
+	case B10G11R11_UFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_R11F_G11F_B10F;
+		*dataFormat = GL_RGB;
+		*dataType = GL_UNSIGNED_INT_10F_11F_11F_REV;
+		return true;
+	case A2B10G10R10_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_RGB10_A2;
+		*dataFormat = GL_RGBA;
+		*dataType = GL_UNSIGNED_INT_2_10_10_10_REV;
+		return true;
+	case R8_UINT_IMAGE_FORMAT:
+		*glFormat = GL_R8UI;
+		*dataFormat = GL_RED_INTEGER;
+		*dataType = GL_UNSIGNED_BYTE;
+		return true;
+	case R16_UINT_IMAGE_FORMAT:
+		*glFormat = GL_R16UI;
+		*dataFormat = GL_RED_INTEGER;
+		*dataType = GL_UNSIGNED_SHORT;
+		return true;
+	case R32_UINT_IMAGE_FORMAT:
+		*glFormat = GL_R32UI;
+		*dataFormat = GL_RED_INTEGER;
+		*dataType = GL_UNSIGNED_INT;
+		return true;
+	case R32_SINT_IMAGE_FORMAT:
+		*glFormat = GL_R32I;
+		*dataFormat = GL_RED_INTEGER;
+		*dataType = GL_INT;
+		return true;
+	case R16G16_UINT_IMAGE_FORMAT:
+		*glFormat = GL_RG16UI;
+		*dataFormat = GL_RG_INTEGER;
+		*dataType = GL_UNSIGNED_SHORT;
+		return true;
+	case R8G8B8A8_UINT_IMAGE_FORMAT:
+		*glFormat = GL_RGBA8UI;
+		*dataFormat = GL_RGBA_INTEGER;
+		*dataType = GL_UNSIGNED_BYTE;
+		return true;
+	case R16G16B16A16_UINT_IMAGE_FORMAT:
+		*glFormat = GL_RGBA16UI;
+		*dataFormat = GL_RGBA_INTEGER;
+		*dataType = GL_UNSIGNED_SHORT;
+		return true;
+	case R32G32B32A32_UINT_IMAGE_FORMAT:
+		*glFormat = GL_RGBA32UI;
+		*dataFormat = GL_RGBA_INTEGER;
+		*dataType = GL_UNSIGNED_INT;
+		return true;
+	case D16_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_DEPTH_COMPONENT16;
+		*dataFormat = GL_DEPTH_COMPONENT;
+		*dataType = GL_UNSIGNED_SHORT;
+		return true;
+	case D32_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_DEPTH_COMPONENT32F;
+		*dataFormat = GL_DEPTH_COMPONENT;
+		*dataType = GL_FLOAT;
+		return true;
+	case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+		*glFormat = GL_DEPTH24_STENCIL8;
+		*dataFormat = GL_DEPTH_STENCIL;
+		*dataType = GL_UNSIGNED_INT_24_8;
+		return true;
+	case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+		*glFormat = GL_DEPTH32F_STENCIL8;
+		*dataFormat = GL_DEPTH_STENCIL;
+		*dataType = GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
+		return true;
+	case BC1_RGB_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		return true;
+	case BC1_RGB_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+		return true;
+	case BC1_RGBA_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		return true;
+	case BC1_RGBA_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+		return true;
+	case BC2_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		return true;
+	case BC2_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+		return true;
+	case BC3_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		return true;
+	case BC3_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		return true;
+	case BC4_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RED_RGTC1;
+		return true;
+	case BC4_SNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SIGNED_RED_RGTC1;
+		return true;
+	case BC5_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RG_RGTC2;
+		return true;
+	case BC5_SNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SIGNED_RG_RGTC2;
+		return true;
+	case BC6H_UFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+		return true;
+	case BC6H_SFLOAT_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+		return true;
+	case BC7_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		return true;
+	case BC7_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		return true;
+	case ETC2_R8G8B8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGB8_ETC2;
+		return true;
+	case ETC2_R8G8B8_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ETC2;
+		return true;
+	case ETC2_R8G8B8A1_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+		return true;
+	case ETC2_R8G8B8A1_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+		return true;
+	case ETC2_R8G8B8A8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+		return true;
+	case ETC2_R8G8B8A8_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+		return true;
+	case EAC_R11_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_R11_EAC;
+		return true;
+	case EAC_R11_SNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SIGNED_R11_EAC;
+		return true;
+	case EAC_R11G11_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RG11_EAC;
+		return true;
+	case EAC_R11G11_SNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SIGNED_RG11_EAC;
+		return true;
+	case ASTC_4X4_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+		return true;
+	case ASTC_4X4_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+		return true;
+	case ASTC_5X4_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_5x4_KHR;
+		return true;
+	case ASTC_5X4_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR;
+		return true;
+	case ASTC_5X5_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_5x5_KHR;
+		return true;
+	case ASTC_5X5_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR;
+		return true;
+	case ASTC_6X5_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_6x5_KHR;
+		return true;
+	case ASTC_6X5_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR;
+		return true;
+	case ASTC_6X6_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+		return true;
+	case ASTC_6X6_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR;
+		return true;
+	case ASTC_8X5_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_8x5_KHR;
+		return true;
+	case ASTC_8X5_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR;
+		return true;
+	case ASTC_8X6_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_8x6_KHR;
+		return true;
+	case ASTC_8X6_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR;
+		return true;
+	case ASTC_8X8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+		return true;
+	case ASTC_8X8_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR;
+		return true;
+	case ASTC_10X5_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_10x5_KHR;
+		return true;
+	case ASTC_10X5_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR;
+		return true;
+	case ASTC_10X6_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_10x6_KHR;
+		return true;
+	case ASTC_10X6_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR;
+		return true;
+	case ASTC_10X8_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_10x8_KHR;
+		return true;
+	case ASTC_10X8_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR;
+		return true;
+	case ASTC_10X10_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_10x10_KHR;
+		return true;
+	case ASTC_10X10_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR;
+		return true;
+	case ASTC_12X10_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_12x10_KHR;
+		return true;
+	case ASTC_12X10_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR;
+		return true;
+	case ASTC_12X12_UNORM_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_RGBA_ASTC_12x12_KHR;
+		return true;
+	case ASTC_12X12_SRGB_IMAGE_FORMAT:
+		*glFormat = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR;
+		return true;
+	}
+}
+inline static MpgxResult createGlImage(
+	Window window,
+	ImageType type,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint32_t mipCount,
+	bool generateMipmap,
+	bool isConstant,
+	Image* image)
+{
+	assert(window);
+	assert(type > 0);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(mipCount <= calcMipLevelCount(size));
+	assert(!generateMipmap || data);
+	assert(image);
+
+	if (!isGlImageFormatSupported(type, format))
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+	bool isCompressed = isImageFormatCompressed(format);
+
+	// OpenGL supports compressed formats only for 2D textures
+	if (isCompressed && dimension != IMAGE_2D)
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+	// Mipmaps are generated only for filterable color formats
+	if (generateMipmap && (isCompressed ||
+		isImageFormatDepthStencil(format) ||
+		isImageFormatInteger(format)))
+	{
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+	}
+
+	// TODO: use isAttachment for renderbuffer optimization
+
+	Image imageInstance = calloc(1, sizeof(Image_T));
+
+	if (!imageInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	imageInstance->gl.window = window;
+	imageInstance->gl.size = size;
+	imageInstance->gl.type = type;
+	imageInstance->gl.dimension = dimension;
+	imageInstance->gl.format = format;
+	imageInstance->gl.isConstant = isConstant;
+	imageInstance->gl.mipCount = mipCount;
+	imageInstance->gl.layerCount = 1;
+
+	GLenum glType;
+
+	if (dimension == IMAGE_2D)
+	{
+		glType = GL_TEXTURE_2D;
+	}
+	else if (dimension == IMAGE_3D)
+	{
+		glType = GL_TEXTURE_3D;
+	}
+	else
+	{
+		destroyGlImage(imageInstance);
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+	}
+
+	imageInstance->gl.glType = glType;
+
+	GLint glFormat;
+	GLenum dataFormat;
+	GLenum dataType;
+
+	if (!getGlImageFormat(
+		format,
+		&glFormat,
+		&dataFormat,
+		&dataType))
+	{
+		destroyGlImage(imageInstance);
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+	}
+
+	// Compressed data is uploaded in the internal format
+	if (isCompressed)
+	{
+		dataFormat = (GLenum)glFormat;
+		dataType = GL_ZERO;
+	}
+
+	imageInstance->gl.dataType = dataType;
+	imageInstance->gl.dataFormat = dataFormat;
+
+	makeGlWindowContextCurrent(window);
+
+	GLuint handle = GL_ZERO;
+
+	glGenTextures(
+		GL_ONE,
+		&handle);
+
+	imageInstance->gl.handle = handle;
+
+	glBindTexture(
+		glType,
+		handle);
+
+	// Generated mipmap data array contains only the base level
+	uint32_t dataMipCount = generateMipmap ? 1 : mipCount;
+
+	if (dimension == IMAGE_2D)
+	{
+		Vec2I mipSize = vec2I(size.x, size.y);
+		Vec2I blockExtent = getImageFormatBlockExtent(format);
+		uint8_t blockSize = getGlImageFormatBlockSize(format);
+
+		for (uint32_t i = 0; i < dataMipCount; i++)
+		{
+			if (isCompressed)
+			{
+				size_t dataSize = calcImageDataSize(
+					vec3I(mipSize.x, mipSize.y, 1),
+					blockExtent,
+					blockSize,
+					1);
+
+				glCompressedTexImage2D(
+					glType,
+					(GLint)i,
+					(GLenum)glFormat,
+					(GLsizei)mipSize.x,
+					(GLsizei)mipSize.y,
+					0,
+					(GLsizei)dataSize,
+					data ? data[i] : NULL);
+			}
+			else
+			{
+				glTexImage2D(
+					glType,
+					(GLint)i,
+					glFormat,
+					(GLsizei)mipSize.x,
+					(GLsizei)mipSize.y,
+					0,
+					dataFormat,
+					dataType,
+					data ? data[i] : NULL);
+			}
+
+			mipSize = divValVec2I(
+				mipSize, 2);
+
+			// Mip size is never less than one pixel
+			if (mipSize.x == 0) mipSize.x = 1;
+			if (mipSize.y == 0) mipSize.y = 1;
+		}
+
+		glTexParameteri(
+			GL_TEXTURE_2D,
+			GL_TEXTURE_BASE_LEVEL,
+			0);
+		glTexParameteri(
+			GL_TEXTURE_2D,
+			GL_TEXTURE_MAX_LEVEL,
+			(GLint)(mipCount - 1));
+	}
+	else
+	{
+		Vec3I mipSize = size;
+
+		for (uint32_t i = 0; i < dataMipCount; i++)
+		{
+			glTexImage3D(
+				glType,
+				(GLint)i,
+				glFormat,
+				(GLsizei)mipSize.x,
+				(GLsizei)mipSize.y,
+				(GLsizei)mipSize.z,
+				0,
+				dataFormat,
+				dataType,
+				data ? data[i] : NULL);
+			mipSize = divValVec3I(
+				mipSize, 2);
+		}
+
+		glTexParameteri(
+			GL_TEXTURE_3D,
+			GL_TEXTURE_BASE_LEVEL,
+			0);
+		glTexParameteri(
+			GL_TEXTURE_3D,
+			GL_TEXTURE_MAX_LEVEL,
+			(GLint)(mipCount - 1));
+	}
+
+	if (generateMipmap)
+		glGenerateMipmap(glType);
+
+	GLenum glError = glGetError();
+
+	if (glError != GL_NO_ERROR)
+	{
+		destroyGlImage(imageInstance);
+		return glToMpgxResult(glError);
+	}
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static MpgxResult setGlImageData(
+	Image image,
+	const void* data,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel)
+{
+	assert(image);
+	assert(data);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(offset.x >= 0);
+	assert(offset.y >= 0);
+	assert(offset.z >= 0);
+	assert(mipLevel < image->gl.mipCount);
+
+	makeGlWindowContextCurrent(
+		image->gl.window);
+
+	glBindTexture(
+		image->gl.glType,
+		image->gl.handle);
+
+	ImageDimension dimension = image->gl.dimension;
+
+	if (isImageFormatCompressed(image->gl.format))
+	{
+		assert(dimension == IMAGE_2D);
+
+		ImageFormat format = image->gl.format;
+		Vec2I blockExtent = getImageFormatBlockExtent(format);
+
+		assert(offset.x % blockExtent.x == 0);
+		assert(offset.y % blockExtent.y == 0);
+
+		size_t dataSize = calcImageDataSize(
+			size,
+			blockExtent,
+			getGlImageFormatBlockSize(format),
+			1);
+
+		glCompressedTexSubImage2D(
+			image->gl.glType,
+			(GLint)mipLevel,
+			(GLint)offset.x,
+			(GLint)offset.y,
+			(GLsizei)size.x,
+			(GLsizei)size.y,
+			image->gl.dataFormat,
+			(GLsizei)dataSize,
+			data);
+	}
+	else if (dimension == IMAGE_2D)
+	{
+		glTexSubImage2D(
+			image->gl.glType,
+			(GLint)mipLevel,
+			(GLint)offset.x,
+			(GLint)offset.y,
+			(GLsizei)size.x,
+			(GLsizei)size.y,
+			image->gl.dataFormat,
+			image->gl.dataType,
+			data);
+	}
+	else if (dimension == IMAGE_3D)
+	{
+		glTexSubImage3D(
+			image->gl.glType,
+			(GLint)mipLevel,
+			(GLint)offset.x,
+			(GLint)offset.y,
+			(GLint)offset.z,
+			(GLsizei)size.x,
+			(GLsizei)size.y,
+			(GLsizei)size.z,
+			image->gl.dataFormat,
+			image->gl.dataType,
+			data);
+	}
+	else
+	{
+		abort();
+	}
+
+	GLenum glError = glGetError();
+
+	if (glError != GL_NO_ERROR)
+		return glToMpgxResult(glError);
+
+	return SUCCESS_MPGX_RESULT;
+}
+inline static uint8_t getGlImageFormatPixelSize(ImageFormat format)
+{
+	switch (format)
+	{
+	default:
+		return getGlImageFormatBlockSize(format);
+	case R8_UNORM_IMAGE_FORMAT:
+	case R8_UINT_IMAGE_FORMAT:
+		return 1;
+	case D16_UNORM_IMAGE_FORMAT:
+	case R8G8_UNORM_IMAGE_FORMAT:
+	case R16_SFLOAT_IMAGE_FORMAT:
+	case R16_UINT_IMAGE_FORMAT:
+		return 2;
+	case R8G8B8A8_UNORM_IMAGE_FORMAT:
+	case R8G8B8A8_SRGB_IMAGE_FORMAT:
+	case D32_SFLOAT_IMAGE_FORMAT:
+	case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+	case R16G16_SFLOAT_IMAGE_FORMAT:
+	case R32_SFLOAT_IMAGE_FORMAT:
+	case B10G11R11_UFLOAT_IMAGE_FORMAT:
+	case A2B10G10R10_UNORM_IMAGE_FORMAT:
+	case R32_UINT_IMAGE_FORMAT:
+	case R32_SINT_IMAGE_FORMAT:
+	case R16G16_UINT_IMAGE_FORMAT:
+	case R8G8B8A8_UINT_IMAGE_FORMAT:
+		return 4;
+	case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
+	case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+	case R16G16B16A16_UINT_IMAGE_FORMAT:
+		return 8;
+	case R32G32B32A32_SFLOAT_IMAGE_FORMAT:
+	case R32G32B32A32_UINT_IMAGE_FORMAT:
+		return 16;
+	}
+}
+inline static void setGlImageStreamBaseLevel(
+	Image image,
+	uint8_t baseLevel)
+{
+	assert(image);
+	assert(image->gl.stream);
+	assert(baseLevel < image->gl.mipCount);
+
+	makeGlWindowContextCurrent(
+		image->gl.window);
+
+	glBindTexture(
+		image->gl.glType,
+		image->gl.handle);
+
+	// Not resident levels are never sampled by the shaders
+	glTexParameteri(
+		image->gl.glType,
+		GL_TEXTURE_BASE_LEVEL,
+		(GLint)baseLevel);
+
+	assertOpenGL();
+
+	image->gl.stream->residentMip = baseLevel;
+}
+inline static MpgxResult uploadGlImageStream(
+	Image image,
+	uint8_t mipLevel)
+{
+	assert(image);
+	assert(image->gl.stream);
+	assert(mipLevel < image->gl.mipCount);
+
+	ImageStream stream = image->gl.stream;
+
+	MpgxResult mpgxResult = setGlImageData(
+		image,
+		stream->data[mipLevel],
+		getImageMipSize(image->gl.size, mipLevel),
+		vec3I(0, 0, 0),
+		mipLevel);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	setGlImageStreamBaseLevel(
+		image,
+		mipLevel);
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createGlStreamingImage(
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint8_t mipCount,
+	uint8_t residentMipCount,
+	Image* image)
+{
+	assert(window);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(data);
+	assert(mipCount > 0);
+	assert(residentMipCount > 0);
+	assert(residentMipCount <= mipCount);
+	assert(image);
+
+	ImageStream stream = calloc(1,
+		sizeof(ImageStream_T) + mipCount * sizeof(const void*));
+
+	if (!stream)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	// Level data array is stored right after the stream
+	stream->data = (const void**)(stream + 1);
+
+	uint8_t residentMip = (uint8_t)(mipCount - residentMipCount);
+
+	// Not resident levels are allocated without the data
+	for (uint8_t i = residentMip; i < mipCount; i++)
+		stream->data[i] = data[i];
+
+	Image imageInstance;
+
+	MpgxResult mpgxResult = createGlImage(
+		window,
+		SAMPLED_IMAGE_TYPE,
+		dimension,
+		format,
+		stream->data,
+		size,
+		mipCount,
+		false,
+		true,
+		&imageInstance);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		free(stream);
+		return mpgxResult;
+	}
+
+	imageInstance->gl.stream = stream;
 
-#if MPGX_SUPPORT_OPENGL
-inline static void destroyGlImage(
-	Image image)
-{
-	if (!image)
-		return;
+	for (uint8_t i = 0; i < residentMip; i++)
+		stream->data[i] = data[i];
 
-	makeGlWindowContextCurrent(
-		image->gl.window);
+	stream->priority = 0.0f;
+	stream->requestedMip = residentMip;
+	stream->uploadMip = residentMip;
+	stream->blockSize = getGlImageFormatPixelSize(format);
+	stream->isFilled = false;
+	stream->isFilterLinear = false;
 
-	glDeleteTextures(
-		GL_ONE,
-		&image->gl.handle);
-	assertOpenGL();
+	setGlImageStreamBaseLevel(
+		imageInstance,
+		residentMip);
 
-	free(image);
+	stream->residentSize = calcImageStreamSize(
+		imageInstance,
+		residentMip,
+		mipCount);
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
 }
-inline static MpgxResult createGlImage(
+inline static MpgxResult createGlSparseImage(
 	Window window,
-	ImageType type,
 	ImageDimension dimension,
 	ImageFormat format,
-	const void** data,
 	Vec3I size,
-	uint32_t mipCount,
-	bool isConstant,
+	uint8_t mipCount,
 	Image* image)
 {
 	assert(window);
-	assert(type > 0);
 	assert(dimension < IMAGE_DIMENSION_COUNT);
 	assert(format < IMAGE_FORMAT_COUNT);
 	assert(size.x > 0);
@@ -865,102 +4676,111 @@ inline static MpgxResult createGlImage(
 	assert(mipCount <= calcMipLevelCount(size));
 	assert(image);
 
-	if (!(type & SAMPLED_IMAGE_TYPE) &&
-		!(type & COLOR_ATTACHMENT_IMAGE_TYPE) &&
-		!(type & DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE))
+	// Virtual page sizes are queried as the internal format parameters
+	if (!GLAD_GL_ARB_sparse_texture ||
+		!GLAD_GL_ARB_texture_storage ||
+		!GLAD_GL_ARB_internalformat_query)
 	{
 		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
 	}
 
-	// TODO: use isAttachment for renderbuffer optimization
-
-	Image imageInstance = calloc(1, sizeof(Image_T));
-
-	if (!imageInstance)
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	if (!isGlImageFormatSupported(SAMPLED_IMAGE_TYPE, format))
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
 
-	imageInstance->gl.window = window;
-	imageInstance->gl.size = size;
-	imageInstance->gl.type = type;
-	imageInstance->gl.dimension = dimension;
-	imageInstance->gl.format = format;
-	imageInstance->gl.isConstant = isConstant;
-	imageInstance->gl.mipCount = mipCount;
-	imageInstance->gl.layerCount = 1;
+	bool isCompressed = isImageFormatCompressed(format);
 
 	GLenum glType;
 
 	if (dimension == IMAGE_2D)
-	{
 		glType = GL_TEXTURE_2D;
-	}
-	else if (dimension == IMAGE_3D)
-	{
+	else if (dimension == IMAGE_3D && !isCompressed)
 		glType = GL_TEXTURE_3D;
-	}
 	else
-	{
-		destroyGlImage(imageInstance);
 		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-	}
-
-	imageInstance->gl.glType = glType;
 
 	GLint glFormat;
 	GLenum dataFormat;
 	GLenum dataType;
 
-	switch (format)
+	if (!getGlImageFormat(
+		format,
+		&glFormat,
+		&dataFormat,
+		&dataType))
 	{
-	default:
-		destroyGlImage(imageInstance);
 		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-	case R8_UNORM_IMAGE_FORMAT:
-		glFormat = GL_R8;
-		dataFormat = GL_RED;
-		dataType = GL_UNSIGNED_BYTE;
-		break;
-	case R8G8B8A8_UNORM_IMAGE_FORMAT:
-		glFormat = GL_RGBA8;
-		dataFormat = GL_RGBA;
-		dataType = GL_UNSIGNED_BYTE;
-		break;
-	case R8G8B8A8_SRGB_IMAGE_FORMAT:
-		glFormat = GL_SRGB8_ALPHA8;
-		dataFormat = GL_RGBA;
-		dataType = GL_UNSIGNED_BYTE;
-		break;
-	case R16G16B16A16_SFLOAT_IMAGE_FORMAT:
-		glFormat = GL_RGBA16F;
-		dataFormat = GL_RGBA;
-		dataType = GL_FLOAT;
-		break;
-	case D16_UNORM_IMAGE_FORMAT:
-		glFormat = GL_DEPTH_COMPONENT16;
-		dataFormat = GL_DEPTH_COMPONENT;
-		dataType = GL_UNSIGNED_SHORT;
-		break;
-	case D32_SFLOAT_IMAGE_FORMAT:
-		glFormat = GL_DEPTH_COMPONENT32F;
-		dataFormat = GL_DEPTH_COMPONENT;
-		dataType = GL_FLOAT;
-		break;
-	case D24_UNORM_S8_UINT_IMAGE_FORMAT:
-		glFormat = GL_DEPTH24_STENCIL8;
-		dataFormat = GL_DEPTH_STENCIL;
-		dataType = GL_UNSIGNED_INT_24_8;
-		break;
-	case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
-		glFormat = GL_DEPTH32F_STENCIL8;
-		dataFormat = GL_DEPTH_STENCIL;
-		dataType = GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
-		break;
 	}
 
+	if (isCompressed)
+	{
+		dataFormat = (GLenum)glFormat;
+		dataType = GL_ZERO;
+	}
+
+	makeGlWindowContextCurrent(window);
+
+	GLint pageSizeCount = 0;
+
+	glGetInternalformativ(
+		glType,
+		(GLenum)glFormat,
+		GL_NUM_VIRTUAL_PAGE_SIZES_ARB,
+		1,
+		&pageSizeCount);
+
+	if (pageSizeCount == 0)
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+	GLint pageSizeX = 0, pageSizeY = 0, pageSizeZ = 0;
+
+	glGetInternalformativ(
+		glType,
+		(GLenum)glFormat,
+		GL_VIRTUAL_PAGE_SIZE_X_ARB,
+		1,
+		&pageSizeX);
+	glGetInternalformativ(
+		glType,
+		(GLenum)glFormat,
+		GL_VIRTUAL_PAGE_SIZE_Y_ARB,
+		1,
+		&pageSizeY);
+	glGetInternalformativ(
+		glType,
+		(GLenum)glFormat,
+		GL_VIRTUAL_PAGE_SIZE_Z_ARB,
+		1,
+		&pageSizeZ);
+
+	if (pageSizeX <= 0 || pageSizeY <= 0 || pageSizeZ <= 0)
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+	Image imageInstance = calloc(1, sizeof(Image_T));
+
+	if (!imageInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	imageInstance->gl.window = window;
+	imageInstance->gl.size = size;
+	imageInstance->gl.type = SAMPLED_IMAGE_TYPE | TRANSFER_DESTINATION_IMAGE_TYPE;
+	imageInstance->gl.dimension = dimension;
+	imageInstance->gl.format = format;
+	imageInstance->gl.isConstant = false;
+	imageInstance->gl.mipCount = mipCount;
+	imageInstance->gl.layerCount = 1;
+	imageInstance->gl.glType = glType;
 	imageInstance->gl.dataType = dataType;
 	imageInstance->gl.dataFormat = dataFormat;
 
-	makeGlWindowContextCurrent(window);
+	ImageSparse sparse = calloc(1, sizeof(ImageSparse_T));
+
+	if (!sparse)
+	{
+		destroyGlImage(imageInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	imageInstance->gl.sparse = sparse;
 
 	GLuint handle = GL_ZERO;
 
@@ -974,65 +4794,66 @@ inline static MpgxResult createGlImage(
 		glType,
 		handle);
 
+	// Sparse storage should be requested before the allocation
+	glTexParameteri(
+		glType,
+		GL_TEXTURE_SPARSE_ARB,
+		GL_TRUE);
+	glTexParameteri(
+		glType,
+		GL_VIRTUAL_PAGE_SIZE_INDEX_ARB,
+		0);
+
 	if (dimension == IMAGE_2D)
 	{
-		Vec2I mipSize = vec2I(size.x, size.y);
-
-		for (uint32_t i = 0; i < mipCount; i++)
-		{
-			glTexImage2D(
-				glType,
-				(GLint)i,
-				glFormat,
-				(GLsizei)mipSize.x,
-				(GLsizei)mipSize.y,
-				0,
-				dataFormat,
-				dataType,
-				data ? data[i] : NULL);
-
-			mipSize = divValVec2I(
-				mipSize, 2);
-		}
-
-		glTexParameteri(
-			GL_TEXTURE_2D,
-			GL_TEXTURE_BASE_LEVEL,
-			0);
-		glTexParameteri(
-			GL_TEXTURE_2D,
-			GL_TEXTURE_MAX_LEVEL,
-			(GLint)(mipCount - 1));
+		glTexStorage2D(
+			glType,
+			(GLsizei)mipCount,
+			(GLenum)glFormat,
+			(GLsizei)size.x,
+			(GLsizei)size.y);
 	}
 	else
 	{
-		Vec3I mipSize = size;
+		glTexStorage3D(
+			glType,
+			(GLsizei)mipCount,
+			(GLenum)glFormat,
+			(GLsizei)size.x,
+			(GLsizei)size.y,
+			(GLsizei)size.z);
+	}
 
-		for (uint32_t i = 0; i < mipCount; i++)
-		{
-			glTexImage3D(
-				glType,
-				(GLint)i,
-				glFormat,
-				(GLsizei)mipSize.x,
-				(GLsizei)mipSize.y,
-				(GLsizei)mipSize.z,
-				0,
-				dataFormat,
-				dataType,
-				data ? data[i] : NULL);
-			mipSize = divValVec3I(
-				mipSize, 2);
-		}
+	GLint sparseLevelCount = 0;
 
-		glTexParameteri(
-			GL_TEXTURE_3D,
-			GL_TEXTURE_BASE_LEVEL,
-			0);
-		glTexParameteri(
-			GL_TEXTURE_3D,
-			GL_TEXTURE_MAX_LEVEL,
-			(GLint)(mipCount - 1));
+	glGetTexParameteriv(
+		glType,
+		GL_NUM_SPARSE_LEVELS_ARB,
+		&sparseLevelCount);
+
+	uint8_t tailMip = (uint8_t)min(sparseLevelCount, (GLint)mipCount);
+
+	sparse->pageSize = vec3I(
+		(cmmt_int_t)pageSizeX,
+		(cmmt_int_t)pageSizeY,
+		(cmmt_int_t)pageSizeZ);
+	sparse->tailMip = tailMip;
+
+	// Mip tail levels are committed together as a whole
+	if (tailMip < mipCount)
+	{
+		Vec3I tailSize = getImageMipSize(size, tailMip);
+
+		glTexPageCommitmentARB(
+			glType,
+			(GLint)tailMip,
+			0,
+			0,
+			0,
+			(GLsizei)tailSize.x,
+			(GLsizei)tailSize.y,
+			(GLsizei)tailSize.z,
+			GL_TRUE);
 	}
 
 	GLenum glError = glGetError();
@@ -1043,19 +4864,103 @@ inline static MpgxResult createGlImage(
 		return glToMpgxResult(glError);
 	}
 
+	sparse->pageCount = getImagePageIndex(
+		imageInstance,
+		tailMip,
+		vec3I(0, 0, 0));
+
+	if (sparse->pageCount > 0)
+	{
+		bool* sparsePages = calloc(
+			sparse->pageCount, sizeof(bool));
+
+		if (!sparsePages)
+		{
+			destroyGlImage(imageInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		imageInstance->gl.sparsePages = sparsePages;
+	}
+
 	*image = imageInstance;
 	return SUCCESS_MPGX_RESULT;
 }
+inline static MpgxResult setGlImagePageCommitment(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount,
+	bool commit)
+{
+	assert(image);
+	assert(image->gl.sparse);
+	assert(pages);
+	assert(pageCount > 0);
 
-inline static MpgxResult setGlImageData(
+	ImageSparse sparse = image->gl.sparse;
+	bool* sparsePages = image->gl.sparsePages;
+	Vec3I pageSize = sparse->pageSize;
+	GLenum glType = image->gl.glType;
+
+	makeGlWindowContextCurrent(
+		image->gl.window);
+
+	glBindTexture(
+		glType,
+		image->gl.handle);
+
+	for (size_t i = 0; i < pageCount; i++)
+	{
+		const ImagePage* page = &pages[i];
+
+		size_t pageIndex = getImagePageIndex(
+			image,
+			page->mipLevel,
+			page->offset);
+
+		// Already committed or decommitted pages are skipped
+		if (sparsePages[pageIndex] == commit)
+			continue;
+
+		Vec3I mipSize = getImageMipSize(image->gl.size, page->mipLevel);
+		Vec3I offset = mulVec3I(page->offset, pageSize);
+
+		// Edge pages are clamped to the mip level extent
+		glTexPageCommitmentARB(
+			glType,
+			(GLint)page->mipLevel,
+			(GLint)offset.x,
+			(GLint)offset.y,
+			(GLint)offset.z,
+			(GLsizei)min(pageSize.x, mipSize.x - offset.x),
+			(GLsizei)min(pageSize.y, mipSize.y - offset.y),
+			(GLsizei)min(pageSize.z, mipSize.z - offset.z),
+			commit ? GL_TRUE : GL_FALSE);
+
+		sparsePages[pageIndex] = commit;
+
+		if (commit)
+			sparse->committedPageCount++;
+		else
+			sparse->committedPageCount--;
+	}
+
+	GLenum glError = glGetError();
+
+	if (glError != GL_NO_ERROR)
+		return glToMpgxResult(glError);
+
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult readGlImageData(
 	Image image,
-	const void* data,
+	GLuint pixelBuffer,
 	Vec3I size,
 	Vec3I offset,
 	uint8_t mipLevel)
 {
 	assert(image);
-	assert(data);
+	assert(pixelBuffer != GL_ZERO);
 	assert(size.x > 0);
 	assert(size.y > 0);
 	assert(size.z > 0);
@@ -1063,49 +4968,77 @@ inline static MpgxResult setGlImageData(
 	assert(offset.y >= 0);
 	assert(offset.z >= 0);
 	assert(mipLevel < image->gl.mipCount);
+	assert(!isImageFormatCompressed(image->gl.format));
+	assert(!isImageFormatDepthStencil(image->gl.format));
 
 	makeGlWindowContextCurrent(
 		image->gl.window);
 
-	glBindTexture(
-		image->gl.glType,
-		image->gl.handle);
+	GLuint framebuffer = GL_ZERO;
 
-	ImageDimension dimension = image->gl.dimension;
+	glGenFramebuffers(
+		GL_ONE,
+		&framebuffer);
+	glBindFramebuffer(
+		GL_READ_FRAMEBUFFER,
+		framebuffer);
+	glBindBuffer(
+		GL_PIXEL_PACK_BUFFER,
+		pixelBuffer);
+	glPixelStorei(
+		GL_PACK_ALIGNMENT,
+		1);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
 
-	if (dimension == IMAGE_2D)
-	{
-		glTexSubImage2D(
-			image->gl.glType,
-			(GLint)mipLevel,
-			(GLint)offset.x,
-			(GLint)offset.y,
-			(GLsizei)size.x,
-			(GLsizei)size.y,
-			image->gl.dataFormat,
-			image->gl.dataType,
-			data);
-	}
-	else if (dimension == IMAGE_3D)
+	size_t sliceSize = calcImageDataSize(
+		vec3I(size.x, size.y, 1),
+		vec2I(1, 1),
+		getGlImageFormatPixelSize(image->gl.format),
+		1);
+
+	// Pixels are packed into the buffer slice by slice,
+	// the read is finished asynchronously by the driver.
+	for (cmmt_int_t i = 0; i < size.z; i++)
 	{
-		glTexSubImage3D(
-			image->gl.glType,
-			(GLint)mipLevel,
+		if (image->gl.dimension == IMAGE_3D)
+		{
+			glFramebufferTextureLayer(
+				GL_READ_FRAMEBUFFER,
+				GL_COLOR_ATTACHMENT0,
+				image->gl.handle,
+				(GLint)mipLevel,
+				(GLint)(offset.z + i));
+		}
+		else
+		{
+			glFramebufferTexture2D(
+				GL_READ_FRAMEBUFFER,
+				GL_COLOR_ATTACHMENT0,
+				image->gl.glType,
+				image->gl.handle,
+				(GLint)mipLevel);
+		}
+
+		glReadPixels(
 			(GLint)offset.x,
 			(GLint)offset.y,
-			(GLint)offset.z,
 			(GLsizei)size.x,
 			(GLsizei)size.y,
-			(GLsizei)size.z,
 			image->gl.dataFormat,
 			image->gl.dataType,
-			data);
-	}
-	else
-	{
-		abort();
+			(void*)(sliceSize * (size_t)i));
 	}
 
+	glBindBuffer(
+		GL_PIXEL_PACK_BUFFER,
+		GL_ZERO);
+	glBindFramebuffer(
+		GL_READ_FRAMEBUFFER,
+		GL_ZERO);
+	glDeleteFramebuffers(
+		GL_ONE,
+		&framebuffer);
+
 	GLenum glError = glGetError();
 
 	if (glError != GL_NO_ERROR)
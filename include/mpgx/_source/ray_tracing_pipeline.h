@@ -500,10 +500,6 @@ inline static void destroyVkRayTracingPipeline(
 		device,
 		rayTracingPipeline->vk.layout,
 		NULL);
-	vkDestroyPipelineCache(
-		device,
-		rayTracingPipeline->vk.cache,
-		NULL);
 	free(rayTracingPipeline->vk.closestHitShaders);
 	free(rayTracingPipeline->vk.missShaders);
 	free(rayTracingPipeline->vk.generationShaders);
@@ -512,6 +508,7 @@ inline static void destroyVkRayTracingPipeline(
 inline static MpgxResult createVkRayTracingPipeline(
 	VkDevice device,
 	VmaAllocator allocator,
+	VkPipelineCache cache,
 	const VkRayTracingPipelineCreateData* createData,
 	RayTracing rayTracing,
 	const char* name,
@@ -529,6 +526,7 @@ inline static MpgxResult createVkRayTracingPipeline(
 {
 	assert(device);
 	assert(allocator);
+	assert(cache);
 	assert(createData);
 	assert(rayTracing);
 	assert(window);
@@ -605,31 +603,6 @@ inline static MpgxResult createVkRayTracingPipeline(
 	for (size_t i = 0; i < closestHitShaderCount; i++)
 		rayClosestHitShaders[i] = closestHitShaders[i];
 
-	VkPipelineCacheCreateInfo cacheCreateInfo = {
-		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
-		NULL,
-		0,
-		0,
-		NULL,
-	};
-
-	VkPipelineCache cache;
-
-	VkResult vkResult = vkCreatePipelineCache(
-		device,
-		&cacheCreateInfo,
-		NULL,
-		&cache);
-
-	if (vkResult != VK_SUCCESS)
-	{
-		destroyVkRayTracingPipeline(
-			device,
-			allocator,
-			rayTracingPipelineInstance);
-		return vkToMpgxResult(vkResult);
-	}
-
 	rayTracingPipelineInstance->vk.cache = cache;
 
 	VkPipelineLayoutCreateInfo layoutCreateInfo = {
@@ -644,7 +617,7 @@ inline static MpgxResult createVkRayTracingPipeline(
 
 	VkPipelineLayout layout;
 
-	vkResult = vkCreatePipelineLayout(
+	VkResult vkResult = vkCreatePipelineLayout(
 		device,
 		&layoutCreateInfo,
 		NULL,
@@ -0,0 +1,1459 @@
+// Copyright 2020-2022 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "mpgx/_source/vulkan.h"
+
+#include <assert.h>
+#include <string.h>
+
+#if MPGX_SUPPORT_VULKAN
+#define SPIRV_MAGIC_NUMBER 0x07230203
+#define SPIRV_HEADER_SIZE 5
+
+#define SPIRV_OP_DECORATE 71
+#define SPIRV_OP_MEMBER_DECORATE 72
+#define SPIRV_OP_TYPE_INT 21
+#define SPIRV_OP_TYPE_FLOAT 22
+#define SPIRV_OP_TYPE_VECTOR 23
+#define SPIRV_OP_TYPE_MATRIX 24
+#define SPIRV_OP_TYPE_IMAGE 25
+#define SPIRV_OP_TYPE_SAMPLER 26
+#define SPIRV_OP_TYPE_SAMPLED_IMAGE 27
+#define SPIRV_OP_TYPE_ARRAY 28
+#define SPIRV_OP_TYPE_RUNTIME_ARRAY 29
+#define SPIRV_OP_TYPE_STRUCT 30
+#define SPIRV_OP_TYPE_POINTER 32
+#define SPIRV_OP_CONSTANT 43
+#define SPIRV_OP_VARIABLE 59
+#define SPIRV_OP_TYPE_ACCELERATION_STRUCTURE 5341
+
+#define SPIRV_DECORATION_BLOCK 2
+#define SPIRV_DECORATION_BUFFER_BLOCK 3
+#define SPIRV_DECORATION_ARRAY_STRIDE 6
+#define SPIRV_DECORATION_MATRIX_STRIDE 7
+#define SPIRV_DECORATION_BUILT_IN 11
+#define SPIRV_DECORATION_LOCATION 30
+#define SPIRV_DECORATION_BINDING 33
+#define SPIRV_DECORATION_DESCRIPTOR_SET 34
+#define SPIRV_DECORATION_OFFSET 35
+
+#define SPIRV_STORAGE_UNIFORM_CONSTANT 0
+#define SPIRV_STORAGE_INPUT 1
+#define SPIRV_STORAGE_UNIFORM 2
+#define SPIRV_STORAGE_PUSH_CONSTANT 9
+#define SPIRV_STORAGE_STORAGE_BUFFER 12
+
+#define SPIRV_DIM_BUFFER 5
+#define SPIRV_DIM_SUBPASS_DATA 6
+
+#define SPIRV_SET_FLAG 0b00000001
+#define SPIRV_BINDING_FLAG 0b00000010
+#define SPIRV_LOCATION_FLAG 0b00000100
+#define SPIRV_BUILT_IN_FLAG 0b00001000
+#define SPIRV_BLOCK_FLAG 0b00010000
+#define SPIRV_BUFFER_BLOCK_FLAG 0b00100000
+
+typedef struct SpirvId
+{
+	const uint32_t* instruction;
+	uint32_t set;
+	uint32_t binding;
+	uint32_t location;
+	uint32_t arrayStride;
+	uint8_t flags;
+} SpirvId;
+
+typedef struct VkShaderReflection_T
+{
+	VkDescriptorSetLayoutBinding* bindings;
+	uint32_t* bindingSets;
+	uint32_t bindingCount;
+	uint32_t vertexAttributeCount;
+	VkVertexInputAttributeDescription* vertexAttributes;
+	uint32_t vertexStride;
+	uint32_t pushConstantRangeCount;
+	VkPushConstantRange pushConstantRange;
+} VkShaderReflection_T;
+
+typedef VkShaderReflection_T* VkShaderReflection;
+
+typedef struct VkSetLayoutEntry
+{
+	VkDescriptorSetLayoutBinding* bindings;
+	uint32_t bindingCount;
+	VkDescriptorSetLayout layout;
+} VkSetLayoutEntry;
+
+typedef struct VkReflectedLayout_T
+{
+	VkDescriptorSetLayout* setLayouts;
+	uint32_t setLayoutCount;
+	uint32_t pushConstantRangeCount;
+	VkPushConstantRange pushConstantRange;
+	VkVertexInputBindingDescription vertexBinding;
+	uint32_t vertexBindingCount;
+	uint32_t vertexAttributeCount;
+	VkVertexInputAttributeDescription* vertexAttributes;
+	VkPipelineLayout layout;
+	bool isLayoutOwner;
+} VkReflectedLayout_T;
+
+typedef VkReflectedLayout_T* VkReflectedLayout;
+
+typedef struct VkLayoutCache_T
+{
+	VkSetLayoutEntry* setLayouts;
+	size_t setLayoutCount;
+	size_t setLayoutCapacity;
+	VkReflectedLayout* layouts;
+	size_t layoutCount;
+	size_t layoutCapacity;
+} VkLayoutCache_T;
+
+typedef VkLayoutCache_T* VkLayoutCache;
+
+inline static bool getSpirvMemberDecoration(
+	const uint32_t* code,
+	size_t wordCount,
+	uint32_t structId,
+	uint32_t member,
+	uint32_t decoration,
+	uint32_t* value)
+{
+	assert(code);
+	assert(value);
+
+	size_t index = SPIRV_HEADER_SIZE;
+
+	while (index < wordCount)
+	{
+		const uint32_t* instruction = code + index;
+		uint32_t instructionSize = instruction[0] >> 16;
+
+		if ((instruction[0] & 0xFFFF) == SPIRV_OP_MEMBER_DECORATE &&
+			instructionSize > 4 &&
+			instruction[1] == structId &&
+			instruction[2] == member &&
+			instruction[3] == decoration)
+		{
+			*value = instruction[4];
+			return true;
+		}
+
+		index += instructionSize;
+	}
+
+	return false;
+}
+inline static bool getSpirvTypeSize(
+	const uint32_t* code,
+	size_t wordCount,
+	const SpirvId* ids,
+	uint32_t idCount,
+	uint32_t typeId,
+	uint32_t matrixStride,
+	uint32_t* size)
+{
+	assert(code);
+	assert(ids);
+	assert(size);
+
+	if (typeId >= idCount || !ids[typeId].instruction)
+		return false;
+
+	const uint32_t* instruction = ids[typeId].instruction;
+	uint32_t instructionSize = instruction[0] >> 16;
+
+	switch (instruction[0] & 0xFFFF)
+	{
+	default:
+		return false;
+	case SPIRV_OP_TYPE_INT:
+	case SPIRV_OP_TYPE_FLOAT:
+		*size = instruction[2] / 8;
+		return true;
+	case SPIRV_OP_TYPE_VECTOR:
+	case SPIRV_OP_TYPE_MATRIX:
+	{
+		uint32_t elementSize;
+
+		bool result = getSpirvTypeSize(
+			code,
+			wordCount,
+			ids,
+			idCount,
+			instruction[2],
+			0,
+			&elementSize);
+
+		if (!result)
+			return false;
+
+		// Matrix columns can be padded by the layout rules
+		if ((instruction[0] & 0xFFFF) == SPIRV_OP_TYPE_MATRIX &&
+			matrixStride > 0)
+		{
+			elementSize = matrixStride;
+		}
+
+		*size = elementSize * instruction[3];
+		return true;
+	}
+	case SPIRV_OP_TYPE_ARRAY:
+	{
+		uint32_t lengthId = instruction[3];
+
+		if (lengthId >= idCount || !ids[lengthId].instruction)
+			return false;
+
+		uint32_t length = ids[lengthId].instruction[3];
+		uint32_t elementSize = ids[typeId].arrayStride;
+
+		if (elementSize == 0)
+		{
+			bool result = getSpirvTypeSize(
+				code,
+				wordCount,
+				ids,
+				idCount,
+				instruction[2],
+				matrixStride,
+				&elementSize);
+
+			if (!result)
+				return false;
+		}
+
+		*size = elementSize * length;
+		return true;
+	}
+	case SPIRV_OP_TYPE_STRUCT:
+	{
+		uint32_t structSize = 0;
+
+		for (uint32_t i = 2; i < instructionSize; i++)
+		{
+			uint32_t member = i - 2;
+			uint32_t offset = 0, memberMatrixStride = 0, memberSize;
+
+			getSpirvMemberDecoration(
+				code,
+				wordCount,
+				typeId,
+				member,
+				SPIRV_DECORATION_OFFSET,
+				&offset);
+			getSpirvMemberDecoration(
+				code,
+				wordCount,
+				typeId,
+				member,
+				SPIRV_DECORATION_MATRIX_STRIDE,
+				&memberMatrixStride);
+
+			bool result = getSpirvTypeSize(
+				code,
+				wordCount,
+				ids,
+				idCount,
+				instruction[i],
+				memberMatrixStride,
+				&memberSize);
+
+			if (!result)
+				return false;
+
+			if (offset + memberSize > structSize)
+				structSize = offset + memberSize;
+		}
+
+		*size = structSize;
+		return true;
+	}
+	}
+}
+inline static bool getSpirvVertexFormat(
+	const SpirvId* ids,
+	uint32_t idCount,
+	uint32_t typeId,
+	VkFormat* format,
+	uint32_t* size)
+{
+	assert(ids);
+	assert(format);
+	assert(size);
+
+	if (typeId >= idCount || !ids[typeId].instruction)
+		return false;
+
+	const uint32_t* instruction = ids[typeId].instruction;
+	uint32_t componentCount = 1;
+
+	if ((instruction[0] & 0xFFFF) == SPIRV_OP_TYPE_VECTOR)
+	{
+		componentCount = instruction[3];
+		typeId = instruction[2];
+
+		if (typeId >= idCount || !ids[typeId].instruction)
+			return false;
+
+		instruction = ids[typeId].instruction;
+	}
+
+	uint32_t opcode = instruction[0] & 0xFFFF;
+
+	// Only 32-bit components can be reflected,
+	// packed formats are not visible in the shader code.
+	if ((opcode != SPIRV_OP_TYPE_FLOAT && opcode != SPIRV_OP_TYPE_INT) ||
+		instruction[2] != 32 || componentCount > 4)
+	{
+		return false;
+	}
+
+	static const VkFormat floatFormats[4] = {
+		VK_FORMAT_R32_SFLOAT,
+		VK_FORMAT_R32G32_SFLOAT,
+		VK_FORMAT_R32G32B32_SFLOAT,
+		VK_FORMAT_R32G32B32A32_SFLOAT,
+	};
+	static const VkFormat intFormats[4] = {
+		VK_FORMAT_R32_SINT,
+		VK_FORMAT_R32G32_SINT,
+		VK_FORMAT_R32G32B32_SINT,
+		VK_FORMAT_R32G32B32A32_SINT,
+	};
+	static const VkFormat uintFormats[4] = {
+		VK_FORMAT_R32_UINT,
+		VK_FORMAT_R32G32_UINT,
+		VK_FORMAT_R32G32B32_UINT,
+		VK_FORMAT_R32G32B32A32_UINT,
+	};
+
+	if (opcode == SPIRV_OP_TYPE_FLOAT)
+		*format = floatFormats[componentCount - 1];
+	else if (instruction[3] == 1)
+		*format = intFormats[componentCount - 1];
+	else
+		*format = uintFormats[componentCount - 1];
+
+	*size = componentCount * sizeof(uint32_t);
+	return true;
+}
+inline static bool getSpirvDescriptorType(
+	const SpirvId* ids,
+	uint32_t idCount,
+	uint32_t storageClass,
+	uint32_t typeId,
+	VkDescriptorType* descriptorType)
+{
+	assert(ids);
+	assert(descriptorType);
+
+	if (typeId >= idCount || !ids[typeId].instruction)
+		return false;
+
+	const uint32_t* instruction = ids[typeId].instruction;
+
+	if (storageClass == SPIRV_STORAGE_STORAGE_BUFFER)
+	{
+		*descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		return true;
+	}
+	if (storageClass == SPIRV_STORAGE_UNIFORM)
+	{
+		*descriptorType = ids[typeId].flags & SPIRV_BUFFER_BLOCK_FLAG ?
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER :
+			VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		return true;
+	}
+
+	switch (instruction[0] & 0xFFFF)
+	{
+	default:
+		return false;
+	case SPIRV_OP_TYPE_SAMPLER:
+		*descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		return true;
+	case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+		*descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		return true;
+	case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+		*descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+		return true;
+	case SPIRV_OP_TYPE_IMAGE:
+	{
+		uint32_t dimension = instruction[3];
+		bool isStorage = instruction[7] == 2;
+
+		if (dimension == SPIRV_DIM_SUBPASS_DATA)
+		{
+			*descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		}
+		else if (dimension == SPIRV_DIM_BUFFER)
+		{
+			*descriptorType = isStorage ?
+				VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER :
+				VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+		}
+		else
+		{
+			*descriptorType = isStorage ?
+				VK_DESCRIPTOR_TYPE_STORAGE_IMAGE :
+				VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		}
+		return true;
+	}
+	}
+}
+
+inline static void destroyVkShaderReflection(
+	VkShaderReflection reflection)
+{
+	if (!reflection)
+		return;
+
+	free(reflection->vertexAttributes);
+	free(reflection->bindingSets);
+	free(reflection->bindings);
+	free(reflection);
+}
+inline static MpgxResult createVkShaderReflection(
+	const uint32_t* code,
+	size_t size,
+	VkShaderStageFlags stage,
+	VkShaderReflection* reflection)
+{
+	assert(code);
+	assert(size > 0);
+	assert(reflection);
+
+	size_t wordCount = size / sizeof(uint32_t);
+
+	if (size % sizeof(uint32_t) != 0 ||
+		wordCount < SPIRV_HEADER_SIZE ||
+		code[0] != SPIRV_MAGIC_NUMBER)
+	{
+		return BAD_SHADER_CODE_MPGX_RESULT;
+	}
+
+	uint32_t idCount = code[3];
+	SpirvId* ids = calloc(idCount, sizeof(SpirvId));
+
+	if (!ids)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	size_t variableCount = 0;
+	size_t index = SPIRV_HEADER_SIZE;
+
+	while (index < wordCount)
+	{
+		const uint32_t* instruction = code + index;
+		uint32_t instructionSize = instruction[0] >> 16;
+
+		if (instructionSize == 0 || index + instructionSize > wordCount)
+		{
+			free(ids);
+			return BAD_SHADER_CODE_MPGX_RESULT;
+		}
+
+		uint32_t opcode = instruction[0] & 0xFFFF;
+		uint32_t id;
+
+		switch (opcode)
+		{
+		default:
+			break;
+		case SPIRV_OP_DECORATE:
+		{
+			id = instruction[1];
+
+			if (id >= idCount || instructionSize < 3)
+				break;
+
+			SpirvId* spirvId = &ids[id];
+			uint32_t value = instructionSize > 3 ? instruction[3] : 0;
+
+			switch (instruction[2])
+			{
+			default:
+				break;
+			case SPIRV_DECORATION_BLOCK:
+				spirvId->flags |= SPIRV_BLOCK_FLAG;
+				break;
+			case SPIRV_DECORATION_BUFFER_BLOCK:
+				spirvId->flags |= SPIRV_BUFFER_BLOCK_FLAG;
+				break;
+			case SPIRV_DECORATION_ARRAY_STRIDE:
+				spirvId->arrayStride = value;
+				break;
+			case SPIRV_DECORATION_BUILT_IN:
+				spirvId->flags |= SPIRV_BUILT_IN_FLAG;
+				break;
+			case SPIRV_DECORATION_LOCATION:
+				spirvId->location = value;
+				spirvId->flags |= SPIRV_LOCATION_FLAG;
+				break;
+			case SPIRV_DECORATION_BINDING:
+				spirvId->binding = value;
+				spirvId->flags |= SPIRV_BINDING_FLAG;
+				break;
+			case SPIRV_DECORATION_DESCRIPTOR_SET:
+				spirvId->set = value;
+				spirvId->flags |= SPIRV_SET_FLAG;
+				break;
+			}
+			break;
+		}
+		case SPIRV_OP_TYPE_INT:
+		case SPIRV_OP_TYPE_FLOAT:
+		case SPIRV_OP_TYPE_VECTOR:
+		case SPIRV_OP_TYPE_MATRIX:
+		case SPIRV_OP_TYPE_IMAGE:
+		case SPIRV_OP_TYPE_SAMPLER:
+		case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+		case SPIRV_OP_TYPE_ARRAY:
+		case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+		case SPIRV_OP_TYPE_STRUCT:
+		case SPIRV_OP_TYPE_POINTER:
+		case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+			id = instruction[1];
+
+			if (id < idCount)
+				ids[id].instruction = instruction;
+			break;
+		case SPIRV_OP_CONSTANT:
+		case SPIRV_OP_VARIABLE:
+			id = instruction[2];
+
+			if (id < idCount)
+				ids[id].instruction = instruction;
+			if (opcode == SPIRV_OP_VARIABLE)
+				variableCount++;
+			break;
+		}
+
+		index += instructionSize;
+	}
+
+	VkShaderReflection reflectionInstance = calloc(1,
+		sizeof(VkShaderReflection_T));
+
+	if (!reflectionInstance)
+	{
+		free(ids);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	if (variableCount > 0)
+	{
+		VkDescriptorSetLayoutBinding* bindings = malloc(
+			variableCount * sizeof(VkDescriptorSetLayoutBinding));
+
+		if (!bindings)
+		{
+			destroyVkShaderReflection(reflectionInstance);
+			free(ids);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		reflectionInstance->bindings = bindings;
+
+		uint32_t* bindingSets = malloc(
+			variableCount * sizeof(uint32_t));
+
+		if (!bindingSets)
+		{
+			destroyVkShaderReflection(reflectionInstance);
+			free(ids);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		reflectionInstance->bindingSets = bindingSets;
+
+		VkVertexInputAttributeDescription* vertexAttributes = malloc(
+			variableCount * sizeof(VkVertexInputAttributeDescription));
+
+		if (!vertexAttributes)
+		{
+			destroyVkShaderReflection(reflectionInstance);
+			free(ids);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		reflectionInstance->vertexAttributes = vertexAttributes;
+	}
+
+	VkDescriptorSetLayoutBinding* bindings = reflectionInstance->bindings;
+	uint32_t* bindingSets = reflectionInstance->bindingSets;
+	VkVertexInputAttributeDescription* vertexAttributes =
+		reflectionInstance->vertexAttributes;
+	uint32_t bindingCount = 0, vertexAttributeCount = 0;
+	uint32_t pushConstantBegin = UINT32_MAX, pushConstantEnd = 0;
+
+	for (uint32_t i = 0; i < idCount; i++)
+	{
+		const SpirvId* variable = &ids[i];
+		const uint32_t* instruction = variable->instruction;
+
+		if (!instruction || (instruction[0] & 0xFFFF) != SPIRV_OP_VARIABLE)
+			continue;
+
+		uint32_t pointerId = instruction[1];
+		uint32_t storageClass = instruction[3];
+
+		if (pointerId >= idCount || !ids[pointerId].instruction)
+		{
+			destroyVkShaderReflection(reflectionInstance);
+			free(ids);
+			return BAD_SHADER_CODE_MPGX_RESULT;
+		}
+
+		uint32_t typeId = ids[pointerId].instruction[3];
+
+		if (typeId >= idCount || !ids[typeId].instruction)
+		{
+			destroyVkShaderReflection(reflectionInstance);
+			free(ids);
+			return BAD_SHADER_CODE_MPGX_RESULT;
+		}
+
+		if (storageClass == SPIRV_STORAGE_UNIFORM_CONSTANT ||
+			storageClass == SPIRV_STORAGE_UNIFORM ||
+			storageClass == SPIRV_STORAGE_STORAGE_BUFFER)
+		{
+			if (!(variable->flags & SPIRV_SET_FLAG) ||
+				!(variable->flags & SPIRV_BINDING_FLAG))
+			{
+				continue;
+			}
+
+			uint32_t descriptorCount = 1;
+			const uint32_t* typeInstruction = ids[typeId].instruction;
+
+			// Bindless arrays have no fixed layout size
+			if ((typeInstruction[0] & 0xFFFF) == SPIRV_OP_TYPE_RUNTIME_ARRAY)
+			{
+				destroyVkShaderReflection(reflectionInstance);
+				free(ids);
+				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			}
+			if ((typeInstruction[0] & 0xFFFF) == SPIRV_OP_TYPE_ARRAY)
+			{
+				uint32_t lengthId = typeInstruction[3];
+
+				if (lengthId >= idCount || !ids[lengthId].instruction)
+				{
+					destroyVkShaderReflection(reflectionInstance);
+					free(ids);
+					return BAD_SHADER_CODE_MPGX_RESULT;
+				}
+
+				descriptorCount = ids[lengthId].instruction[3];
+				typeId = typeInstruction[2];
+			}
+
+			VkDescriptorType descriptorType;
+
+			bool result = getSpirvDescriptorType(
+				ids,
+				idCount,
+				storageClass,
+				typeId,
+				&descriptorType);
+
+			if (!result)
+			{
+				destroyVkShaderReflection(reflectionInstance);
+				free(ids);
+				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			}
+
+			VkDescriptorSetLayoutBinding binding = {
+				variable->binding,
+				descriptorType,
+				descriptorCount,
+				stage,
+				NULL,
+			};
+
+			bindings[bindingCount] = binding;
+			bindingSets[bindingCount] = variable->set;
+			bindingCount++;
+		}
+		else if (storageClass == SPIRV_STORAGE_PUSH_CONSTANT)
+		{
+			uint32_t offset = 0, structSize;
+
+			getSpirvMemberDecoration(
+				code,
+				wordCount,
+				typeId,
+				0,
+				SPIRV_DECORATION_OFFSET,
+				&offset);
+
+			bool result = getSpirvTypeSize(
+				code,
+				wordCount,
+				ids,
+				idCount,
+				typeId,
+				0,
+				&structSize);
+
+			if (!result)
+			{
+				destroyVkShaderReflection(reflectionInstance);
+				free(ids);
+				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			}
+
+			if (offset < pushConstantBegin)
+				pushConstantBegin = offset;
+			if (structSize > pushConstantEnd)
+				pushConstantEnd = structSize;
+		}
+		else if (storageClass == SPIRV_STORAGE_INPUT &&
+			stage == VK_SHADER_STAGE_VERTEX_BIT)
+		{
+			if (variable->flags & SPIRV_BUILT_IN_FLAG ||
+				!(variable->flags & SPIRV_LOCATION_FLAG))
+			{
+				continue;
+			}
+
+			VkFormat format;
+			uint32_t attributeSize;
+
+			bool result = getSpirvVertexFormat(
+				ids,
+				idCount,
+				typeId,
+				&format,
+				&attributeSize);
+
+			if (!result)
+			{
+				destroyVkShaderReflection(reflectionInstance);
+				free(ids);
+				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			}
+
+			// Offset temporary holds attribute size
+			VkVertexInputAttributeDescription vertexAttribute = {
+				variable->location,
+				0,
+				format,
+				attributeSize,
+			};
+
+			vertexAttributes[vertexAttributeCount++] = vertexAttribute;
+		}
+	}
+
+	free(ids);
+
+	// Attributes are interleaved in the location order
+	for (uint32_t i = 1; i < vertexAttributeCount; i++)
+	{
+		VkVertexInputAttributeDescription vertexAttribute = vertexAttributes[i];
+		uint32_t j = i;
+
+		while (j > 0 && vertexAttributes[j - 1].location > vertexAttribute.location)
+		{
+			vertexAttributes[j] = vertexAttributes[j - 1];
+			j--;
+		}
+
+		vertexAttributes[j] = vertexAttribute;
+	}
+
+	uint32_t vertexStride = 0;
+
+	for (uint32_t i = 0; i < vertexAttributeCount; i++)
+	{
+		uint32_t attributeSize = vertexAttributes[i].offset;
+		vertexAttributes[i].offset = vertexStride;
+		vertexStride += attributeSize;
+	}
+
+	reflectionInstance->bindingCount = bindingCount;
+	reflectionInstance->vertexAttributeCount = vertexAttributeCount;
+	reflectionInstance->vertexStride = vertexStride;
+
+	if (pushConstantEnd > 0)
+	{
+		VkPushConstantRange pushConstantRange = {
+			stage,
+			pushConstantBegin,
+			pushConstantEnd - pushConstantBegin,
+		};
+
+		reflectionInstance->pushConstantRange = pushConstantRange;
+		reflectionInstance->pushConstantRangeCount = 1;
+	}
+
+	*reflection = reflectionInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static void destroyVkLayoutCache(
+	VkDevice device,
+	VkLayoutCache layoutCache)
+{
+	assert(device);
+
+	if (!layoutCache)
+		return;
+
+	VkReflectedLayout* layouts = layoutCache->layouts;
+	size_t layoutCount = layoutCache->layoutCount;
+
+	for (size_t i = 0; i < layoutCount; i++)
+	{
+		VkReflectedLayout layout = layouts[i];
+
+		if (layout->isLayoutOwner)
+		{
+			vkDestroyPipelineLayout(
+				device,
+				layout->layout,
+				NULL);
+		}
+
+		free(layout->vertexAttributes);
+		free(layout->setLayouts);
+		free(layout);
+	}
+
+	VkSetLayoutEntry* setLayouts = layoutCache->setLayouts;
+	size_t setLayoutCount = layoutCache->setLayoutCount;
+
+	for (size_t i = 0; i < setLayoutCount; i++)
+	{
+		vkDestroyDescriptorSetLayout(
+			device,
+			setLayouts[i].layout,
+			NULL);
+		free(setLayouts[i].bindings);
+	}
+
+	free(layouts);
+	free(setLayouts);
+	free(layoutCache);
+}
+inline static MpgxResult createVkLayoutCache(
+	VkLayoutCache* layoutCache)
+{
+	assert(layoutCache);
+
+	VkLayoutCache layoutCacheInstance = calloc(1,
+		sizeof(VkLayoutCache_T));
+
+	if (!layoutCacheInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	VkSetLayoutEntry* setLayouts = malloc(
+		sizeof(VkSetLayoutEntry));
+
+	if (!setLayouts)
+	{
+		free(layoutCacheInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	layoutCacheInstance->setLayouts = setLayouts;
+	layoutCacheInstance->setLayoutCapacity = 1;
+
+	VkReflectedLayout* layouts = malloc(
+		sizeof(VkReflectedLayout));
+
+	if (!layouts)
+	{
+		free(setLayouts);
+		free(layoutCacheInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	layoutCacheInstance->layouts = layouts;
+	layoutCacheInstance->layoutCapacity = 1;
+
+	*layoutCache = layoutCacheInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
+inline static MpgxResult getVkCachedSetLayout(
+	VkDevice device,
+	VkLayoutCache layoutCache,
+	const VkDescriptorSetLayoutBinding* bindings,
+	uint32_t bindingCount,
+	VkDescriptorSetLayout* setLayout)
+{
+	assert(device);
+	assert(layoutCache);
+	assert(bindingCount == 0 || bindings);
+	assert(setLayout);
+
+	VkSetLayoutEntry* setLayouts = layoutCache->setLayouts;
+	size_t setLayoutCount = layoutCache->setLayoutCount;
+
+	for (size_t i = 0; i < setLayoutCount; i++)
+	{
+		VkSetLayoutEntry* entry = &setLayouts[i];
+
+		if (entry->bindingCount != bindingCount)
+			continue;
+
+		bool isEqual = true;
+
+		for (uint32_t j = 0; j < bindingCount; j++)
+		{
+			const VkDescriptorSetLayoutBinding* a = &entry->bindings[j];
+			const VkDescriptorSetLayoutBinding* b = &bindings[j];
+
+			if (a->binding != b->binding ||
+				a->descriptorType != b->descriptorType ||
+				a->descriptorCount != b->descriptorCount ||
+				a->stageFlags != b->stageFlags)
+			{
+				isEqual = false;
+				break;
+			}
+		}
+
+		if (isEqual)
+		{
+			*setLayout = entry->layout;
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
+
+	if (setLayoutCount == layoutCache->setLayoutCapacity)
+	{
+		size_t capacity = layoutCache->setLayoutCapacity * 2;
+
+		setLayouts = realloc(setLayouts,
+			capacity * sizeof(VkSetLayoutEntry));
+
+		if (!setLayouts)
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+		layoutCache->setLayouts = setLayouts;
+		layoutCache->setLayoutCapacity = capacity;
+	}
+
+	VkDescriptorSetLayoutBinding* entryBindings = NULL;
+
+	if (bindingCount > 0)
+	{
+		entryBindings = malloc(
+			bindingCount * sizeof(VkDescriptorSetLayoutBinding));
+
+		if (!entryBindings)
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+		memcpy(entryBindings, bindings,
+			bindingCount * sizeof(VkDescriptorSetLayoutBinding));
+	}
+
+	VkDescriptorSetLayoutCreateInfo createInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		NULL,
+		0,
+		bindingCount,
+		entryBindings,
+	};
+
+	VkDescriptorSetLayout layout;
+
+	VkResult vkResult = vkCreateDescriptorSetLayout(
+		device,
+		&createInfo,
+		NULL,
+		&layout);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		free(entryBindings);
+		return vkToMpgxResult(vkResult);
+	}
+
+	VkSetLayoutEntry entry = {
+		entryBindings,
+		bindingCount,
+		layout,
+	};
+
+	setLayouts[setLayoutCount] = entry;
+	layoutCache->setLayoutCount = setLayoutCount + 1;
+
+	*setLayout = layout;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static bool isVkReflectedLayoutEqual(
+	VkReflectedLayout layout,
+	const VkDescriptorSetLayout* setLayouts,
+	uint32_t setLayoutCount,
+	const VkPushConstantRange* pushConstantRange,
+	uint32_t pushConstantRangeCount)
+{
+	assert(layout);
+
+	if (layout->setLayoutCount != setLayoutCount ||
+		layout->pushConstantRangeCount != pushConstantRangeCount)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < setLayoutCount; i++)
+	{
+		if (layout->setLayouts[i] != setLayouts[i])
+			return false;
+	}
+
+	if (pushConstantRangeCount > 0)
+	{
+		const VkPushConstantRange* range = &layout->pushConstantRange;
+
+		if (range->stageFlags != pushConstantRange->stageFlags ||
+			range->offset != pushConstantRange->offset ||
+			range->size != pushConstantRange->size)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+inline static bool isVkReflectedVertexInputEqual(
+	VkReflectedLayout layout,
+	const VkShaderReflection vertexReflection)
+{
+	assert(layout);
+
+	uint32_t vertexAttributeCount = vertexReflection ?
+		vertexReflection->vertexAttributeCount : 0;
+
+	if (layout->vertexAttributeCount != vertexAttributeCount)
+		return false;
+
+	for (uint32_t i = 0; i < vertexAttributeCount; i++)
+	{
+		const VkVertexInputAttributeDescription* a =
+			&layout->vertexAttributes[i];
+		const VkVertexInputAttributeDescription* b =
+			&vertexReflection->vertexAttributes[i];
+
+		if (a->location != b->location ||
+			a->format != b->format ||
+			a->offset != b->offset)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+inline static MpgxResult createVkReflectedLayoutEntry(
+	VkDevice device,
+	VkLayoutCache layoutCache,
+	const VkDescriptorSetLayout* setLayouts,
+	uint32_t setLayoutCount,
+	const VkPushConstantRange* pushConstantRange,
+	uint32_t pushConstantRangeCount,
+	const VkShaderReflection vertexReflection,
+	VkReflectedLayout* layout)
+{
+	assert(device);
+	assert(layoutCache);
+	assert(layout);
+
+	VkReflectedLayout layoutInstance = calloc(1,
+		sizeof(VkReflectedLayout_T));
+
+	if (!layoutInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	if (setLayoutCount > 0)
+	{
+		VkDescriptorSetLayout* layoutSetLayouts = malloc(
+			setLayoutCount * sizeof(VkDescriptorSetLayout));
+
+		if (!layoutSetLayouts)
+		{
+			free(layoutInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		memcpy(layoutSetLayouts, setLayouts,
+			setLayoutCount * sizeof(VkDescriptorSetLayout));
+
+		layoutInstance->setLayouts = layoutSetLayouts;
+		layoutInstance->setLayoutCount = setLayoutCount;
+	}
+
+	if (pushConstantRangeCount > 0)
+	{
+		layoutInstance->pushConstantRange = *pushConstantRange;
+		layoutInstance->pushConstantRangeCount = 1;
+	}
+
+	if (vertexReflection && vertexReflection->vertexAttributeCount > 0)
+	{
+		uint32_t vertexAttributeCount = vertexReflection->vertexAttributeCount;
+
+		VkVertexInputAttributeDescription* vertexAttributes = malloc(
+			vertexAttributeCount * sizeof(VkVertexInputAttributeDescription));
+
+		if (!vertexAttributes)
+		{
+			free(layoutInstance->setLayouts);
+			free(layoutInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		memcpy(vertexAttributes, vertexReflection->vertexAttributes,
+			vertexAttributeCount * sizeof(VkVertexInputAttributeDescription));
+
+		VkVertexInputBindingDescription vertexBinding = {
+			0,
+			vertexReflection->vertexStride,
+			VK_VERTEX_INPUT_RATE_VERTEX,
+		};
+
+		layoutInstance->vertexBinding = vertexBinding;
+		layoutInstance->vertexBindingCount = 1;
+		layoutInstance->vertexAttributes = vertexAttributes;
+		layoutInstance->vertexAttributeCount = vertexAttributeCount;
+	}
+
+	VkReflectedLayout* layouts = layoutCache->layouts;
+	size_t layoutCount = layoutCache->layoutCount;
+
+	// Pipeline layout is shared with the other vertex inputs
+	for (size_t i = 0; i < layoutCount; i++)
+	{
+		VkReflectedLayout otherLayout = layouts[i];
+
+		bool isEqual = isVkReflectedLayoutEqual(
+			otherLayout,
+			setLayouts,
+			setLayoutCount,
+			pushConstantRange,
+			pushConstantRangeCount);
+
+		if (isEqual)
+		{
+			layoutInstance->layout = otherLayout->layout;
+			layoutInstance->isLayoutOwner = false;
+			break;
+		}
+	}
+
+	if (!layoutInstance->layout)
+	{
+		VkPipelineLayoutCreateInfo createInfo = {
+			VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			NULL,
+			0,
+			setLayoutCount,
+			setLayouts,
+			pushConstantRangeCount,
+			pushConstantRange,
+		};
+
+		VkPipelineLayout pipelineLayout;
+
+		VkResult vkResult = vkCreatePipelineLayout(
+			device,
+			&createInfo,
+			NULL,
+			&pipelineLayout);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			free(layoutInstance->vertexAttributes);
+			free(layoutInstance->setLayouts);
+			free(layoutInstance);
+			return vkToMpgxResult(vkResult);
+		}
+
+		layoutInstance->layout = pipelineLayout;
+		layoutInstance->isLayoutOwner = true;
+	}
+
+	if (layoutCount == layoutCache->layoutCapacity)
+	{
+		size_t capacity = layoutCache->layoutCapacity * 2;
+
+		layouts = realloc(layouts,
+			capacity * sizeof(VkReflectedLayout));
+
+		if (!layouts)
+		{
+			if (layoutInstance->isLayoutOwner)
+			{
+				vkDestroyPipelineLayout(
+					device,
+					layoutInstance->layout,
+					NULL);
+			}
+
+			free(layoutInstance->vertexAttributes);
+			free(layoutInstance->setLayouts);
+			free(layoutInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		layoutCache->layouts = layouts;
+		layoutCache->layoutCapacity = capacity;
+	}
+
+	layouts[layoutCount] = layoutInstance;
+	layoutCache->layoutCount = layoutCount + 1;
+
+	*layout = layoutInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult getVkReflectedLayout(
+	VkDevice device,
+	VkLayoutCache layoutCache,
+	const VkShaderReflection* reflections,
+	size_t reflectionCount,
+	VkReflectedLayout* layout)
+{
+	assert(device);
+	assert(layoutCache);
+	assert(reflections);
+	assert(reflectionCount > 0);
+	assert(layout);
+
+	uint32_t totalBindingCount = 0;
+	VkShaderReflection vertexReflection = NULL;
+
+	VkPushConstantRange pushConstantRange = {
+		0,
+		UINT32_MAX,
+		0,
+	};
+
+	uint32_t pushConstantEnd = 0;
+
+	for (size_t i = 0; i < reflectionCount; i++)
+	{
+		VkShaderReflection reflection = reflections[i];
+		totalBindingCount += reflection->bindingCount;
+
+		if (reflection->vertexAttributeCount > 0)
+			vertexReflection = reflection;
+
+		if (reflection->pushConstantRangeCount > 0)
+		{
+			const VkPushConstantRange* range = &reflection->pushConstantRange;
+			uint32_t rangeEnd = range->offset + range->size;
+
+			pushConstantRange.stageFlags |= range->stageFlags;
+
+			if (range->offset < pushConstantRange.offset)
+				pushConstantRange.offset = range->offset;
+			if (rangeEnd > pushConstantEnd)
+				pushConstantEnd = rangeEnd;
+		}
+	}
+
+	uint32_t pushConstantRangeCount = 0;
+
+	if (pushConstantEnd > 0)
+	{
+		pushConstantRange.size = pushConstantEnd - pushConstantRange.offset;
+		pushConstantRangeCount = 1;
+	}
+
+	VkDescriptorSetLayoutBinding* bindings = NULL;
+	uint32_t* bindingSets = NULL;
+	uint32_t bindingCount = 0, setLayoutCount = 0;
+
+	if (totalBindingCount > 0)
+	{
+		bindings = malloc(totalBindingCount *
+			sizeof(VkDescriptorSetLayoutBinding));
+
+		if (!bindings)
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+		bindingSets = malloc(totalBindingCount * sizeof(uint32_t));
+
+		if (!bindingSets)
+		{
+			free(bindings);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+	}
+
+	// Same bindings from the different stages are merged
+	for (size_t i = 0; i < reflectionCount; i++)
+	{
+		VkShaderReflection reflection = reflections[i];
+
+		for (uint32_t j = 0; j < reflection->bindingCount; j++)
+		{
+			const VkDescriptorSetLayoutBinding* binding =
+				&reflection->bindings[j];
+			uint32_t set = reflection->bindingSets[j];
+
+			uint32_t k = 0;
+
+			for (; k < bindingCount; k++)
+			{
+				if (bindingSets[k] == set &&
+					bindings[k].binding == binding->binding)
+				{
+					break;
+				}
+			}
+
+			if (k < bindingCount)
+			{
+				if (bindings[k].descriptorType != binding->descriptorType ||
+					bindings[k].descriptorCount != binding->descriptorCount)
+				{
+					free(bindingSets);
+					free(bindings);
+					return BAD_SHADER_CODE_MPGX_RESULT;
+				}
+
+				bindings[k].stageFlags |= binding->stageFlags;
+				continue;
+			}
+
+			bindings[bindingCount] = *binding;
+			bindingSets[bindingCount] = set;
+			bindingCount++;
+
+			if (set + 1 > setLayoutCount)
+				setLayoutCount = set + 1;
+		}
+	}
+
+	VkDescriptorSetLayout* setLayouts = NULL;
+	VkDescriptorSetLayoutBinding* setBindings = NULL;
+
+	if (setLayoutCount > 0)
+	{
+		setLayouts = malloc(setLayoutCount *
+			sizeof(VkDescriptorSetLayout));
+
+		if (!setLayouts)
+		{
+			free(bindingSets);
+			free(bindings);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		setBindings = malloc(bindingCount *
+			sizeof(VkDescriptorSetLayoutBinding));
+
+		if (!setBindings)
+		{
+			free(setLayouts);
+			free(bindingSets);
+			free(bindings);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+	}
+
+	for (uint32_t i = 0; i < setLayoutCount; i++)
+	{
+		uint32_t setBindingCount = 0;
+
+		// Bindings are sorted to get the same cache entry
+		for (uint32_t j = 0; j < bindingCount; j++)
+		{
+			if (bindingSets[j] != i)
+				continue;
+
+			VkDescriptorSetLayoutBinding binding = bindings[j];
+			uint32_t k = setBindingCount;
+
+			while (k > 0 && setBindings[k - 1].binding > binding.binding)
+			{
+				setBindings[k] = setBindings[k - 1];
+				k--;
+			}
+
+			setBindings[k] = binding;
+			setBindingCount++;
+		}
+
+		MpgxResult mpgxResult = getVkCachedSetLayout(
+			device,
+			layoutCache,
+			setBindings,
+			setBindingCount,
+			&setLayouts[i]);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			free(setBindings);
+			free(setLayouts);
+			free(bindingSets);
+			free(bindings);
+			return mpgxResult;
+		}
+	}
+
+	free(setBindings);
+	free(bindingSets);
+	free(bindings);
+
+	VkReflectedLayout* layouts = layoutCache->layouts;
+	size_t layoutCount = layoutCache->layoutCount;
+
+	for (size_t i = 0; i < layoutCount; i++)
+	{
+		VkReflectedLayout otherLayout = layouts[i];
+
+		bool isEqual = isVkReflectedLayoutEqual(
+			otherLayout,
+			setLayouts,
+			setLayoutCount,
+			&pushConstantRange,
+			pushConstantRangeCount);
+		isEqual &= isVkReflectedVertexInputEqual(
+			otherLayout,
+			vertexReflection);
+
+		if (isEqual)
+		{
+			free(setLayouts);
+			*layout = otherLayout;
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
+
+	MpgxResult mpgxResult = createVkReflectedLayoutEntry(
+		device,
+		layoutCache,
+		setLayouts,
+		setLayoutCount,
+		&pushConstantRange,
+		pushConstantRangeCount,
+		vertexReflection,
+		layout);
+
+	free(setLayouts);
+	return mpgxResult;
+}
+#endif
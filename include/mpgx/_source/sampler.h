@@ -30,6 +30,8 @@ typedef struct BaseSampler_T
 	bool useCompare;
 	Vec2F mipmapLodRange;
 	float mipmapLodBias;
+	float maxAnisotropy;
+	size_t refCount;
 } BaseSampler_T;
 #if MPGX_SUPPORT_VULKAN
 typedef struct VkSampler_T
@@ -46,6 +48,8 @@ typedef struct VkSampler_T
 	bool useCompare;
 	Vec2F mipmapLodRange;
 	float mipmapLodBias;
+	float maxAnisotropy;
+	size_t refCount;
 	VkSampler handle;
 } VkSampler_T;
 #endif
@@ -64,6 +68,8 @@ typedef struct GlSampler_T
 	bool useCompare;
 	Vec2F mipmapLodRange;
 	float mipmapLodBias;
+	float maxAnisotropy;
+	size_t refCount;
 	GLuint handle;
 } GlSampler_T;
 #endif
@@ -160,6 +166,29 @@ inline static bool getVkImageWrap(
 		return false;
 	}
 }
+inline static float getVkMaxSamplerAnisotropy(
+	VkPhysicalDevice physicalDevice)
+{
+	assert(physicalDevice);
+
+	VkPhysicalDeviceFeatures features;
+
+	vkGetPhysicalDeviceFeatures(
+		physicalDevice,
+		&features);
+
+	// Supported features are enabled on the device creation
+	if (!features.samplerAnisotropy)
+		return 1.0f;
+
+	VkPhysicalDeviceProperties properties;
+
+	vkGetPhysicalDeviceProperties(
+		physicalDevice,
+		&properties);
+
+	return properties.limits.maxSamplerAnisotropy;
+}
 
 inline static void destroyVkSampler(
 	VkDevice device,
@@ -190,6 +219,7 @@ inline static MpgxResult createVkSampler(
 	bool useCompare,
 	Vec2F mipmapLodRange,
 	float mipmapLodBias,
+	float maxAnisotropy,
 	Sampler* sampler)
 {
 	assert(device);
@@ -201,6 +231,7 @@ inline static MpgxResult createVkSampler(
 	assert(imageWrapY < IMAGE_WRAP_COUNT);
 	assert(imageWrapZ < IMAGE_WRAP_COUNT);
 	assert(depthCompare < COMPARE_OPERATOR_COUNT);
+	assert(maxAnisotropy >= 1.0f);
 	assert(sampler);
 
 	Sampler samplerInstance = calloc(1,
@@ -221,6 +252,7 @@ inline static MpgxResult createVkSampler(
 	samplerInstance->vk.useCompare = useCompare;
 	samplerInstance->vk.mipmapLodRange = mipmapLodRange;
 	samplerInstance->vk.mipmapLodBias = mipmapLodBias;
+	samplerInstance->vk.maxAnisotropy = maxAnisotropy;
 
 	VkFilter minFilter, magFilter;
 	VkSamplerMipmapMode mipmapMode;
@@ -268,8 +300,8 @@ inline static MpgxResult createVkSampler(
 		wrapY,
 		wrapZ,
 		mipmapLodBias,
-		VK_FALSE, // TODO
-		1.0f,
+		maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE,
+		maxAnisotropy,
 		useCompare ? VK_TRUE : VK_FALSE,
 		compare,
 		mipmapLodRange.x,
@@ -394,6 +426,20 @@ inline static bool getGlImageWrap(
 		return false;
 	}
 }
+inline static float getGlMaxSamplerAnisotropy()
+{
+	if (!GLAD_GL_EXT_texture_filter_anisotropic)
+		return 1.0f;
+
+	GLfloat maxAnisotropy = 1.0f;
+
+	glGetFloatv(
+		GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT,
+		&maxAnisotropy);
+	assertOpenGL();
+
+	return (float)maxAnisotropy;
+}
 
 inline static void destroyGlSampler(
 	Sampler sampler)
@@ -423,6 +469,7 @@ inline static MpgxResult createGlSampler(
 	CompareOperator depthCompare,
 	bool useCompare,
 	Vec2F mipmapLodRange,
+	float maxAnisotropy,
 	Sampler* sampler)
 {
 	assert(window);
@@ -433,6 +480,7 @@ inline static MpgxResult createGlSampler(
 	assert(imageWrapY < IMAGE_WRAP_COUNT);
 	assert(imageWrapZ < IMAGE_WRAP_COUNT);
 	assert(depthCompare < COMPARE_OPERATOR_COUNT);
+	assert(maxAnisotropy >= 1.0f);
 	assert(sampler);
 
 	Sampler samplerInstance = calloc(1,
@@ -453,6 +501,7 @@ inline static MpgxResult createGlSampler(
 	samplerInstance->gl.useCompare = useCompare;
 	samplerInstance->gl.mipmapLodRange = mipmapLodRange;
 	samplerInstance->gl.mipmapLodBias = 0.0f;
+	samplerInstance->gl.maxAnisotropy = maxAnisotropy;
 
 	makeGlWindowContextCurrent(window);
 
@@ -536,6 +585,14 @@ inline static MpgxResult createGlSampler(
 		GL_TEXTURE_MAX_LOD,
 		(GLfloat)mipmapLodRange.y);
 
+	if (maxAnisotropy > 1.0f)
+	{
+		glSamplerParameterf(
+			handle,
+			GL_TEXTURE_MAX_ANISOTROPY_EXT,
+			(GLfloat)maxAnisotropy);
+	}
+
 	GLenum glError = glGetError();
 
 	if (glError != GL_NO_ERROR)
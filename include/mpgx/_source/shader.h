@@ -15,8 +15,9 @@
 #pragma once
 #include "mpgx/_source/vulkan.h"
 #include "mpgx/_source/opengl.h"
+#include "mpgx/_source/reflection.h"
 
-#include "mpgx/md5.h"
+#include "mpgx/xxhash.h"
 #include <string.h>
 
 #if MPGX_SUPPORT_OPENGL
@@ -26,34 +27,41 @@
 typedef struct BaseShader_T
 {
 	Window window;
+	uint64_t hash;
+	size_t size;
+	size_t refCount;
+	uint8_t* hashedCode;
 	ShaderType type;
-#ifndef NDEBUG
-	uint8_t hash[MD5_BLOCK_SIZE];
-#endif
 } BaseShader_T;
 #if MPGX_SUPPORT_VULKAN
 typedef struct VkShader_T
 {
 	Window window;
+	uint64_t hash;
+	size_t size;
+	size_t refCount;
+	uint8_t* hashedCode;
 	ShaderType type;
-#ifndef NDEBUG
-	uint8_t hash[MD5_BLOCK_SIZE];
-#endif
 	uint8_t _alignment[3];
 	VkShaderStageFlags stage;
 	VkShaderModule handle;
+	VkShaderReflection reflection;
 } VkShader_T;
 #endif
 #if MPGX_SUPPORT_OPENGL
 typedef struct GlShader_T
 {
 	Window window;
+	uint64_t hash;
+	size_t size;
+	size_t refCount;
+	uint8_t* hashedCode;
 	ShaderType type;
-#ifndef NDEBUG
-	uint8_t hash[MD5_BLOCK_SIZE];
-#endif
 	uint8_t _alignment[3];
 	GLuint handle;
+	GLenum glType;
+	char* code;
+	GLint codeSize;
 } GlShader_T;
 #endif
 union Shader_T
@@ -77,10 +85,12 @@ inline static void destroyVkShader(
 	if (!shader)
 		return;
 
+	destroyVkShaderReflection(shader->vk.reflection);
 	vkDestroyShaderModule(
 		device,
 		shader->vk.handle,
 		NULL);
+	free(shader->vk.hashedCode);
 	free(shader);
 }
 inline static MpgxResult createVkShader(
@@ -172,9 +182,74 @@ inline static MpgxResult createVkShader(
 
 	shaderInstance->vk.handle = handle;
 
+	VkShaderReflection reflection;
+
+	MpgxResult mpgxResult = createVkShaderReflection(
+		code,
+		size,
+		stage,
+		&reflection);
+
+	// Shaders with not reflectable layout are still usable
+	// with the manually specified pipeline create data.
+	if (mpgxResult == OUT_OF_HOST_MEMORY_MPGX_RESULT)
+	{
+		destroyVkShader(
+			device,
+			shaderInstance);
+		return mpgxResult;
+	}
+
+	shaderInstance->vk.reflection = mpgxResult == SUCCESS_MPGX_RESULT ?
+		reflection : NULL;
+
 	*shader = shaderInstance;
 	return SUCCESS_MPGX_RESULT;
 }
+
+inline static MpgxResult createVkSpecializationInfo(
+	const VkSpecializationInfo* source,
+	VkSpecializationInfo** specializationInfo)
+{
+	assert(specializationInfo);
+
+	if (!source)
+	{
+		*specializationInfo = NULL;
+		return SUCCESS_MPGX_RESULT;
+	}
+
+	assert(source->mapEntryCount == 0 || source->pMapEntries);
+	assert(source->dataSize == 0 || source->pData);
+
+	size_t mapEntrySize = source->mapEntryCount *
+		sizeof(VkSpecializationMapEntry);
+
+	// Map entries and constant data are stored in one block
+	VkSpecializationInfo* specializationInfoInstance = malloc(
+		sizeof(VkSpecializationInfo) + mapEntrySize + source->dataSize);
+
+	if (!specializationInfoInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	uint8_t* mapEntries = (uint8_t*)specializationInfoInstance +
+		sizeof(VkSpecializationInfo);
+	uint8_t* data = mapEntries + mapEntrySize;
+
+	if (mapEntrySize > 0)
+		memcpy(mapEntries, source->pMapEntries, mapEntrySize);
+	if (source->dataSize > 0)
+		memcpy(data, source->pData, source->dataSize);
+
+	specializationInfoInstance->mapEntryCount = source->mapEntryCount;
+	specializationInfoInstance->pMapEntries =
+		(const VkSpecializationMapEntry*)mapEntries;
+	specializationInfoInstance->dataSize = source->dataSize;
+	specializationInfoInstance->pData = data;
+
+	*specializationInfo = specializationInfoInstance;
+	return SUCCESS_MPGX_RESULT;
+}
 #endif
 
 #if MPGX_SUPPORT_OPENGL
@@ -218,52 +293,29 @@ inline static void destroyGlShader(
 	glDeleteShader(shader->gl.handle);
 	assertOpenGL();
 
+	free(shader->gl.hashedCode);
+	free(shader->gl.code);
 	free(shader);
 }
-inline static MpgxResult createGlShader(
-	Window window,
-	ShaderType type,
-	const void* code,
-	size_t size,
-	GraphicsAPI api,
-	Shader* shader)
+inline static MpgxResult compileGlShader(
+	Shader shader)
 {
-	assert(window);
-	assert(type < SHADER_TYPE_COUNT);
-	assert(code);
-	assert(size > 0);
-	assert(api < GRAPHICS_API_COUNT);
 	assert(shader);
-
-	Shader shaderInstance = calloc(1, sizeof(Shader_T));
-
-	if (!shaderInstance)
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-
-	shaderInstance->gl.window = window;
-	shaderInstance->gl.type = type;
-
-	GLenum glType;
-
-	if (!getGlShaderType(type, &glType))
-	{
-		destroyGlShader(shaderInstance);
-		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-	}
+	assert(shader->gl.code);
+	assert(shader->gl.handle == GL_ZERO);
 
 	const char* sources[2] = {
 		OPENGL_SHADER_HEADER,
-		(const char*)code,
+		shader->gl.code,
 	};
 	GLint lengths[2] = {
 		(GLint)strlen(OPENGL_SHADER_HEADER),
-		(GLint)size
+		shader->gl.codeSize,
 	};
 
-	makeGlWindowContextCurrent(window);
+	makeGlWindowContextCurrent(shader->gl.window);
 
-	GLuint handle = glCreateShader(glType);
-	shaderInstance->gl.handle = handle;
+	GLuint handle = glCreateShader(shader->gl.glType);
 
 	glShaderSource(
 		handle,
@@ -296,7 +348,7 @@ inline static MpgxResult createGlShader(
 
 			if (!infoLog)
 			{
-				destroyGlShader(shaderInstance);
+				glDeleteShader(handle);
 				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 			}
 
@@ -306,6 +358,7 @@ inline static MpgxResult createGlShader(
 				&length,
 				(GLchar*)infoLog);
 
+			ShaderType type = shader->gl.type;
 			const char* typeString;
 
 			if (type == VERTEX_SHADER_TYPE)
@@ -322,9 +375,9 @@ inline static MpgxResult createGlShader(
 			free(infoLog);
 		}
 
+		// Failed shader keeps the source and stays uncompiled
+		glDeleteShader(handle);
 		assertOpenGL();
-
-		destroyGlShader(shaderInstance);
 		return BAD_SHADER_CODE_MPGX_RESULT;
 	}
 
@@ -332,10 +385,78 @@ inline static MpgxResult createGlShader(
 
 	if (glError != GL_NO_ERROR)
 	{
-		destroyGlShader(shaderInstance);
+		glDeleteShader(handle);
 		return glToMpgxResult(glError);
 	}
 
+	shader->gl.handle = handle;
+
+	// Source is released only after the successful compile
+	free(shader->gl.code);
+	shader->gl.code = NULL;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createGlShader(
+	Window window,
+	ShaderType type,
+	const void* code,
+	size_t size,
+	GraphicsAPI api,
+	bool useLazyCompile,
+	Shader* shader)
+{
+	assert(window);
+	assert(type < SHADER_TYPE_COUNT);
+	assert(code);
+	assert(size > 0);
+	assert(api < GRAPHICS_API_COUNT);
+	assert(shader);
+
+	Shader shaderInstance = calloc(1, sizeof(Shader_T));
+
+	if (!shaderInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	shaderInstance->gl.window = window;
+	shaderInstance->gl.type = type;
+
+	GLenum glType;
+
+	if (!getGlShaderType(type, &glType))
+	{
+		destroyGlShader(shaderInstance);
+		return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+	}
+
+	shaderInstance->gl.glType = glType;
+
+	char* shaderCode = malloc(size * sizeof(char));
+
+	if (!shaderCode)
+	{
+		destroyGlShader(shaderInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	memcpy(shaderCode, code, size);
+
+	shaderInstance->gl.code = shaderCode;
+	shaderInstance->gl.codeSize = (GLint)size;
+
+	// Lazy shader is compiled only if program
+	// binary is not found in the program cache.
+	if (!useLazyCompile)
+	{
+		MpgxResult mpgxResult = compileGlShader(
+			shaderInstance);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyGlShader(shaderInstance);
+			return mpgxResult;
+		}
+	}
+
 	*shader = shaderInstance;
 	return SUCCESS_MPGX_RESULT;
 }
@@ -30,12 +30,16 @@ typedef struct VkSwapchainBuffer
 typedef struct VkSwapchain_T
 {
 	VkSwapchainKHR handle;
+	VkImage colorImage;
+	VmaAllocation colorAllocation;
+	VkImageView colorImageView;
 	VkImage depthImage;
 	VmaAllocation depthAllocation;
 	VkImageView depthImageView;
 	VkRenderPass renderPass;
 	VkSwapchainBuffer* buffers;
 	uint32_t bufferCount;
+	VkSampleCountFlagBits sampleCount;
 } VkSwapchain_T;
 
 typedef VkSwapchain_T* VkSwapchain;
@@ -431,6 +435,7 @@ inline static MpgxResult createVkDepthImage(
 	VmaAllocator allocator,
 	VkFormat format,
 	VkExtent2D extent,
+	VkSampleCountFlagBits sampleCount,
 	VkImage* depthImage,
 	VmaAllocation* depthAllocation)
 {
@@ -447,9 +452,10 @@ inline static MpgxResult createVkDepthImage(
 		{ extent.width, extent.height, 1, },
 		1,
 		1,
-		VK_SAMPLE_COUNT_1_BIT,
+		sampleCount,
 		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
 		VK_SHARING_MODE_EXCLUSIVE,
 		0,
 		NULL,
@@ -462,12 +468,13 @@ inline static MpgxResult createVkDepthImage(
 	allocationCreateInfo.flags =
 		VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT |
 		VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
-	allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-	// TODO: VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED on mobiles
+	allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
 
 	VkImage depthImageInstance;
 	VmaAllocation depthAllocationInstance;
 
+	// Depth buffer is never stored, so it can stay in
+	// the tile memory on the devices with lazily allocated memory.
 	VkResult vkResult = vmaCreateImage(
 		allocator,
 		&imageCreateInfo,
@@ -477,7 +484,20 @@ inline static MpgxResult createVkDepthImage(
 		NULL);
 
 	if (vkResult != VK_SUCCESS)
-		return vkToMpgxResult(vkResult);
+	{
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+		vkResult = vmaCreateImage(
+			allocator,
+			&imageCreateInfo,
+			&allocationCreateInfo,
+			&depthImageInstance,
+			&depthAllocationInstance,
+			NULL);
+
+		if (vkResult != VK_SUCCESS)
+			return vkToMpgxResult(vkResult);
+	}
 
 	*depthImage = depthImageInstance;
 	*depthAllocation = depthAllocationInstance;
@@ -530,10 +550,131 @@ inline static MpgxResult createVkDepthImageView(
 	return SUCCESS_MPGX_RESULT;
 }
 
+inline static MpgxResult createVkColorImage(
+	VmaAllocator allocator,
+	VkFormat format,
+	VkExtent2D extent,
+	VkSampleCountFlagBits sampleCount,
+	VkImage* colorImage,
+	VmaAllocation* colorAllocation)
+{
+	assert(allocator);
+	assert(sampleCount > VK_SAMPLE_COUNT_1_BIT);
+	assert(colorImage);
+	assert(colorAllocation);
+
+	VkImageCreateInfo imageCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		NULL,
+		0,
+		VK_IMAGE_TYPE_2D,
+		format,
+		{ extent.width, extent.height, 1, },
+		1,
+		1,
+		sampleCount,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		NULL,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+
+	VmaAllocationCreateInfo allocationCreateInfo;
+	memset(&allocationCreateInfo, 0, sizeof(VmaAllocationCreateInfo));
+
+	allocationCreateInfo.flags =
+		VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT |
+		VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+	allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+
+	VkImage colorImageInstance;
+	VmaAllocation colorAllocationInstance;
+
+	// Multisampled color is resolved inside the
+	// render pass, so it is never stored to the memory.
+	VkResult vkResult = vmaCreateImage(
+		allocator,
+		&imageCreateInfo,
+		&allocationCreateInfo,
+		&colorImageInstance,
+		&colorAllocationInstance,
+		NULL);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+		vkResult = vmaCreateImage(
+			allocator,
+			&imageCreateInfo,
+			&allocationCreateInfo,
+			&colorImageInstance,
+			&colorAllocationInstance,
+			NULL);
+
+		if (vkResult != VK_SUCCESS)
+			return vkToMpgxResult(vkResult);
+	}
+
+	*colorImage = colorImageInstance;
+	*colorAllocation = colorAllocationInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult createVkColorImageView(
+	VkDevice device,
+	VkImage image,
+	VkFormat format,
+	VkImageView* imageView)
+{
+	assert(device);
+	assert(image);
+	assert(imageView);
+
+	VkImageViewCreateInfo createInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		NULL,
+		0,
+		image,
+		VK_IMAGE_VIEW_TYPE_2D,
+		format,
+		{
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY
+		},
+		{
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			0,
+			1,
+			0,
+			1,
+		}
+	};
+
+	VkImageView imageViewInstance;
+
+	VkResult vkResult = vkCreateImageView(
+		device,
+		&createInfo,
+		NULL,
+		&imageViewInstance);
+
+	if(vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	*imageView = imageViewInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
 inline static MpgxResult createVkRenderPass(
 	VkDevice device,
 	VkFormat colorFormat,
 	VkFormat depthFormat,
+	VkSampleCountFlagBits sampleCount,
 	bool useBeginClear,
 	bool useDeferredShading,
 	VkRenderPass* renderPass)
@@ -541,28 +682,35 @@ inline static MpgxResult createVkRenderPass(
 	assert(device);
 	assert(renderPass);
 
-	// TODO: create deferred rendering render pass.
-	//  Mostly useful for tiled devices. (mobile GPUs)
+	// Deferred shading is done in the separate
+	// framebuffer, see createDeferredFramebuffer().
 	assert(!useDeferredShading);
 
-	VkAttachmentDescription attachmentDescriptions[2] = {
+	bool useMultisampling = sampleCount > VK_SAMPLE_COUNT_1_BIT;
+
+	// Multisampled color is resolved to the swapchain image
+	VkAttachmentDescription attachmentDescriptions[3] = {
 		{
 			0,
 			colorFormat,
-			VK_SAMPLE_COUNT_1_BIT,
+			sampleCount,
 			useBeginClear ?
 				VK_ATTACHMENT_LOAD_OP_CLEAR :
 				VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-			VK_ATTACHMENT_STORE_OP_STORE,
+			useMultisampling ?
+				VK_ATTACHMENT_STORE_OP_DONT_CARE :
+				VK_ATTACHMENT_STORE_OP_STORE,
 			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			VK_ATTACHMENT_STORE_OP_DONT_CARE,
 			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+			useMultisampling ?
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL :
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 		},
 		{
 			0,
 			depthFormat,
-			VK_SAMPLE_COUNT_1_BIT,
+			sampleCount,
 			useBeginClear ?
 				VK_ATTACHMENT_LOAD_OP_CLEAR :
 				VK_ATTACHMENT_LOAD_OP_DONT_CARE,
@@ -572,6 +720,17 @@ inline static MpgxResult createVkRenderPass(
 			VK_IMAGE_LAYOUT_UNDEFINED,
 			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
 		},
+		{
+			0,
+			colorFormat,
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_STORE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+		},
 	};
 
 	VkAttachmentReference colorAttachmentReference = {
@@ -582,6 +741,10 @@ inline static MpgxResult createVkRenderPass(
 		1,
 		VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
 	};
+	VkAttachmentReference resolveAttachmentReference = {
+		2,
+		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+	};
 
 	VkSubpassDescription subpassDescription = {
 		0,
@@ -590,7 +753,8 @@ inline static MpgxResult createVkRenderPass(
 		NULL,
 		1,
 		&colorAttachmentReference,
-		NULL,
+		useMultisampling ?
+			&resolveAttachmentReference : NULL,
 		&depthAttachmentReference,
 		0,
 		NULL
@@ -608,7 +772,7 @@ inline static MpgxResult createVkRenderPass(
 		VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
 		NULL,
 		0,
-		2,
+		useMultisampling ? 3 : 2,
 		attachmentDescriptions,
 		1,
 		&subpassDescription,
@@ -692,6 +856,7 @@ inline static MpgxResult createVkSwapchainBuffers(
 	VkCommandPool graphicsCommandPool,
 	VkCommandPool presentCommandPool,
 	VkFormat surfaceFormat,
+	VkImageView colorImageView,
 	VkImageView depthImageView,
 	VkExtent2D surfaceExtent,
 	VkSwapchainBuffer** buffers,
@@ -767,16 +932,20 @@ inline static MpgxResult createVkSwapchainBuffers(
 			1,
 		},
 	};
-	VkImageView imageViews[2] = {
-		NULL,
+	// Swapchain image is the resolve target if multisampled
+	VkImageView imageViews[3] = {
+		colorImageView,
 		depthImageView,
+		NULL,
 	};
+	uint32_t swapchainViewIndex = colorImageView ? 2 : 0;
+
 	VkFramebufferCreateInfo framebufferCreateInfo = {
 		VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
 		NULL,
 		0,
 		renderPass,
-		2,
+		colorImageView ? 3 : 2,
 		imageViews,
 		surfaceExtent.width,
 		surfaceExtent.height,
@@ -838,7 +1007,7 @@ inline static MpgxResult createVkSwapchainBuffers(
 			return vkToMpgxResult(vkResult);
 		}
 
-		imageViews[0] = imageView;
+		imageViews[swapchainViewIndex] = imageView;
 
 		VkFramebuffer framebuffer;
 
@@ -1062,6 +1231,14 @@ inline static void destroyVkSwapchain(
 		allocator,
 		swapchain->depthImage,
 		swapchain->depthAllocation);
+	vkDestroyImageView(
+		device,
+		swapchain->colorImageView,
+		NULL);
+	vmaDestroyImage(
+		allocator,
+		swapchain->colorImage,
+		swapchain->colorAllocation);
 	vkDestroySwapchainKHR(
 		device,
 		swapchain->handle,
@@ -1079,6 +1256,7 @@ inline static MpgxResult createVkSwapchain(
 	VkCommandPool presentCommandPool,
 	bool useStencilBuffer,
 	bool useDeferredShading,
+	uint8_t sampleCount,
 	Vec2I framebufferSize,
 	VkSwapchain* vkSwapchain)
 {
@@ -1088,6 +1266,7 @@ inline static MpgxResult createVkSwapchain(
 	assert(allocator);
 	assert(graphicsCommandPool);
 	assert(presentCommandPool);
+	assert(sampleCount > 0);
 	assert(framebufferSize.x > 0);
 	assert(framebufferSize.y > 0);
 	assert(vkSwapchain);
@@ -1098,6 +1277,11 @@ inline static MpgxResult createVkSwapchain(
 	if (!swapchain)
 		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
+	VkSampleCountFlagBits vkSampleCount = getVkSampleCount(
+		physicalDevice,
+		sampleCount);
+	swapchain->sampleCount = vkSampleCount;
+
 	VkSurfaceFormatKHR surfaceFormat;
 
 	if (!getBestVkSurfaceFormat(physicalDevice,
@@ -1209,6 +1393,55 @@ inline static MpgxResult createVkSwapchain(
 		return VULKAN_IS_NOT_SUPPORTED_MPGX_RESULT;
 	}
 
+	if (vkSampleCount > VK_SAMPLE_COUNT_1_BIT)
+	{
+		VkImage colorImage;
+		VmaAllocation colorAllocation;
+
+		mpgxResult = createVkColorImage(
+			allocator,
+			surfaceFormat.format,
+			surfaceExtent,
+			vkSampleCount,
+			&colorImage,
+			&colorAllocation);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyVkSwapchain(
+				device,
+				allocator,
+				graphicsCommandPool,
+				presentCommandPool,
+				swapchain);
+			return mpgxResult;
+		}
+
+		swapchain->colorImage = colorImage;
+		swapchain->colorAllocation = colorAllocation;
+
+		VkImageView colorImageView;
+
+		mpgxResult = createVkColorImageView(
+			device,
+			colorImage,
+			surfaceFormat.format,
+			&colorImageView);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyVkSwapchain(
+				device,
+				allocator,
+				graphicsCommandPool,
+				presentCommandPool,
+				swapchain);
+			return mpgxResult;
+		}
+
+		swapchain->colorImageView = colorImageView;
+	}
+
 	VkImage depthImage;
 	VmaAllocation depthAllocation;
 
@@ -1216,6 +1449,7 @@ inline static MpgxResult createVkSwapchain(
 		allocator,
 		depthFormat,
 		surfaceExtent,
+		vkSampleCount,
 		&depthImage,
 		&depthAllocation);
 
@@ -1260,6 +1494,7 @@ inline static MpgxResult createVkSwapchain(
 		device,
 		surfaceFormat.format,
 		depthFormat,
+		vkSampleCount,
 		true,
 		useDeferredShading,
 		&renderPass);
@@ -1289,6 +1524,7 @@ inline static MpgxResult createVkSwapchain(
 		graphicsCommandPool,
 		presentCommandPool,
 		surfaceFormat.format,
+		swapchain->colorImageView,
 		depthImageView,
 		surfaceExtent,
 		&buffers,
@@ -1416,6 +1652,50 @@ inline static MpgxResult resizeVkSwapchain(
 		return VULKAN_IS_NOT_SUPPORTED_MPGX_RESULT;
 	}
 
+	VkSampleCountFlagBits sampleCount = swapchain->sampleCount;
+	VkImage colorImage = VK_NULL_HANDLE;
+	VmaAllocation colorAllocation = NULL;
+	VkImageView colorImageView = VK_NULL_HANDLE;
+
+	if (sampleCount > VK_SAMPLE_COUNT_1_BIT)
+	{
+		mpgxResult = createVkColorImage(
+			allocator,
+			surfaceFormat.format,
+			surfaceExtent,
+			sampleCount,
+			&colorImage,
+			&colorAllocation);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			vkDestroySwapchainKHR(
+				device,
+				handle,
+				NULL);
+			return mpgxResult;
+		}
+
+		mpgxResult = createVkColorImageView(
+			device,
+			colorImage,
+			surfaceFormat.format,
+			&colorImageView);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			vmaDestroyImage(
+				allocator,
+				colorImage,
+				colorAllocation);
+			vkDestroySwapchainKHR(
+				device,
+				handle,
+				NULL);
+			return mpgxResult;
+		}
+	}
+
 	VkImage depthImage;
 	VmaAllocation depthAllocation;
 
@@ -1423,11 +1703,20 @@ inline static MpgxResult resizeVkSwapchain(
 		allocator,
 		depthFormat,
 		surfaceExtent,
+		sampleCount,
 		&depthImage,
 		&depthAllocation);
 
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
 	{
+		vkDestroyImageView(
+			device,
+			colorImageView,
+			NULL);
+		vmaDestroyImage(
+			allocator,
+			colorImage,
+			colorAllocation);
 		vkDestroySwapchainKHR(
 			device,
 			handle,
@@ -1449,6 +1738,14 @@ inline static MpgxResult resizeVkSwapchain(
 			allocator,
 			depthImage,
 			depthAllocation);
+		vkDestroyImageView(
+			device,
+			colorImageView,
+			NULL);
+		vmaDestroyImage(
+			allocator,
+			colorImage,
+			colorAllocation);
 		vkDestroySwapchainKHR(
 			device,
 			handle,
@@ -1462,6 +1759,7 @@ inline static MpgxResult resizeVkSwapchain(
 		device,
 		surfaceFormat.format,
 		depthFormat,
+		sampleCount,
 		useBeginClear,
 		useDeferredShading,
 		&renderPass);
@@ -1476,6 +1774,14 @@ inline static MpgxResult resizeVkSwapchain(
 			allocator,
 			depthImage,
 			depthAllocation);
+		vkDestroyImageView(
+			device,
+			colorImageView,
+			NULL);
+		vmaDestroyImage(
+			allocator,
+			colorImage,
+			colorAllocation);
 		vkDestroySwapchainKHR(
 			device,
 			handle,
@@ -1495,6 +1801,7 @@ inline static MpgxResult resizeVkSwapchain(
 		graphicsCommandPool,
 		presentCommandPool,
 		surfaceFormat.format,
+		colorImageView,
 		depthImageView,
 		surfaceExtent,
 		&buffers,
@@ -1514,6 +1821,14 @@ inline static MpgxResult resizeVkSwapchain(
 			allocator,
 			depthImage,
 			depthAllocation);
+		vkDestroyImageView(
+			device,
+			colorImageView,
+			NULL);
+		vmaDestroyImage(
+			allocator,
+			colorImage,
+			colorAllocation);
 		vkDestroySwapchainKHR(
 			device,
 			handle,
@@ -1539,12 +1854,23 @@ inline static MpgxResult resizeVkSwapchain(
 		allocator,
 		swapchain->depthImage,
 		swapchain->depthAllocation);
+	vkDestroyImageView(
+		device,
+		swapchain->colorImageView,
+		NULL);
+	vmaDestroyImage(
+		allocator,
+		swapchain->colorImage,
+		swapchain->colorAllocation);
 	vkDestroySwapchainKHR(
 		device,
 		swapchain->handle,
 		NULL);
 
 	swapchain->handle = handle;
+	swapchain->colorImage = colorImage;
+	swapchain->colorAllocation = colorAllocation;
+	swapchain->colorImageView = colorImageView;
 	swapchain->depthImage = depthImage;
 	swapchain->depthAllocation = depthAllocation;
 	swapchain->depthImageView = depthImageView;
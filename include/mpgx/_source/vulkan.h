@@ -119,6 +119,46 @@ inline static MpgxResult endSubmitWaitVkCommandBuffer(
 
 	return SUCCESS_MPGX_RESULT;
 }
+inline static MpgxResult bindSparseWaitVkQueue(
+	VkDevice device,
+	VkQueue queue,
+	VkFence fence,
+	const VkBindSparseInfo* bindSparseInfo)
+{
+	assert(device);
+	assert(queue);
+	assert(fence);
+	assert(bindSparseInfo);
+
+	VkResult vkResult = vkResetFences(
+		device,
+		1,
+		&fence);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	vkResult = vkQueueBindSparse(
+		queue,
+		1,
+		bindSparseInfo,
+		fence);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	vkResult = vkWaitForFences(
+		device,
+		1,
+		&fence,
+		VK_TRUE,
+		UINT64_MAX);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	return SUCCESS_MPGX_RESULT;
+}
 
 inline static MpgxResult allocateBeginVkCommandBuffer(
 	VkDevice device,
@@ -310,4 +350,284 @@ inline static bool getVkCompareOperator(
 		return true;
 	}
 }
+
+inline static VkSampleCountFlagBits getVkSampleCount(
+	VkPhysicalDevice physicalDevice,
+	uint8_t sampleCount)
+{
+	assert(physicalDevice);
+	assert(sampleCount > 0);
+
+	VkPhysicalDeviceProperties properties;
+
+	vkGetPhysicalDeviceProperties(
+		physicalDevice,
+		&properties);
+
+	VkSampleCountFlags sampleCounts =
+		properties.limits.framebufferColorSampleCounts &
+		properties.limits.framebufferDepthSampleCounts;
+
+	// Selects highest supported count not above requested
+	for (uint32_t count = VK_SAMPLE_COUNT_64_BIT; count > 1; count >>= 1)
+	{
+		if (count <= sampleCount && (sampleCounts & count))
+			return (VkSampleCountFlagBits)count;
+	}
+
+	return VK_SAMPLE_COUNT_1_BIT;
+}
+
+#define VK_ACCESS_WRITE_MASK ( \
+	VK_ACCESS_2_SHADER_WRITE_BIT_KHR | \
+	VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR | \
+	VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR | \
+	VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR | \
+	VK_ACCESS_2_HOST_WRITE_BIT_KHR | \
+	VK_ACCESS_2_MEMORY_WRITE_BIT_KHR)
+
+typedef struct VkBarrierBatch_T
+{
+	VkImageMemoryBarrier2KHR* imageBarriers;
+	VkImageMemoryBarrier* legacyBarriers;
+	size_t imageBarrierCapacity;
+	size_t imageBarrierCount;
+	PFN_vkCmdPipelineBarrier2KHR cmdPipelineBarrier2;
+} VkBarrierBatch_T;
+
+typedef VkBarrierBatch_T* VkBarrierBatch;
+
+inline static void destroyVkBarrierBatch(
+	VkBarrierBatch barrierBatch)
+{
+	if (!barrierBatch)
+		return;
+
+	free(barrierBatch->legacyBarriers);
+	free(barrierBatch->imageBarriers);
+	free(barrierBatch);
+}
+inline static MpgxResult createVkBarrierBatch(
+	VkDevice device,
+	bool useSynchronization2,
+	VkBarrierBatch* barrierBatch)
+{
+	assert(device);
+	assert(barrierBatch);
+
+	VkBarrierBatch barrierBatchInstance = calloc(1,
+		sizeof(VkBarrierBatch_T));
+
+	if (!barrierBatchInstance)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	VkImageMemoryBarrier2KHR* imageBarriers = malloc(
+		sizeof(VkImageMemoryBarrier2KHR));
+
+	if (!imageBarriers)
+	{
+		destroyVkBarrierBatch(barrierBatchInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	barrierBatchInstance->imageBarriers = imageBarriers;
+
+	VkImageMemoryBarrier* legacyBarriers = malloc(
+		sizeof(VkImageMemoryBarrier));
+
+	if (!legacyBarriers)
+	{
+		destroyVkBarrierBatch(barrierBatchInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	barrierBatchInstance->legacyBarriers = legacyBarriers;
+	barrierBatchInstance->imageBarrierCapacity = 1;
+	barrierBatchInstance->imageBarrierCount = 0;
+
+	// Without the extension barriers are translated
+	// into the one legacy pipeline barrier command.
+	if (useSynchronization2)
+	{
+		barrierBatchInstance->cmdPipelineBarrier2 =
+			(PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(
+			device, "vkCmdPipelineBarrier2KHR");
+	}
+	else
+	{
+		barrierBatchInstance->cmdPipelineBarrier2 = NULL;
+	}
+
+	*barrierBatch = barrierBatchInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult reserveVkImageBarriers(
+	VkBarrierBatch barrierBatch,
+	size_t barrierCount)
+{
+	assert(barrierBatch);
+
+	size_t count = barrierBatch->imageBarrierCount + barrierCount;
+	size_t capacity = barrierBatch->imageBarrierCapacity;
+
+	if (count <= capacity)
+		return SUCCESS_MPGX_RESULT;
+
+	while (count > capacity)
+		capacity *= 2;
+
+	VkImageMemoryBarrier2KHR* imageBarriers = realloc(
+		barrierBatch->imageBarriers,
+		capacity * sizeof(VkImageMemoryBarrier2KHR));
+
+	if (!imageBarriers)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	barrierBatch->imageBarriers = imageBarriers;
+
+	VkImageMemoryBarrier* legacyBarriers = realloc(
+		barrierBatch->legacyBarriers,
+		capacity * sizeof(VkImageMemoryBarrier));
+
+	if (!legacyBarriers)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	barrierBatch->legacyBarriers = legacyBarriers;
+	barrierBatch->imageBarrierCapacity = capacity;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult addVkImageBarrier(
+	VkBarrierBatch barrierBatch,
+	const VkImageMemoryBarrier2KHR* imageBarrier)
+{
+	assert(barrierBatch);
+	assert(imageBarrier);
+
+	MpgxResult mpgxResult = reserveVkImageBarriers(
+		barrierBatch,
+		1);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	size_t count = barrierBatch->imageBarrierCount;
+	barrierBatch->imageBarriers[count] = *imageBarrier;
+	barrierBatch->imageBarrierCount = count + 1;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static bool isVkImageBarrierPending(
+	VkBarrierBatch barrierBatch,
+	VkImage image,
+	uint32_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount)
+{
+	assert(barrierBatch);
+	assert(image);
+
+	const VkImageMemoryBarrier2KHR* imageBarriers =
+		barrierBatch->imageBarriers;
+	size_t count = barrierBatch->imageBarrierCount;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const VkImageMemoryBarrier2KHR* imageBarrier = &imageBarriers[i];
+		const VkImageSubresourceRange* range = &imageBarrier->subresourceRange;
+
+		if (imageBarrier->image == image &&
+			range->baseMipLevel <= mipLevel &&
+			range->baseMipLevel + range->levelCount > mipLevel &&
+			range->baseArrayLayer <= baseLayer &&
+			range->baseArrayLayer + range->layerCount >= baseLayer + layerCount)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+inline static void flushVkBarrierBatch(
+	VkCommandBuffer commandBuffer,
+	VkBarrierBatch barrierBatch)
+{
+	assert(commandBuffer);
+	assert(barrierBatch);
+
+	size_t count = barrierBatch->imageBarrierCount;
+
+	if (count == 0)
+		return;
+
+	VkImageMemoryBarrier2KHR* imageBarriers =
+		barrierBatch->imageBarriers;
+
+	if (barrierBatch->cmdPipelineBarrier2)
+	{
+		VkDependencyInfoKHR dependencyInfo = {
+			VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+			NULL,
+			0,
+			0,
+			NULL,
+			0,
+			NULL,
+			(uint32_t)count,
+			imageBarriers,
+		};
+
+		barrierBatch->cmdPipelineBarrier2(
+			commandBuffer,
+			&dependencyInfo);
+	}
+	else
+	{
+		VkImageMemoryBarrier* legacyBarriers =
+			barrierBatch->legacyBarriers;
+		VkPipelineStageFlags srcStageMask = 0;
+		VkPipelineStageFlags dstStageMask = 0;
+
+		// Only the legacy stage and access bits are used,
+		// they have the same values as the first 32 bits.
+		for (size_t i = 0; i < count; i++)
+		{
+			const VkImageMemoryBarrier2KHR* imageBarrier = &imageBarriers[i];
+			srcStageMask |= (VkPipelineStageFlags)imageBarrier->srcStageMask;
+			dstStageMask |= (VkPipelineStageFlags)imageBarrier->dstStageMask;
+
+			VkImageMemoryBarrier legacyBarrier = {
+				VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				NULL,
+				(VkAccessFlags)imageBarrier->srcAccessMask,
+				(VkAccessFlags)imageBarrier->dstAccessMask,
+				imageBarrier->oldLayout,
+				imageBarrier->newLayout,
+				imageBarrier->srcQueueFamilyIndex,
+				imageBarrier->dstQueueFamilyIndex,
+				imageBarrier->image,
+				imageBarrier->subresourceRange,
+			};
+
+			legacyBarriers[i] = legacyBarrier;
+		}
+
+		if (srcStageMask == 0)
+			srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		if (dstStageMask == 0)
+			dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			srcStageMask,
+			dstStageMask,
+			0,
+			0,
+			NULL,
+			0,
+			NULL,
+			(uint32_t)count,
+			legacyBarriers);
+	}
+
+	barrierBatch->imageBarrierCount = 0;
+}
 #endif
@@ -27,12 +27,16 @@
 #endif
 
 #include "mpgx/_source/swapchain.h"
+#include "mpgx/_source/reflection.h"
 
 #include "GLFW/glfw3.h"
 #include <stdio.h>
+#include <string.h>
 
 #define VK_VERSION VK_API_VERSION_1_2
 #define VK_FRAME_LAG 2
+#define VK_PIPELINE_CACHE_FILE_NAME "vk-pipeline.cache"
+#define VK_PIPELINE_CACHE_HEADER_SIZE 32
 
 #if MPGX_SUPPORT_VULKAN
 typedef struct VkWindow_T
@@ -53,6 +57,7 @@ typedef struct VkWindow_T
 	VkCommandPool presentCommandPool;
 	VkCommandPool transferCommandPool;
 	VkCommandPool computeCommandPool;
+	VkCommandBuffer graphicsCommandBuffer;
 	VkCommandBuffer transferCommandBuffer;
 	VkCommandBuffer computeCommandBuffer;
 	VkFence fences[VK_FRAME_LAG];
@@ -60,15 +65,29 @@ typedef struct VkWindow_T
 	VkSemaphore drawCompleteSemaphores[VK_FRAME_LAG];
 	VkSemaphore imageOwnershipSemaphores[VK_FRAME_LAG];
 	VkFence transferFence;
+	VkSemaphore sparseSemaphores[2];
+	VkSemaphore sparseSemaphore;
+	VkFence sparseFence;
 	VkSwapchain swapchain;
+	VkPipelineCache pipelineCache;
+	char* pipelineCachePath;
+	VkLayoutCache layoutCache;
+	VkBarrierBatch barrierBatch;
 	uint32_t frameIndex;
 	uint32_t bufferIndex;
 	VkCommandBuffer currenCommandBuffer;
 	VkBuffer stagingBuffer;
 	VmaAllocation stagingAllocation;
 	size_t stagingSize;
+	VkBuffer streamingBuffers[VK_FRAME_LAG];
+	VmaAllocation streamingAllocations[VK_FRAME_LAG];
+	size_t streamingSizes[VK_FRAME_LAG];
 	VkPhysicalDeviceProperties deviceProperties;
+	uint32_t resizableBarHeapIndex;
 	bool isDeviceIntegrated;
+	bool useGraphicsPipelineLibrary;
+	bool isSparseSupported;
+	bool isSparseBindPending;
 } VkWindow_T;
 
 typedef VkWindow_T* VkWindow;
@@ -483,6 +502,64 @@ inline static MpgxResult getBestVkPhysicalDevice(
 		VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU;
 	return SUCCESS_MPGX_RESULT;
 }
+inline static bool getVkResizableBarHeap(
+	VkPhysicalDevice physicalDevice,
+	uint32_t* heapIndex)
+{
+	assert(physicalDevice);
+	assert(heapIndex);
+
+	VkPhysicalDeviceMemoryProperties properties;
+
+	vkGetPhysicalDeviceMemoryProperties(
+		physicalDevice,
+		&properties);
+
+	const VkMemoryHeap* memoryHeaps = properties.memoryHeaps;
+	uint32_t heapCount = properties.memoryHeapCount;
+
+	uint32_t deviceHeapIndex = UINT32_MAX;
+	VkDeviceSize deviceHeapSize = 0;
+
+	for (uint32_t i = 0; i < heapCount; i++)
+	{
+		VkMemoryHeap heap = memoryHeaps[i];
+
+		if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+			heap.size > deviceHeapSize)
+		{
+			deviceHeapIndex = i;
+			deviceHeapSize = heap.size;
+		}
+	}
+
+	if (deviceHeapIndex == UINT32_MAX)
+		return false;
+
+	const VkMemoryType* memoryTypes = properties.memoryTypes;
+	uint32_t typeCount = properties.memoryTypeCount;
+
+	VkMemoryPropertyFlags targetFlags =
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+	// Without resizable BAR host visible device memory
+	// is only a small separate heap (usually 256 MiB),
+	// so we use it only when it covers whole VRAM heap.
+	for (uint32_t i = 0; i < typeCount; i++)
+	{
+		VkMemoryType type = memoryTypes[i];
+
+		if ((type.propertyFlags & targetFlags) == targetFlags &&
+			type.heapIndex == deviceHeapIndex)
+		{
+			*heapIndex = deviceHeapIndex;
+			return true;
+		}
+	}
+
+	return false;
+}
 inline static MpgxResult getVkQueueFamilyIndices(
 	VkPhysicalDevice physicalDevice,
 	VkSurfaceKHR surface,
@@ -715,6 +792,108 @@ inline static MpgxResult checkVkDeviceExtensions(
 	free(properties);
 	return SUCCESS_MPGX_RESULT;
 }
+inline static bool isVkGraphicsPipelineLibrarySupported(
+	VkPhysicalDevice physicalDevice)
+{
+	assert(physicalDevice);
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures;
+	memset(&libraryFeatures, 0,
+		sizeof(VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT));
+	libraryFeatures.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+	VkPhysicalDeviceFeatures2 features;
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &libraryFeatures;
+
+	vkGetPhysicalDeviceFeatures2(
+		physicalDevice,
+		&features);
+
+	if (!libraryFeatures.graphicsPipelineLibrary)
+		return false;
+
+	VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties;
+	memset(&libraryProperties, 0,
+		sizeof(VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT));
+	libraryProperties.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+	VkPhysicalDeviceProperties2 properties;
+	memset(&properties, 0, sizeof(VkPhysicalDeviceProperties2));
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &libraryProperties;
+
+	vkGetPhysicalDeviceProperties2(
+		physicalDevice,
+		&properties);
+
+	// Without fast linking libraries are slower than monolithic pipelines
+	return libraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+}
+inline static bool isVkSynchronization2Supported(
+	VkPhysicalDevice physicalDevice)
+{
+	assert(physicalDevice);
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features;
+	memset(&synchronization2Features, 0,
+		sizeof(VkPhysicalDeviceSynchronization2FeaturesKHR));
+	synchronization2Features.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+	VkPhysicalDeviceFeatures2 features;
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &synchronization2Features;
+
+	vkGetPhysicalDeviceFeatures2(
+		physicalDevice,
+		&features);
+
+	return synchronization2Features.synchronization2 == VK_TRUE;
+}
+inline static bool isVkSparseImageSupported(
+	VkPhysicalDevice physicalDevice,
+	uint32_t graphicsQueueFamilyIndex)
+{
+	assert(physicalDevice);
+
+	VkPhysicalDeviceFeatures features;
+
+	vkGetPhysicalDeviceFeatures(
+		physicalDevice,
+		&features);
+
+	if (!features.sparseBinding || !features.sparseResidencyImage2D)
+		return false;
+
+	uint32_t propertyCount = 0;
+
+	vkGetPhysicalDeviceQueueFamilyProperties(
+		physicalDevice,
+		&propertyCount,
+		NULL);
+
+	VkQueueFamilyProperties* properties = malloc(
+		propertyCount * sizeof(VkQueueFamilyProperties));
+
+	if (!properties)
+		return false;
+
+	vkGetPhysicalDeviceQueueFamilyProperties(
+		physicalDevice,
+		&propertyCount,
+		properties);
+
+	// Sparse memory is bound on the graphics queue,
+	// so binds are ordered with the frame submissions.
+	bool isSupported = properties[graphicsQueueFamilyIndex].queueFlags &
+		VK_QUEUE_SPARSE_BINDING_BIT;
+
+	free(properties);
+	return isSupported;
+}
 inline static MpgxResult createVkDevice(
 	VkPhysicalDevice physicalDevice,
 	uint32_t graphicsQueueFamilyIndex,
@@ -722,6 +901,8 @@ inline static MpgxResult createVkDevice(
 	uint32_t transferQueueFamilyIndex,
 	uint32_t computeQueueFamilyIndex,
 	bool useRayTracing,
+	bool useGraphicsPipelineLibrary,
+	bool useSynchronization2,
 	const char** extensions,
 	uint32_t extensionCount,
 	VkDevice* device)
@@ -816,6 +997,32 @@ inline static MpgxResult createVkDevice(
 		rayTracingPipelineFeatures.rayTracingPipeline = VK_TRUE;
 	}
 
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures;
+
+	if (useGraphicsPipelineLibrary)
+	{
+		memset(&graphicsPipelineLibraryFeatures, 0,
+			sizeof(VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT));
+		graphicsPipelineLibraryFeatures.sType =
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		graphicsPipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+		graphicsPipelineLibraryFeatures.pNext = features.pNext;
+		features.pNext = &graphicsPipelineLibraryFeatures;
+	}
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features;
+
+	if (useSynchronization2)
+	{
+		memset(&synchronization2Features, 0,
+			sizeof(VkPhysicalDeviceSynchronization2FeaturesKHR));
+		synchronization2Features.sType =
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+		synchronization2Features.synchronization2 = VK_TRUE;
+		synchronization2Features.pNext = features.pNext;
+		features.pNext = &synchronization2Features;
+	}
+
 	VkDeviceCreateInfo deviceCreateInfo = {
 		VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
 		&features,
@@ -883,6 +1090,248 @@ inline static MpgxResult createVmaAllocator(
 	return SUCCESS_MPGX_RESULT;
 }
 
+inline static char* createVkPipelineCachePath(
+	const char* cacheDirectory)
+{
+	assert(cacheDirectory);
+
+	size_t directoryLength = strlen(cacheDirectory);
+	size_t nameLength = strlen(VK_PIPELINE_CACHE_FILE_NAME);
+
+	char* path = malloc((directoryLength +
+		nameLength + 2) * sizeof(char));
+
+	if (!path)
+		return NULL;
+
+	memcpy(path, cacheDirectory, directoryLength);
+	path[directoryLength] = '/';
+	memcpy(path + directoryLength + 1,
+		VK_PIPELINE_CACHE_FILE_NAME, nameLength);
+	path[directoryLength + nameLength + 1] = '\0';
+	return path;
+}
+inline static bool isVkPipelineCacheDataValid(
+	const VkPhysicalDeviceProperties* deviceProperties,
+	const uint8_t* data,
+	size_t dataSize)
+{
+	assert(deviceProperties);
+	assert(data);
+
+	if (dataSize < VK_PIPELINE_CACHE_HEADER_SIZE)
+		return false;
+
+	uint32_t headerSize, headerVersion, vendorID, deviceID;
+	memcpy(&headerSize, data, sizeof(uint32_t));
+	memcpy(&headerVersion, data + 4, sizeof(uint32_t));
+	memcpy(&vendorID, data + 8, sizeof(uint32_t));
+	memcpy(&deviceID, data + 12, sizeof(uint32_t));
+
+	return headerSize >= VK_PIPELINE_CACHE_HEADER_SIZE &&
+		headerSize <= dataSize &&
+		headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		vendorID == deviceProperties->vendorID &&
+		deviceID == deviceProperties->deviceID &&
+		memcmp(data + 16, deviceProperties->pipelineCacheUUID,
+			VK_UUID_SIZE) == 0;
+}
+inline static uint8_t* readVkPipelineCacheFile(
+	const VkPhysicalDeviceProperties* deviceProperties,
+	const char* filePath,
+	size_t* dataSize)
+{
+	assert(deviceProperties);
+	assert(filePath);
+	assert(dataSize);
+
+	FILE* file = fopen(filePath, "rb");
+
+	if (!file)
+		return NULL;
+
+	// Driver version is not a part of the cache header,
+	// so it is stored in front of the cache data.
+	uint32_t header[2];
+
+	if (fread(header, sizeof(uint32_t), 2, file) != 2 ||
+		header[0] != deviceProperties->driverVersion ||
+		header[1] == 0)
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	size_t size = header[1];
+	uint8_t* data = malloc(size);
+
+	if (!data)
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	if (fread(data, sizeof(uint8_t), size, file) != size ||
+		!isVkPipelineCacheDataValid(deviceProperties, data, size))
+	{
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+
+	*dataSize = size;
+	return data;
+}
+inline static void writeVkPipelineCacheFile(
+	VkDevice device,
+	VkPipelineCache pipelineCache,
+	const VkPhysicalDeviceProperties* deviceProperties,
+	const char* filePath)
+{
+	assert(device);
+	assert(pipelineCache);
+	assert(deviceProperties);
+	assert(filePath);
+
+	size_t dataSize;
+
+	VkResult vkResult = vkGetPipelineCacheData(
+		device,
+		pipelineCache,
+		&dataSize,
+		NULL);
+
+	if (vkResult != VK_SUCCESS || dataSize == 0 ||
+		dataSize > UINT32_MAX)
+	{
+		return;
+	}
+
+	uint8_t* data = malloc(dataSize);
+
+	if (!data)
+		return;
+
+	vkResult = vkGetPipelineCacheData(
+		device,
+		pipelineCache,
+		&dataSize,
+		data);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		free(data);
+		return;
+	}
+
+	// Cache is written to the temporary file and renamed,
+	// so interrupted write does not leave a truncated cache.
+	size_t pathLength = strlen(filePath);
+	char* tempPath = malloc(pathLength + 5);
+
+	if (!tempPath)
+	{
+		free(data);
+		return;
+	}
+
+	memcpy(tempPath, filePath, pathLength);
+	memcpy(tempPath + pathLength, ".tmp", 5);
+
+	FILE* file = fopen(tempPath, "wb");
+
+	if (!file)
+	{
+		free(tempPath);
+		free(data);
+		return;
+	}
+
+	uint32_t header[2] = {
+		deviceProperties->driverVersion,
+		(uint32_t)dataSize,
+	};
+
+	bool isWritten =
+		fwrite(header, sizeof(uint32_t), 2, file) == 2 &&
+		fwrite(data, sizeof(uint8_t), dataSize, file) == dataSize;
+
+	isWritten &= fclose(file) == 0;
+	free(data);
+
+	if (isWritten && rename(tempPath, filePath) != 0)
+	{
+		// Rename does not replace existing file on Windows
+		remove(filePath);
+		isWritten = rename(tempPath, filePath) == 0;
+	}
+
+	if (!isWritten)
+		remove(tempPath);
+
+	free(tempPath);
+}
+inline static MpgxResult createVkPipelineCache(
+	VkDevice device,
+	const VkPhysicalDeviceProperties* deviceProperties,
+	const char* filePath,
+	VkPipelineCache* pipelineCache)
+{
+	assert(device);
+	assert(deviceProperties);
+	assert(pipelineCache);
+
+	size_t dataSize = 0;
+	uint8_t* data = NULL;
+
+	if (filePath)
+	{
+		data = readVkPipelineCacheFile(
+			deviceProperties,
+			filePath,
+			&dataSize);
+	}
+
+	VkPipelineCacheCreateInfo createInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		NULL,
+		0,
+		dataSize,
+		data,
+	};
+
+	VkPipelineCache pipelineCacheInstance;
+
+	VkResult vkResult = vkCreatePipelineCache(
+		device,
+		&createInfo,
+		NULL,
+		&pipelineCacheInstance);
+
+	if (vkResult != VK_SUCCESS && data)
+	{
+		// Driver rejected stored data, start from the empty cache.
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = NULL;
+
+		vkResult = vkCreatePipelineCache(
+			device,
+			&createInfo,
+			NULL,
+			&pipelineCacheInstance);
+	}
+
+	free(data);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	*pipelineCache = pipelineCacheInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+
 inline static void destroyVkWindow(
 	VkInstance instance,
 	VkWindow window)
@@ -902,11 +1351,42 @@ inline static void destroyVkWindow(
 			window->stagingBuffer,
 			window->stagingAllocation);
 
+		for (uint8_t i = 0; i < VK_FRAME_LAG; i++)
+		{
+			vmaDestroyBuffer(
+				allocator,
+				window->streamingBuffers[i],
+				window->streamingAllocations[i]);
+		}
+
 		VkCommandPool graphicsCommandPool = window->graphicsCommandPool;
 		VkCommandPool presentCommandPool = window->presentCommandPool;
 
 		if (device)
 		{
+			destroyVkLayoutCache(
+				device,
+				window->layoutCache);
+
+			VkPipelineCache pipelineCache = window->pipelineCache;
+
+			if (pipelineCache)
+			{
+				if (window->pipelineCachePath)
+				{
+					writeVkPipelineCacheFile(
+						device,
+						pipelineCache,
+						&window->deviceProperties,
+						window->pipelineCachePath);
+				}
+
+				vkDestroyPipelineCache(
+					device,
+					pipelineCache,
+					NULL);
+			}
+
 			destroyVkSwapchain(
 				device,
 				allocator,
@@ -918,6 +1398,18 @@ inline static void destroyVkWindow(
 				device,
 				window->transferFence,
 				NULL);
+			vkDestroyFence(
+				device,
+				window->sparseFence,
+				NULL);
+
+			for (uint8_t i = 0; i < 2; i++)
+			{
+				vkDestroySemaphore(
+					device,
+					window->sparseSemaphores[i],
+					NULL);
+			}
 
 			VkFence* fences = window->fences;
 			VkSemaphore* imageAcquiredSemaphores =
@@ -996,6 +1488,8 @@ inline static void destroyVkWindow(
 		vmaDestroyAllocator(allocator);
 	}
 
+	destroyVkBarrierBatch(window->barrierBatch);
+
 	vkDestroyDevice(
 		device,
 		NULL);
@@ -1003,6 +1497,7 @@ inline static void destroyVkWindow(
 		instance,
 		window->surface,
 		NULL);
+	free(window->pipelineCachePath);
 	free(window);
 }
 inline static MpgxResult createVkWindow(
@@ -1010,7 +1505,9 @@ inline static MpgxResult createVkWindow(
 	GLFWwindow* handle,
 	bool useStencilBuffer,
 	bool useDeferredShading,
+	uint8_t sampleCount,
 	bool useRayTracing,
+	const char* cacheDirectory,
 	Vec2I framebufferSize,
 	VkWindow* vkWindow)
 {
@@ -1062,6 +1559,16 @@ inline static MpgxResult createVkWindow(
 	window->deviceProperties = deviceProperties;
 	window->isDeviceIntegrated = isDeviceIntegrated;
 
+	uint32_t resizableBarHeapIndex;
+
+	if (isDeviceIntegrated || !getVkResizableBarHeap(
+		physicalDevice, &resizableBarHeapIndex))
+	{
+		resizableBarHeapIndex = UINT32_MAX;
+	}
+
+	window->resizableBarHeapIndex = resizableBarHeapIndex;
+
 	uint32_t graphicsQueueFamilyIndex,
 		presentQueueFamilyIndex,
 		transferQueueFamilyIndex,
@@ -1085,10 +1592,13 @@ inline static MpgxResult createVkWindow(
 	window->presentQueueFamilyIndex = presentQueueFamilyIndex;
 	window->transferQueueFamilyIndex = transferQueueFamilyIndex;
 	window->computeQueueFamilyIndex = computeQueueFamilyIndex;
+	window->isSparseSupported = isVkSparseImageSupported(
+		physicalDevice,
+		graphicsQueueFamilyIndex);
 
-	const char* extensions[6];
-	const char* targetExtensions[6];
-	bool isExtensionSupported[6];
+	const char* extensions[9];
+	const char* targetExtensions[9];
+	bool isExtensionSupported[9];
 	uint32_t extensionCount = 0;
 	uint32_t targetExtensionCount = 0;
 
@@ -1132,6 +1642,18 @@ inline static MpgxResult createVkWindow(
 		rayTracingPipelineExtIndex = targetExtensionCount++;
 	}
 
+	targetExtensions[targetExtensionCount] =
+		VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME;
+	uint32_t pipelineLibraryExtIndex = targetExtensionCount++;
+
+	targetExtensions[targetExtensionCount] =
+		VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME;
+	uint32_t graphicsPipelineLibraryExtIndex = targetExtensionCount++;
+
+	targetExtensions[targetExtensionCount] =
+		VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME;
+	uint32_t synchronization2ExtIndex = targetExtensionCount++;
+
 	mpgxResult = checkVkDeviceExtensions(
 		physicalDevice,
 		targetExtensions,
@@ -1172,6 +1694,31 @@ inline static MpgxResult createVkWindow(
 		}
 	}
 
+	bool useGraphicsPipelineLibrary =
+		isExtensionSupported[pipelineLibraryExtIndex] &&
+		isExtensionSupported[graphicsPipelineLibraryExtIndex] &&
+		isVkGraphicsPipelineLibrarySupported(physicalDevice);
+
+	if (useGraphicsPipelineLibrary)
+	{
+		extensions[extensionCount++] =
+			targetExtensions[pipelineLibraryExtIndex];
+		extensions[extensionCount++] =
+			targetExtensions[graphicsPipelineLibraryExtIndex];
+	}
+
+	window->useGraphicsPipelineLibrary = useGraphicsPipelineLibrary;
+
+	bool useSynchronization2 =
+		isExtensionSupported[synchronization2ExtIndex] &&
+		isVkSynchronization2Supported(physicalDevice);
+
+	if (useSynchronization2)
+	{
+		extensions[extensionCount++] =
+			targetExtensions[synchronization2ExtIndex];
+	}
+
 	VkDevice device;
 
 	mpgxResult = createVkDevice(
@@ -1181,6 +1728,8 @@ inline static MpgxResult createVkWindow(
 		transferQueueFamilyIndex,
 		computeQueueFamilyIndex,
 		useRayTracing,
+		useGraphicsPipelineLibrary,
+		useSynchronization2,
 		extensions,
 		extensionCount,
 		&device);
@@ -1193,6 +1742,21 @@ inline static MpgxResult createVkWindow(
 
 	window->device = device;
 
+	VkBarrierBatch barrierBatch;
+
+	mpgxResult = createVkBarrierBatch(
+		device,
+		useSynchronization2,
+		&barrierBatch);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkWindow(instance, window);
+		return mpgxResult;
+	}
+
+	window->barrierBatch = barrierBatch;
+
 	VmaAllocator allocator;
 
 	mpgxResult = createVmaAllocator(
@@ -1334,11 +1898,29 @@ inline static MpgxResult createVkWindow(
 	VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
 		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
 		NULL,
-		transferCommandPool,
+		graphicsCommandPool,
 		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
 		1,
 	};
 
+	VkCommandBuffer graphicsCommandBuffer;
+
+	vkResult = vkAllocateCommandBuffers(
+		device,
+		&commandBufferAllocateInfo,
+		&graphicsCommandBuffer);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkWindow(instance, window);
+		return vkToMpgxResult(vkResult);
+	}
+
+	window->graphicsCommandBuffer = graphicsCommandBuffer;
+
+	commandBufferAllocateInfo.commandPool =
+		transferCommandPool;
+
 	VkCommandBuffer transferCommandBuffer;
 
 	vkResult = vkAllocateCommandBuffers(
@@ -1473,6 +2055,50 @@ inline static MpgxResult createVkWindow(
 
 	window->transferFence = transferFence;
 
+	VkFence sparseFence;
+
+	vkResult = vkCreateFence(
+		device,
+		&fenceCreateInfo,
+		NULL,
+		&sparseFence);
+
+	if (vkResult != VK_SUCCESS)
+	{
+		destroyVkWindow(instance, window);
+		return vkToMpgxResult(vkResult);
+	}
+
+	window->sparseFence = sparseFence;
+
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {
+		VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		NULL,
+		0,
+	};
+
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		VkSemaphore semaphore;
+
+		vkResult = vkCreateSemaphore(
+			device,
+			&semaphoreCreateInfo,
+			NULL,
+			&semaphore);
+
+		if (vkResult != VK_SUCCESS)
+		{
+			destroyVkWindow(instance, window);
+			return vkToMpgxResult(vkResult);
+		}
+
+		window->sparseSemaphores[i] = semaphore;
+	}
+
+	window->sparseSemaphore = NULL;
+	window->isSparseBindPending = false;
+
 	VkSwapchain swapchain;
 
 	mpgxResult = createVkSwapchain(
@@ -1486,6 +2112,7 @@ inline static MpgxResult createVkWindow(
 		presentCommandPool,
 		useStencilBuffer,
 		useDeferredShading,
+		sampleCount,
 		framebufferSize,
 		&swapchain);
 
@@ -1496,6 +2123,50 @@ inline static MpgxResult createVkWindow(
 	}
 
 	window->swapchain = swapchain;
+
+	char* pipelineCachePath = NULL;
+
+	if (cacheDirectory)
+	{
+		pipelineCachePath = createVkPipelineCachePath(
+			cacheDirectory);
+
+		if (!pipelineCachePath)
+		{
+			destroyVkWindow(instance, window);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		window->pipelineCachePath = pipelineCachePath;
+	}
+
+	VkPipelineCache pipelineCache;
+
+	mpgxResult = createVkPipelineCache(
+		device,
+		&deviceProperties,
+		pipelineCachePath,
+		&pipelineCache);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkWindow(instance, window);
+		return mpgxResult;
+	}
+
+	window->pipelineCache = pipelineCache;
+
+	VkLayoutCache layoutCache;
+
+	mpgxResult = createVkLayoutCache(&layoutCache);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		destroyVkWindow(instance, window);
+		return mpgxResult;
+	}
+
+	window->layoutCache = layoutCache;
 	window->frameIndex = 0;
 	window->bufferIndex = 0;
 	window->currenCommandBuffer = NULL;
@@ -1503,9 +2174,103 @@ inline static MpgxResult createVkWindow(
 	window->stagingAllocation = NULL;
 	window->stagingSize = 0;
 
+	for (uint8_t i = 0; i < VK_FRAME_LAG; i++)
+	{
+		window->streamingBuffers[i] = NULL;
+		window->streamingAllocations[i] = NULL;
+		window->streamingSizes[i] = 0;
+	}
+
 	*vkWindow = window;
 	return SUCCESS_MPGX_RESULT;
 }
+inline static MpgxResult waitVkSparseBind(VkWindow window)
+{
+	assert(window);
+
+	if (!window->isSparseBindPending)
+		return SUCCESS_MPGX_RESULT;
+
+	VkDevice device = window->device;
+	VkFence sparseFence = window->sparseFence;
+
+	VkResult vkResult = vkWaitForFences(
+		device,
+		1,
+		&sparseFence,
+		VK_TRUE,
+		UINT64_MAX);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	vkResult = vkResetFences(
+		device,
+		1,
+		&sparseFence);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	window->isSparseBindPending = false;
+	return SUCCESS_MPGX_RESULT;
+}
+inline static MpgxResult bindVkSparseImage(
+	VkWindow window,
+	VkImage image,
+	const VkSparseImageMemoryBind* binds,
+	uint32_t bindCount)
+{
+	assert(window);
+	assert(image);
+	assert(binds);
+	assert(bindCount > 0);
+
+	// Previous bind is usually complete at this point
+	MpgxResult mpgxResult = waitVkSparseBind(window);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	// Binds are chained until the next frame submit waits for them
+	VkSemaphore waitSemaphore = window->sparseSemaphore;
+	VkSemaphore signalSemaphore =
+		waitSemaphore == window->sparseSemaphores[0] ?
+		window->sparseSemaphores[1] : window->sparseSemaphores[0];
+
+	VkSparseImageMemoryBindInfo sparseImageMemoryBindInfo = {
+		image,
+		bindCount,
+		binds,
+	};
+	VkBindSparseInfo bindSparseInfo = {
+		VK_STRUCTURE_TYPE_BIND_SPARSE_INFO,
+		NULL,
+		waitSemaphore ? 1 : 0,
+		&waitSemaphore,
+		0,
+		NULL,
+		0,
+		NULL,
+		1,
+		&sparseImageMemoryBindInfo,
+		1,
+		&signalSemaphore,
+	};
+
+	VkResult vkResult = vkQueueBindSparse(
+		window->graphicsQueue,
+		1,
+		&bindSparseInfo,
+		window->sparseFence);
+
+	if (vkResult != VK_SUCCESS)
+		return vkToMpgxResult(vkResult);
+
+	window->sparseSemaphore = signalSemaphore;
+	window->isSparseBindPending = true;
+	return SUCCESS_MPGX_RESULT;
+}
 #endif
 
 // TODO: implement DemoUpdateTargetIPD (VK_GOOGLE) from cube.c
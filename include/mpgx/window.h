@@ -34,14 +34,11 @@
 #define DEFAULT_DEPTH_BIAS_SLOPE 0
 #define DEFAULT_BLEND_COLOR 0
 
-// TODO: add ability to store and load shader cache
 // TODO: add buffer/image/rayTracing array creation function with shared resources.
-// TODO: add buffer/image multiple data arrays setters, in one call
 // TODO: add any hit, intersection, callable, task mesh shaders
 // TODO: add/remove ray scene mesh
 // TODO: get/set ray mesh transform matrix
 // TODO: add hash checking system for the images, pipelines, samplers.
-// TODO: add deferred rendering framebuffer constructor, utilize vulkan subpass optimization
 
 static const Vec2I defaultWindowSize = {
 	DEFAULT_WINDOW_WIDTH,
@@ -313,6 +310,8 @@ typedef enum ImageType_T
 	STORAGE_IMAGE_TYPE = 0b00001000,
 	TRANSFER_SOURCE_IMAGE_TYPE = 0b00010000,
 	TRANSFER_DESTINATION_IMAGE_TYPE = 0b00100000,
+	TRANSIENT_ATTACHMENT_IMAGE_TYPE = 0b01000000,
+	INPUT_ATTACHMENT_IMAGE_TYPE = 0b10000000,
 } ImageType_T;
 /*
  * Image type mask.
@@ -334,7 +333,76 @@ typedef enum ImageFormat_T
 	D16_UNORM_S8_UINT_IMAGE_FORMAT = 7,
 	D24_UNORM_S8_UINT_IMAGE_FORMAT = 8,
 	D32_SFLOAT_S8_UINT_IMAGE_FORMAT = 9,
-	IMAGE_FORMAT_COUNT = 10,
+	BC1_RGB_UNORM_IMAGE_FORMAT = 10,
+	BC1_RGB_SRGB_IMAGE_FORMAT = 11,
+	BC1_RGBA_UNORM_IMAGE_FORMAT = 12,
+	BC1_RGBA_SRGB_IMAGE_FORMAT = 13,
+	BC2_UNORM_IMAGE_FORMAT = 14,
+	BC2_SRGB_IMAGE_FORMAT = 15,
+	BC3_UNORM_IMAGE_FORMAT = 16,
+	BC3_SRGB_IMAGE_FORMAT = 17,
+	BC4_UNORM_IMAGE_FORMAT = 18,
+	BC4_SNORM_IMAGE_FORMAT = 19,
+	BC5_UNORM_IMAGE_FORMAT = 20,
+	BC5_SNORM_IMAGE_FORMAT = 21,
+	BC6H_UFLOAT_IMAGE_FORMAT = 22,
+	BC6H_SFLOAT_IMAGE_FORMAT = 23,
+	BC7_UNORM_IMAGE_FORMAT = 24,
+	BC7_SRGB_IMAGE_FORMAT = 25,
+	ETC2_R8G8B8_UNORM_IMAGE_FORMAT = 26,
+	ETC2_R8G8B8_SRGB_IMAGE_FORMAT = 27,
+	ETC2_R8G8B8A1_UNORM_IMAGE_FORMAT = 28,
+	ETC2_R8G8B8A1_SRGB_IMAGE_FORMAT = 29,
+	ETC2_R8G8B8A8_UNORM_IMAGE_FORMAT = 30,
+	ETC2_R8G8B8A8_SRGB_IMAGE_FORMAT = 31,
+	EAC_R11_UNORM_IMAGE_FORMAT = 32,
+	EAC_R11_SNORM_IMAGE_FORMAT = 33,
+	EAC_R11G11_UNORM_IMAGE_FORMAT = 34,
+	EAC_R11G11_SNORM_IMAGE_FORMAT = 35,
+	ASTC_4X4_UNORM_IMAGE_FORMAT = 36,
+	ASTC_4X4_SRGB_IMAGE_FORMAT = 37,
+	ASTC_5X4_UNORM_IMAGE_FORMAT = 38,
+	ASTC_5X4_SRGB_IMAGE_FORMAT = 39,
+	ASTC_5X5_UNORM_IMAGE_FORMAT = 40,
+	ASTC_5X5_SRGB_IMAGE_FORMAT = 41,
+	ASTC_6X5_UNORM_IMAGE_FORMAT = 42,
+	ASTC_6X5_SRGB_IMAGE_FORMAT = 43,
+	ASTC_6X6_UNORM_IMAGE_FORMAT = 44,
+	ASTC_6X6_SRGB_IMAGE_FORMAT = 45,
+	ASTC_8X5_UNORM_IMAGE_FORMAT = 46,
+	ASTC_8X5_SRGB_IMAGE_FORMAT = 47,
+	ASTC_8X6_UNORM_IMAGE_FORMAT = 48,
+	ASTC_8X6_SRGB_IMAGE_FORMAT = 49,
+	ASTC_8X8_UNORM_IMAGE_FORMAT = 50,
+	ASTC_8X8_SRGB_IMAGE_FORMAT = 51,
+	ASTC_10X5_UNORM_IMAGE_FORMAT = 52,
+	ASTC_10X5_SRGB_IMAGE_FORMAT = 53,
+	ASTC_10X6_UNORM_IMAGE_FORMAT = 54,
+	ASTC_10X6_SRGB_IMAGE_FORMAT = 55,
+	ASTC_10X8_UNORM_IMAGE_FORMAT = 56,
+	ASTC_10X8_SRGB_IMAGE_FORMAT = 57,
+	ASTC_10X10_UNORM_IMAGE_FORMAT = 58,
+	ASTC_10X10_SRGB_IMAGE_FORMAT = 59,
+	ASTC_12X10_UNORM_IMAGE_FORMAT = 60,
+	ASTC_12X10_SRGB_IMAGE_FORMAT = 61,
+	ASTC_12X12_UNORM_IMAGE_FORMAT = 62,
+	ASTC_12X12_SRGB_IMAGE_FORMAT = 63,
+	R8G8_UNORM_IMAGE_FORMAT = 64,
+	R16_SFLOAT_IMAGE_FORMAT = 65,
+	R16G16_SFLOAT_IMAGE_FORMAT = 66,
+	R32_SFLOAT_IMAGE_FORMAT = 67,
+	R32G32B32A32_SFLOAT_IMAGE_FORMAT = 68,
+	B10G11R11_UFLOAT_IMAGE_FORMAT = 69,
+	A2B10G10R10_UNORM_IMAGE_FORMAT = 70,
+	R8_UINT_IMAGE_FORMAT = 71,
+	R16_UINT_IMAGE_FORMAT = 72,
+	R32_UINT_IMAGE_FORMAT = 73,
+	R32_SINT_IMAGE_FORMAT = 74,
+	R16G16_UINT_IMAGE_FORMAT = 75,
+	R8G8B8A8_UINT_IMAGE_FORMAT = 76,
+	R16G16B16A16_UINT_IMAGE_FORMAT = 77,
+	R32G32B32A32_UINT_IMAGE_FORMAT = 78,
+	IMAGE_FORMAT_COUNT = 79,
 } ImageFormat_T;
 /*
  * Image format type.
@@ -548,6 +616,35 @@ typedef enum IndexType_T
  */
 typedef uint8_t IndexType;
 
+/*
+ * Framebuffer attachment load operation types.
+ */
+typedef enum AttachmentLoadOp_T
+{
+	LOAD_ATTACHMENT_LOAD_OP = 0,
+	CLEAR_ATTACHMENT_LOAD_OP = 1,
+	DONT_CARE_ATTACHMENT_LOAD_OP = 2,
+	ATTACHMENT_LOAD_OP_COUNT = 3,
+} AttachmentLoadOp_T;
+/*
+ * Framebuffer attachment load operation type.
+ */
+typedef uint8_t AttachmentLoadOp;
+
+/*
+ * Framebuffer attachment store operation types.
+ */
+typedef enum AttachmentStoreOp_T
+{
+	STORE_ATTACHMENT_STORE_OP = 0,
+	DONT_CARE_ATTACHMENT_STORE_OP = 1,
+	ATTACHMENT_STORE_OP_COUNT = 2,
+} AttachmentStoreOp_T;
+/*
+ * Framebuffer attachment store operation type.
+ */
+typedef uint8_t AttachmentStoreOp;
+
 /*
  * Framebuffer depth stencil clear data structure.
  */
@@ -558,6 +655,7 @@ typedef struct DepthStencilClear
 } DepthStencilClear;
 /*
  * Framebuffer clear data structure.
+ * (integer attachments use the truncated color values)
  */
 typedef union FramebufferClear
 {
@@ -596,6 +694,7 @@ typedef struct GraphicsPipelineState
 	Vec2F depthRange;
 	Vec2F depthBias;
 	Vec4F blendColor;
+	uint8_t subpassIndex;
 } GraphicsPipelineState;
 
 /*
@@ -700,6 +799,50 @@ typedef RayTracingScene_T* RayTracingScene;
  * argument - function argument or NULL.
  */
 typedef void(*OnWindowUpdate)(void* argument);
+/*
+ * Image readback function.
+ * Data pointer is valid only inside the function.
+ *
+ * ticket - readback request ticket.
+ * data - read pixel data or NULL on failure.
+ * size - read pixel data size in bytes.
+ * argument - function argument or NULL.
+ */
+typedef void(*OnImageReadback)(
+	uint64_t ticket, const void* data, size_t size, void* argument);
+
+/*
+ * Buffer data set info structure.
+ */
+typedef struct BufferDataInfo
+{
+	Buffer buffer;
+	const void* data;
+	size_t size;
+	size_t offset;
+} BufferDataInfo;
+/*
+ * Image data set info structure.
+ */
+typedef struct ImageDataInfo
+{
+	Image image;
+	const void* data;
+	Vec3I size;
+	Vec3I offset;
+	uint32_t baseLayer;
+	uint32_t layerCount;
+	uint8_t mipLevel;
+} ImageDataInfo;
+
+/*
+ * Sparse image page.
+ */
+typedef struct ImagePage
+{
+	Vec3I offset;
+	uint8_t mipLevel;
+} ImagePage;
 
 /*
  * Graphics pipeline destroy function.
@@ -726,11 +869,38 @@ typedef void(*OnGraphicsPipelineUniformsSet)(
  *
  * graphicsPipeline - graphics pipeline instance.
  * newSize - new framebuffer size value.
- * vkCreateData - VkGraphicsPipelineCreateData. (NULL in OpenGL)
+ * vkCreateData - VkGraphicsPipelineCreateData. (NULL in OpenGL, ignored if reflected)
  */
 typedef void(*OnGraphicsPipelineResize)(
 	GraphicsPipeline graphicsPipeline,
 	Vec2I newSize, void* vkCreateData);
+/*
+ * Graphics pipeline ready function.
+ *
+ * graphicsPipeline - graphics pipeline instance.
+ * result - pipeline compilation MPGX result.
+ */
+typedef void(*OnGraphicsPipelineReady)(
+	GraphicsPipeline graphicsPipeline,
+	MpgxResult result);
+
+/*
+ * Graphics pipeline batch create info structure.
+ */
+typedef struct GraphicsPipelineInfo
+{
+	Framebuffer framebuffer;
+	const char* name;
+	const GraphicsPipelineState* state;
+	OnGraphicsPipelineBind onBind;
+	OnGraphicsPipelineUniformsSet onUniformsSet;
+	OnGraphicsPipelineResize onResize;
+	OnGraphicsPipelineDestroy onDestroy;
+	void* handle;
+	const void* createData;
+	Shader* shaders;
+	size_t shaderCount;
+} GraphicsPipelineInfo;
 
 /*
  * Compute pipeline destroy function.
@@ -863,17 +1033,23 @@ GraphicsAPI getGraphicsAPI();
  * onUpdate - on window update function.
  * updateArgument - onUpdate function argument.
  * useStencilBuffer - use stencil buffer in the framebuffer.
+ * sampleCount - framebuffer MSAA sample count. (1 to disable)
  * useDeferredShading - use deferred shading framebuffer.
  * useRayTracing - use ray tracing extension.
+ * cacheDirectory - pipeline cache directory path or NULL.
  * parent - window parent or NULL.
  * window - pointer to the window.
+ *
+ * Sample count is clamped to the highest supported value.
  */
 MpgxResult createWindow(
 	OnWindowUpdate onUpdate,
 	void* updateArgument,
 	bool useStencilBuffer,
+	uint8_t sampleCount,
 	bool useDeferredShading,
 	bool useRayTracing,
+	const char* cacheDirectory,
 	Window parent,
 	Window* window);
 /*
@@ -944,6 +1120,13 @@ const char* getWindowGpuName(Window window);
  * window - window instance.
  */
 const char* getWindowGpuDriver(Window window);
+/*
+ * Returns window graphics pipeline count
+ * waiting for the background compilation.
+ *
+ * window - window instance.
+ */
+size_t getWindowPendingPipelineCount(Window window);
 
 /*
  * Returns Vulkan window instance.
@@ -1416,6 +1599,18 @@ MpgxResult setBufferData(
 	const void* data,
 	size_t size,
 	size_t offset);
+/*
+ * Set multiple buffers data in one call.
+ * Device local buffers are written through the one transfer
+ * command buffer submit. (require transfer destination type)
+ * Returns operation MPGX result.
+ *
+ * infos - buffer data info array.
+ * infoCount - buffer data info count.
+ */
+MpgxResult setBuffersData(
+	const BufferDataInfo* infos,
+	size_t infoCount);
 
 /*
  * Create a new mipmap image instance.
@@ -1445,6 +1640,7 @@ MpgxResult createMipmapImage(
 	Image* image);
 /*
  * Create a new image instance.
+ * Generated mipmap chain is blitted on the GPU from the base level.
  * Returns operation MPGX result.
  *
  * window - window instance.
@@ -1454,6 +1650,7 @@ MpgxResult createMipmapImage(
  * data - pixel data or NULL.
  * size - image size in pixels.
  * layerCount - array layer count.
+ * generateMipmap - generate full mipmap chain. (requires data)
  * isConstant - is image constant.
  * image - pointer to the image.
  */
@@ -1465,8 +1662,73 @@ MpgxResult createImage(
 	const void* data,
 	Vec3I size,
 	uint32_t layerCount,
+	bool generateMipmap,
 	bool isConstant,
 	Image* image);
+/*
+ * Create a new image instance sharing base image memory.
+ * Aliased images can be used one after another inside a frame,
+ * using another alias discards the memory content.
+ * Aliased images should be destroyed before the base image.
+ * Returns operation MPGX result.
+ *
+ * baseImage - base image instance.
+ * type - type mask
+ * format - format type.
+ * size - image size in pixels.
+ * image - pointer to the image.
+ */
+MpgxResult createAliasImage(
+	Image baseImage,
+	ImageType type,
+	ImageFormat format,
+	Vec3I size,
+	Image* image);
+/*
+ * Create a new streaming image instance.
+ * Only the coarsest mip levels are uploaded on creation,
+ * finer levels become resident progressively at the
+ * window record begin, within the window streaming budget.
+ * Returns operation MPGX result.
+ *
+ * window - window instance.
+ * dimension - dimension type.
+ * format - format type.
+ * data - mipmap pixel data array. (should be valid until destroyed)
+ * size - image size in pixels.
+ * mipCount - mipmap level count.
+ * residentMipCount - initially resident coarsest level count.
+ * image - pointer to the image.
+ */
+MpgxResult createStreamingImage(
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint8_t mipCount,
+	uint8_t residentMipCount,
+	Image* image);
+/*
+ * Create a new sparse image instance.
+ * Image memory is committed page by page from the shared
+ * memory pool, only the mipmap tail is always resident.
+ * Returns operation MPGX result.
+ *
+ * window - window instance.
+ * dimension - dimension type.
+ * format - format type.
+ * size - image size in pixels.
+ * mipCount - mipmap level count.
+ * image - pointer to the image.
+ */
+MpgxResult createSparseImage(
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	Vec3I size,
+	uint8_t mipCount,
+	Image* image);
 /*
  * Destroys image instance.
  * image - image instance or NULL.
@@ -1478,7 +1740,7 @@ void destroyImage(Image image);
  * Returns operation MPGX result.
  *
  * image - image instance.
- * data - mipmap pixel data array.
+ * data - mipmap pixel data array. (NULL levels are skipped)
  * size - data size in pixels.
  * offset - data offset in pixels or 0.
  */
@@ -1492,9 +1754,9 @@ MpgxResult setMipmapImageData(
  * Returns operation MPGX result.
  *
  * image - image instance.
- * data - pixel data.
+ * data - pixel data. (block data for the compressed formats)
  * size - data size in pixels.
- * offset - data offset in pixels or 0.
+ * offset - data offset in pixels or 0. (aligned to the format block size)
  * mipLevel - mipmap level index.
  */
 MpgxResult setImageData(
@@ -1503,6 +1765,64 @@ MpgxResult setImageData(
 	Vec3I size,
 	Vec3I offset,
 	uint8_t mipLevel);
+/*
+ * Set image array layer range pixel data.
+ * Texels outside of the region keep their content.
+ * Returns operation MPGX result.
+ *
+ * image - image instance.
+ * data - tightly packed layer pixel data.
+ * size - data size in pixels. (block aligned unless it reaches the mip edge)
+ * offset - data offset in pixels or 0. (aligned to the format block size)
+ * mipLevel - mipmap level index.
+ * baseLayer - first array layer index.
+ * layerCount - array layer count.
+ */
+MpgxResult setImageLayerData(
+	Image image,
+	const void* data,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount);
+/*
+ * Set multiple images pixel data in one call.
+ * All copies are recorded into the one transfer command buffer.
+ * Returns operation MPGX result.
+ *
+ * infos - image data info array.
+ * infoCount - image data info count.
+ */
+MpgxResult setImagesData(
+	const ImageDataInfo* infos,
+	size_t infoCount);
+/*
+ * Request asynchronous image pixel data read. (Rendering command)
+ * Data is delivered at one of the next record begins,
+ * after the GPU finishes the copy, without a queue wait.
+ * Returns operation MPGX result.
+ *
+ * image - image instance.
+ * size - image part size.
+ * offset - image part offset.
+ * mipLevel - mipmap level index.
+ * baseLayer - first array layer index.
+ * layerCount - array layer count.
+ * onReadback - on readback function.
+ * argument - readback function argument or NULL.
+ * ticket - pointer to the readback request ticket.
+ */
+MpgxResult readImageData(
+	Image image,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount,
+	OnImageReadback onReadback,
+	void* argument,
+	uint64_t* ticket);
 
 /*
  * Returns image window instance.
@@ -1545,6 +1865,145 @@ Vec3I getImageSize(Image image);
  */
 bool isImageConstant(Image image);
 
+/*
+ * Commits sparse image pages memory.
+ * Returns operation MPGX result.
+ *
+ * image - sparse image instance.
+ * pages - page array. (offset in pages)
+ * pageCount - page array size.
+ */
+MpgxResult commitImagePages(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount);
+/*
+ * Decommits sparse image pages memory.
+ * Sampling decommitted pages returns undefined values.
+ * Returns operation MPGX result.
+ *
+ * image - sparse image instance.
+ * pages - page array. (offset in pages)
+ * pageCount - page array size.
+ */
+MpgxResult decommitImagePages(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount);
+
+/*
+ * Returns true if image is created as sparse.
+ * image - image instance.
+ */
+bool isImageSparse(Image image);
+/*
+ * Returns sparse image page size in pixels.
+ * image - sparse image instance.
+ */
+Vec3I getImagePageSize(Image image);
+/*
+ * Returns first sparse image mipmap tail level.
+ * (levels starting from it are always resident)
+ *
+ * image - sparse image instance.
+ */
+uint8_t getImageMipTail(Image image);
+/*
+ * Returns sparse image committed page count.
+ * image - sparse image instance.
+ */
+size_t getImageCommittedPageCount(Image image);
+
+/*
+ * Returns true if image is created as streaming.
+ * image - image instance.
+ */
+bool isImageStreaming(Image image);
+/*
+ * Sets streaming image priority.
+ * Higher priority images are uploaded first
+ * and evicted last when out of memory budget.
+ *
+ * image - streaming image instance.
+ * priority - image priority value.
+ */
+void setImageStreamPriority(
+	Image image,
+	float priority);
+/*
+ * Requests streaming image mipmap level residency.
+ * Usually called with the LOD feedback from the previous frame.
+ *
+ * image - streaming image instance.
+ * mipLevel - most detailed required mipmap level.
+ */
+void requestImageStreamMip(
+	Image image,
+	uint8_t mipLevel);
+/*
+ * Returns most detailed resident mipmap level.
+ * Should be used as a minimal sampler LOD for the
+ * formats which are not filled from the resident level.
+ *
+ * image - streaming image instance.
+ */
+uint8_t getImageResidentMip(Image image);
+/*
+ * Sets window image streaming budget.
+ *
+ * window - window instance.
+ * memoryBudget - resident level memory budget in bytes.
+ * uploadBudget - per frame upload size in bytes.
+ */
+void setWindowStreamingBudget(
+	Window window,
+	size_t memoryBudget,
+	size_t uploadBudget);
+/*
+ * Returns window resident streaming image memory in bytes.
+ * window - window instance.
+ */
+size_t getWindowStreamingMemory(Window window);
+
+/*
+ * Returns true if image format is supported by the device.
+ * (block-compressed format support depends on the GPU)
+ *
+ * window - window instance.
+ * type - image type mask.
+ * format - image format type.
+ * isConstant - is image constant.
+ */
+bool isImageFormatSupported(
+	Window window,
+	ImageType type,
+	ImageFormat format,
+	bool isConstant);
+/*
+ * Returns first supported image format from the array.
+ * (IMAGE_FORMAT_COUNT if none of the formats is supported)
+ * Formats should be ordered from the cheapest one.
+ *
+ * window - window instance.
+ * type - image type mask.
+ * formats - image format array.
+ * formatCount - image format count.
+ * isConstant - is image constant.
+ */
+ImageFormat getBestImageFormat(
+	Window window,
+	ImageType type,
+	const ImageFormat* formats,
+	size_t formatCount,
+	bool isConstant);
+/*
+ * Returns image format block size in pixels.
+ * Compressed image data size and offset should be aligned to it.
+ * (1x1 for the uncompressed formats)
+ * format - image format type.
+ */
+Vec2I getImageFormatBlockSize(ImageFormat format);
+
 /*
  * Calculates image mip level count based on size.
  * size - image size in pixels.
@@ -1560,6 +2019,7 @@ inline static uint8_t calcMipLevelCount(Vec3I size)
 
 /*
  * Create a new sampler instance.
+ * Returns existing instance if the same parameters were already used.
  * Returns operation MPGX result.
  *
  * window - window instance.
@@ -1574,7 +2034,10 @@ inline static uint8_t calcMipLevelCount(Vec3I size)
  * useCompare - use image depth compare.
  * mipmapLodRange - image mipmap level of detail range.
  * mipmapLodBias - image mipmap level of detail bias.
+ * maxAnisotropy - maximal anisotropy. (1.0 to disable)
  * sampler - pointer to the sampler instance.
+ *
+ * Anisotropy is clamped to the device limit.
  */
 MpgxResult createSampler(
 	Window window,
@@ -1589,9 +2052,11 @@ MpgxResult createSampler(
 	bool useCompare,
 	Vec2F mipmapLodRange,
 	float mipmapLodBias,
+	float maxAnisotropy,
 	Sampler* sampler);
 /*
- * Destroys sampler instance.
+ * Releases sampler instance reference.
+ * Destroys instance when the last reference is released.
  * sampler - sampler instance or NULL.
  */
 void destroySampler(Sampler sampler);
@@ -1656,9 +2121,15 @@ Vec2F getSamplerMipmapLodRange(Sampler sampler);
  * sampler - sampler instance.
  */
 float getSamplerMipmapLodBias(Sampler sampler);
+/*
+ * Returns sampler maximal anisotropy.
+ * sampler - sampler instance.
+ */
+float getSamplerMaxAnisotropy(Sampler sampler);
 
 /*
  * Create a new shader instance.
+ * Returns existing instance if the same code was already loaded.
  * Returns operation MPGX result.
  *
  * window - window instance.
@@ -1674,7 +2145,8 @@ MpgxResult createShader(
 	size_t size,
 	Shader* shader);
 /*
- * Destroys shader instance.
+ * Releases shader instance reference.
+ * Destroys instance when the last reference is released.
  * shader - shader instance or NULL.
  */
 void destroyShader(Shader shader);
@@ -1696,16 +2168,65 @@ ShaderType getShaderType(Shader shader);
  *
  * window - window instance.
  * size - framebuffer size in pixels.
+ * sampleCount - MSAA sample count. (1 to disable)
  * useBeginClear - use begin function clear values.
  * colorAttachments - color attachment instance array or NULL.
  * colorAttachmentCount - color attachment count or 0.
  * depthStencilAttachment - depth/stencil attachment instance or NULL.
+ * loadOps - attachment load operation array or NULL.
+ * storeOps - attachment store operation array or NULL.
  * framebuffer - pointer to the framebuffer instance.
+ *
+ * Multisampled attachments are resolved to the color
+ * attachments at the render end, inside the render pass.
+ * Depth/stencil is not resolved, it should be transient.
+ *
+ * Operations are ordered as color and depth/stencil.
+ * Attachments are cleared or discarded if loadOps is NULL,
+ * depending on useBeginClear, and stored if storeOps is NULL.
+ * Clear load operation requires useBeginClear to be true,
+ * multisampled attachments can not be loaded.
  */
 MpgxResult createFramebuffer(
+	Window window,
+	Vec2I size,
+	uint8_t sampleCount,
+	bool useBeginClear,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	Framebuffer* framebuffer);
+/*
+ * Create a new deferred framebuffer instance.
+ * First subpass writes G-buffer and depth/stencil attachments,
+ * second subpass reads them as the input attachments
+ * and writes the color attachments. (lighting)
+ * Transient G-buffer attachments are not stored to the memory.
+ * Returns operation MPGX result.
+ *
+ * window - window instance.
+ * size - framebuffer size in pixels.
+ * useBeginClear - use begin function clear values.
+ * gBufferAttachments - G-buffer attachment instance array.
+ * gBufferAttachmentCount - G-buffer attachment count.
+ * colorAttachments - color attachment instance array.
+ * colorAttachmentCount - color attachment count.
+ * depthStencilAttachment - depth/stencil attachment instance or NULL.
+ * framebuffer - pointer to the framebuffer instance.
+ *
+ * Clear values are ordered as color, G-buffer and depth/stencil.
+ * Input attachment indices are G-buffer and depth/stencil order.
+ * OpenGL renders subpasses to the separate framebuffers,
+ * G-buffer attachments should be bound as the sampled images.
+ */
+MpgxResult createDeferredFramebuffer(
 	Window window,
 	Vec2I size,
 	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	Image depthStencilAttachment,
@@ -1747,6 +2268,23 @@ Vec2I getFramebufferSize(Framebuffer framebuffer);
  * framebuffer - framebuffer instance.
  */
 bool isFramebufferUseBeginClear(Framebuffer framebuffer);
+/*
+ * Returns framebuffer MSAA sample count.
+ * framebuffer - framebuffer instance.
+ */
+uint8_t getFramebufferSampleCount(Framebuffer framebuffer);
+/*
+ * Returns framebuffer attachment load operation array.
+ * (NULL if operations are derived from useBeginClear)
+ * framebuffer - framebuffer instance.
+ */
+const AttachmentLoadOp* getFramebufferLoadOps(Framebuffer framebuffer);
+/*
+ * Returns framebuffer attachment store operation array.
+ * (NULL if all attachments are stored)
+ * framebuffer - framebuffer instance.
+ */
+const AttachmentStoreOp* getFramebufferStoreOps(Framebuffer framebuffer);
 /*
  * Returns framebuffer color attachment array.
  * framebuffer - framebuffer instance.
@@ -1762,6 +2300,17 @@ size_t getFramebufferColorAttachmentCount(Framebuffer framebuffer);
  * framebuffer - framebuffer instance.
  */
 Image getFramebufferDepthStencilAttachment(Framebuffer framebuffer);
+/*
+ * Returns framebuffer G-buffer attachment array.
+ * framebuffer - framebuffer instance.
+ */
+Image* getFramebufferGBufferAttachments(Framebuffer framebuffer);
+/*
+ * Returns framebuffer G-buffer attachment count.
+ * (0 if framebuffer is not deferred)
+ * framebuffer - framebuffer instance.
+ */
+size_t getFramebufferGBufferAttachmentCount(Framebuffer framebuffer);
 /*
  * Returns true if framebuffer is created by the window.
  * framebuffer - framebuffer instance.
@@ -1773,6 +2322,28 @@ bool isFramebufferDefault(Framebuffer framebuffer);
  */
 size_t getFramebufferPipelineCount(Framebuffer framebuffer);
 
+/*
+ * Request asynchronous framebuffer color attachment read. (Rendering command)
+ * Should be called outside the framebuffer render pass.
+ * Returns operation MPGX result.
+ *
+ * framebuffer - framebuffer instance.
+ * attachmentIndex - color attachment index.
+ * size - framebuffer part size.
+ * offset - framebuffer part offset.
+ * onReadback - on readback function.
+ * argument - readback function argument or NULL.
+ * ticket - pointer to the readback request ticket.
+ */
+MpgxResult readFramebufferData(
+	Framebuffer framebuffer,
+	size_t attachmentIndex,
+	Vec2I size,
+	Vec2I offset,
+	OnImageReadback onReadback,
+	void* argument,
+	uint64_t* ticket);
+
 /*
  * Set framebuffer attachments.
  * Returns operation MPGX result.
@@ -1783,6 +2354,8 @@ size_t getFramebufferPipelineCount(Framebuffer framebuffer);
  * colorAttachments - color attachment instance array or NULL.
  * colorAttachmentCount - color attachment count or 0.
  * depthStencilAttachment - depth/stencil attachment instance or NULL.
+ * loadOps - attachment load operation array or NULL.
+ * storeOps - attachment store operation array or NULL.
  */
 MpgxResult setFramebufferAttachments(
 	Framebuffer framebuffer,
@@ -1790,6 +2363,30 @@ MpgxResult setFramebufferAttachments(
 	bool useBeginClear,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps);
+/*
+ * Set deferred framebuffer attachments.
+ * Returns operation MPGX result.
+ *
+ * framebuffer - deferred framebuffer instance.
+ * size - framebuffer size in pixels.
+ * useBeginClear - use begin function clear values.
+ * gBufferAttachments - G-buffer attachment instance array.
+ * gBufferAttachmentCount - G-buffer attachment count.
+ * colorAttachments - color attachment instance array.
+ * colorAttachmentCount - color attachment count.
+ * depthStencilAttachment - depth/stencil attachment instance or NULL.
+ */
+MpgxResult setDeferredFramebufferAttachments(
+	Framebuffer framebuffer,
+	Vec2I size,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
 	Image depthStencilAttachment);
 
 /*
@@ -1808,9 +2405,16 @@ void beginFramebufferRender(
  * framebuffer - framebuffer instance.
  */
 void endFramebufferRender(Framebuffer framebuffer);
+/*
+ * Switch to the deferred framebuffer lighting subpass.
+ * Should be called once between begin and end render.
+ * framebuffer - deferred framebuffer instance.
+ */
+void nextFramebufferSubpass(Framebuffer framebuffer);
 
 /*
  * Clears framebuffer attachments.
+ * (not supported by the deferred framebuffers)
  *
  * framebuffer - framebuffer instance.
  * clearAttachments - target clear attachment array.
@@ -1837,6 +2441,8 @@ void enumerateFramebufferGraphicsPipelines(
 
 /*
  * Create a new graphics pipeline instance.
+ * Reflected Vulkan pipelines are fast linked from the
+ * cached pipeline libraries if supported by the device.
  * Returns operation MPGX result.
  *
  * framebuffer - framebuffer instance.
@@ -1847,7 +2453,7 @@ void enumerateFramebufferGraphicsPipelines(
  * onResize - on graphics pipeline resize function.
  * onDestroy - on graphics pipeline destroy function.
  * handle - graphics pipeline handle.
- * createData - Vulkan create data. (NULL in OpenGL)
+ * createData - Vulkan create data or NULL to reflect shaders. (NULL in OpenGL)
  * shaders - shader instance array.
  * shaderCount - shader count.
  * graphicsPipeline - pointer to the graphics pipeline.
@@ -1865,6 +2471,58 @@ MpgxResult createGraphicsPipeline(
 	Shader* shaders,
 	size_t shaderCount,
 	GraphicsPipeline* graphicsPipeline);
+/*
+ * Create a new graphics pipeline instance,
+ * compiled on the background threads.
+ * Draws with the pending pipeline use fallback or are skipped.
+ * Fallback should be destroyed after the pipelines using it.
+ * (OpenGL pipeline is compiled immediately)
+ * Returns operation MPGX result.
+ *
+ * framebuffer - framebuffer instance.
+ * name - name string or NULL. (for debugging)
+ * state - graphics pipeline state.
+ * onBind - on graphics pipeline bind function or NULL.
+ * onUniformsSet - on graphics pipeline uniforms set function or NULL.
+ * onResize - on graphics pipeline resize function.
+ * onDestroy - on graphics pipeline destroy function.
+ * onReady - on graphics pipeline ready function or NULL.
+ * handle - graphics pipeline handle.
+ * createData - Vulkan create data or NULL to reflect shaders. (NULL in OpenGL)
+ * shaders - shader instance array.
+ * shaderCount - shader count.
+ * fallback - fallback graphics pipeline or NULL.
+ * graphicsPipeline - pointer to the graphics pipeline.
+ */
+MpgxResult createAsyncGraphicsPipeline(
+	Framebuffer framebuffer,
+	const char* name,
+	const GraphicsPipelineState* state,
+	OnGraphicsPipelineBind onBind,
+	OnGraphicsPipelineUniformsSet onUniformsSet,
+	OnGraphicsPipelineResize onResize,
+	OnGraphicsPipelineDestroy onDestroy,
+	OnGraphicsPipelineReady onReady,
+	void* handle,
+	const void* createData,
+	Shader* shaders,
+	size_t shaderCount,
+	GraphicsPipeline fallback,
+	GraphicsPipeline* graphicsPipeline);
+/*
+ * Create a new graphics pipeline instance array.
+ * Vulkan pipelines of the same framebuffer are created
+ * with one call, split between the background threads.
+ * Returns operation MPGX result.
+ *
+ * infos - graphics pipeline create info array.
+ * infoCount - graphics pipeline create info count.
+ * graphicsPipelines - pointer to the graphics pipeline array.
+ */
+MpgxResult createGraphicsPipelines(
+	const GraphicsPipelineInfo* infos,
+	size_t infoCount,
+	GraphicsPipeline* graphicsPipelines);
 /*
  * Destroys graphics pipeline instance.
  * pipeline - graphics pipeline instance or NULL.
@@ -1926,12 +2584,23 @@ size_t getGraphicsPipelineShaderCount(GraphicsPipeline pipeline);
  * pipeline - graphics pipeline instance.
  */
 Window getGraphicsPipelineWindow(GraphicsPipeline pipeline);
+/*
+ * Returns graphics pipeline fallback instance or NULL.
+ * pipeline - graphics pipeline instance.
+ */
+GraphicsPipeline getGraphicsPipelineFallback(GraphicsPipeline pipeline);
+/*
+ * Returns true if graphics pipeline is compiled.
+ * pipeline - graphics pipeline instance.
+ */
+bool isGraphicsPipelineReady(GraphicsPipeline pipeline);
 
 /*
  * Binds graphics pipeline. (rendering command)
+ * Returns the compile error if async pipeline failed.
  * pipeline - graphics pipeline instance.
  */
-void bindGraphicsPipeline(GraphicsPipeline pipeline);
+MpgxResult bindGraphicsPipeline(GraphicsPipeline pipeline);
 
 /*
  * Create a new graphics mesh instance.
@@ -2048,7 +2717,7 @@ size_t drawGraphicsMesh(GraphicsPipeline pipeline, GraphicsMesh mesh);
  * onBind - on compute pipeline bind function or NULL.
  * onDestroy - on compute pipeline destroy function.
  * handle - compute pipeline handle.
- * createData - Vulkan create data. (NULL in OpenGL)
+ * createData - Vulkan create data or NULL to reflect shaders. (NULL in OpenGL)
  * shader - compute shader instance.
  * computePipeline - pointer to the compute pipeline instance.
  */
@@ -0,0 +1,64 @@
+/*
+ * xxHash - Extremely Fast Hash algorithm
+ * Copyright (C) 2012-2021 Yann Collet
+ *
+ * BSD 2-Clause License (https://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at:
+ *   - xxHash homepage: https://www.xxhash.com
+ *   - xxHash source repository: https://github.com/Cyan4973/xxHash
+ */
+
+/*********************************************************************
+* Filename:   xxhash.h
+* Authors:    Yann Collet (xxHash algorithm), Nikita Fediuchin
+* Copyright:  2012-2021 Yann Collet, BSD 2-Clause License
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Defines the API for the corresponding XXH64 implementation.
+*********************************************************************/
+
+#pragma once
+
+/*************************** HEADER FILES ***************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/****************************** MACROS ******************************/
+#define XXH64_STRIPE_SIZE 32            // XXH64 consumes 32 byte stripes
+
+typedef struct {
+	uint64_t state[4];
+	uint64_t totalLength;
+	uint8_t data[XXH64_STRIPE_SIZE];
+	uint32_t dataLength;
+	uint32_t _alignment;
+} XXH64_CONTEXT;
+
+/*********************** FUNCTION DECLARATIONS **********************/
+void xxh64_init(XXH64_CONTEXT* context, uint64_t seed);
+void xxh64_update(XXH64_CONTEXT* context, const uint8_t data[], size_t length);
+uint64_t xxh64_final(const XXH64_CONTEXT* context);
+uint64_t xxh64(const uint8_t data[], size_t length, uint64_t seed);
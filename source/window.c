@@ -22,11 +22,36 @@
 
 #include "cmmt/common.h"
 #include "mpmt/common.h"
+#include "mpmt/thread_pool.h"
 
 #include <stdio.h>
 
+#define PIPELINE_THREAD_COUNT 4
+#define PIPELINE_TASK_CAPACITY 256
+#define PIPELINE_BATCH_MIN_SPLIT 16
+#define STREAMING_UPLOAD_BUDGET 16777216
+
 // TODO: add VMA defragmentation
 
+typedef struct ImageReadback
+{
+	OnImageReadback onReadback;
+	void* argument;
+	uint64_t ticket;
+	size_t dataSize;
+	size_t bufferSize;
+#if MPGX_SUPPORT_VULKAN
+	VkBuffer vkBuffer;
+	VmaAllocation vkAllocation;
+	uint32_t frameIndex;
+#endif
+#if MPGX_SUPPORT_OPENGL
+	GLuint glBuffer;
+	GLsync glSync;
+#endif
+	bool isPending;
+} ImageReadback;
+
 struct Window_T
 {
 	Window parent;
@@ -45,8 +70,24 @@ struct Window_T
 	uint32_t* inputBuffer;
 	size_t inputCapacity;
 	size_t inputLength;
+	char* cacheDirectory;
 #if MPGX_SUPPORT_VULKAN
 	VkWindow vkWindow;
+	ThreadPool pipelineThreadPool;
+	Mutex pipelineMutex;
+	VkGraphicsPipelineTask* pipelineTasks;
+	size_t pipelineTaskCapacity;
+	size_t pipelineTaskCount;
+	VkRenderPassCache renderPassCache;
+	VkRetiredFramebuffer* retiredFramebuffers;
+	size_t retiredFramebufferCapacity;
+	size_t retiredFramebufferCount;
+	VkRetiredImagePages* retiredImagePages;
+	size_t retiredImagePageCapacity;
+	size_t retiredImagePageCount;
+	VkComputePipelineEntry* computePipelineEntries;
+	size_t computePipelineEntryCapacity;
+	size_t computePipelineEntryCount;
 #endif
 	RayTracing rayTracing;
 	Framebuffer framebuffer;
@@ -56,6 +97,15 @@ struct Window_T
 	Image* images;
 	size_t imageCapacity;
 	size_t imageCount;
+	size_t streamingMemoryBudget;
+	size_t streamingUploadBudget;
+	size_t streamingMemory;
+	size_t streamingImageCount;
+	uint32_t streamingUpdateIndex;
+	ImageReadback* readbacks;
+	size_t readbackCapacity;
+	size_t readbackCount;
+	uint64_t readbackTicket;
 	Sampler* samplers;
 	size_t samplerCapacity;
 	size_t samplerCount;
@@ -106,6 +156,255 @@ static void glfwErrorCallback(int code, const char* description)
 	fprintf(stderr, "GLFW ERROR [%d]: %s\n", code, description);
 }
 
+#if MPGX_SUPPORT_VULKAN
+static void updateVkGraphicsPipelineTasks(Window window, bool wait)
+{
+	assert(window);
+
+	if (window->pipelineTaskCount == 0)
+		return;
+
+	if (wait)
+		waitThreadPool(window->pipelineThreadPool);
+
+	size_t i = 0;
+
+	// Ready function is able to create new pipelines,
+	// so task array is read again on each iteration.
+	while (i < window->pipelineTaskCount)
+	{
+		VkGraphicsPipelineTask* tasks = window->pipelineTasks;
+		VkGraphicsPipelineTask task = tasks[i];
+
+		if (!completeVkGraphicsPipelineTask(task))
+		{
+			i++;
+			continue;
+		}
+
+		size_t taskCount = window->pipelineTaskCount;
+
+		for (size_t j = i + 1; j < taskCount; j++)
+			tasks[j - 1] = tasks[j];
+
+		window->pipelineTaskCount = taskCount - 1;
+
+		GraphicsPipeline graphicsPipeline = task->graphicsPipeline;
+		OnGraphicsPipelineReady onReady = task->onReady;
+		MpgxResult mpgxResult = task->result;
+
+		releaseVkGraphicsPipelineTask(task);
+
+		if (onReady)
+			onReady(graphicsPipeline, mpgxResult);
+	}
+}
+static void cancelVkGraphicsPipelineTasks(
+	Window window,
+	GraphicsPipeline graphicsPipeline)
+{
+	assert(window);
+	assert(graphicsPipeline);
+
+	VkDevice device = window->vkWindow->device;
+	VkGraphicsPipelineTask* tasks = window->pipelineTasks;
+	size_t taskCount = window->pipelineTaskCount;
+	size_t count = 0;
+
+	for (size_t i = 0; i < taskCount; i++)
+	{
+		VkGraphicsPipelineTask task = tasks[i];
+
+		if (task->graphicsPipeline != graphicsPipeline)
+		{
+			tasks[count++] = task;
+			continue;
+		}
+
+		// Handle finished before the cancel is not used
+		vkDestroyPipeline(
+			device,
+			cancelVkGraphicsPipelineTask(task),
+			NULL);
+	}
+
+	window->pipelineTaskCount = count;
+	graphicsPipeline->vk.taskCount = 0;
+}
+static void updateVkRetiredFramebuffers(Window window, bool destroyAll)
+{
+	assert(window);
+
+	VkWindow vkWindow = window->vkWindow;
+	VkRetiredFramebuffer* retiredFramebuffers = window->retiredFramebuffers;
+	size_t retiredFramebufferCount = window->retiredFramebufferCount;
+	size_t count = 0;
+
+	for (size_t i = 0; i < retiredFramebufferCount; i++)
+	{
+		VkRetiredFramebuffer* retiredFramebuffer = &retiredFramebuffers[i];
+
+		// Only this frame index fence is waited at the record begin
+		if (!destroyAll &&
+			retiredFramebuffer->frameIndex != vkWindow->frameIndex)
+		{
+			retiredFramebuffers[count++] = *retiredFramebuffer;
+			continue;
+		}
+
+		destroyVkRetiredFramebuffer(
+			vkWindow->device,
+			vkWindow->allocator,
+			retiredFramebuffer);
+	}
+
+	window->retiredFramebufferCount = count;
+}
+static MpgxResult updateVkRetiredImagePages(Window window, bool isDeviceIdle)
+{
+	assert(window);
+
+	VkWindow vkWindow = window->vkWindow;
+	VkRetiredImagePages* retiredImagePages = window->retiredImagePages;
+	size_t retiredImagePageCount = window->retiredImagePageCount;
+	uint32_t frameIndex = vkWindow->frameIndex;
+	MpgxResult mpgxResult = SUCCESS_MPGX_RESULT;
+	size_t count = 0;
+
+	for (size_t i = 0; i < retiredImagePageCount; i++)
+	{
+		VkRetiredImagePages* retiredPages = &retiredImagePages[i];
+
+		if (!isDeviceIdle && retiredPages->frameIndex != frameIndex)
+		{
+			retiredImagePages[count++] = *retiredPages;
+			continue;
+		}
+
+		// Unbind has been waited by the frame of this fence
+		if (retiredPages->isUnbound)
+		{
+			destroyVkRetiredImagePages(
+				vkWindow->allocator,
+				retiredPages);
+			continue;
+		}
+
+		Image image = retiredPages->image;
+		VmaAllocation* sparsePages = image->vk.sparsePages;
+		VkSparseImageMemoryBind* binds = retiredPages->binds;
+		size_t* pageIndices = retiredPages->pageIndices;
+		uint32_t pageCount = retiredPages->pageCount;
+		uint32_t bindCount = 0;
+
+		// Recommitted pages are already bound to the new memory
+		for (uint32_t j = 0; j < pageCount; j++)
+		{
+			if (!sparsePages[pageIndices[j]])
+				binds[bindCount++] = binds[j];
+		}
+
+		if (bindCount == 0)
+		{
+			destroyVkRetiredImagePages(
+				vkWindow->allocator,
+				retiredPages);
+			continue;
+		}
+
+		if (mpgxResult == SUCCESS_MPGX_RESULT)
+		{
+			mpgxResult = bindVkSparseImage(
+				vkWindow,
+				image->vk.handle,
+				binds,
+				bindCount);
+		}
+
+		// Failed unbind is retried after the next fence wait
+		if (mpgxResult == SUCCESS_MPGX_RESULT)
+		{
+			retiredPages->isUnbound = true;
+			retiredPages->frameIndex = frameIndex;
+		}
+
+		retiredImagePages[count++] = *retiredPages;
+	}
+
+	window->retiredImagePageCount = count;
+	return mpgxResult;
+}
+static void destroyVkImageRetiredPages(Window window, Image image)
+{
+	assert(window);
+	assert(image);
+
+	VmaAllocator allocator = window->vkWindow->allocator;
+	VkRetiredImagePages* retiredImagePages = window->retiredImagePages;
+	size_t retiredImagePageCount = window->retiredImagePageCount;
+	size_t count = 0;
+
+	for (size_t i = 0; i < retiredImagePageCount; i++)
+	{
+		VkRetiredImagePages* retiredPages = &retiredImagePages[i];
+
+		if (retiredPages->image != image)
+		{
+			retiredImagePages[count++] = *retiredPages;
+			continue;
+		}
+
+		destroyVkRetiredImagePages(
+			allocator,
+			retiredPages);
+	}
+
+	window->retiredImagePageCount = count;
+}
+static MpgxResult getVkShaderReflectedLayout(
+	Window window,
+	Shader* shaders,
+	size_t shaderCount,
+	VkReflectedLayout* reflectedLayout)
+{
+	assert(window);
+	assert(shaders);
+	assert(shaderCount > 0);
+	assert(reflectedLayout);
+
+	VkShaderReflection* reflections = malloc(
+		shaderCount * sizeof(VkShaderReflection));
+
+	if (!reflections)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	for (size_t i = 0; i < shaderCount; i++)
+	{
+		VkShaderReflection reflection = shaders[i]->vk.reflection;
+
+		if (!reflection)
+		{
+			free(reflections);
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		}
+
+		reflections[i] = reflection;
+	}
+
+	VkWindow vkWindow = window->vkWindow;
+
+	MpgxResult mpgxResult = getVkReflectedLayout(
+		vkWindow->device,
+		vkWindow->layoutCache,
+		reflections,
+		shaderCount,
+		reflectedLayout);
+
+	free(reflections);
+	return mpgxResult;
+}
+#endif
+
 MpgxResult initializeGraphics(
 	GraphicsAPI api,
 	const char* engineName,
@@ -349,13 +648,16 @@ MpgxResult createWindow(
 	OnWindowUpdate onUpdate,
 	void* updateArgument,
 	bool useStencilBuffer,
+	uint8_t sampleCount,
 	bool useDeferredShading,
 	bool useRayTracing,
+	const char* cacheDirectory,
 	Window parent,
 	Window* window)
 {
 	assert(onUpdate);
 	assert(updateArgument);
+	assert(sampleCount > 0);
 	assert(window);
 
 	if (!graphicsInitialized)
@@ -395,6 +697,9 @@ MpgxResult createWindow(
 			glfwWindowHint(GLFW_STENCIL_BITS, 0);
 		}
 
+		glfwWindowHint(GLFW_SAMPLES,
+			sampleCount > 1 ? sampleCount : 0);
+
 #ifndef NDEBUG
 		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 #else
@@ -534,6 +839,25 @@ MpgxResult createWindow(
 	windowInstance->inputCapacity = 1;
 	windowInstance->inputLength = 0;
 
+	if (cacheDirectory)
+	{
+		size_t directoryLength = strlen(cacheDirectory);
+
+		char* directory = malloc(
+			(directoryLength + 1) * sizeof(char));
+
+		if (!directory)
+		{
+			destroyWindow(windowInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		memcpy(directory, cacheDirectory, directoryLength);
+		directory[directoryLength] = '\0';
+
+		windowInstance->cacheDirectory = directory;
+	}
+
 #if MPGX_SUPPORT_VULKAN
 	VkWindow vkWindow = NULL;
 #endif
@@ -550,7 +874,9 @@ MpgxResult createWindow(
 			handle,
 			useStencilBuffer,
 			useDeferredShading,
+			sampleCount,
 			useRayTracing,
+			cacheDirectory,
 			framebufferSize,
 			&vkWindow);
 
@@ -589,10 +915,12 @@ MpgxResult createWindow(
 
 		mpgxResult = createVkDefaultFramebuffer(
 			vkWindow->device,
+			vkWindow->allocator,
 			swapchain->renderPass,
 			firstBuffer.framebuffer,
 			windowInstance,
 			framebufferSize,
+			swapchain->sampleCount,
 			&framebuffer);
 
 		if (mpgxResult != SUCCESS_MPGX_RESULT)
@@ -602,6 +930,93 @@ MpgxResult createWindow(
 		}
 
 		windowInstance->framebuffer = framebuffer;
+
+		Mutex pipelineMutex = createMutex();
+
+		if (!pipelineMutex)
+		{
+			destroyWindow(windowInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		windowInstance->pipelineMutex = pipelineMutex;
+
+		ThreadPool pipelineThreadPool = createThreadPool(
+			PIPELINE_THREAD_COUNT,
+			PIPELINE_TASK_CAPACITY,
+			QUEUE_TASK_ORDER);
+
+		if (!pipelineThreadPool)
+		{
+			destroyWindow(windowInstance);
+			return FAILED_TO_INITIALIZE_MPGX_RESULT;
+		}
+
+		windowInstance->pipelineThreadPool = pipelineThreadPool;
+
+		VkGraphicsPipelineTask* pipelineTasks = malloc(
+			sizeof(VkGraphicsPipelineTask));
+
+		if (!pipelineTasks)
+		{
+			destroyWindow(windowInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		windowInstance->pipelineTasks = pipelineTasks;
+		windowInstance->pipelineTaskCapacity = 1;
+		windowInstance->pipelineTaskCount = 0;
+
+		VkRenderPassCache renderPassCache;
+
+		mpgxResult = createVkRenderPassCache(&renderPassCache);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyWindow(windowInstance);
+			return mpgxResult;
+		}
+
+		windowInstance->renderPassCache = renderPassCache;
+
+		VkRetiredFramebuffer* retiredFramebuffers = malloc(
+			sizeof(VkRetiredFramebuffer));
+
+		if (!retiredFramebuffers)
+		{
+			destroyWindow(windowInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		windowInstance->retiredFramebuffers = retiredFramebuffers;
+		windowInstance->retiredFramebufferCapacity = 1;
+		windowInstance->retiredFramebufferCount = 0;
+
+		VkRetiredImagePages* retiredImagePages = malloc(
+			sizeof(VkRetiredImagePages));
+
+		if (!retiredImagePages)
+		{
+			destroyWindow(windowInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		windowInstance->retiredImagePages = retiredImagePages;
+		windowInstance->retiredImagePageCapacity = 1;
+		windowInstance->retiredImagePageCount = 0;
+
+		VkComputePipelineEntry* computePipelineEntries = malloc(
+			sizeof(VkComputePipelineEntry));
+
+		if (!computePipelineEntries)
+		{
+			destroyWindow(windowInstance);
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		windowInstance->computePipelineEntries = computePipelineEntries;
+		windowInstance->computePipelineEntryCapacity = 1;
+		windowInstance->computePipelineEntryCount = 0;
 #else
 		abort();
 #endif
@@ -660,6 +1075,24 @@ MpgxResult createWindow(
 	windowInstance->images = images;
 	windowInstance->imageCapacity = 1;
 	windowInstance->imageCount = 0;
+	windowInstance->streamingMemoryBudget = SIZE_MAX;
+	windowInstance->streamingUploadBudget = STREAMING_UPLOAD_BUDGET;
+	windowInstance->streamingMemory = 0;
+	windowInstance->streamingImageCount = 0;
+	windowInstance->streamingUpdateIndex = 0;
+
+	ImageReadback* readbacks = malloc(sizeof(ImageReadback));
+
+	if (!readbacks)
+	{
+		destroyWindow(windowInstance);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
+
+	windowInstance->readbacks = readbacks;
+	windowInstance->readbackCapacity = 1;
+	windowInstance->readbackCount = 0;
+	windowInstance->readbackTicket = 0;
 
 	Sampler* samplers = malloc(sizeof(Sampler));
 
@@ -751,6 +1184,17 @@ void destroyWindow(Window window)
 #if MPGX_SUPPORT_VULKAN
 		VkWindow vkWindow = window->vkWindow;
 
+		if (window->pipelineThreadPool)
+		{
+			updateVkGraphicsPipelineTasks(window, true);
+			waitThreadPool(window->pipelineThreadPool);
+			destroyThreadPool(window->pipelineThreadPool);
+		}
+
+		assert(window->pipelineTaskCount == 0);
+		free(window->pipelineTasks);
+		destroyMutex(window->pipelineMutex);
+
 		if (vkWindow)
 		{
 			VkDevice device = vkWindow->device;
@@ -759,10 +1203,49 @@ void destroyWindow(Window window)
 			if (result != VK_SUCCESS)
 				abort();
 
-			destroyVkFramebuffer(device, window->framebuffer);
+			ImageReadback* readbacks = window->readbacks;
+			size_t readbackCount = window->readbackCount;
+
+			for (size_t i = 0; i < readbackCount; i++)
+			{
+				vmaDestroyBuffer(
+					vkWindow->allocator,
+					readbacks[i].vkBuffer,
+					readbacks[i].vkAllocation);
+			}
+
+			VkRetiredFramebuffer* retiredFramebuffers =
+				window->retiredFramebuffers;
+			size_t retiredFramebufferCount =
+				window->retiredFramebufferCount;
+
+			for (size_t i = 0; i < retiredFramebufferCount; i++)
+			{
+				destroyVkRetiredFramebuffer(
+					device,
+					vkWindow->allocator,
+					&retiredFramebuffers[i]);
+			}
+
+			destroyVkRenderPassCache(
+				device,
+				window->renderPassCache);
+			destroyVkFramebuffer(
+				device,
+				vkWindow->allocator,
+				window->framebuffer);
 			destroyVkRayTracing(window->rayTracing);
 			destroyVkWindow(vkInstance, vkWindow);
 		}
+
+		// Retired pages are destroyed with their images
+		assert(window->retiredImagePageCount == 0);
+		free(window->retiredImagePages);
+
+		// Entries are released with their compute pipelines
+		assert(window->computePipelineEntryCount == 0);
+		free(window->computePipelineEntries);
+		free(window->retiredFramebuffers);
 #else
 		abort();
 #endif
@@ -770,6 +1253,20 @@ void destroyWindow(Window window)
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
+		ImageReadback* readbacks = window->readbacks;
+		size_t readbackCount = window->readbackCount;
+
+		if (readbackCount > 0)
+			makeGlWindowContextCurrent(window);
+
+		for (size_t i = 0; i < readbackCount; i++)
+		{
+			glDeleteSync(readbacks[i].glSync);
+			glDeleteBuffers(
+				GL_ONE,
+				&readbacks[i].glBuffer);
+		}
+
 		destroyGlFramebuffer(window->framebuffer);
 #else
 		abort();
@@ -780,6 +1277,7 @@ void destroyWindow(Window window)
 		abort();
 	}
 
+	free(window->readbacks);
 	free(window->computePipelines);
 	free(window->graphicsMeshes);
 	free(window->shaders);
@@ -787,6 +1285,7 @@ void destroyWindow(Window window)
 	free(window->samplers);
 	free(window->images);
 	free(window->buffers);
+	free(window->cacheDirectory);
 	free(window->inputBuffer);
 
 	glfwDestroyCursor(window->vresizeCursor);
@@ -931,6 +1430,18 @@ const char* getWindowGpuDriver(Window window)
 		abort();
 	}
 }
+size_t getWindowPendingPipelineCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+
+#if MPGX_SUPPORT_VULKAN
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+		return window->pipelineTaskCount;
+#endif
+
+	return 0;
+}
 
 void* getVkWindow(Window window)
 {
@@ -1268,6 +1779,11 @@ void joinWindow(Window window)
 		window->inputLength = 0;
 		glfwPollEvents();
 
+#if MPGX_SUPPORT_VULKAN
+		if (graphicsAPI == VULKAN_GRAPHICS_API)
+			updateVkGraphicsPipelineTasks(window, false);
+#endif
+
 		glfwGetWindowSize(handle, &ix, &iy);
 		size = window->size = vec2I((cmmt_int_t)ix, (cmmt_int_t)iy);
 		glfwGetWindowPos(handle, &ix, &iy);
@@ -1295,6 +1811,8 @@ void joinWindow(Window window)
 				VkDevice device = vkWindow->device;
 				VkSwapchain swapchain = vkWindow->swapchain;
 
+				updateVkGraphicsPipelineTasks(window, true);
+
 				MpgxResult mpgxResult = resizeVkSwapchain(
 					vkWindow->surface,
 					vkWindow->physicalDevice,
@@ -1311,6 +1829,13 @@ void joinWindow(Window window)
 					window->useDeferredShading,
 					newFramebufferSize);
 
+				if (mpgxResult != SUCCESS_MPGX_RESULT)
+					abort();
+
+				// Swapchain resize waits for the device idle
+				updateVkRetiredFramebuffers(window, true);
+				mpgxResult = updateVkRetiredImagePages(window, true);
+
 				if (mpgxResult != SUCCESS_MPGX_RESULT)
 					abort();
 
@@ -1334,13 +1859,18 @@ void joinWindow(Window window)
 						framebuffer->vk.renderPass,
 						pipeline,
 						framebuffer->vk.colorAttachmentCount,
+						(VkSampleCountFlagBits)framebuffer->vk.sampleCount,
 						framebuffer->vk.size,
-						&createData);
+						&createData,
+						NULL);
 
 					if (mpgxResult != SUCCESS_MPGX_RESULT)
 						abort();
 				}
 
+				// Libraries were created for the old render pass
+				clearVkFramebufferLibraries(device, framebuffer);
+
 				vkWindow->frameIndex = 0;
 				useVsync = window->useVsync;
 #else
@@ -1399,292 +1929,467 @@ void closeWindow(Window window)
 	glfwSetWindowShouldClose(window->handle, GLFW_TRUE);
 }
 
-MpgxResult beginWindowRecord(Window window)
+static void updateImageReadbacks(Window window)
 {
 	assert(window);
-	assert(!window->isRecording);
-	assert(graphicsInitialized);
 
-	Framebuffer framebuffer = window->framebuffer;
+	ImageReadback* readbacks = window->readbacks;
+	size_t readbackCount = window->readbackCount;
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	for (size_t i = 0; i < readbackCount; i++)
 	{
-#if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = window->vkWindow;
-		VmaAllocator allocator = vkWindow->allocator;
+		ImageReadback* readback = &readbacks[i];
 
-		if (vkWindow->stagingBuffer)
+		if (!readback->isPending)
+			continue;
+
+		size_t dataSize = readback->dataSize;
+
+		if (graphicsAPI == VULKAN_GRAPHICS_API)
 		{
-			vmaDestroyBuffer(
+#if MPGX_SUPPORT_VULKAN
+			VkWindow vkWindow = window->vkWindow;
+
+			// Only this frame index fence is waited at the record begin
+			if (readback->frameIndex != vkWindow->frameIndex)
+				continue;
+
+			readback->isPending = false;
+
+			void* mapData;
+
+			MpgxResult mpgxResult = mapVkBuffer(
 				vkWindow->allocator,
-				vkWindow->stagingBuffer,
-				vkWindow->stagingAllocation);
-			vkWindow->stagingBuffer = NULL;
-			vkWindow->stagingAllocation = NULL;
-			vkWindow->stagingSize = 0;
-		}
+				readback->vkAllocation,
+				GPU_TO_CPU_BUFFER_USAGE,
+				dataSize,
+				0,
+				&mapData);
 
-		VkDevice device = vkWindow->device;
-		uint32_t frameIndex = vkWindow->frameIndex;
-		VkFence fence = vkWindow->fences[frameIndex];
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				readback->onReadback(
+					readback->ticket,
+					NULL,
+					0,
+					readback->argument);
+				continue;
+			}
 
-		VkResult vkResult = vkWaitForFences(
-			device, 1, &fence, VK_TRUE, UINT64_MAX);
+			readback->onReadback(
+				readback->ticket,
+				mapData,
+				dataSize,
+				readback->argument);
 
-		if (vkResult != VK_SUCCESS)
-			return vkToMpgxResult(vkResult);
+			unmapVkBuffer(
+				vkWindow->allocator,
+				readback->vkAllocation,
+				GPU_TO_CPU_BUFFER_USAGE,
+				dataSize,
+				0);
+#else
+			abort();
+#endif
+		}
+		else if (graphicsAPI == OPENGL_GRAPHICS_API)
+		{
+#if MPGX_SUPPORT_OPENGL
+			makeGlWindowContextCurrent(window);
 
-		vkResult = vkResetFences(device, 1, &fence);
+			// Sync object is polled, the driver is never waited
+			GLenum status = glClientWaitSync(
+				readback->glSync,
+				0,
+				0);
 
-		if (vkResult != VK_SUCCESS)
-			return vkToMpgxResult(vkResult);
+			if (status == GL_TIMEOUT_EXPIRED)
+				continue;
 
-		VkSemaphore* imageAcquiredSemaphores =
-			vkWindow->imageAcquiredSemaphores;
-		VkSwapchain swapchain = vkWindow->swapchain;
-		VkSwapchainKHR handle = swapchain->handle;
+			glDeleteSync(readback->glSync);
+			readback->glSync = NULL;
+			readback->isPending = false;
 
-		uint32_t bufferIndex;
+			glBindBuffer(
+				GL_PIXEL_PACK_BUFFER,
+				readback->glBuffer);
 
-		do
-		{
-			vkResult = vkAcquireNextImageKHR(
-				device,
-				handle,
-				UINT64_MAX,
-				imageAcquiredSemaphores[frameIndex],
-				NULL,
-				&bufferIndex);
+			void* mapData = status != GL_WAIT_FAILED ? glMapBufferRange(
+				GL_PIXEL_PACK_BUFFER,
+				0,
+				(GLsizeiptr)dataSize,
+				GL_MAP_READ_BIT) : NULL;
 
-			if (vkResult == VK_ERROR_OUT_OF_DATE_KHR)
-			{
-				return OUT_OF_DATE_MPGX_RESULT;
-			}
-			else if (vkResult == VK_ERROR_OUT_OF_HOST_MEMORY)
+			if (mapData)
 			{
-				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-			}
-			else if (vkResult == VK_ERROR_OUT_OF_DEVICE_MEMORY)
-			{
-				return OUT_OF_DEVICE_MEMORY_MPGX_RESULT;
-			}
-			else if (vkResult == VK_ERROR_DEVICE_LOST)
-			{
-				return DEVICE_IS_LOST_MPGX_RESULT;
+				readback->onReadback(
+					readback->ticket,
+					mapData,
+					dataSize,
+					readback->argument);
+
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
 			}
-			else if (vkResult == VK_ERROR_SURFACE_LOST_KHR)
+			else
 			{
-				return SURFACE_IS_LOST_MPGX_RESULT;
+				readback->onReadback(
+					readback->ticket,
+					NULL,
+					0,
+					readback->argument);
 			}
-		} while (vkResult != VK_SUCCESS);
-
-		vmaSetCurrentFrameIndex(
-			allocator,
-			bufferIndex);
 
-		VkSwapchainBuffer buffer = swapchain->buffers[bufferIndex];
-		VkCommandBuffer graphicsCommandBuffer = buffer.graphicsCommandBuffer;
-		framebuffer->vk.renderPass = swapchain->renderPass;
-		framebuffer->vk.handle = buffer.framebuffer;
+			glBindBuffer(
+				GL_PIXEL_PACK_BUFFER,
+				GL_ZERO);
+#else
+			abort();
+#endif
+		}
+		else
+		{
+			abort();
+		}
+	}
+}
+static void demoteImageStream(
+	Window window,
+	Image image)
+{
+	assert(window);
+	assert(image);
 
-		VkCommandBufferBeginInfo commandBufferBeginInfo = {
-			VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-			NULL,
-			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-			NULL,
-		};
+	ImageStream stream = image->base.stream;
+	uint8_t residentMip = stream->residentMip;
 
-		vkResult = vkBeginCommandBuffer(
-			graphicsCommandBuffer, &commandBufferBeginInfo);
+	size_t levelSize = calcImageStreamSize(
+		image,
+		residentMip,
+		residentMip + 1);
 
-		if (vkResult != VK_SUCCESS)
-			return vkToMpgxResult(vkResult);
+	stream->residentSize -= levelSize;
+	window->streamingMemory -= levelSize;
+	residentMip++;
 
-		vkWindow->bufferIndex = bufferIndex;
-		vkWindow->currenCommandBuffer = graphicsCommandBuffer;
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		// Vulkan image memory is allocated for the whole mip
+		// chain, so evicted level is only excluded from the budget.
+		stream->residentMip = residentMip;
+		stream->uploadMip = residentMip;
 #else
 		abort();
 #endif
 	}
-
-#ifndef NDEBUG
-	window->isRecording = true;
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		setGlImageStreamBaseLevel(
+			image,
+			residentMip);
+		stream->uploadMip = residentMip;
+#else
+		abort();
 #endif
-	return SUCCESS_MPGX_RESULT;
+	}
+	else
+	{
+		abort();
+	}
 }
+static bool isImageStreamEvictable(
+	Image image,
+	float priority)
+{
+	assert(image);
 
-void endWindowRecord(Window window)
+	// Images with the pending uploads are never evicted
+	ImageStream stream = image->base.stream;
+
+	return stream && stream->uploadMip == stream->residentMip &&
+		stream->residentMip + 1 < image->base.mipCount &&
+		stream->priority < priority;
+}
+static bool evictImageStreams(
+	Window window,
+	float priority,
+	size_t size)
 {
 	assert(window);
-	assert(window->isRecording);
-	assert(!window->renderFramebuffer);
-	assert(graphicsInitialized);
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	Image* images = window->images;
+	size_t imageCount = window->imageCount;
+
+	if (window->streamingMemory + size <= window->streamingMemoryBudget)
+		return true;
+
+	size_t evictableSize = 0;
+
+	for (size_t i = 0; i < imageCount; i++)
 	{
-#if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = window->vkWindow;
-		VkSwapchain swapchain = vkWindow->swapchain;
+		Image image = images[i];
 
-		uint32_t graphicsQueueFamilyIndex =
-			vkWindow->graphicsQueueFamilyIndex;
-		uint32_t presentQueueFamilyIndex =
-			vkWindow->presentQueueFamilyIndex;
+		if (!isImageStreamEvictable(image, priority))
+			continue;
 
-		uint32_t bufferIndex = vkWindow->bufferIndex;
+		evictableSize += calcImageStreamSize(
+			image,
+			image->base.stream->residentMip,
+			(uint8_t)(image->base.mipCount - 1));
+	}
 
-		VkSwapchainBuffer* buffer =
-			&swapchain->buffers[bufferIndex];
-		VkCommandBuffer graphicsCommandBuffer =
-			buffer->graphicsCommandBuffer;
+	// Nothing is demoted if the size can not be freed completely
+	if (window->streamingMemory + size >
+		window->streamingMemoryBudget + evictableSize)
+	{
+		return false;
+	}
 
-		if (graphicsQueueFamilyIndex != presentQueueFamilyIndex)
+	while (window->streamingMemory + size > window->streamingMemoryBudget)
+	{
+		Image evictImage = NULL;
+		float evictPriority = priority;
+
+		// Least important image loses its most detailed level
+		for (size_t i = 0; i < imageCount; i++)
 		{
-			VkImageMemoryBarrier imageMemoryBarrier = {
-				VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-				NULL,
-				VK_ACCESS_NONE_KHR,
-				VK_ACCESS_NONE_KHR,
-				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-				graphicsQueueFamilyIndex,
-				presentQueueFamilyIndex,
-				buffer->image,
-				{
-					VK_IMAGE_ASPECT_COLOR_BIT,
-					0,
-					1,
-					0,
-					1,
-				},
-			};
+			Image image = images[i];
 
-			vkCmdPipelineBarrier(
-				graphicsCommandBuffer,
-				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-				0,
-				0,
-				NULL,
-				0,
-				NULL,
-				1,
-				&imageMemoryBarrier);
+			if (!isImageStreamEvictable(image, evictPriority))
+				continue;
+
+			evictImage = image;
+			evictPriority = image->base.stream->priority;
 		}
 
-		VkResult vkResult = vkEndCommandBuffer(
-			graphicsCommandBuffer);
+		assert(evictImage);
 
-		if (vkResult != VK_SUCCESS)
-			abort();
+		demoteImageStream(
+			window,
+			evictImage);
+	}
 
-		uint32_t frameIndex = vkWindow->frameIndex;
+	return true;
+}
+static void cancelImageStreamUploads(Window window)
+{
+	assert(window);
 
-		VkSemaphore drawCompleteSemaphore =
-			vkWindow->drawCompleteSemaphores[frameIndex];
+	Image* images = window->images;
+	size_t imageCount = window->imageCount;
 
-		VkPipelineStageFlags pipelineStage =
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		VkSubmitInfo submitInfo = {
-			VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			NULL,
-			1,
-			&vkWindow->imageAcquiredSemaphores[frameIndex],
-			&pipelineStage,
-			1,
-			&graphicsCommandBuffer,
-			1,
-			&drawCompleteSemaphore,
-		};
+	for (size_t i = 0; i < imageCount; i++)
+	{
+		Image image = images[i];
+		ImageStream stream = image->base.stream;
 
-		vkResult = vkQueueSubmit(vkWindow->graphicsQueue, 1,
-			&submitInfo, vkWindow->fences[frameIndex]);
+		if (!stream || stream->uploadMip == stream->residentMip)
+			continue;
 
-		if (vkResult != VK_SUCCESS)
-			abort();
+		window->streamingMemory -= calcImageStreamSize(
+			image,
+			stream->uploadMip,
+			stream->residentMip);
+		stream->uploadMip = stream->residentMip;
+	}
+}
+static MpgxResult updateImageStreaming(Window window)
+{
+	assert(window);
 
-		VkSwapchainKHR handle = swapchain->handle;
+	if (window->streamingImageCount == 0)
+		return SUCCESS_MPGX_RESULT;
 
-		VkPresentInfoKHR presentInfo = {
-			VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-			NULL,
-			1,
-			&drawCompleteSemaphore,
-			1,
-			&handle,
-			&bufferIndex,
-			NULL,
-		};
+	Image* images = window->images;
+	size_t imageCount = window->imageCount;
+	size_t uploadBudget = window->streamingUploadBudget;
+	uint32_t updateIndex = ++window->streamingUpdateIndex;
+	size_t uploadSize = 0;
+	size_t uploadCount = 0;
 
-		VkSemaphore imageOwnershipSemaphore =
-			vkWindow->imageOwnershipSemaphores[frameIndex];
-		VkQueue presentQueue = vkWindow->presentQueue;
+	// Most important images are promoted first, one mip
+	// level per frame, until the upload budget is spent.
+	while (true)
+	{
+		Image uploadImage = NULL;
+		float uploadPriority = 0.0f;
 
-		if (graphicsQueueFamilyIndex != presentQueueFamilyIndex)
+		for (size_t i = 0; i < imageCount; i++)
 		{
-			submitInfo.pWaitSemaphores = &drawCompleteSemaphore;
-			submitInfo.pCommandBuffers = &buffer->presentCommandBuffer;
-			submitInfo.pSignalSemaphores = &imageOwnershipSemaphore;
-			vkResult = vkQueueSubmit(presentQueue, 1, &submitInfo, NULL);
+			Image image = images[i];
+			ImageStream stream = image->base.stream;
 
-			if (vkResult != VK_SUCCESS)
-				abort();
+			if (!stream || stream->updateIndex == updateIndex ||
+				stream->requestedMip >= stream->residentMip)
+			{
+				continue;
+			}
 
-			presentInfo.pWaitSemaphores = &imageOwnershipSemaphore;
+			if (uploadImage && stream->priority <= uploadPriority)
+				continue;
+
+			uploadImage = image;
+			uploadPriority = stream->priority;
 		}
 
-		vkQueuePresentKHR(presentQueue, &presentInfo);
-		vkWindow->frameIndex = (frameIndex + 1) % VK_FRAME_LAG;
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_OPENGL
-		glfwSwapBuffers(window->handle);
-#else
-		abort();
-#endif
-	}
-	else
-	{
-		abort();
-	}
+		if (!uploadImage)
+			break;
 
-#ifndef NDEBUG
-	window->isRecording = false;
-#endif
-}
+		ImageStream stream = uploadImage->base.stream;
+		stream->updateIndex = updateIndex;
 
-void setWindowScissor(Window window, Vec4I scissor)
-{
-	assert(window);
-	assert(scissor.x >= 0);
-	assert(scissor.y >= 0);
-	assert(scissor.z >= 0);
-	assert(scissor.w >= 0);
-	assert(window->isRecording);
-	assert(graphicsInitialized);
+		uint8_t uploadMip = stream->residentMip - 1;
+
+		size_t levelSize = calcImageStreamSize(
+			uploadImage,
+			uploadMip,
+			uploadMip + 1);
+
+		// Single level larger than the budget is still uploaded
+		if (uploadCount > 0 && uploadSize + levelSize > uploadBudget)
+			break;
+
+		if (!evictImageStreams(
+			window,
+			stream->priority,
+			levelSize))
+		{
+			continue;
+		}
+
+		stream->uploadMip = uploadMip;
+		window->streamingMemory += levelSize;
+		uploadSize += levelSize;
+		uploadCount++;
+	}
+
+	if (uploadCount == 0)
+		return SUCCESS_MPGX_RESULT;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = getVkWindow(window);
+		VkWindow vkWindow = window->vkWindow;
+		VmaAllocator allocator = vkWindow->allocator;
+		uint32_t frameIndex = vkWindow->frameIndex;
+		size_t stagingDataSize = 0;
+
+		for (size_t i = 0; i < imageCount; i++)
+		{
+			Image image = images[i];
+			ImageStream stream = image->base.stream;
+
+			if (!stream || stream->uploadMip == stream->residentMip)
+				continue;
+
+			stagingDataSize = alignVkMemory(stagingDataSize, 16);
+			stagingDataSize += calcVkImageStreamDataSize(
+				image,
+				stream->uploadMip,
+				stream->residentMip);
+		}
+
+		// Streaming buffer is reused only after the frame fence
+		MpgxResult mpgxResult = reserveVkStagingBuffer(
+			allocator,
+			stagingDataSize,
+			&vkWindow->streamingBuffers[frameIndex],
+			&vkWindow->streamingAllocations[frameIndex],
+			&vkWindow->streamingSizes[frameIndex]);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			cancelImageStreamUploads(window);
+			return mpgxResult;
+		}
+
+		VmaAllocation streamingAllocation =
+			vkWindow->streamingAllocations[frameIndex];
+		void* mapData;
+
+		mpgxResult = mapVkBuffer(
+			allocator,
+			streamingAllocation,
+			CPU_ONLY_BUFFER_USAGE,
+			stagingDataSize,
+			0,
+			&mapData);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			cancelImageStreamUploads(window);
+			return mpgxResult;
+		}
+
 		VkCommandBuffer commandBuffer = vkWindow->currenCommandBuffer;
-		Framebuffer framebuffer = window->renderFramebuffer;
+		VkBuffer streamingBuffer = vkWindow->streamingBuffers[frameIndex];
+		VkDeviceSize stagingOffset = 0;
 
-		assert(scissor.x + scissor.z <= framebuffer->base.size.x);
-		assert(scissor.y + scissor.w <= framebuffer->base.size.y);
+		for (size_t i = 0; i < imageCount; i++)
+		{
+			Image image = images[i];
+			ImageStream stream = image->base.stream;
 
-		VkRect2D vkScissor = {
-			(int32_t)scissor.x,
-			(int32_t)((framebuffer->vk.size.y - scissor.y) - scissor.w),
-			(uint32_t)scissor.z,
-			(uint32_t)scissor.w,
-		};
+			if (!stream || stream->uploadMip == stream->residentMip)
+				continue;
 
-		vkCmdSetScissor(commandBuffer, 0, 1, &vkScissor);
+			stagingOffset = alignVkMemory(stagingOffset, 16);
+
+			mpgxResult = recordVkImageStreamUpload(
+				commandBuffer,
+				vkWindow->barrierBatch,
+				streamingBuffer,
+				(uint8_t*)mapData,
+				stagingOffset,
+				image,
+				stream->uploadMip,
+				stream->residentMip);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				unmapVkBuffer(
+					allocator,
+					streamingAllocation,
+					CPU_ONLY_BUFFER_USAGE,
+					stagingDataSize,
+					0);
+				cancelImageStreamUploads(window);
+				return mpgxResult;
+			}
+
+			stagingOffset += calcVkImageStreamDataSize(
+				image,
+				stream->uploadMip,
+				stream->residentMip);
+		}
+
+		mpgxResult = unmapVkBuffer(
+			allocator,
+			streamingAllocation,
+			CPU_ONLY_BUFFER_USAGE,
+			stagingDataSize,
+			0);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			cancelImageStreamUploads(window);
+			return mpgxResult;
+		}
+
+		for (size_t i = 0; i < imageCount; i++)
+		{
+			ImageStream stream = images[i]->base.stream;
+
+			if (!stream || stream->uploadMip == stream->residentMip)
+				continue;
+
+			stream->residentSize += calcImageStreamSize(
+				images[i],
+				stream->uploadMip,
+				stream->residentMip);
+			stream->residentMip = stream->uploadMip;
+		}
 #else
 		abort();
 #endif
@@ -1692,8 +2397,30 @@ void setWindowScissor(Window window, Vec4I scissor)
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		glScissor((GLint)scissor.x,(GLint)scissor.y,
-			(GLsizei)scissor.z, (GLsizei)scissor.w);
+		for (size_t i = 0; i < imageCount; i++)
+		{
+			Image image = images[i];
+			ImageStream stream = image->base.stream;
+
+			if (!stream || stream->uploadMip == stream->residentMip)
+				continue;
+
+			MpgxResult mpgxResult = uploadGlImageStream(
+				image,
+				stream->uploadMip);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				cancelImageStreamUploads(window);
+				return mpgxResult;
+			}
+
+			// Base level is already moved to the uploaded one
+			stream->residentSize += calcImageStreamSize(
+				image,
+				stream->uploadMip,
+				stream->uploadMip + 1);
+		}
 #else
 		abort();
 #endif
@@ -1702,367 +2429,2801 @@ void setWindowScissor(Window window, Vec4I scissor)
 	{
 		abort();
 	}
-}
 
-size_t getWindowBufferCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->bufferCount;
-}
-size_t getWindowImageCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->imageCount;
-}
-size_t getWindowSamplerCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->samplerCount;
-}
-size_t getWindowFramebufferCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->framebufferCount;
-}
-size_t getWindowShaderCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->shaderCount;
-}
-size_t getWindowGraphicsMeshCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->graphicsMeshCount;
-}
-size_t getWindowComputePipelineCount(Window window)
-{
-	assert(window);
-	assert(graphicsInitialized);
-	return window->computePipelineCount;
-}
-size_t getWindowRayTracingPipelineCount(Window window)
-{
-	assert(window);
-	assert(window->rayTracing);
-	assert(graphicsInitialized);
-	return window->rayTracing->base.pipelineCount;
-}
-size_t getWindowRayTracingMeshCount(Window window)
-{
-	assert(window);
-	assert(window->rayTracing);
-	assert(graphicsInitialized);
-	return window->rayTracing->base.meshCount;
-}
-size_t getWindowRayTracingSceneCount(Window window)
-{
-	assert(window);
-	assert(window->rayTracing);
-	assert(graphicsInitialized);
-	return window->rayTracing->base.sceneCount;
+	return SUCCESS_MPGX_RESULT;
 }
 
-void enumerateWindowBuffers(
-	Window window,
-	OnWindowBuffer onBuffer,
-	void* handle)
+MpgxResult beginWindowRecord(Window window)
 {
 	assert(window);
-	assert(onBuffer);
+	assert(!window->isRecording);
 	assert(graphicsInitialized);
 
-#ifndef NDEBUG
-	window->isEnumeratingBuffers = true;
-#endif
+	Framebuffer framebuffer = window->framebuffer;
 
-	Buffer* buffers = window->buffers;
-	size_t bufferCount = window->bufferCount;
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+		VmaAllocator allocator = vkWindow->allocator;
 
-	for (size_t i = 0; i < bufferCount; i++)
-		onBuffer(buffers[i], handle);
+		if (vkWindow->stagingBuffer)
+		{
+			vmaDestroyBuffer(
+				vkWindow->allocator,
+				vkWindow->stagingBuffer,
+				vkWindow->stagingAllocation);
+			vkWindow->stagingBuffer = NULL;
+			vkWindow->stagingAllocation = NULL;
+			vkWindow->stagingSize = 0;
+		}
 
-#ifndef NDEBUG
-	window->isEnumeratingBuffers = false;
-#endif
-}
-void enumerateWindowImages(
-	Window window,
-	OnWindowImage onImage,
-	void* handle)
-{
-	assert(window);
-	assert(onImage);
-	assert(graphicsInitialized);
+		VkDevice device = vkWindow->device;
+		uint32_t frameIndex = vkWindow->frameIndex;
+		VkFence fence = vkWindow->fences[frameIndex];
 
-#ifndef NDEBUG
-	window->isEnumeratingImages = true;
-#endif
+		VkResult vkResult = vkWaitForFences(
+			device, 1, &fence, VK_TRUE, UINT64_MAX);
 
-	Image* images = window->images;
-	size_t imageCount = window->imageCount;
+		if (vkResult != VK_SUCCESS)
+			return vkToMpgxResult(vkResult);
 
-	for (size_t i = 0; i < imageCount; i++)
-		onImage(images[i], handle);
+		vkResult = vkResetFences(device, 1, &fence);
 
-#ifndef NDEBUG
-	window->isEnumeratingImages = false;
-#endif
-}
-void enumerateWindowSamplers(
-	Window window,
-	OnWindowSampler onSampler,
-	void* handle)
-{
-	assert(window);
-	assert(onSampler);
-	assert(graphicsInitialized);
+		if (vkResult != VK_SUCCESS)
+			return vkToMpgxResult(vkResult);
 
-#ifndef NDEBUG
-	window->isEnumeratingSamplers = true;
-#endif
+		updateVkRetiredFramebuffers(window, false);
 
-	Sampler* samplers = window->samplers;
-	size_t samplerCount = window->samplerCount;
+		MpgxResult mpgxResult = updateVkRetiredImagePages(
+			window,
+			false);
 
-	for (size_t i = 0; i < samplerCount; i++)
-		onSampler(samplers[i], handle);
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
 
-#ifndef NDEBUG
-	window->isEnumeratingSamplers = false;
-#endif
-}
-void enumerateWindowFramebuffers(
-	Window window,
-	OnWindowFramebuffer onFramebuffer,
-	void* handle)
-{
-	assert(window);
-	assert(onFramebuffer);
-	assert(graphicsInitialized);
+		VkSemaphore* imageAcquiredSemaphores =
+			vkWindow->imageAcquiredSemaphores;
+		VkSwapchain swapchain = vkWindow->swapchain;
+		VkSwapchainKHR handle = swapchain->handle;
 
-#ifndef NDEBUG
-	window->isEnumeratingFramebuffers = true;
-#endif
+		uint32_t bufferIndex;
 
-	Framebuffer* framebuffers = window->framebuffers;
-	size_t framebufferCount = window->framebufferCount;
+		do
+		{
+			vkResult = vkAcquireNextImageKHR(
+				device,
+				handle,
+				UINT64_MAX,
+				imageAcquiredSemaphores[frameIndex],
+				NULL,
+				&bufferIndex);
 
-	for (size_t i = 0; i < framebufferCount; i++)
-		onFramebuffer(framebuffers[i], handle);
+			if (vkResult == VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				return OUT_OF_DATE_MPGX_RESULT;
+			}
+			else if (vkResult == VK_ERROR_OUT_OF_HOST_MEMORY)
+			{
+				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+			}
+			else if (vkResult == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+			{
+				return OUT_OF_DEVICE_MEMORY_MPGX_RESULT;
+			}
+			else if (vkResult == VK_ERROR_DEVICE_LOST)
+			{
+				return DEVICE_IS_LOST_MPGX_RESULT;
+			}
+			else if (vkResult == VK_ERROR_SURFACE_LOST_KHR)
+			{
+				return SURFACE_IS_LOST_MPGX_RESULT;
+			}
+		} while (vkResult != VK_SUCCESS);
 
-#ifndef NDEBUG
-	window->isEnumeratingFramebuffers = false;
-#endif
-}
-void enumerateWindowShaders(
-	Window window,
-	OnWindowShader onShader,
-	void* handle)
-{
-	assert(window);
-	assert(onShader);
-	assert(graphicsInitialized);
+		vmaSetCurrentFrameIndex(
+			allocator,
+			bufferIndex);
 
-#ifndef NDEBUG
-	window->isEnumeratingShaders = true;
-#endif
+		VkSwapchainBuffer buffer = swapchain->buffers[bufferIndex];
+		VkCommandBuffer graphicsCommandBuffer = buffer.graphicsCommandBuffer;
+		framebuffer->vk.renderPass = swapchain->renderPass;
+		framebuffer->vk.handle = buffer.framebuffer;
 
-	Shader* shaders = window->shaders;
-	size_t shaderCount = window->shaderCount;
+		VkCommandBufferBeginInfo commandBufferBeginInfo = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			NULL,
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			NULL,
+		};
 
-	for (size_t i = 0; i < shaderCount; i++)
-		onShader(shaders[i], handle);
+		vkResult = vkBeginCommandBuffer(
+			graphicsCommandBuffer, &commandBufferBeginInfo);
 
-#ifndef NDEBUG
-	window->isEnumeratingShaders = false;
-#endif
-}
-void enumerateWindowGraphicsMeshes(
-	Window window,
-	OnWindowGraphicsMesh onGraphicsMesh,
-	void* handle)
-{
-	assert(window);
-	assert(onGraphicsMesh);
-	assert(graphicsInitialized);
+		if (vkResult != VK_SUCCESS)
+			return vkToMpgxResult(vkResult);
 
-#ifndef NDEBUG
-	window->isEnumeratingGraphicsMeshes = true;
+		vkWindow->bufferIndex = bufferIndex;
+		vkWindow->currenCommandBuffer = graphicsCommandBuffer;
+#else
+		abort();
 #endif
+	}
 
-	GraphicsMesh* graphicsMeshes = window->graphicsMeshes;
-	size_t graphicsMeshCount = window->graphicsMeshCount;
+	updateImageReadbacks(window);
 
-	for (size_t i = 0; i < graphicsMeshCount; i++)
-		onGraphicsMesh(graphicsMeshes[i], handle);
+	MpgxResult mpgxResult = updateImageStreaming(window);
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
 
 #ifndef NDEBUG
-	window->isEnumeratingGraphicsMeshes = false;
+	window->isRecording = true;
 #endif
+	return SUCCESS_MPGX_RESULT;
 }
-void enumerateWindowComputePipelines(
-	Window window,
-	OnWindowComputePipeline onComputePipeline,
-	void* handle)
+
+void endWindowRecord(Window window)
 {
 	assert(window);
-	assert(onComputePipeline);
+	assert(window->isRecording);
+	assert(!window->renderFramebuffer);
 	assert(graphicsInitialized);
 
-#ifndef NDEBUG
-	window->isEnumeratingComputePipelines = true;
-#endif
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+		VkSwapchain swapchain = vkWindow->swapchain;
 
-	ComputePipeline* computePipelines = window->computePipelines;
-	size_t computePipelineCount = window->computePipelineCount;
+		uint32_t graphicsQueueFamilyIndex =
+			vkWindow->graphicsQueueFamilyIndex;
+		uint32_t presentQueueFamilyIndex =
+			vkWindow->presentQueueFamilyIndex;
 
-	for (size_t i = 0; i < computePipelineCount; i++)
-		onComputePipeline(computePipelines[i], handle);
+		uint32_t bufferIndex = vkWindow->bufferIndex;
 
-#ifndef NDEBUG
-	window->isEnumeratingComputePipelines = false;
-#endif
-}
-void enumerateWindowRayTracingPipelines(
-	Window window,
-	OnWindowRayTracingPipeline onRayTracingPipeline,
-	void* handle)
-{
-	assert(window);
-	assert(onRayTracingPipeline);
-	assert(window->rayTracing);
-	assert(graphicsInitialized);
+		VkSwapchainBuffer* buffer =
+			&swapchain->buffers[bufferIndex];
+		VkCommandBuffer graphicsCommandBuffer =
+			buffer->graphicsCommandBuffer;
 
-#ifndef NDEBUG
-	window->rayTracing->base.isEnumeratingPipelines = true;
-#endif
+		if (graphicsQueueFamilyIndex != presentQueueFamilyIndex)
+		{
+			VkImageMemoryBarrier imageMemoryBarrier = {
+				VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				NULL,
+				VK_ACCESS_NONE_KHR,
+				VK_ACCESS_NONE_KHR,
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				graphicsQueueFamilyIndex,
+				presentQueueFamilyIndex,
+				buffer->image,
+				{
+					VK_IMAGE_ASPECT_COLOR_BIT,
+					0,
+					1,
+					0,
+					1,
+				},
+			};
 
-	RayTracing rayTracing = window->rayTracing;
-	RayTracingPipeline* rayTracingPipelines = rayTracing->base.pipelines;
-	size_t rayTracingPipelineCount = rayTracing->base.pipelineCount;
+			vkCmdPipelineBarrier(
+				graphicsCommandBuffer,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0,
+				0,
+				NULL,
+				0,
+				NULL,
+				1,
+				&imageMemoryBarrier);
+		}
 
-	for (size_t i = 0; i < rayTracingPipelineCount; i++)
-		onRayTracingPipeline(rayTracingPipelines[i], handle);
+		VkResult vkResult = vkEndCommandBuffer(
+			graphicsCommandBuffer);
 
-#ifndef NDEBUG
-	window->rayTracing->base.isEnumeratingPipelines = false;
-#endif
-}
-void enumerateWindowRayTracingMeshes(
-	Window window,
-	OnWindowRayTracingMesh onRayTracingMesh,
-	void* handle)
-{
-	assert(window);
-	assert(onRayTracingMesh);
-	assert(window->rayTracing);
-	assert(graphicsInitialized);
+		if (vkResult != VK_SUCCESS)
+			abort();
 
-#ifndef NDEBUG
-	window->rayTracing->base.isEnumeratingMeshes = true;
-#endif
+		uint32_t frameIndex = vkWindow->frameIndex;
 
-	RayTracing rayTracing = window->rayTracing;
-	RayTracingMesh* rayTracingMeshes = rayTracing->base.meshes;
-	size_t rayTracingMeshCount = rayTracing->base.meshCount;
+		VkSemaphore drawCompleteSemaphore =
+			vkWindow->drawCompleteSemaphores[frameIndex];
 
-	for (size_t i = 0; i < rayTracingMeshCount; i++)
-		onRayTracingMesh(rayTracingMeshes[i], handle);
+		VkSemaphore waitSemaphores[2] = {
+			vkWindow->imageAcquiredSemaphores[frameIndex],
+			vkWindow->sparseSemaphore,
+		};
+		VkPipelineStageFlags pipelineStages[2] = {
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		};
+		VkSubmitInfo submitInfo = {
+			VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			NULL,
+			// Sparse binds are waited before the first page use
+			vkWindow->sparseSemaphore ? 2 : 1,
+			waitSemaphores,
+			pipelineStages,
+			1,
+			&graphicsCommandBuffer,
+			1,
+			&drawCompleteSemaphore,
+		};
 
-#ifndef NDEBUG
-	window->rayTracing->base.isEnumeratingMeshes = false;
+		vkResult = vkQueueSubmit(vkWindow->graphicsQueue, 1,
+			&submitInfo, vkWindow->fences[frameIndex]);
+
+		if (vkResult != VK_SUCCESS)
+			abort();
+
+		vkWindow->sparseSemaphore = NULL;
+
+		VkSwapchainKHR handle = swapchain->handle;
+
+		VkPresentInfoKHR presentInfo = {
+			VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+			NULL,
+			1,
+			&drawCompleteSemaphore,
+			1,
+			&handle,
+			&bufferIndex,
+			NULL,
+		};
+
+		VkSemaphore imageOwnershipSemaphore =
+			vkWindow->imageOwnershipSemaphores[frameIndex];
+		VkQueue presentQueue = vkWindow->presentQueue;
+
+		if (graphicsQueueFamilyIndex != presentQueueFamilyIndex)
+		{
+			submitInfo.waitSemaphoreCount = 1;
+			submitInfo.pWaitSemaphores = &drawCompleteSemaphore;
+			submitInfo.pCommandBuffers = &buffer->presentCommandBuffer;
+			submitInfo.pSignalSemaphores = &imageOwnershipSemaphore;
+			vkResult = vkQueueSubmit(presentQueue, 1, &submitInfo, NULL);
+
+			if (vkResult != VK_SUCCESS)
+				abort();
+
+			presentInfo.pWaitSemaphores = &imageOwnershipSemaphore;
+		}
+
+		vkQueuePresentKHR(presentQueue, &presentInfo);
+		vkWindow->frameIndex = (frameIndex + 1) % VK_FRAME_LAG;
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		glfwSwapBuffers(window->handle);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+#ifndef NDEBUG
+	window->isRecording = false;
+#endif
+}
+
+void setWindowScissor(Window window, Vec4I scissor)
+{
+	assert(window);
+	assert(scissor.x >= 0);
+	assert(scissor.y >= 0);
+	assert(scissor.z >= 0);
+	assert(scissor.w >= 0);
+	assert(window->isRecording);
+	assert(graphicsInitialized);
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = getVkWindow(window);
+		VkCommandBuffer commandBuffer = vkWindow->currenCommandBuffer;
+		Framebuffer framebuffer = window->renderFramebuffer;
+
+		assert(scissor.x + scissor.z <= framebuffer->base.size.x);
+		assert(scissor.y + scissor.w <= framebuffer->base.size.y);
+
+		VkRect2D vkScissor = {
+			(int32_t)scissor.x,
+			(int32_t)((framebuffer->vk.size.y - scissor.y) - scissor.w),
+			(uint32_t)scissor.z,
+			(uint32_t)scissor.w,
+		};
+
+		vkCmdSetScissor(commandBuffer, 0, 1, &vkScissor);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		glScissor((GLint)scissor.x,(GLint)scissor.y,
+			(GLsizei)scissor.z, (GLsizei)scissor.w);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+
+size_t getWindowBufferCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->bufferCount;
+}
+size_t getWindowImageCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->imageCount;
+}
+size_t getWindowSamplerCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->samplerCount;
+}
+size_t getWindowFramebufferCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->framebufferCount;
+}
+size_t getWindowShaderCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->shaderCount;
+}
+size_t getWindowGraphicsMeshCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->graphicsMeshCount;
+}
+size_t getWindowComputePipelineCount(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->computePipelineCount;
+}
+size_t getWindowRayTracingPipelineCount(Window window)
+{
+	assert(window);
+	assert(window->rayTracing);
+	assert(graphicsInitialized);
+	return window->rayTracing->base.pipelineCount;
+}
+size_t getWindowRayTracingMeshCount(Window window)
+{
+	assert(window);
+	assert(window->rayTracing);
+	assert(graphicsInitialized);
+	return window->rayTracing->base.meshCount;
+}
+size_t getWindowRayTracingSceneCount(Window window)
+{
+	assert(window);
+	assert(window->rayTracing);
+	assert(graphicsInitialized);
+	return window->rayTracing->base.sceneCount;
+}
+
+void enumerateWindowBuffers(
+	Window window,
+	OnWindowBuffer onBuffer,
+	void* handle)
+{
+	assert(window);
+	assert(onBuffer);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingBuffers = true;
+#endif
+
+	Buffer* buffers = window->buffers;
+	size_t bufferCount = window->bufferCount;
+
+	for (size_t i = 0; i < bufferCount; i++)
+		onBuffer(buffers[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingBuffers = false;
+#endif
+}
+void enumerateWindowImages(
+	Window window,
+	OnWindowImage onImage,
+	void* handle)
+{
+	assert(window);
+	assert(onImage);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingImages = true;
+#endif
+
+	Image* images = window->images;
+	size_t imageCount = window->imageCount;
+
+	for (size_t i = 0; i < imageCount; i++)
+		onImage(images[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingImages = false;
+#endif
+}
+void enumerateWindowSamplers(
+	Window window,
+	OnWindowSampler onSampler,
+	void* handle)
+{
+	assert(window);
+	assert(onSampler);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingSamplers = true;
+#endif
+
+	Sampler* samplers = window->samplers;
+	size_t samplerCount = window->samplerCount;
+
+	for (size_t i = 0; i < samplerCount; i++)
+		onSampler(samplers[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingSamplers = false;
+#endif
+}
+void enumerateWindowFramebuffers(
+	Window window,
+	OnWindowFramebuffer onFramebuffer,
+	void* handle)
+{
+	assert(window);
+	assert(onFramebuffer);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingFramebuffers = true;
+#endif
+
+	Framebuffer* framebuffers = window->framebuffers;
+	size_t framebufferCount = window->framebufferCount;
+
+	for (size_t i = 0; i < framebufferCount; i++)
+		onFramebuffer(framebuffers[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingFramebuffers = false;
+#endif
+}
+void enumerateWindowShaders(
+	Window window,
+	OnWindowShader onShader,
+	void* handle)
+{
+	assert(window);
+	assert(onShader);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingShaders = true;
+#endif
+
+	Shader* shaders = window->shaders;
+	size_t shaderCount = window->shaderCount;
+
+	for (size_t i = 0; i < shaderCount; i++)
+		onShader(shaders[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingShaders = false;
+#endif
+}
+void enumerateWindowGraphicsMeshes(
+	Window window,
+	OnWindowGraphicsMesh onGraphicsMesh,
+	void* handle)
+{
+	assert(window);
+	assert(onGraphicsMesh);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingGraphicsMeshes = true;
+#endif
+
+	GraphicsMesh* graphicsMeshes = window->graphicsMeshes;
+	size_t graphicsMeshCount = window->graphicsMeshCount;
+
+	for (size_t i = 0; i < graphicsMeshCount; i++)
+		onGraphicsMesh(graphicsMeshes[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingGraphicsMeshes = false;
+#endif
+}
+void enumerateWindowComputePipelines(
+	Window window,
+	OnWindowComputePipeline onComputePipeline,
+	void* handle)
+{
+	assert(window);
+	assert(onComputePipeline);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->isEnumeratingComputePipelines = true;
+#endif
+
+	ComputePipeline* computePipelines = window->computePipelines;
+	size_t computePipelineCount = window->computePipelineCount;
+
+	for (size_t i = 0; i < computePipelineCount; i++)
+		onComputePipeline(computePipelines[i], handle);
+
+#ifndef NDEBUG
+	window->isEnumeratingComputePipelines = false;
+#endif
+}
+void enumerateWindowRayTracingPipelines(
+	Window window,
+	OnWindowRayTracingPipeline onRayTracingPipeline,
+	void* handle)
+{
+	assert(window);
+	assert(onRayTracingPipeline);
+	assert(window->rayTracing);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->rayTracing->base.isEnumeratingPipelines = true;
+#endif
+
+	RayTracing rayTracing = window->rayTracing;
+	RayTracingPipeline* rayTracingPipelines = rayTracing->base.pipelines;
+	size_t rayTracingPipelineCount = rayTracing->base.pipelineCount;
+
+	for (size_t i = 0; i < rayTracingPipelineCount; i++)
+		onRayTracingPipeline(rayTracingPipelines[i], handle);
+
+#ifndef NDEBUG
+	window->rayTracing->base.isEnumeratingPipelines = false;
+#endif
+}
+void enumerateWindowRayTracingMeshes(
+	Window window,
+	OnWindowRayTracingMesh onRayTracingMesh,
+	void* handle)
+{
+	assert(window);
+	assert(onRayTracingMesh);
+	assert(window->rayTracing);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->rayTracing->base.isEnumeratingMeshes = true;
+#endif
+
+	RayTracing rayTracing = window->rayTracing;
+	RayTracingMesh* rayTracingMeshes = rayTracing->base.meshes;
+	size_t rayTracingMeshCount = rayTracing->base.meshCount;
+
+	for (size_t i = 0; i < rayTracingMeshCount; i++)
+		onRayTracingMesh(rayTracingMeshes[i], handle);
+
+#ifndef NDEBUG
+	window->rayTracing->base.isEnumeratingMeshes = false;
+#endif
+}
+void enumerateWindowRayTracingScene(
+	Window window,
+	OnWindowRayTracingScene onRayTracingScene,
+	void* handle)
+{
+	assert(window);
+	assert(onRayTracingScene);
+	assert(window->rayTracing);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	window->rayTracing->base.isEnumeratingScenes = true;
+#endif
+
+	RayTracing rayTracing = window->rayTracing;
+	RayTracingScene* rayTracingScenes = rayTracing->base.scenes;
+	size_t rayTracingSceneCount = rayTracing->base.sceneCount;
+
+	for (size_t i = 0; i < rayTracingSceneCount; i++)
+		onRayTracingScene(rayTracingScenes[i], handle);
+
+#ifndef NDEBUG
+	window->rayTracing->base.isEnumeratingScenes = false;
+#endif
+}
+
+MpgxResult createBuffer(
+	Window window,
+	BufferType type,
+	BufferUsage usage,
+	const void* data,
+	size_t size,
+	Buffer* buffer)
+{
+	assert(window);
+	assert(type > 0);
+	assert(usage < BUFFER_USAGE_COUNT);
+	assert(size > 0);
+	assert(buffer);
+	assert(!window->isRecording);
+	assert(!window->isEnumeratingBuffers);
+	assert(graphicsInitialized);
+
+	assert((usage != GPU_TO_CPU_BUFFER_USAGE) ||
+		(usage == GPU_TO_CPU_BUFFER_USAGE && !data));
+
+	MpgxResult mpgxResult;
+	Buffer bufferInstance;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+
+		mpgxResult = createVkBuffer(
+			vkWindow->device,
+			vkWindow->allocator,
+			vkWindow->transferQueue,
+			vkWindow->transferCommandBuffer,
+			vkWindow->transferFence,
+			&vkWindow->stagingBuffer,
+			&vkWindow->stagingAllocation,
+			&vkWindow->stagingSize,
+			vkWindow->resizableBarHeapIndex,
+			window,
+			type,
+			usage,
+			data,
+			size,
+			window->rayTracing,
+			&bufferInstance);
+#else
+	abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		mpgxResult = createGlBuffer(
+			window,
+			type,
+			usage,
+			data,
+			size,
+			&bufferInstance);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	size_t count = window->bufferCount;
+
+	if (count == window->bufferCapacity)
+	{
+		size_t capacity = window->bufferCapacity * 2;
+
+		Buffer* buffers = realloc(window->buffers,
+			sizeof(Buffer) * capacity);
+
+		if (!buffers)
+		{
+			if (graphicsAPI == VULKAN_GRAPHICS_API)
+			{
+#if MPGX_SUPPORT_VULKAN
+				destroyVkBuffer(
+					window->vkWindow->allocator,
+					bufferInstance);
+#else
+				abort();
+#endif
+			}
+			else
+			{
+#if MPGX_SUPPORT_OPENGL
+				destroyGlBuffer(bufferInstance);
+#else
+				abort();
+#endif
+			}
+
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		window->buffers = buffers;
+		window->bufferCapacity = capacity;
+	}
+
+	window->buffers[count] = bufferInstance;
+	window->bufferCount = count + 1;
+
+	*buffer = bufferInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+void destroyBuffer(Buffer buffer)
+{
+	if (!buffer)
+		return;
+
+	assert(!buffer->base.isMapped);
+	assert(!buffer->base.window->isRecording);
+	assert(!buffer->base.window->isEnumeratingBuffers);
+	assert(graphicsInitialized);
+
+	Window window = buffer->base.window;
+	Buffer* buffers = window->buffers;
+	size_t bufferCount = window->bufferCount;
+
+	for (int64_t i = (int64_t)bufferCount - 1; i >= 0 ; i--)
+	{
+		if (buffer != buffers[i])
+			continue;
+
+		if (graphicsAPI == VULKAN_GRAPHICS_API)
+		{
+#if MPGX_SUPPORT_VULKAN
+			VkWindow vkWindow = window->vkWindow;
+
+			VkResult result = vkQueueWaitIdle(
+				vkWindow->graphicsQueue);
+
+			if (result != VK_SUCCESS)
+				abort();
+
+			destroyVkBuffer(
+				vkWindow->allocator,
+				buffer);
+#else
+			abort();
+#endif
+		}
+		else if (graphicsAPI == OPENGL_GRAPHICS_API)
+		{
+#if MPGX_SUPPORT_OPENGL
+			destroyGlBuffer(buffer);
+#else
+			abort();
+#endif
+		}
+		else
+		{
+			abort();
+		}
+
+		for (size_t j = i + 1; j < bufferCount; j++)
+			buffers[j - 1] = buffers[j];
+
+		window->bufferCount--;
+		return;
+	}
+
+	abort();
+}
+
+Window getBufferWindow(Buffer buffer)
+{
+	assert(buffer);
+	assert(graphicsInitialized);
+	return buffer->base.window;
+}
+BufferType getBufferType(Buffer buffer)
+{
+	assert(buffer);
+	assert(graphicsInitialized);
+	return buffer->base.type;
+}
+BufferUsage getBufferUsage(Buffer buffer)
+{
+	assert(buffer);
+	assert(graphicsInitialized);
+	return buffer->base.usage;
+}
+size_t getBufferSize(Buffer buffer)
+{
+	assert(buffer);
+	assert(graphicsInitialized);
+	return buffer->base.size;
+}
+
+MpgxResult mapBuffer(
+	Buffer buffer,
+	size_t size,
+	size_t offset,
+	void** map)
+{
+	assert(buffer);
+	assert(size > 0);
+	assert(map);
+	assert(graphicsInitialized);
+	assert(buffer->base.usage == CPU_ONLY_BUFFER_USAGE ||
+		buffer->base.usage == CPU_TO_GPU_BUFFER_USAGE ||
+		buffer->base.usage == GPU_TO_CPU_BUFFER_USAGE);
+	assert(size + offset <= buffer->base.size);
+	assert(!buffer->base.isMapped);
+
+	size_t mapSize = size > 0 ? size : buffer->base.size;
+	Window window = buffer->base.window;
+
+	MpgxResult mpgxResult;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		mpgxResult = mapVkBuffer(
+			window->vkWindow->allocator,
+			buffer->vk.allocation,
+			buffer->vk.usage,
+			mapSize,
+			offset,
+			map);
+
+		buffer->vk.mapSize = mapSize;
+		buffer->vk.mapOffset = offset;
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		mpgxResult = mapGlBuffer(
+			buffer->gl.glType,
+			buffer->gl.handle,
+			buffer->gl.usage,
+			mapSize,
+			offset,
+			map);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+#ifndef NDEBUG
+	buffer->base.isMapped = true;
+#endif
+	return SUCCESS_MPGX_RESULT;
+}
+MpgxResult unmapBuffer(Buffer buffer)
+{
+	assert(buffer);
+	assert(buffer->base.isMapped);
+	assert(graphicsInitialized);
+
+	Window window = buffer->base.window;
+
+	MpgxResult mpgxResult;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		mpgxResult = unmapVkBuffer(
+			window->vkWindow->allocator,
+			buffer->vk.allocation,
+			buffer->vk.usage,
+			buffer->vk.mapSize,
+			buffer->vk.mapOffset);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		mpgxResult = unmapGlBuffer(
+			buffer->gl.glType,
+			buffer->gl.handle);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+#ifndef NDEBUG
+	buffer->base.isMapped = false;
+#endif
+	return mpgxResult;
+}
+
+MpgxResult setBufferData(
+	Buffer buffer,
+	const void* data,
+	size_t size,
+	size_t offset)
+{
+	assert(buffer);
+	assert(data);
+	assert(size > 0);
+	assert(buffer->base.usage == CPU_ONLY_BUFFER_USAGE ||
+		buffer->base.usage == CPU_TO_GPU_BUFFER_USAGE);
+	assert(!buffer->base.isMapped);
+	assert(size + offset <= buffer->base.size);
+	assert(graphicsInitialized);
+
+	Window window = buffer->base.window;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		return setVkBufferData(
+			window->vkWindow->allocator,
+			buffer->vk.allocation,
+			data,
+			size,
+			offset);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		return setGlBufferData(
+			buffer->gl.glType,
+			buffer->gl.handle,
+			data,
+			size,
+			offset);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+MpgxResult setBuffersData(
+	const BufferDataInfo* infos,
+	size_t infoCount)
+{
+	assert(infos);
+	assert(infoCount > 0);
+	assert(graphicsInitialized);
+
+	Window window = infos[0].buffer->base.window;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+
+		return setVkBuffersData(
+			vkWindow->device,
+			vkWindow->allocator,
+			vkWindow->transferQueue,
+			vkWindow->transferCommandBuffer,
+			vkWindow->transferFence,
+			&vkWindow->stagingBuffer,
+			&vkWindow->stagingAllocation,
+			&vkWindow->stagingSize,
+			infos,
+			infoCount);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		for (size_t i = 0; i < infoCount; i++)
+		{
+			const BufferDataInfo* info = &infos[i];
+			Buffer buffer = info->buffer;
+
+			assert(buffer);
+			assert(info->data);
+			assert(info->size > 0);
+			assert(info->size + info->offset <= buffer->gl.size);
+			assert(!buffer->gl.isMapped);
+			assert(buffer->gl.window == window);
+
+			MpgxResult mpgxResult = setGlBufferData(
+				buffer->gl.glType,
+				buffer->gl.handle,
+				info->data,
+				info->size,
+				info->offset);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				return mpgxResult;
+		}
+
+		return SUCCESS_MPGX_RESULT;
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+
+inline static bool addWindowImage(
+	Window window,
+	Image image)
+{
+	assert(window);
+	assert(image);
+
+	size_t count = window->imageCount;
+
+	if (count == window->imageCapacity)
+	{
+		size_t capacity = window->imageCapacity * 2;
+
+		Image* images = realloc(window->images,
+			sizeof(Image) * capacity);
+
+		if (!images)
+		{
+			if (graphicsAPI == VULKAN_GRAPHICS_API)
+			{
+#if MPGX_SUPPORT_VULKAN
+				VkWindow vkWindow = window->vkWindow;
+
+				destroyVkImage(
+					vkWindow->device,
+					vkWindow->allocator,
+					image);
+#else
+				abort();
+#endif
+			}
+			else
+			{
+#if MPGX_SUPPORT_OPENGL
+				destroyGlImage(image);
+#else
+				abort();
+#endif
+			}
+
+			return false;
+		}
+
+		window->images = images;
+		window->imageCapacity = capacity;
+	}
+
+	window->images[count] = image;
+	window->imageCount = count + 1;
+	return true;
+}
+static MpgxResult createAnyImage(
+	Window window,
+	ImageType type,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint32_t mipCount,
+	uint32_t layerCount,
+	bool generateMipmap,
+	bool isConstant,
+	Image* image)
+{
+	assert(window);
+	assert(type > 0);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(layerCount > 0);
+	assert(image);
+	assert(mipCount <= calcMipLevelCount(size));
+	assert(!(type & TRANSIENT_ATTACHMENT_IMAGE_TYPE) || (!data &&
+		(type & (COLOR_ATTACHMENT_IMAGE_TYPE | DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)) &&
+		!(type & (SAMPLED_IMAGE_TYPE | STORAGE_IMAGE_TYPE |
+		TRANSFER_SOURCE_IMAGE_TYPE | TRANSFER_DESTINATION_IMAGE_TYPE))));
+	assert(!generateMipmap || data);
+
+	MpgxResult mpgxResult;
+	Image imageInstance;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+
+		if (!isVkImageFormatSupported(
+			vkWindow->physicalDevice,
+			type,
+			format,
+			isConstant))
+		{
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		}
+
+		VkQueue queue = vkWindow->transferQueue;
+		VkCommandBuffer commandBuffer = vkWindow->transferCommandBuffer;
+		VkFilter mipmapFilter = VK_FILTER_LINEAR;
+
+		if (generateMipmap)
+		{
+			if (!getVkImageMipmapFilter(
+				vkWindow->physicalDevice,
+				format,
+				&mipmapFilter))
+			{
+				return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			}
+
+			// Image blit is supported only by the graphics queue
+			queue = vkWindow->graphicsQueue;
+			commandBuffer = vkWindow->graphicsCommandBuffer;
+		}
+
+		mpgxResult = createVkImage(
+			vkWindow->device,
+			vkWindow->allocator,
+			queue,
+			commandBuffer,
+			vkWindow->transferFence,
+			vkWindow->barrierBatch,
+			&vkWindow->stagingBuffer,
+			&vkWindow->stagingAllocation,
+			&vkWindow->stagingSize,
+			window,
+			type,
+			dimension,
+			format,
+			data,
+			size,
+			mipCount,
+			layerCount,
+			generateMipmap,
+			mipmapFilter,
+			isConstant,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		if (layerCount != 1)
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+		mpgxResult = createGlImage(
+			window,
+			type,
+			dimension,
+			format,
+			data,
+			size,
+			mipCount,
+			generateMipmap,
+			isConstant,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	if (!addWindowImage(window, imageInstance))
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+MpgxResult createMipmapImage(
+	Window window,
+	ImageType type,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint32_t mipCount,
+	uint32_t layerCount,
+	bool isConstant,
+	Image* image)
+{
+	assert(window);
+	assert(type > 0);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(layerCount > 0);
+	assert(image);
+	assert(!window->isRecording);
+	assert(!window->isEnumeratingImages);
+	assert(mipCount <= calcMipLevelCount(size));
+	assert(!(type & TRANSIENT_ATTACHMENT_IMAGE_TYPE) || (!data &&
+		(type & (COLOR_ATTACHMENT_IMAGE_TYPE | DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE)) &&
+		!(type & (SAMPLED_IMAGE_TYPE | STORAGE_IMAGE_TYPE |
+		TRANSFER_SOURCE_IMAGE_TYPE | TRANSFER_DESTINATION_IMAGE_TYPE))));
+	assert(graphicsInitialized);
+
+	return createAnyImage(
+		window,
+		type,
+		dimension,
+		format,
+		data,
+		size,
+		mipCount,
+		layerCount,
+		false,
+		isConstant,
+		image);
+}
+MpgxResult createImage(
+	Window window,
+	ImageType type,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void* data,
+	Vec3I size,
+	uint32_t layerCount,
+	bool generateMipmap,
+	bool isConstant,
+	Image* image)
+{
+	assert(window);
+	assert(type > 0);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(layerCount > 0);
+	assert(image);
+	assert(!window->isRecording);
+	assert(!window->isEnumeratingImages);
+	assert(!generateMipmap || data);
+	assert(graphicsInitialized);
+
+	return createAnyImage(
+		window,
+		type,
+		dimension,
+		format,
+		data? &data : NULL,
+		size,
+		generateMipmap ? calcMipLevelCount(size) : 1,
+		layerCount,
+		generateMipmap,
+		isConstant,
+		image);
+}
+MpgxResult createAliasImage(
+	Image baseImage,
+	ImageType type,
+	ImageFormat format,
+	Vec3I size,
+	Image* image)
+{
+	assert(baseImage);
+	assert(type > 0);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(image);
+	assert(baseImage->base.isConstant);
+	assert(baseImage->base.type & (COLOR_ATTACHMENT_IMAGE_TYPE |
+		DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE | STORAGE_IMAGE_TYPE));
+	assert(!baseImage->base.window->isRecording);
+	assert(!baseImage->base.window->isEnumeratingImages);
+	assert(graphicsInitialized);
+
+	Window window = baseImage->base.window;
+
+	MpgxResult mpgxResult;
+	Image imageInstance;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+
+		mpgxResult = createVkAliasImage(
+			vkWindow->device,
+			vkWindow->allocator,
+			baseImage,
+			type,
+			format,
+			size,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		// OpenGL has no memory aliasing, so separate image is created.
+		mpgxResult = createGlImage(
+			window,
+			type,
+			baseImage->base.dimension,
+			format,
+			NULL,
+			size,
+			1,
+			false,
+			true,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	size_t count = window->imageCount;
+
+	if (count == window->imageCapacity)
+	{
+		size_t capacity = window->imageCapacity * 2;
+
+		Image* images = realloc(window->images,
+			sizeof(Image) * capacity);
+
+		if (!images)
+		{
+			if (graphicsAPI == VULKAN_GRAPHICS_API)
+			{
+#if MPGX_SUPPORT_VULKAN
+				VkWindow vkWindow = window->vkWindow;
+
+				destroyVkImage(
+					vkWindow->device,
+					vkWindow->allocator,
+					imageInstance);
+#else
+				abort();
+#endif
+			}
+			else
+			{
+#if MPGX_SUPPORT_OPENGL
+				destroyGlImage(imageInstance);
+#else
+				abort();
+#endif
+			}
+
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		window->images = images;
+		window->imageCapacity = capacity;
+	}
+
+	window->images[count] = imageInstance;
+	window->imageCount = count + 1;
+
+	// Base image is destroyed only after all of its aliases
+	imageInstance->base.aliasBase = baseImage;
+	baseImage->base.aliasCount++;
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+MpgxResult createStreamingImage(
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	const void** data,
+	Vec3I size,
+	uint8_t mipCount,
+	uint8_t residentMipCount,
+	Image* image)
+{
+	assert(window);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(data);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(residentMipCount > 0);
+	assert(residentMipCount <= mipCount);
+	assert(image);
+	assert(!window->isRecording);
+	assert(!window->isEnumeratingImages);
+	assert(mipCount <= calcMipLevelCount(size));
+	assert(graphicsInitialized);
+
+	MpgxResult mpgxResult;
+	Image imageInstance;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+
+		if (!isVkImageFormatSupported(
+			vkWindow->physicalDevice,
+			SAMPLED_IMAGE_TYPE,
+			format,
+			true))
+		{
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		}
+
+		// Not blittable formats keep not resident levels
+		// undefined, their sampling should be clamped by LOD.
+		VkFilter fillFilter = VK_FILTER_NEAREST;
+
+		bool isFilled = getVkImageMipmapFilter(
+			vkWindow->physicalDevice,
+			format,
+			&fillFilter);
+
+		mpgxResult = createVkStreamingImage(
+			vkWindow->device,
+			vkWindow->allocator,
+			vkWindow->graphicsQueue,
+			vkWindow->graphicsCommandBuffer,
+			vkWindow->transferFence,
+			vkWindow->barrierBatch,
+			&vkWindow->stagingBuffer,
+			&vkWindow->stagingAllocation,
+			&vkWindow->stagingSize,
+			window,
+			dimension,
+			format,
+			data,
+			size,
+			mipCount,
+			residentMipCount,
+			isFilled,
+			fillFilter,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		mpgxResult = createGlStreamingImage(
+			window,
+			dimension,
+			format,
+			data,
+			size,
+			mipCount,
+			residentMipCount,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	if (!addWindowImage(window, imageInstance))
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	window->streamingMemory += imageInstance->base.stream->residentSize;
+	window->streamingImageCount++;
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+MpgxResult createSparseImage(
+	Window window,
+	ImageDimension dimension,
+	ImageFormat format,
+	Vec3I size,
+	uint8_t mipCount,
+	Image* image)
+{
+	assert(window);
+	assert(dimension < IMAGE_DIMENSION_COUNT);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(size.z > 0);
+	assert(mipCount > 0);
+	assert(image);
+	assert(!window->isRecording);
+	assert(!window->isEnumeratingImages);
+	assert(mipCount <= calcMipLevelCount(size));
+	assert(graphicsInitialized);
+
+	MpgxResult mpgxResult;
+	Image imageInstance;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+
+		if (!vkWindow->isSparseSupported)
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+		mpgxResult = createVkSparseImage(
+			vkWindow->device,
+			vkWindow->allocator,
+			vkWindow->physicalDevice,
+			vkWindow->graphicsQueue,
+			vkWindow->transferFence,
+			window,
+			dimension,
+			format,
+			size,
+			mipCount,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		mpgxResult = createGlSparseImage(
+			window,
+			dimension,
+			format,
+			size,
+			mipCount,
+			&imageInstance);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
+
+	if (!addWindowImage(window, imageInstance))
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	*image = imageInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+void destroyImage(Image image)
+{
+	if (!image)
+		return;
+
+	assert(image->base.aliasCount == 0);
+	assert(!image->base.window->isRecording);
+	assert(!image->base.window->isEnumeratingImages);
+	assert(graphicsInitialized);
+
+	Window window = image->base.window;
+	Image* images = window->images;
+	size_t imageCount = window->imageCount;
+
+	for (int64_t i = (int64_t)imageCount - 1; i >= 0; i--)
+	{
+		if (image != images[i])
+			continue;
+
+		Image aliasBase = image->base.aliasBase;
+		ImageStream stream = image->base.stream;
+
+		if (stream)
+		{
+			window->streamingMemory -= stream->residentSize;
+			window->streamingImageCount--;
+		}
+
+		if (graphicsAPI == VULKAN_GRAPHICS_API)
+		{
+#if MPGX_SUPPORT_VULKAN
+			VkWindow vkWindow = window->vkWindow;
+
+			VkResult result = vkQueueWaitIdle(
+				vkWindow->graphicsQueue);
+
+			if (result != VK_SUCCESS)
+				abort();
+
+			if (image->vk.sparse)
+				destroyVkImageRetiredPages(window, image);
+
+			// Next alias still waits for the destroyed alias accesses
+			if (aliasBase && aliasBase->vk.activeAlias == image)
+				aliasBase->vk.activeAlias = NULL;
+
+			destroyVkImage(
+				vkWindow->device,
+				vkWindow->allocator,
+				image);
+#else
+			abort();
+#endif
+		}
+		else if (graphicsAPI == OPENGL_GRAPHICS_API)
+		{
+#if MPGX_SUPPORT_OPENGL
+			destroyGlImage(image);
+#else
+			abort();
+#endif
+		}
+		else
+		{
+			abort();
+		}
+
+		for (size_t j = i + 1; j < imageCount; j++)
+			images[j - 1] = images[j];
+
+		window->imageCount--;
+
+		if (aliasBase)
+			aliasBase->base.aliasCount--;
+		return;
+	}
+
+	abort();
+}
+
+MpgxResult setMipmapImageData(
+	Image image,
+	const void** data,
+	Vec3I size,
+	Vec3I offset)
+{
+	assert(image);
+	assert(data);
+	assert(graphicsInitialized);
+
+	uint32_t mipCount = image->base.mipCount;
+
+	ImageDataInfo* infos = malloc(
+		mipCount * sizeof(ImageDataInfo));
+
+	if (!infos)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+	size_t infoCount = 0;
+
+	// Mip levels are written at once, missing levels are skipped
+	for (uint32_t i = 0; i < mipCount; i++)
+	{
+		if (data[i])
+		{
+			ImageDataInfo info = {
+				image,
+				data[i],
+				size,
+				offset,
+				0,
+				image->base.layerCount,
+				(uint8_t)i,
+			};
+
+			infos[infoCount++] = info;
+		}
+
+		if (size.x > 1) size.x /= 2;
+		if (size.y > 1) size.y /= 2;
+		if (size.z > 1) size.z /= 2;
+		offset.x /= 2;
+		offset.y /= 2;
+		offset.z /= 2;
+	}
+
+	if (infoCount == 0)
+	{
+		free(infos);
+		return SUCCESS_MPGX_RESULT;
+	}
+
+	MpgxResult mpgxResult = setImagesData(
+		infos,
+		infoCount);
+
+	free(infos);
+	return mpgxResult;
+}
+MpgxResult setImageData(
+	Image image,
+	const void* data,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel)
+{
+	assert(image);
+	assert(data);
+	assert(graphicsInitialized);
+
+	return setImageLayerData(
+		image,
+		data,
+		size,
+		offset,
+		mipLevel,
+		0,
+		image->base.layerCount);
+}
+#ifndef NDEBUG
+static bool isImageRegionValid(
+	Image image,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel)
+{
+	if (size.x <= 0 || size.y <= 0 || size.z <= 0 ||
+		offset.x < 0 || offset.y < 0 || offset.z < 0 ||
+		mipLevel >= image->base.mipCount)
+	{
+		return false;
+	}
+
+	Vec3I mipSize = getImageMipSize(image->base.size, mipLevel);
+
+	if (size.x + offset.x > mipSize.x ||
+		size.y + offset.y > mipSize.y ||
+		size.z + offset.z > mipSize.z)
+	{
+		return false;
+	}
+
+	Vec2I blockExtent = getImageFormatBlockExtent(image->base.format);
+
+	if (offset.x % blockExtent.x != 0 || offset.y % blockExtent.y != 0)
+		return false;
+
+	// Only the region reaching the mip edge can end with a partial block
+	if ((size.x % blockExtent.x != 0 && size.x + offset.x != mipSize.x) ||
+		(size.y % blockExtent.y != 0 && size.y + offset.y != mipSize.y))
+	{
+		return false;
+	}
+
+	return true;
+}
+#endif
+
+MpgxResult setImageLayerData(
+	Image image,
+	const void* data,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount)
+{
+	assert(image);
+	assert(data);
+	assert(isImageRegionValid(image, size, offset, mipLevel));
+	assert(layerCount > 0);
+	assert(baseLayer + layerCount <= image->base.layerCount);
+	assert(!image->base.isConstant);
+	assert(!image->base.window->isRecording);
+	assert(graphicsInitialized);
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow =
+			image->vk.window->vkWindow;
+
+		// Sparse images are written through the window staging buffer
+		if (image->vk.sparse)
+		{
+			// Transfer queue copies are not ordered with the page binds
+			MpgxResult mpgxResult = waitVkSparseBind(vkWindow);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				return mpgxResult;
+
+			ImageDataInfo info = {
+				image,
+				data,
+				size,
+				offset,
+				baseLayer,
+				layerCount,
+				mipLevel,
+			};
+
+			return setVkImagesData(
+				vkWindow->device,
+				vkWindow->allocator,
+				vkWindow->transferQueue,
+				vkWindow->transferCommandBuffer,
+				vkWindow->transferFence,
+				vkWindow->barrierBatch,
+				&vkWindow->stagingBuffer,
+				&vkWindow->stagingAllocation,
+				&vkWindow->stagingSize,
+				&info,
+				1);
+		}
+
+		return setVkImageData(
+			vkWindow->device,
+			vkWindow->allocator,
+			vkWindow->transferQueue,
+			vkWindow->transferCommandBuffer,
+			vkWindow->transferFence,
+			vkWindow->barrierBatch,
+			image,
+			data,
+			size,
+			offset,
+			mipLevel,
+			baseLayer,
+			layerCount);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		// OpenGL images always have one array layer
+		return setGlImageData(
+			image,
+			data,
+			size,
+			offset,
+			mipLevel);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+MpgxResult setImagesData(
+	const ImageDataInfo* infos,
+	size_t infoCount)
+{
+	assert(infos);
+	assert(infoCount > 0);
+	assert(!infos[0].image->base.window->isRecording);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		const ImageDataInfo* info = &infos[i];
+		Image image = info->image;
+
+		assert(info->data);
+		assert(isImageRegionValid(
+			image,
+			info->size,
+			info->offset,
+			info->mipLevel));
+		assert(info->layerCount > 0);
+		assert(info->baseLayer + info->layerCount <= image->base.layerCount);
+		assert(!image->base.isConstant);
+	}
+#endif
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow =
+			infos[0].image->vk.window->vkWindow;
+
+		// Transfer queue copies are not ordered with the page binds
+		MpgxResult mpgxResult = waitVkSparseBind(vkWindow);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		return setVkImagesData(
+			vkWindow->device,
+			vkWindow->allocator,
+			vkWindow->transferQueue,
+			vkWindow->transferCommandBuffer,
+			vkWindow->transferFence,
+			vkWindow->barrierBatch,
+			&vkWindow->stagingBuffer,
+			&vkWindow->stagingAllocation,
+			&vkWindow->stagingSize,
+			infos,
+			infoCount);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		// OpenGL uploads are queued by the driver
+		for (size_t i = 0; i < infoCount; i++)
+		{
+			const ImageDataInfo* info = &infos[i];
+
+			MpgxResult mpgxResult = setGlImageData(
+				info->image,
+				info->data,
+				info->size,
+				info->offset,
+				info->mipLevel);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				return mpgxResult;
+		}
+
+		return SUCCESS_MPGX_RESULT;
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+
+#ifndef NDEBUG
+static bool isImagePagesValid(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount)
+{
+	ImageSparse sparse = image->base.sparse;
+
+	for (size_t i = 0; i < pageCount; i++)
+	{
+		const ImagePage* page = &pages[i];
+
+		if (page->mipLevel >= sparse->tailMip)
+			return false;
+
+		Vec3I levelPageCount = getImagePageCount(
+			getImageMipSize(image->base.size, page->mipLevel),
+			sparse->pageSize);
+
+		if (page->offset.x < 0 || page->offset.x >= levelPageCount.x ||
+			page->offset.y < 0 || page->offset.y >= levelPageCount.y ||
+			page->offset.z < 0 || page->offset.z >= levelPageCount.z)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+#endif
+
+MpgxResult commitImagePages(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount)
+{
+	assert(image);
+	assert(image->base.sparse);
+	assert(pages);
+	assert(pageCount > 0);
+	assert(isImagePagesValid(image, pages, pageCount));
+	assert(!image->base.window->isRecording);
+	assert(graphicsInitialized);
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow =
+			image->vk.window->vkWindow;
+		VmaAllocator allocator = vkWindow->allocator;
+
+		VkSparseImageMemoryBind* binds;
+		size_t* pageIndices;
+		uint32_t bindCount;
+
+		MpgxResult mpgxResult = allocateVkImagePages(
+			vkWindow->device,
+			allocator,
+			image,
+			pages,
+			pageCount,
+			&binds,
+			&pageIndices,
+			&bindCount);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		if (bindCount > 0)
+		{
+			// Bind is not waited, the next submit waits for it instead
+			mpgxResult = bindVkSparseImage(
+				vkWindow,
+				image->vk.handle,
+				binds,
+				bindCount);
+
+			if (mpgxResult == SUCCESS_MPGX_RESULT)
+			{
+				image->vk.sparse->committedPageCount += bindCount;
+			}
+			else
+			{
+				freeVkImagePages(
+					allocator,
+					image,
+					pageIndices,
+					bindCount);
+			}
+		}
+
+		free(pageIndices);
+		free(binds);
+		return mpgxResult;
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		return setGlImagePageCommitment(
+			image,
+			pages,
+			pageCount,
+			true);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+MpgxResult decommitImagePages(
+	Image image,
+	const ImagePage* pages,
+	size_t pageCount)
+{
+	assert(image);
+	assert(image->base.sparse);
+	assert(pages);
+	assert(pageCount > 0);
+	assert(isImagePagesValid(image, pages, pageCount));
+	assert(!image->base.window->isRecording);
+	assert(graphicsInitialized);
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		Window window = image->vk.window;
+		VkWindow vkWindow = window->vkWindow;
+
+		VkRetiredImagePages* retiredImagePages =
+			window->retiredImagePages;
+		size_t retiredImagePageCount =
+			window->retiredImagePageCount;
+
+		if (retiredImagePageCount == window->retiredImagePageCapacity)
+		{
+			size_t capacity = window->retiredImagePageCapacity * 2;
+
+			retiredImagePages = realloc(retiredImagePages,
+				capacity * sizeof(VkRetiredImagePages));
+
+			if (!retiredImagePages)
+				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+			window->retiredImagePages = retiredImagePages;
+			window->retiredImagePageCapacity = capacity;
+		}
+
+		VkRetiredImagePages retiredPages;
+
+		MpgxResult mpgxResult = retireVkImagePages(
+			image,
+			pages,
+			pageCount,
+			&retiredPages);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		if (retiredPages.pageCount == 0)
+		{
+			destroyVkRetiredImagePages(
+				vkWindow->allocator,
+				&retiredPages);
+			return SUCCESS_MPGX_RESULT;
+		}
+
+		// Page memory can still be read by the in-flight frames,
+		// it is unbound after the fences of all of them are waited.
+		retiredPages.frameIndex = (vkWindow->frameIndex +
+			VK_FRAME_LAG - 1) % VK_FRAME_LAG;
+
+		retiredImagePages[retiredImagePageCount] = retiredPages;
+		window->retiredImagePageCount = retiredImagePageCount + 1;
+		return SUCCESS_MPGX_RESULT;
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		return setGlImagePageCommitment(
+			image,
+			pages,
+			pageCount,
+			false);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+}
+
+static MpgxResult reserveImageReadback(
+	Window window,
+	size_t dataSize,
+	ImageReadback** readback)
+{
+	assert(window);
+	assert(dataSize > 0);
+	assert(readback);
+
+	ImageReadback* readbacks = window->readbacks;
+	size_t readbackCount = window->readbackCount;
+	ImageReadback* readbackInstance = NULL;
+
+	// Idle readback buffers are reused by the next requests
+	for (size_t i = 0; i < readbackCount; i++)
+	{
+		if (readbacks[i].isPending)
+			continue;
+
+		readbackInstance = &readbacks[i];
+
+		if (readbackInstance->bufferSize >= dataSize)
+		{
+			*readback = readbackInstance;
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
+
+	if (!readbackInstance)
+	{
+		if (readbackCount == window->readbackCapacity)
+		{
+			size_t capacity = window->readbackCapacity * 2;
+
+			readbacks = realloc(window->readbacks,
+				sizeof(ImageReadback) * capacity);
+
+			if (!readbacks)
+				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+			window->readbacks = readbacks;
+			window->readbackCapacity = capacity;
+		}
+
+		readbackInstance = &readbacks[readbackCount];
+		memset(readbackInstance, 0, sizeof(ImageReadback));
+		window->readbackCount = readbackCount + 1;
+	}
+
+	// Too small idle buffer is recreated with the required size
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VmaAllocator allocator = window->vkWindow->allocator;
+
+		vmaDestroyBuffer(
+			allocator,
+			readbackInstance->vkBuffer,
+			readbackInstance->vkAllocation);
+		readbackInstance->vkBuffer = NULL;
+		readbackInstance->vkAllocation = NULL;
+		readbackInstance->bufferSize = 0;
+
+		VkBuffer buffer;
+		VmaAllocation allocation;
+
+		MpgxResult mpgxResult = createVkReadbackBuffer(
+			allocator,
+			dataSize,
+			&buffer,
+			&allocation);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		readbackInstance->vkBuffer = buffer;
+		readbackInstance->vkAllocation = allocation;
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		makeGlWindowContextCurrent(window);
+
+		GLuint buffer = readbackInstance->glBuffer;
+
+		if (buffer == GL_ZERO)
+		{
+			glGenBuffers(
+				GL_ONE,
+				&buffer);
+			readbackInstance->glBuffer = buffer;
+		}
+
+		glBindBuffer(
+			GL_PIXEL_PACK_BUFFER,
+			buffer);
+		glBufferData(
+			GL_PIXEL_PACK_BUFFER,
+			(GLsizeiptr)dataSize,
+			NULL,
+			GL_STREAM_READ);
+		glBindBuffer(
+			GL_PIXEL_PACK_BUFFER,
+			GL_ZERO);
+
+		GLenum glError = glGetError();
+
+		if (glError != GL_NO_ERROR)
+		{
+			readbackInstance->bufferSize = 0;
+			return glToMpgxResult(glError);
+		}
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	readbackInstance->bufferSize = dataSize;
+	*readback = readbackInstance;
+	return SUCCESS_MPGX_RESULT;
+}
+MpgxResult readImageData(
+	Image image,
+	Vec3I size,
+	Vec3I offset,
+	uint8_t mipLevel,
+	uint32_t baseLayer,
+	uint32_t layerCount,
+	OnImageReadback onReadback,
+	void* argument,
+	uint64_t* ticket)
+{
+	assert(image);
+	assert(isImageRegionValid(image, size, offset, mipLevel));
+	assert(layerCount > 0);
+	assert(baseLayer + layerCount <= image->base.layerCount);
+	assert(image->base.type & TRANSFER_SOURCE_IMAGE_TYPE);
+	assert(!isImageFormatDepthStencil(image->base.format));
+	assert(onReadback);
+	assert(ticket);
+	assert(image->base.window->isRecording);
+	assert(!image->base.window->renderFramebuffer);
+	assert(graphicsInitialized);
+
+	Window window = image->base.window;
+	ImageReadback* readback;
+	size_t dataSize;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		dataSize = calcImageDataSize(
+			size,
+			getImageFormatBlockExtent(image->vk.format),
+			image->vk.sizeMultiplier,
+			layerCount);
+
+		MpgxResult mpgxResult = reserveImageReadback(
+			window,
+			dataSize,
+			&readback);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		VkWindow vkWindow = window->vkWindow;
+
+		// Copy is recorded into the frame command buffer
+		mpgxResult = recordVkImageReadback(
+			vkWindow->currenCommandBuffer,
+			vkWindow->barrierBatch,
+			readback->vkBuffer,
+			image,
+			size,
+			offset,
+			mipLevel,
+			baseLayer,
+			layerCount);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		readback->frameIndex = vkWindow->frameIndex;
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		// OpenGL reads only one array layer per request
+		assert(layerCount == 1);
+
+		// Compressed texture regions can not be read by OpenGL
+		if (isImageFormatCompressed(image->gl.format))
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+		dataSize = calcImageDataSize(
+			size,
+			vec2I(1, 1),
+			getGlImageFormatPixelSize(image->gl.format),
+			1);
+
+		MpgxResult mpgxResult = reserveImageReadback(
+			window,
+			dataSize,
+			&readback);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		mpgxResult = readGlImageData(
+			image,
+			readback->glBuffer,
+			size,
+			offset,
+			mipLevel);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		GLsync sync = glFenceSync(
+			GL_SYNC_GPU_COMMANDS_COMPLETE,
+			0);
+
+		if (!sync)
+			return glToMpgxResult(glGetError());
+
+		readback->glSync = sync;
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	uint64_t readbackTicket = ++window->readbackTicket;
+
+	readback->onReadback = onReadback;
+	readback->argument = argument;
+	readback->ticket = readbackTicket;
+	readback->dataSize = dataSize;
+	readback->isPending = true;
+
+	*ticket = readbackTicket;
+	return SUCCESS_MPGX_RESULT;
+}
+
+Window getImageWindow(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.window;
+}
+ImageType getImageType(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.type;
+}
+ImageDimension getImageDimension(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.dimension;
+}
+ImageFormat getImageFormat(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.format;
+}
+uint32_t getImageMipCount(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.mipCount;
+}
+uint32_t getImageLayerCount(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.layerCount;
+}
+Vec3I getImageSize(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.size;
+}
+bool isImageConstant(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.isConstant;
+}
+
+bool isImageSparse(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.sparse != NULL;
+}
+Vec3I getImagePageSize(Image image)
+{
+	assert(image);
+	assert(image->base.sparse);
+	assert(graphicsInitialized);
+	return image->base.sparse->pageSize;
+}
+uint8_t getImageMipTail(Image image)
+{
+	assert(image);
+	assert(image->base.sparse);
+	assert(graphicsInitialized);
+	return image->base.sparse->tailMip;
+}
+size_t getImageCommittedPageCount(Image image)
+{
+	assert(image);
+	assert(image->base.sparse);
+	assert(graphicsInitialized);
+	return image->base.sparse->committedPageCount;
+}
+
+bool isImageStreaming(Image image)
+{
+	assert(image);
+	assert(graphicsInitialized);
+	return image->base.stream != NULL;
+}
+void setImageStreamPriority(
+	Image image,
+	float priority)
+{
+	assert(image);
+	assert(image->base.stream);
+	assert(graphicsInitialized);
+	image->base.stream->priority = priority;
+}
+void requestImageStreamMip(
+	Image image,
+	uint8_t mipLevel)
+{
+	assert(image);
+	assert(image->base.stream);
+	assert(mipLevel < image->base.mipCount);
+	assert(graphicsInitialized);
+	image->base.stream->requestedMip = mipLevel;
+}
+uint8_t getImageResidentMip(Image image)
+{
+	assert(image);
+	assert(image->base.stream);
+	assert(graphicsInitialized);
+	return image->base.stream->residentMip;
+}
+void setWindowStreamingBudget(
+	Window window,
+	size_t memoryBudget,
+	size_t uploadBudget)
+{
+	assert(window);
+	assert(uploadBudget > 0);
+	assert(!window->isRecording);
+	assert(graphicsInitialized);
+	window->streamingMemoryBudget = memoryBudget;
+	window->streamingUploadBudget = uploadBudget;
+}
+size_t getWindowStreamingMemory(Window window)
+{
+	assert(window);
+	assert(graphicsInitialized);
+	return window->streamingMemory;
+}
+
+bool isImageFormatSupported(
+	Window window,
+	ImageType type,
+	ImageFormat format,
+	bool isConstant)
+{
+	assert(window);
+	assert(type > 0);
+	assert(format < IMAGE_FORMAT_COUNT);
+	assert(graphicsInitialized);
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		return isVkImageFormatSupported(
+			window->vkWindow->physicalDevice,
+			type,
+			format,
+			isConstant);
+#else
+		abort();
 #endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		return isGlImageFormatSupported(
+			type,
+			format);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
 }
-void enumerateWindowRayTracingScene(
+ImageFormat getBestImageFormat(
 	Window window,
-	OnWindowRayTracingScene onRayTracingScene,
-	void* handle)
+	ImageType type,
+	const ImageFormat* formats,
+	size_t formatCount,
+	bool isConstant)
 {
 	assert(window);
-	assert(onRayTracingScene);
-	assert(window->rayTracing);
+	assert(type > 0);
+	assert(formats);
+	assert(formatCount > 0);
 	assert(graphicsInitialized);
 
-#ifndef NDEBUG
-	window->rayTracing->base.isEnumeratingScenes = true;
-#endif
-
-	RayTracing rayTracing = window->rayTracing;
-	RayTracingScene* rayTracingScenes = rayTracing->base.scenes;
-	size_t rayTracingSceneCount = rayTracing->base.sceneCount;
+	for (size_t i = 0; i < formatCount; i++)
+	{
+		ImageFormat format = formats[i];
 
-	for (size_t i = 0; i < rayTracingSceneCount; i++)
-		onRayTracingScene(rayTracingScenes[i], handle);
+		if (isImageFormatSupported(
+			window,
+			type,
+			format,
+			isConstant))
+		{
+			return format;
+		}
+	}
 
-#ifndef NDEBUG
-	window->rayTracing->base.isEnumeratingScenes = false;
-#endif
+	return IMAGE_FORMAT_COUNT;
+}
+Vec2I getImageFormatBlockSize(ImageFormat format)
+{
+	assert(format < IMAGE_FORMAT_COUNT);
+	return getImageFormatBlockExtent(format);
 }
 
-MpgxResult createBuffer(
+MpgxResult createSampler(
 	Window window,
-	BufferType type,
-	BufferUsage usage,
-	const void* data,
-	size_t size,
-	Buffer* buffer)
+	ImageFilter minImageFilter,
+	ImageFilter magImageFilter,
+	ImageFilter minMipmapFilter,
+	bool useMipmapping,
+	ImageWrap imageWrapX,
+	ImageWrap imageWrapY,
+	ImageWrap imageWrapZ,
+	CompareOperator depthCompare,
+	bool useCompare,
+	Vec2F mipmapLodRange,
+	float mipmapLodBias,
+	float maxAnisotropy,
+	Sampler* sampler)
 {
 	assert(window);
-	assert(type > 0);
-	assert(usage < BUFFER_USAGE_COUNT);
-	assert(size > 0);
-	assert(buffer);
+	assert(minImageFilter < IMAGE_FILTER_COUNT);
+	assert(magImageFilter < IMAGE_FILTER_COUNT);
+	assert(minMipmapFilter < IMAGE_FILTER_COUNT);
+	assert(imageWrapX < IMAGE_WRAP_COUNT);
+	assert(imageWrapY < IMAGE_WRAP_COUNT);
+	assert(imageWrapZ < IMAGE_WRAP_COUNT);
+	assert(depthCompare < COMPARE_OPERATOR_COUNT);
+	assert(maxAnisotropy >= 1.0f);
+	assert(sampler);
 	assert(!window->isRecording);
-	assert(!window->isEnumeratingBuffers);
+	assert(!window->isEnumeratingSamplers);
 	assert(graphicsInitialized);
 
-	assert((usage != GPU_TO_CPU_BUFFER_USAGE) ||
-		(usage == GPU_TO_CPU_BUFFER_USAGE && !data));
+	float anisotropyLimit;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		anisotropyLimit = getVkMaxSamplerAnisotropy(
+			window->vkWindow->physicalDevice);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		makeGlWindowContextCurrent(window);
+		anisotropyLimit = getGlMaxSamplerAnisotropy();
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
+
+	if (maxAnisotropy > anisotropyLimit)
+		maxAnisotropy = anisotropyLimit;
+
+	Sampler* windowSamplers = window->samplers;
+	size_t count = window->samplerCount;
+
+	// Same parameters are shared between samplers,
+	// drivers limit the total sampler allocation count.
+	for (size_t i = 0; i < count; i++)
+	{
+		BaseSampler_T* other = &windowSamplers[i]->base;
+
+		if (other->minImageFilter == minImageFilter &&
+			other->magImageFilter == magImageFilter &&
+			other->minMipmapFilter == minMipmapFilter &&
+			other->useMipmapping == useMipmapping &&
+			other->imageWrapX == imageWrapX &&
+			other->imageWrapY == imageWrapY &&
+			other->imageWrapZ == imageWrapZ &&
+			other->depthCompare == depthCompare &&
+			other->useCompare == useCompare &&
+			other->mipmapLodRange.x == mipmapLodRange.x &&
+			other->mipmapLodRange.y == mipmapLodRange.y &&
+			other->mipmapLodBias == mipmapLodBias &&
+			other->maxAnisotropy == maxAnisotropy)
+		{
+			other->refCount++;
+			*sampler = windowSamplers[i];
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
 
 	MpgxResult mpgxResult;
-	Buffer bufferInstance;
+	Sampler samplerInstance;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = window->vkWindow;
-
-		mpgxResult = createVkBuffer(
-			vkWindow->device,
-			vkWindow->allocator,
-			vkWindow->transferQueue,
-			vkWindow->transferCommandBuffer,
-			vkWindow->transferFence,
-			&vkWindow->stagingBuffer,
-			&vkWindow->stagingAllocation,
-			&vkWindow->stagingSize,
+		mpgxResult = createVkSampler(
+			window->vkWindow->device,
 			window,
-			type,
-			usage,
-			data,
-			size,
-			window->rayTracing,
-			&bufferInstance);
+			minImageFilter,
+			magImageFilter,
+			minMipmapFilter,
+			useMipmapping,
+			imageWrapX,
+			imageWrapY,
+			imageWrapZ,
+			depthCompare,
+			useCompare,
+			mipmapLodRange,
+			mipmapLodBias,
+			maxAnisotropy,
+			&samplerInstance);
 #else
-	abort();
+		abort();
 #endif
 	}
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		mpgxResult = createGlBuffer(
+		if (mipmapLodBias != 0.0f)
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+		mpgxResult = createGlSampler(
 			window,
-			type,
-			usage,
-			data,
-			size,
-			&bufferInstance);
+			minImageFilter,
+			magImageFilter,
+			minMipmapFilter,
+			useMipmapping,
+			imageWrapX,
+			imageWrapY,
+			imageWrapZ,
+			depthCompare,
+			useCompare,
+			mipmapLodRange,
+			maxAnisotropy,
+			&samplerInstance);
 #else
 		abort();
 #endif
@@ -2075,23 +5236,23 @@ MpgxResult createBuffer(
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
 		return mpgxResult;
 
-	size_t count = window->bufferCount;
+	samplerInstance->base.refCount = 1;
 
-	if (count == window->bufferCapacity)
+	if (count == window->samplerCapacity)
 	{
-		size_t capacity = window->bufferCapacity * 2;
+		size_t capacity = window->samplerCapacity * 2;
 
-		Buffer* buffers = realloc(window->buffers,
-			sizeof(Buffer) * capacity);
+		Sampler* samplers = realloc(window->samplers,
+			sizeof(Sampler) * capacity);
 
-		if (!buffers)
+		if (!samplers)
 		{
 			if (graphicsAPI == VULKAN_GRAPHICS_API)
 			{
 #if MPGX_SUPPORT_VULKAN
-				destroyVkBuffer(
-					window->vkWindow->allocator,
-					bufferInstance);
+				destroyVkSampler(
+					window->vkWindow->device,
+					samplerInstance);
 #else
 				abort();
 #endif
@@ -2099,7 +5260,7 @@ MpgxResult createBuffer(
 			else
 			{
 #if MPGX_SUPPORT_OPENGL
-				destroyGlBuffer(bufferInstance);
+				destroyGlSampler(samplerInstance);
 #else
 				abort();
 #endif
@@ -2108,33 +5269,35 @@ MpgxResult createBuffer(
 			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
 
-		window->buffers = buffers;
-		window->bufferCapacity = capacity;
+		window->samplers = samplers;
+		window->samplerCapacity = capacity;
 	}
 
-	window->buffers[count] = bufferInstance;
-	window->bufferCount = count + 1;
+	window->samplers[count] = samplerInstance;
+	window->samplerCount = count + 1;
 
-	*buffer = bufferInstance;
+	*sampler = samplerInstance;
 	return SUCCESS_MPGX_RESULT;
 }
-void destroyBuffer(Buffer buffer)
+void destroySampler(Sampler sampler)
 {
-	if (!buffer)
+	if (!sampler)
 		return;
 
-	assert(!buffer->base.isMapped);
-	assert(!buffer->base.window->isRecording);
-	assert(!buffer->base.window->isEnumeratingBuffers);
+	assert(!sampler->base.window->isRecording);
+	assert(!sampler->base.window->isEnumeratingSamplers);
 	assert(graphicsInitialized);
 
-	Window window = buffer->base.window;
-	Buffer* buffers = window->buffers;
-	size_t bufferCount = window->bufferCount;
+	if (--sampler->base.refCount > 0)
+		return;
 
-	for (int64_t i = (int64_t)bufferCount - 1; i >= 0 ; i--)
+	Window window = sampler->base.window;
+	Sampler* samplers = window->samplers;
+	size_t samplerCount = window->samplerCount;
+
+	for (int64_t i = (int64_t)samplerCount - 1; i >= 0; i--)
 	{
-		if (buffer != buffers[i])
+		if (sampler != samplers[i])
 			continue;
 
 		if (graphicsAPI == VULKAN_GRAPHICS_API)
@@ -2148,9 +5311,9 @@ void destroyBuffer(Buffer buffer)
 			if (result != VK_SUCCESS)
 				abort();
 
-			destroyVkBuffer(
-				vkWindow->allocator,
-				buffer);
+			destroyVkSampler(
+				vkWindow->device,
+				sampler);
 #else
 			abort();
 #endif
@@ -2158,7 +5321,7 @@ void destroyBuffer(Buffer buffer)
 		else if (graphicsAPI == OPENGL_GRAPHICS_API)
 		{
 #if MPGX_SUPPORT_OPENGL
-			destroyGlBuffer(buffer);
+			destroyGlSampler(sampler);
 #else
 			abort();
 #endif
@@ -2168,253 +5331,163 @@ void destroyBuffer(Buffer buffer)
 			abort();
 		}
 
-		for (size_t j = i + 1; j < bufferCount; j++)
-			buffers[j - 1] = buffers[j];
+		for (size_t j = i + 1; j < samplerCount; j++)
+			samplers[j - 1] = samplers[j];
 
-		window->bufferCount--;
+		window->samplerCount--;
 		return;
 	}
 
 	abort();
 }
-
-Window getBufferWindow(Buffer buffer)
+
+Window getSamplerWindow(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.window;
+}
+ImageFilter getSamplerMinImageFilter(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.minImageFilter;
+}
+ImageFilter getSamplerMagImageFilter(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.magImageFilter;
+}
+ImageFilter getSamplerMinMipmapFilter(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.minMipmapFilter;
+}
+bool isSamplerUseMipmapping(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.useMipmapping;
+}
+ImageWrap getSamplerImageWrapX(Sampler sampler)
 {
-	assert(buffer);
+	assert(sampler);
 	assert(graphicsInitialized);
-	return buffer->base.window;
+	return sampler->base.imageWrapX;
 }
-BufferType getBufferType(Buffer buffer)
+ImageWrap getSamplerImageWrapY(Sampler sampler)
 {
-	assert(buffer);
+	assert(sampler);
 	assert(graphicsInitialized);
-	return buffer->base.type;
+	return sampler->base.imageWrapY;
 }
-BufferUsage getBufferUsage(Buffer buffer)
+ImageWrap getSamplerImageWrapZ(Sampler sampler)
 {
-	assert(buffer);
+	assert(sampler);
 	assert(graphicsInitialized);
-	return buffer->base.usage;
+	return sampler->base.imageWrapZ;
 }
-size_t getBufferSize(Buffer buffer)
+CompareOperator getSamplerDepthCompare(Sampler sampler)
 {
-	assert(buffer);
+	assert(sampler);
 	assert(graphicsInitialized);
-	return buffer->base.size;
+	return sampler->base.depthCompare;
 }
-
-MpgxResult mapBuffer(
-	Buffer buffer,
-	size_t size,
-	size_t offset,
-	void** map)
+bool isSamplerUseCompare(Sampler sampler)
 {
-	assert(buffer);
-	assert(size > 0);
-	assert(map);
+	assert(sampler);
 	assert(graphicsInitialized);
-	assert(buffer->base.usage == CPU_ONLY_BUFFER_USAGE ||
-		buffer->base.usage == CPU_TO_GPU_BUFFER_USAGE ||
-		buffer->base.usage == GPU_TO_CPU_BUFFER_USAGE);
-	assert(size + offset <= buffer->base.size);
-	assert(!buffer->base.isMapped);
-
-	size_t mapSize = size > 0 ? size : buffer->base.size;
-	Window window = buffer->base.window;
-
-	MpgxResult mpgxResult;
-
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_VULKAN
-		mpgxResult = mapVkBuffer(
-			window->vkWindow->allocator,
-			buffer->vk.allocation,
-			buffer->vk.usage,
-			mapSize,
-			offset,
-			map);
-
-		buffer->vk.mapSize = mapSize;
-		buffer->vk.mapOffset = offset;
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_OPENGL
-		mpgxResult = mapGlBuffer(
-			buffer->gl.glType,
-			buffer->gl.handle,
-			buffer->gl.usage,
-			mapSize,
-			offset,
-			map);
-#else
-		abort();
-#endif
-	}
-	else
-	{
-		abort();
-	}
-
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-		return mpgxResult;
-
-#ifndef NDEBUG
-	buffer->base.isMapped = true;
-#endif
-	return SUCCESS_MPGX_RESULT;
+	return sampler->base.useCompare;
 }
-MpgxResult unmapBuffer(Buffer buffer)
+Vec2F getSamplerMipmapLodRange(Sampler sampler)
 {
-	assert(buffer);
-	assert(buffer->base.isMapped);
+	assert(sampler);
 	assert(graphicsInitialized);
-
-	Window window = buffer->base.window;
-
-	MpgxResult mpgxResult;
-
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_VULKAN
-		mpgxResult = unmapVkBuffer(
-			window->vkWindow->allocator,
-			buffer->vk.allocation,
-			buffer->vk.usage,
-			buffer->vk.mapSize,
-			buffer->vk.mapOffset);
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_OPENGL
-		mpgxResult = unmapGlBuffer(
-			buffer->gl.glType,
-			buffer->gl.handle);
-#else
-		abort();
-#endif
-	}
-	else
-	{
-		abort();
-	}
-
-#ifndef NDEBUG
-	buffer->base.isMapped = false;
-#endif
-	return mpgxResult;
+	return sampler->base.mipmapLodRange;
+}
+float getSamplerMipmapLodBias(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.mipmapLodBias;
+}
+float getSamplerMaxAnisotropy(Sampler sampler)
+{
+	assert(sampler);
+	assert(graphicsInitialized);
+	return sampler->base.maxAnisotropy;
 }
 
-MpgxResult setBufferData(
-	Buffer buffer,
-	const void* data,
+MpgxResult createShader(
+	Window window,
+	ShaderType type,
+	const void* code,
 	size_t size,
-	size_t offset)
+	Shader* shader)
 {
-	assert(buffer);
-	assert(data);
+	assert(window);
+	assert(type < SHADER_TYPE_COUNT);
+	assert(code);
 	assert(size > 0);
-	assert(buffer->base.usage == CPU_ONLY_BUFFER_USAGE ||
-		buffer->base.usage == CPU_TO_GPU_BUFFER_USAGE);
-	assert(!buffer->base.isMapped);
-	assert(size + offset <= buffer->base.size);
+	assert(shader);
+	assert(!window->isRecording);
+	assert(!window->isEnumeratingShaders);
 	assert(graphicsInitialized);
 
-	Window window = buffer->base.window;
+	uint64_t hash = xxh64(
+		code,
+		size,
+		0);
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_VULKAN
-		return setVkBufferData(
-			window->vkWindow->allocator,
-			buffer->vk.allocation,
-			data,
-			size,
-			offset);
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	Shader* windowShaders = window->shaders;
+	size_t count = window->shaderCount;
+	size_t index = 0, end = count;
+
+	// Window shaders are sorted by the code hash
+	while (index < end)
 	{
-#if MPGX_SUPPORT_OPENGL
-		return setGlBufferData(
-			buffer->gl.glType,
-			buffer->gl.handle,
-			data,
-			size,
-			offset);
-#else
-		abort();
-#endif
+		size_t middle = (index + end) / 2;
+
+		if (windowShaders[middle]->base.hash < hash)
+			index = middle + 1;
+		else
+			end = middle;
 	}
-	else
+
+	// Same code is shared between shaders,
+	// to not create duplicate modules.
+	for (size_t i = index; i < count; i++)
 	{
-		abort();
-	}
-}
+		Shader otherShader = windowShaders[i];
 
-MpgxResult createMipmapImage(
-	Window window,
-	ImageType type,
-	ImageDimension dimension,
-	ImageFormat format,
-	const void** data,
-	Vec3I size,
-	uint32_t mipCount,
-	uint32_t layerCount,
-	bool isConstant,
-	Image* image)
-{
-	assert(window);
-	assert(type > 0);
-	assert(dimension < IMAGE_DIMENSION_COUNT);
-	assert(format < IMAGE_FORMAT_COUNT);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(size.z > 0);
-	assert(mipCount > 0);
-	assert(layerCount > 0);
-	assert(image);
-	assert(!window->isRecording);
-	assert(!window->isEnumeratingImages);
-	assert(mipCount <= calcMipLevelCount(size));
-	assert(graphicsInitialized);
+		if (otherShader->base.hash != hash)
+			break;
+
+		if (otherShader->base.size == size &&
+			otherShader->base.type == type &&
+			memcmp(otherShader->base.hashedCode, code, size) == 0)
+		{
+			otherShader->base.refCount++;
+			*shader = otherShader;
+			return SUCCESS_MPGX_RESULT;
+		}
+	}
 
 	MpgxResult mpgxResult;
-	Image imageInstance;
+	Shader shaderInstance;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = window->vkWindow;
-
-		mpgxResult = createVkImage(
-			vkWindow->device,
-			vkWindow->allocator,
-			vkWindow->transferQueue,
-			vkWindow->transferCommandBuffer,
-			vkWindow->transferFence,
-			&vkWindow->stagingBuffer,
-			&vkWindow->stagingAllocation,
-			&vkWindow->stagingSize,
+		mpgxResult = createVkShader(
+			window->vkWindow->device,
 			window,
 			type,
-			dimension,
-			format,
-			data,
-			size,
-			mipCount,
-			layerCount,
-			isConstant,
-			&imageInstance);
+			code,
+			size,
+			&shaderInstance);
 #else
 		abort();
 #endif
@@ -2422,19 +5495,14 @@ MpgxResult createMipmapImage(
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		if (layerCount != 1)
-			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
-
-		mpgxResult = createGlImage(
+		mpgxResult = createGlShader(
 			window,
 			type,
-			dimension,
-			format,
-			data,
+			code,
 			size,
-			mipCount,
-			isConstant,
-			&imageInstance);
+			graphicsAPI,
+			window->cacheDirectory != NULL,
+			&shaderInstance);
 #else
 		abort();
 #endif
@@ -2447,26 +5515,55 @@ MpgxResult createMipmapImage(
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
 		return mpgxResult;
 
-	size_t count = window->imageCount;
+	// Code is kept to tell apart shaders with the same hash
+	uint8_t* hashedCode = malloc(size);
 
-	if (count == window->imageCapacity)
+	if (!hashedCode)
 	{
-		size_t capacity = window->imageCapacity * 2;
+		if (graphicsAPI == VULKAN_GRAPHICS_API)
+		{
+#if MPGX_SUPPORT_VULKAN
+			destroyVkShader(
+				window->vkWindow->device,
+				shaderInstance);
+#else
+			abort();
+#endif
+		}
+		else
+		{
+#if MPGX_SUPPORT_OPENGL
+			destroyGlShader(shaderInstance);
+#else
+			abort();
+#endif
+		}
 
-		Image* images = realloc(window->images,
-			sizeof(Image) * capacity);
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+	}
 
-		if (!images)
+	memcpy(hashedCode, code, size);
+
+	shaderInstance->base.hash = hash;
+	shaderInstance->base.size = size;
+	shaderInstance->base.refCount = 1;
+	shaderInstance->base.hashedCode = hashedCode;
+
+	if (count == window->shaderCapacity)
+	{
+		size_t capacity = window->shaderCapacity * 2;
+
+		Shader* shaders = realloc(window->shaders,
+			sizeof(Shader) * capacity);
+
+		if (!shaders)
 		{
 			if (graphicsAPI == VULKAN_GRAPHICS_API)
 			{
 #if MPGX_SUPPORT_VULKAN
-				VkWindow vkWindow = window->vkWindow;
-
-				destroyVkImage(
-					vkWindow->device,
-					vkWindow->allocator,
-					imageInstance);
+				destroyVkShader(
+					window->vkWindow->device,
+					shaderInstance);
 #else
 				abort();
 #endif
@@ -2474,7 +5571,7 @@ MpgxResult createMipmapImage(
 			else
 			{
 #if MPGX_SUPPORT_OPENGL
-				destroyGlImage(imageInstance);
+				destroyGlShader(shaderInstance);
 #else
 				abort();
 #endif
@@ -2483,85 +5580,48 @@ MpgxResult createMipmapImage(
 			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
 
-		window->images = images;
-		window->imageCapacity = capacity;
+		window->shaders = shaders;
+		window->shaderCapacity = capacity;
 	}
 
-	window->images[count] = imageInstance;
-	window->imageCount = count + 1;
+	Shader* shaders = window->shaders;
 
-	*image = imageInstance;
-	return SUCCESS_MPGX_RESULT;
-}
-MpgxResult createImage(
-	Window window,
-	ImageType type,
-	ImageDimension dimension,
-	ImageFormat format,
-	const void* data,
-	Vec3I size,
-	uint32_t layerCount,
-	bool isConstant,
-	Image* image)
-{
-	assert(window);
-	assert(type > 0);
-	assert(dimension < IMAGE_DIMENSION_COUNT);
-	assert(format < IMAGE_FORMAT_COUNT);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(size.z > 0);
-	assert(layerCount > 0);
-	assert(image);
-	assert(!window->isRecording);
-	assert(!window->isEnumeratingImages);
-	assert(graphicsInitialized);
+	for (size_t i = count; i > index; i--)
+		shaders[i] = shaders[i - 1];
 
-	return createMipmapImage(
-		window,
-		type,
-		dimension,
-		format,
-		data? &data : NULL,
-		size,
-		1,
-		layerCount,
-		isConstant,
-		image);
+	shaders[index] = shaderInstance;
+	window->shaderCount = count + 1;
+
+	*shader = shaderInstance;
+	return SUCCESS_MPGX_RESULT;
 }
-void destroyImage(Image image)
+void destroyShader(Shader shader)
 {
-	if (!image)
+	if (!shader)
 		return;
 
-	assert(!image->base.window->isRecording);
-	assert(!image->base.window->isEnumeratingImages);
+	assert(!shader->base.window->isRecording);
+	assert(!shader->base.window->isEnumeratingShaders);
 	assert(graphicsInitialized);
 
-	Window window = image->base.window;
-	Image* images = window->images;
-	size_t imageCount = window->imageCount;
+	if (--shader->base.refCount > 0)
+		return;
 
-	for (int64_t i = (int64_t)imageCount - 1; i >= 0; i--)
+	Window window = shader->base.window;
+	Shader* shaders = window->shaders;
+	size_t shaderCount = window->shaderCount;
+
+	for (int64_t i = (int64_t)shaderCount - 1; i >= 0; i--)
 	{
-		if (image != images[i])
+		if (shader != shaders[i])
 			continue;
 
 		if (graphicsAPI == VULKAN_GRAPHICS_API)
 		{
 #if MPGX_SUPPORT_VULKAN
-			VkWindow vkWindow = window->vkWindow;
-
-			VkResult result = vkQueueWaitIdle(
-				vkWindow->graphicsQueue);
-
-			if (result != VK_SUCCESS)
-				abort();
-
-			destroyVkImage(
-				vkWindow->device,
-				vkWindow->allocator,
-				image);
+			destroyVkShader(
+				window->vkWindow->device,
+				shader);
 #else
 			abort();
 #endif
@@ -2569,7 +5629,7 @@ void destroyImage(Image image)
 		else if (graphicsAPI == OPENGL_GRAPHICS_API)
 		{
 #if MPGX_SUPPORT_OPENGL
-			destroyGlImage(image);
+			destroyGlShader(shader);
 #else
 			abort();
 #endif
@@ -2579,425 +5639,405 @@ void destroyImage(Image image)
 			abort();
 		}
 
-		for (size_t j = i + 1; j < imageCount; j++)
-			images[j - 1] = images[j];
+		for (size_t j = i + 1; j < shaderCount; j++)
+			shaders[j - 1] = shaders[j];
 
-		window->imageCount--;
+		window->shaderCount--;
 		return;
 	}
-
-	abort();
-}
-
-MpgxResult setMipmapImageData(
-	Image image,
-	const void** data,
-	Vec3I size,
-	Vec3I offset)
-{
-	// TODO:
-	abort();
-}
-MpgxResult setImageData(
-	Image image,
-	const void* data,
-	Vec3I size,
-	Vec3I offset,
-	uint8_t mipLevel)
-{
-	assert(image);
-	assert(data);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(size.z > 0);
-	assert(offset.x >= 0);
-	assert(offset.y >= 0);
-	assert(offset.z >= 0);
-	assert(size.x + offset.x <= image->base.size.x);
-	assert(size.y + offset.y <= image->base.size.y);
-	assert(size.z + offset.z <= image->base.size.z);
-	assert(!image->base.isConstant);
-	assert(!image->base.window->isRecording);
-	assert(mipLevel < image->base.mipCount);
-	assert(graphicsInitialized);
-
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow =
-			image->vk.window->vkWindow;
-
-		return setVkImageData(
-			vkWindow->device,
-			vkWindow->allocator,
-			vkWindow->transferQueue,
-			vkWindow->transferCommandBuffer,
-			vkWindow->transferFence,
-			image,
-			data,
-			size,
-			offset,
-			mipLevel);
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_OPENGL
-		return setGlImageData(
-			image,
-			data,
-			size,
-			offset,
-			mipLevel);
-#else
-		abort();
-#endif
-	}
-	else
-	{
-		abort();
-	}
-}
-
-Window getImageWindow(Image image)
-{
-	assert(image);
-	assert(graphicsInitialized);
-	return image->base.window;
-}
-ImageType getImageType(Image image)
-{
-	assert(image);
-	assert(graphicsInitialized);
-	return image->base.type;
-}
-ImageDimension getImageDimension(Image image)
-{
-	assert(image);
-	assert(graphicsInitialized);
-	return image->base.dimension;
-}
-ImageFormat getImageFormat(Image image)
-{
-	assert(image);
-	assert(graphicsInitialized);
-	return image->base.format;
-}
-uint32_t getImageMipCount(Image image)
-{
-	assert(image);
-	assert(graphicsInitialized);
-	return image->base.mipCount;
-}
-uint32_t getImageLayerCount(Image image)
-{
-	assert(image);
-	assert(graphicsInitialized);
-	return image->base.layerCount;
+
+	abort();
 }
-Vec3I getImageSize(Image image)
+
+Window getShaderWindow(Shader shader)
 {
-	assert(image);
+	assert(shader);
 	assert(graphicsInitialized);
-	return image->base.size;
+	return shader->base.window;
 }
-bool isImageConstant(Image image)
+ShaderType getShaderType(Shader shader)
 {
-	assert(image);
+	assert(shader);
 	assert(graphicsInitialized);
-	return image->base.isConstant;
+	return shader->base.type;
 }
 
-MpgxResult createSampler(
+inline static bool addWindowFramebuffer(
 	Window window,
-	ImageFilter minImageFilter,
-	ImageFilter magImageFilter,
-	ImageFilter minMipmapFilter,
-	bool useMipmapping,
-	ImageWrap imageWrapX,
-	ImageWrap imageWrapY,
-	ImageWrap imageWrapZ,
-	CompareOperator depthCompare,
-	bool useCompare,
-	Vec2F mipmapLodRange,
-	float mipmapLodBias,
-	Sampler* sampler)
+	Framebuffer framebuffer)
 {
 	assert(window);
-	assert(minImageFilter < IMAGE_FILTER_COUNT);
-	assert(magImageFilter < IMAGE_FILTER_COUNT);
-	assert(minMipmapFilter < IMAGE_FILTER_COUNT);
-	assert(imageWrapX < IMAGE_WRAP_COUNT);
-	assert(imageWrapY < IMAGE_WRAP_COUNT);
-	assert(imageWrapZ < IMAGE_WRAP_COUNT);
-	assert(depthCompare < COMPARE_OPERATOR_COUNT);
-	assert(sampler);
+	assert(framebuffer);
+
+	assert(window);
+	assert(framebuffer);
+
+	size_t count = window->framebufferCount;
+
+	if (count == window->framebufferCapacity)
+	{
+		size_t capacity = window->framebufferCapacity * 2;
+
+		Framebuffer* framebuffers = realloc(window->framebuffers,
+			sizeof(Framebuffer) * capacity);
+
+		if (!framebuffers)
+			return false;
+
+		window->framebuffers = framebuffers;
+		window->framebufferCapacity = capacity;
+	}
+
+	window->framebuffers[count] = framebuffer;
+	window->framebufferCount = count + 1;
+	return true;
+}
+static MpgxResult createAnyFramebuffer(
+	Window window,
+	Vec2I size,
+	uint8_t sampleCount,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	Framebuffer* framebuffer)
+{
+	assert(window);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(sampleCount > 0);
+	assert(framebuffer);
 	assert(!window->isRecording);
-	assert(!window->isEnumeratingSamplers);
+	assert(!window->isEnumeratingFramebuffers);
 	assert(graphicsInitialized);
 
-	MpgxResult mpgxResult;
-	Sampler samplerInstance;
+#ifndef NDEBUG
+	bool hasSomeAttachments = false;
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	if (colorAttachmentCount > 0)
 	{
-#if MPGX_SUPPORT_VULKAN
-		mpgxResult = createVkSampler(
-			window->vkWindow->device,
-			window,
-			minImageFilter,
-			magImageFilter,
-			minMipmapFilter,
-			useMipmapping,
-			imageWrapX,
-			imageWrapY,
-			imageWrapZ,
-			depthCompare,
-			useCompare,
-			mipmapLodRange,
-			mipmapLodBias,
-			&samplerInstance);
-#else
-		abort();
-#endif
+		assert(colorAttachments);
+
+		for (size_t i = 0; i < colorAttachmentCount; i++)
+		{
+			Image image = colorAttachments[i];
+
+			assert(image->base.type &
+				COLOR_ATTACHMENT_IMAGE_TYPE);
+			assert(image->base.size.x  == size.x &&
+				image->base.size.y == size.y);
+			assert(image->base.window == window);
+		}
+
+		hasSomeAttachments = true;
 	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	else
 	{
-#if MPGX_SUPPORT_OPENGL
-		if (mipmapLodBias != 0.0f)
-			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+		assert(!colorAttachments);
+	}
+	if (gBufferAttachmentCount > 0)
+	{
+		assert(gBufferAttachments);
 
-		mpgxResult = createGlSampler(
-			window,
-			minImageFilter,
-			magImageFilter,
-			minMipmapFilter,
-			useMipmapping,
-			imageWrapX,
-			imageWrapY,
-			imageWrapZ,
-			depthCompare,
-			useCompare,
-			mipmapLodRange,
-			&samplerInstance);
-#else
-		abort();
-#endif
+		for (size_t i = 0; i < gBufferAttachmentCount; i++)
+		{
+			Image image = gBufferAttachments[i];
+
+			assert(image->base.type &
+				COLOR_ATTACHMENT_IMAGE_TYPE);
+			assert(image->base.type &
+				INPUT_ATTACHMENT_IMAGE_TYPE);
+			assert(image->base.size.x  == size.x &&
+				image->base.size.y == size.y);
+			assert(image->base.window == window);
+		}
 	}
 	else
 	{
-		abort();
+		assert(!gBufferAttachments);
+	}
+	if (depthStencilAttachment)
+	{
+		assert(depthStencilAttachment->base.type &
+			DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE);
+		assert(gBufferAttachmentCount == 0 ||
+			depthStencilAttachment->base.type &
+			INPUT_ATTACHMENT_IMAGE_TYPE);
+		assert(depthStencilAttachment->base.size.x == size.x &&
+			depthStencilAttachment->base.size.y == size.y);
+		assert(depthStencilAttachment->base.window == window);
+		hasSomeAttachments = true;
 	}
 
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-		return mpgxResult;
-
-	size_t count = window->samplerCount;
+	assert(hasSomeAttachments);
 
-	if (count == window->samplerCapacity)
+	if (sampleCount > 1)
 	{
-		size_t capacity = window->samplerCapacity * 2;
+		// Multisampled depth/stencil is not resolved
+		assert(colorAttachmentCount > 0);
+		assert(gBufferAttachmentCount == 0);
+		assert(!depthStencilAttachment ||
+			depthStencilAttachment->base.type &
+			TRANSIENT_ATTACHMENT_IMAGE_TYPE);
+	}
 
-		Sampler* samplers = realloc(window->samplers,
-			sizeof(Sampler) * capacity);
+	size_t attachmentCount = depthStencilAttachment ?
+		colorAttachmentCount + 1 : colorAttachmentCount;
 
-		if (!samplers)
-		{
-			if (graphicsAPI == VULKAN_GRAPHICS_API)
-			{
-#if MPGX_SUPPORT_VULKAN
-				destroyVkSampler(
-					window->vkWindow->device,
-					samplerInstance);
-#else
-				abort();
-#endif
-			}
-			else
-			{
-#if MPGX_SUPPORT_OPENGL
-				destroyGlSampler(samplerInstance);
-#else
-				abort();
-#endif
-			}
+	if (loadOps)
+	{
+		assert(gBufferAttachmentCount == 0);
 
-			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		for (size_t i = 0; i < attachmentCount; i++)
+		{
+			AttachmentLoadOp loadOp = loadOps[i];
+			assert(loadOp < ATTACHMENT_LOAD_OP_COUNT);
+			assert(loadOp != CLEAR_ATTACHMENT_LOAD_OP || useBeginClear);
+			assert(loadOp != LOAD_ATTACHMENT_LOAD_OP || sampleCount == 1);
 		}
+	}
+	if (storeOps)
+	{
+		assert(gBufferAttachmentCount == 0);
 
-		window->samplers = samplers;
-		window->samplerCapacity = capacity;
+		for (size_t i = 0; i < attachmentCount; i++)
+			assert(storeOps[i] < ATTACHMENT_STORE_OP_COUNT);
 	}
+#endif
 
-	window->samplers[count] = samplerInstance;
-	window->samplerCount = count + 1;
+	MpgxResult mpgxResult;
+	Framebuffer framebufferInstance;
 
-	*sampler = samplerInstance;
-	return SUCCESS_MPGX_RESULT;
-}
-void destroySampler(Sampler sampler)
-{
-	if (!sampler)
-		return;
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		VkWindow vkWindow = window->vkWindow;
+		VkDevice device = vkWindow->device;
 
-	assert(!sampler->base.window->isRecording);
-	assert(!sampler->base.window->isEnumeratingSamplers);
-	assert(graphicsInitialized);
+		VkSampleCountFlagBits vkSampleCount = getVkSampleCount(
+			vkWindow->physicalDevice,
+			sampleCount);
+
+		VkRenderPass renderPass;
+
+		mpgxResult = getVkCachedRenderPass(
+			device,
+			window->renderPassCache,
+			false,
+			vkSampleCount,
+			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			loadOps,
+			storeOps,
+			&renderPass);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		mpgxResult = createVkFramebuffer(
+			device,
+			vkWindow->allocator,
+			renderPass,
+			window,
+			size,
+			vkSampleCount,
+			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			loadOps,
+			storeOps,
+			&framebufferInstance);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		mpgxResult = createGlFramebuffer(
+			window,
+			size,
+			sampleCount,
+			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			loadOps,
+			storeOps,
+			&framebufferInstance);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
 
-	Window window = sampler->base.window;
-	Sampler* samplers = window->samplers;
-	size_t samplerCount = window->samplerCount;
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
 
-	for (int64_t i = (int64_t)samplerCount - 1; i >= 0; i--)
+	if (!addWindowFramebuffer(window, framebufferInstance))
 	{
-		if (sampler != samplers[i])
-			continue;
-
 		if (graphicsAPI == VULKAN_GRAPHICS_API)
 		{
 #if MPGX_SUPPORT_VULKAN
-			VkWindow vkWindow = window->vkWindow;
-
-			VkResult result = vkQueueWaitIdle(
-				vkWindow->graphicsQueue);
-
-			if (result != VK_SUCCESS)
-				abort();
-
-			destroyVkSampler(
-				vkWindow->device,
-				sampler);
+			destroyVkFramebuffer(
+				window->vkWindow->device,
+				window->vkWindow->allocator,
+				framebufferInstance);
 #else
 			abort();
 #endif
 		}
-		else if (graphicsAPI == OPENGL_GRAPHICS_API)
+		else
 		{
 #if MPGX_SUPPORT_OPENGL
-			destroyGlSampler(sampler);
+			destroyGlFramebuffer(framebufferInstance);
 #else
 			abort();
 #endif
 		}
-		else
-		{
-			abort();
-		}
-
-		for (size_t j = i + 1; j < samplerCount; j++)
-			samplers[j - 1] = samplers[j];
 
-		window->samplerCount--;
-		return;
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 	}
 
-	abort();
-}
-
-Window getSamplerWindow(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.window;
-}
-ImageFilter getSamplerMinImageFilter(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.minImageFilter;
-}
-ImageFilter getSamplerMagImageFilter(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.magImageFilter;
-}
-ImageFilter getSamplerMinMipmapFilter(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.minMipmapFilter;
-}
-bool isSamplerUseMipmapping(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.useMipmapping;
-}
-ImageWrap getSamplerImageWrapX(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.imageWrapX;
-}
-ImageWrap getSamplerImageWrapY(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.imageWrapY;
-}
-ImageWrap getSamplerImageWrapZ(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.imageWrapZ;
-}
-CompareOperator getSamplerDepthCompare(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.depthCompare;
-}
-bool isSamplerUseCompare(Sampler sampler)
-{
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.useCompare;
+	*framebuffer = framebufferInstance;
+	return SUCCESS_MPGX_RESULT;
 }
-Vec2F getSamplerMipmapLodRange(Sampler sampler)
+MpgxResult createFramebuffer(
+	Window window,
+	Vec2I size,
+	uint8_t sampleCount,
+	bool useBeginClear,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps,
+	Framebuffer* framebuffer)
 {
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.mipmapLodRange;
-}
-float getSamplerMipmapLodBias(Sampler sampler)
+	return createAnyFramebuffer(
+		window,
+		size,
+		sampleCount,
+		useBeginClear,
+		NULL,
+		0,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		loadOps,
+		storeOps,
+		framebuffer);
+}
+MpgxResult createDeferredFramebuffer(
+	Window window,
+	Vec2I size,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	Framebuffer* framebuffer)
 {
-	assert(sampler);
-	assert(graphicsInitialized);
-	return sampler->base.mipmapLodBias;
-}
+	assert(gBufferAttachments);
+	assert(gBufferAttachmentCount > 0);
+	assert(colorAttachments);
+	assert(colorAttachmentCount > 0);
 
-MpgxResult createShader(
+	return createAnyFramebuffer(
+		window,
+		size,
+		1,
+		useBeginClear,
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		NULL,
+		NULL,
+		framebuffer);
+}
+MpgxResult createShadowFramebuffer(
 	Window window,
-	ShaderType type,
-	const void* code,
-	size_t size,
-	Shader* shader)
+	Vec2I size,
+	bool useBeginClear,
+	Image depthAttachment,
+	Framebuffer* framebuffer)
 {
 	assert(window);
-	assert(type < SHADER_TYPE_COUNT);
-	assert(code);
-	assert(size > 0);
-	assert(shader);
+	assert(size.x > 0);
+	assert(size.y > 0);
+	assert(depthAttachment);
+	assert(depthAttachment->base.size.x == size.x &&
+		depthAttachment->base.size.y == size.y);
+	assert(depthAttachment->base.window == window);
+	assert(framebuffer);
 	assert(!window->isRecording);
-	assert(!window->isEnumeratingShaders);
+	assert(!window->isEnumeratingFramebuffers);
 	assert(graphicsInitialized);
 
 	MpgxResult mpgxResult;
-	Shader shaderInstance;
+	Framebuffer framebufferInstance;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		mpgxResult = createVkShader(
-			window->vkWindow->device,
+		VkWindow vkWindow = window->vkWindow;
+		VkDevice device = vkWindow->device;
+
+		VkRenderPass renderPass;
+
+		mpgxResult = getVkCachedRenderPass(
+			device,
+			window->renderPassCache,
+			true,
+			VK_SAMPLE_COUNT_1_BIT,
+			useBeginClear,
+			NULL,
+			0,
+			NULL,
+			0,
+			depthAttachment,
+			NULL,
+			NULL,
+			&renderPass);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		mpgxResult = createVkFramebuffer(
+			device,
+			vkWindow->allocator,
+			renderPass,
 			window,
-			type,
-			code,
 			size,
-			&shaderInstance);
+			VK_SAMPLE_COUNT_1_BIT,
+			useBeginClear,
+			NULL,
+			0,
+			NULL,
+			0,
+			depthAttachment,
+			NULL,
+			NULL,
+			&framebufferInstance);
 #else
 		abort();
 #endif
@@ -3005,13 +6045,19 @@ MpgxResult createShader(
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		mpgxResult = createGlShader(
+		mpgxResult = createGlFramebuffer(
 			window,
-			type,
-			code,
 			size,
-			graphicsAPI,
-			&shaderInstance);
+			1,
+			useBeginClear,
+			NULL,
+			0,
+			NULL,
+			0,
+			depthAttachment,
+			NULL,
+			NULL,
+			&framebufferInstance);
 #else
 		abort();
 #endif
@@ -3024,103 +6070,67 @@ MpgxResult createShader(
 	if (mpgxResult != SUCCESS_MPGX_RESULT)
 		return mpgxResult;
 
-	size_t count = window->shaderCount;
-
-#ifndef NDEBUG
-	MD5_CONTEXT md5Context;
-	md5_init(&md5Context);
-
-	md5_update(
-		&md5Context,
-		code,
-		size);
-
-	uint8_t* hash = shaderInstance->base.hash;
-	md5_final(&md5Context, hash);
-
-	Shader* windowShaders = window->shaders;
-
-	for (size_t i = 0; i < count; i++)
-	{
-		Shader otherShader = windowShaders[i];
-
-		int result = memcmp(hash,
-			otherShader->base.hash,
-			MD5_BLOCK_SIZE * sizeof(uint8_t));
-
-		if (result == 0)
-		{
-			printf("Shader %p have same code with %p.\n",
-				shader, otherShader);
-		}
-	}
-#endif
-
-	if (count == window->shaderCapacity)
+	if (!addWindowFramebuffer(window, framebufferInstance))
 	{
-		size_t capacity = window->shaderCapacity * 2;
-
-		Shader* shaders = realloc(window->shaders,
-			sizeof(Shader) * capacity);
-
-		if (!shaders)
+		if (graphicsAPI == VULKAN_GRAPHICS_API)
 		{
-			if (graphicsAPI == VULKAN_GRAPHICS_API)
-			{
 #if MPGX_SUPPORT_VULKAN
-				destroyVkShader(
-					window->vkWindow->device,
-					shaderInstance);
+			destroyVkFramebuffer(
+				window->vkWindow->device,
+				window->vkWindow->allocator,
+				framebufferInstance);
 #else
-				abort();
+			abort();
 #endif
-			}
-			else
-			{
+		}
+		else
+		{
 #if MPGX_SUPPORT_OPENGL
-				destroyGlShader(shaderInstance);
+			destroyGlFramebuffer(framebufferInstance);
 #else
-				abort();
+			abort();
 #endif
-			}
-
-			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 		}
 
-		window->shaders = shaders;
-		window->shaderCapacity = capacity;
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 	}
 
-	window->shaders[count] = shaderInstance;
-	window->shaderCount = count + 1;
-
-	*shader = shaderInstance;
+	*framebuffer = framebufferInstance;
 	return SUCCESS_MPGX_RESULT;
 }
-void destroyShader(Shader shader)
+void destroyFramebuffer(Framebuffer framebuffer)
 {
-	if (!shader)
+	if (!framebuffer)
 		return;
 
-	assert(!shader->base.window->isRecording);
-	assert(!shader->base.window->isEnumeratingShaders);
+	assert(!framebuffer->base.window->isRecording);
+	assert(!framebuffer->base.window->isEnumeratingFramebuffers);
 	assert(graphicsInitialized);
 
-	Window window = shader->base.window;
-	Shader* shaders = window->shaders;
-	size_t shaderCount = window->shaderCount;
+	Window window = framebuffer->base.window;
+	Framebuffer* framebuffers = window->framebuffers;
+	size_t framebufferCount = window->framebufferCount;
 
-	for (int64_t i = (int64_t)shaderCount - 1; i >= 0; i--)
+	for (int64_t i = (int64_t)framebufferCount - 1; i >= 0; i--)
 	{
-		if (shader != shaders[i])
+		if (framebuffer != framebuffers[i])
 			continue;
 
 		if (graphicsAPI == VULKAN_GRAPHICS_API)
 		{
 #if MPGX_SUPPORT_VULKAN
-			destroyVkShader(
-				window->vkWindow->device,
-				shader);
+			VkWindow vkWindow = window->vkWindow;
+
+			VkResult result = vkQueueWaitIdle(
+				vkWindow->graphicsQueue);
+
+			if (result != VK_SUCCESS)
+				abort();
+
+			destroyVkFramebuffer(
+				vkWindow->device,
+				vkWindow->allocator,
+				framebuffer);
 #else
 			abort();
 #endif
@@ -3128,7 +6138,7 @@ void destroyShader(Shader shader)
 		else if (graphicsAPI == OPENGL_GRAPHICS_API)
 		{
 #if MPGX_SUPPORT_OPENGL
-			destroyGlShader(shader);
+			destroyGlFramebuffer(framebuffer);
 #else
 			abort();
 #endif
@@ -3138,74 +6148,145 @@ void destroyShader(Shader shader)
 			abort();
 		}
 
-		for (size_t j = i + 1; j < shaderCount; j++)
-			shaders[j - 1] = shaders[j];
+		for (size_t j = i + 1; j < framebufferCount; j++)
+			framebuffers[j - 1] = framebuffers[j];
 
-		window->shaderCount--;
+		window->framebufferCount--;
 		return;
 	}
 
 	abort();
 }
 
-Window getShaderWindow(Shader shader)
+Window getFramebufferWindow(Framebuffer framebuffer)
 {
-	assert(shader);
+	assert(framebuffer);
 	assert(graphicsInitialized);
-	return shader->base.window;
+	return framebuffer->base.window;
 }
-ShaderType getShaderType(Shader shader)
+Vec2I getFramebufferSize(Framebuffer framebuffer)
 {
-	assert(shader);
+	assert(framebuffer);
 	assert(graphicsInitialized);
-	return shader->base.type;
+	return framebuffer->base.size;
 }
-
-inline static bool addWindowFramebuffer(
-	Window window,
-	Framebuffer framebuffer)
+bool isFramebufferUseBeginClear(Framebuffer framebuffer)
 {
-	assert(window);
 	assert(framebuffer);
-
-	assert(window);
+	assert(graphicsInitialized);
+	return framebuffer->base.useBeginClear;
+}
+uint8_t getFramebufferSampleCount(Framebuffer framebuffer)
+{
 	assert(framebuffer);
+	assert(graphicsInitialized);
+	return framebuffer->base.sampleCount;
+}
+const AttachmentLoadOp* getFramebufferLoadOps(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(graphicsInitialized);
+	return framebuffer->base.loadOps;
+}
+const AttachmentStoreOp* getFramebufferStoreOps(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(graphicsInitialized);
+	return framebuffer->base.storeOps;
+}
+Image* getFramebufferColorAttachments(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(!framebuffer->base.isDefault);
+	assert(graphicsInitialized);
+	return framebuffer->base.colorAttachments;
+}
+size_t getFramebufferColorAttachmentCount(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(!framebuffer->base.isDefault);
+	assert(graphicsInitialized);
+	return framebuffer->base.colorAttachmentCount;
+}
+Image getFramebufferDepthStencilAttachment(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(!framebuffer->base.isDefault);
+	assert(graphicsInitialized);
+	return framebuffer->base.depthStencilAttachment;
+}
+Image* getFramebufferGBufferAttachments(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(!framebuffer->base.isDefault);
+	assert(graphicsInitialized);
+	return framebuffer->base.gBufferAttachments;
+}
+size_t getFramebufferGBufferAttachmentCount(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(!framebuffer->base.isDefault);
+	assert(graphicsInitialized);
+	return framebuffer->base.gBufferAttachmentCount;
+}
+bool isFramebufferDefault(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(graphicsInitialized);
+	return framebuffer->base.isDefault;
+}
+size_t getFramebufferPipelineCount(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(graphicsInitialized);
+	return framebuffer->base.pipelineCount;
+}
 
-	size_t count = window->framebufferCount;
-
-	if (count == window->framebufferCapacity)
-	{
-		size_t capacity = window->framebufferCapacity * 2;
-
-		Framebuffer* framebuffers = realloc(window->framebuffers,
-			sizeof(Framebuffer) * capacity);
-
-		if (!framebuffers)
-			return false;
-
-		window->framebuffers = framebuffers;
-		window->framebufferCapacity = capacity;
-	}
+MpgxResult readFramebufferData(
+	Framebuffer framebuffer,
+	size_t attachmentIndex,
+	Vec2I size,
+	Vec2I offset,
+	OnImageReadback onReadback,
+	void* argument,
+	uint64_t* ticket)
+{
+	assert(framebuffer);
+	assert(!framebuffer->base.isDefault);
+	assert(attachmentIndex < framebuffer->base.colorAttachmentCount);
+	assert(size.x + offset.x <= framebuffer->base.size.x);
+	assert(size.y + offset.y <= framebuffer->base.size.y);
+	assert(graphicsInitialized);
 
-	window->framebuffers[count] = framebuffer;
-	window->framebufferCount = count + 1;
-	return true;
+	return readImageData(
+		framebuffer->base.colorAttachments[attachmentIndex],
+		vec3I(size.x, size.y, 1),
+		vec3I(offset.x, offset.y, 0),
+		0,
+		0,
+		1,
+		onReadback,
+		argument,
+		ticket);
 }
-MpgxResult createFramebuffer(
-	Window window,
+
+static MpgxResult setAnyFramebufferAttachments(
+	Framebuffer framebuffer,
 	Vec2I size,
 	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
 	Image* colorAttachments,
 	size_t colorAttachmentCount,
 	Image depthStencilAttachment,
-	Framebuffer* framebuffer)
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps)
 {
-	assert(window);
+	assert(framebuffer);
 	assert(size.x > 0);
 	assert(size.y > 0);
-	assert(framebuffer);
-	assert(!window->isRecording);
-	assert(!window->isEnumeratingFramebuffers);
+	assert(!framebuffer->base.isDefault);
+	assert(!framebuffer->base.window->isRecording);
 	assert(graphicsInitialized);
 
 #ifndef NDEBUG
@@ -3223,7 +6304,7 @@ MpgxResult createFramebuffer(
 				COLOR_ATTACHMENT_IMAGE_TYPE);
 			assert(image->base.size.x  == size.x &&
 				image->base.size.y == size.y);
-			assert(image->base.window == window);
+			assert(image->base.window == framebuffer->base.window);
 		}
 
 		hasSomeAttachments = true;
@@ -3232,21 +6313,76 @@ MpgxResult createFramebuffer(
 	{
 		assert(!colorAttachments);
 	}
+	if (gBufferAttachmentCount > 0)
+	{
+		assert(gBufferAttachments);
+
+		for (size_t i = 0; i < gBufferAttachmentCount; i++)
+		{
+			Image image = gBufferAttachments[i];
+
+			assert(image->base.type &
+				COLOR_ATTACHMENT_IMAGE_TYPE);
+			assert(image->base.type &
+				INPUT_ATTACHMENT_IMAGE_TYPE);
+			assert(image->base.size.x  == size.x &&
+				image->base.size.y == size.y);
+			assert(image->base.window == framebuffer->base.window);
+		}
+	}
+	else
+	{
+		assert(!gBufferAttachments);
+	}
 	if (depthStencilAttachment)
 	{
 		assert(depthStencilAttachment->base.type &
 			DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE);
+		assert(gBufferAttachmentCount == 0 ||
+			depthStencilAttachment->base.type &
+			INPUT_ATTACHMENT_IMAGE_TYPE);
 		assert(depthStencilAttachment->base.size.x == size.x &&
 			depthStencilAttachment->base.size.y == size.y);
-		assert(depthStencilAttachment->base.window == window);
+		assert(depthStencilAttachment->base.window == framebuffer->base.window);
 		hasSomeAttachments = true;
 	}
 
 	assert(hasSomeAttachments);
+
+	if (framebuffer->base.sampleCount > 1)
+	{
+		assert(colorAttachmentCount > 0);
+		assert(!depthStencilAttachment ||
+			depthStencilAttachment->base.type &
+			TRANSIENT_ATTACHMENT_IMAGE_TYPE);
+	}
+
+	size_t attachmentCount = depthStencilAttachment ?
+		colorAttachmentCount + 1 : colorAttachmentCount;
+
+	if (loadOps)
+	{
+		assert(gBufferAttachmentCount == 0);
+
+		for (size_t i = 0; i < attachmentCount; i++)
+		{
+			AttachmentLoadOp loadOp = loadOps[i];
+			assert(loadOp < ATTACHMENT_LOAD_OP_COUNT);
+			assert(loadOp != CLEAR_ATTACHMENT_LOAD_OP || useBeginClear);
+			assert(loadOp != LOAD_ATTACHMENT_LOAD_OP ||
+				framebuffer->base.sampleCount == 1);
+		}
+	}
+	if (storeOps)
+	{
+		assert(gBufferAttachmentCount == 0);
+
+		for (size_t i = 0; i < attachmentCount; i++)
+			assert(storeOps[i] < ATTACHMENT_STORE_OP_COUNT);
+	}
 #endif
 
-	MpgxResult mpgxResult;
-	Framebuffer framebufferInstance;
+	Window window = framebuffer->base.window;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
@@ -3256,27 +6392,146 @@ MpgxResult createFramebuffer(
 
 		VkRenderPass renderPass;
 
-		mpgxResult = createVkGeneralRenderPass(
-			device,
-			useBeginClear,
-			colorAttachments,
-			colorAttachmentCount,
-			depthStencilAttachment,
-			&renderPass);
+		MpgxResult mpgxResult = getVkCachedRenderPass(
+			device,
+			window->renderPassCache,
+			false,
+			(VkSampleCountFlagBits)framebuffer->vk.sampleCount,
+			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
+			colorAttachments,
+			colorAttachmentCount,
+			depthStencilAttachment,
+			loadOps,
+			storeOps,
+			&renderPass);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		VkRetiredFramebuffer* retiredFramebuffers =
+			window->retiredFramebuffers;
+		size_t retiredFramebufferCount =
+			window->retiredFramebufferCount;
+
+		if (retiredFramebufferCount == window->retiredFramebufferCapacity)
+		{
+			size_t capacity = window->retiredFramebufferCapacity * 2;
+
+			retiredFramebuffers = realloc(retiredFramebuffers,
+				capacity * sizeof(VkRetiredFramebuffer));
+
+			if (!retiredFramebuffers)
+				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+
+			window->retiredFramebuffers = retiredFramebuffers;
+			window->retiredFramebufferCapacity = capacity;
+		}
+
+		VkGraphicsPipelineTask* tasks = window->pipelineTasks;
+		size_t taskCount = window->pipelineTaskCount;
+		size_t readyCount = 0;
+
+		for (size_t i = 0; i < taskCount; i++)
+		{
+			VkGraphicsPipelineTask task = tasks[i];
+
+			if (task->graphicsPipeline->vk.framebuffer == framebuffer &&
+				task->onReady)
+			{
+				readyCount++;
+			}
+		}
+
+		uint8_t* readyData = NULL;
+
+		if (readyCount > 0)
+		{
+			readyData = malloc(readyCount * (sizeof(GraphicsPipeline) +
+				sizeof(OnGraphicsPipelineReady)));
+
+			if (!readyData)
+				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
+
+		GraphicsPipeline* readyPipelines = (GraphicsPipeline*)readyData;
+		OnGraphicsPipelineReady* readyFunctions =
+			(OnGraphicsPipelineReady*)(readyPipelines + readyCount);
+		size_t count = 0;
+
+		readyCount = 0;
+
+		// Tasks of this framebuffer compile for the old render pass,
+		// their pipelines are recreated with the attachments instead.
+		for (size_t i = 0; i < taskCount; i++)
+		{
+			VkGraphicsPipelineTask task = tasks[i];
+			GraphicsPipeline pipeline = task->graphicsPipeline;
+
+			if (pipeline->vk.framebuffer != framebuffer)
+			{
+				tasks[count++] = task;
+				continue;
+			}
+
+			if (task->onReady)
+			{
+				readyPipelines[readyCount] = pipeline;
+				readyFunctions[readyCount++] = task->onReady;
+			}
+
+			pipeline->vk.taskCount--;
+
+			vkDestroyPipeline(
+				device,
+				cancelVkGraphicsPipelineTask(task),
+				NULL);
+		}
+
+		window->pipelineTaskCount = count;
 
-		if (mpgxResult != SUCCESS_MPGX_RESULT)
-			return mpgxResult;
+		VkRetiredFramebuffer retiredFramebuffer;
 
-		mpgxResult = createVkFramebuffer(
+		mpgxResult = setVkFramebufferAttachments(
 			device,
+			vkWindow->allocator,
 			renderPass,
-			window,
+			framebuffer,
 			size,
 			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
 			colorAttachments,
 			colorAttachmentCount,
 			depthStencilAttachment,
-			&framebufferInstance);
+			loadOps,
+			storeOps,
+			&retiredFramebuffer);
+
+		// Old handles are destroyed instead of the queue wait,
+		// after the fences of all in-flight frames are waited.
+		retiredFramebuffer.frameIndex = (vkWindow->frameIndex +
+			VK_FRAME_LAG - 1) % VK_FRAME_LAG;
+		retiredFramebuffers[retiredFramebufferCount] = retiredFramebuffer;
+		window->retiredFramebufferCount = retiredFramebufferCount + 1;
+
+		// Ready functions are called after the swap, because
+		// they are able to create new pipelines of this framebuffer.
+		for (size_t i = 0; i < readyCount; i++)
+		{
+			GraphicsPipeline pipeline = readyPipelines[i];
+
+			// Pipeline is not recreated if the swap failed before it
+			if (!pipeline->vk.isReady)
+				pipeline->vk.compileResult = mpgxResult;
+
+			readyFunctions[i](pipeline, pipeline->vk.isReady ?
+				SUCCESS_MPGX_RESULT : mpgxResult);
+		}
+
+		free(readyData);
+		return mpgxResult;
 #else
 		abort();
 #endif
@@ -3284,14 +6539,17 @@ MpgxResult createFramebuffer(
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		mpgxResult = createGlFramebuffer(
-			window,
+		return setGlFramebufferAttachments(
+			framebuffer,
 			size,
 			useBeginClear,
+			gBufferAttachments,
+			gBufferAttachmentCount,
 			colorAttachments,
 			colorAttachmentCount,
 			depthStencilAttachment,
-			&framebufferInstance);
+			loadOps,
+			storeOps);
 #else
 		abort();
 #endif
@@ -3300,94 +6558,281 @@ MpgxResult createFramebuffer(
 	{
 		abort();
 	}
+}
+MpgxResult setFramebufferAttachments(
+	Framebuffer framebuffer,
+	Vec2I size,
+	bool useBeginClear,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment,
+	const AttachmentLoadOp* loadOps,
+	const AttachmentStoreOp* storeOps)
+{
+	assert(framebuffer);
+	assert(framebuffer->base.gBufferAttachmentCount == 0);
 
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-		return mpgxResult;
+	return setAnyFramebufferAttachments(
+		framebuffer,
+		size,
+		useBeginClear,
+		NULL,
+		0,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		loadOps,
+		storeOps);
+}
+MpgxResult setDeferredFramebufferAttachments(
+	Framebuffer framebuffer,
+	Vec2I size,
+	bool useBeginClear,
+	Image* gBufferAttachments,
+	size_t gBufferAttachmentCount,
+	Image* colorAttachments,
+	size_t colorAttachmentCount,
+	Image depthStencilAttachment)
+{
+	assert(framebuffer);
+	assert(framebuffer->base.gBufferAttachmentCount > 0);
+	assert(gBufferAttachments);
+	assert(gBufferAttachmentCount > 0);
+	assert(colorAttachments);
+	assert(colorAttachmentCount > 0);
+
+	return setAnyFramebufferAttachments(
+		framebuffer,
+		size,
+		useBeginClear,
+		gBufferAttachments,
+		gBufferAttachmentCount,
+		colorAttachments,
+		colorAttachmentCount,
+		depthStencilAttachment,
+		NULL,
+		NULL);
+}
 
-	if (!addWindowFramebuffer(window, framebufferInstance))
+void beginFramebufferRender(
+	Framebuffer framebuffer,
+	const FramebufferClear* clearValues,
+	size_t clearValueCount)
+{
+	assert(framebuffer);
+	assert((clearValues && clearValueCount > 0 &&
+		framebuffer->base.useBeginClear) ||
+		(!clearValues && clearValueCount == 0 &&
+		!framebuffer->base.useBeginClear));
+	assert(framebuffer->base.window->isRecording);
+	assert(!framebuffer->base.window->renderFramebuffer);
+	assert(graphicsInitialized);
+
+#ifndef NDEBUG
+	if (clearValueCount > 0)
 	{
-		if (graphicsAPI == VULKAN_GRAPHICS_API)
+		Image depthStencilAttachment =
+			framebuffer->base.depthStencilAttachment;
+		size_t colorAttachmentCount =
+			framebuffer->base.colorAttachmentCount +
+			framebuffer->base.gBufferAttachmentCount;
+		size_t attachmentCount = depthStencilAttachment ?
+								 colorAttachmentCount + 1 : colorAttachmentCount;
+
+		if (framebuffer->base.isDefault)
+			assert(clearValueCount == 2);
+		else
+			assert(clearValueCount == attachmentCount);
+
+		if (depthStencilAttachment)
 		{
+			float depth = clearValues[colorAttachmentCount].depthStencil.depth;
+			assert(depth >= 0.0f && depth <= 1.0f);
+		}
+	}
+#endif
+
+	Window window = framebuffer->base.window;
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
 #if MPGX_SUPPORT_VULKAN
-			destroyVkFramebuffer(
-				window->vkWindow->device,
-				framebufferInstance);
+		VkWindow vkWindow = window->vkWindow;
+
+		if (!framebuffer->vk.isDefault)
+		{
+			MpgxResult mpgxResult = transitVkFramebufferAttachments(
+				vkWindow->barrierBatch,
+				framebuffer);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				abort();
+
+			flushVkBarrierBatch(
+				vkWindow->currenCommandBuffer,
+				vkWindow->barrierBatch);
+		}
+
+		beginVkFramebufferRender(
+			vkWindow->currenCommandBuffer,
+			framebuffer,
+			clearValues,
+			clearValueCount);
 #else
-			abort();
+		abort();
 #endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		bool hasDepthBuffer, hasStencilBuffer;
+
+		if (framebuffer->gl.isDefault)
+		{
+			hasDepthBuffer = true;
+			hasStencilBuffer = window->useStencilBuffer;
 		}
 		else
 		{
-#if MPGX_SUPPORT_OPENGL
-			destroyGlFramebuffer(framebufferInstance);
-#else
-			abort();
-#endif
+			Image depthStencilAttachment =
+				framebuffer->gl.depthStencilAttachment;
+
+			if (depthStencilAttachment)
+			{
+				ImageFormat format = depthStencilAttachment->gl.format;
+
+				switch (format)
+				{
+				default:
+					abort();
+				case D16_UNORM_IMAGE_FORMAT:
+				case D32_SFLOAT_IMAGE_FORMAT:
+					hasDepthBuffer = true;
+					hasStencilBuffer = false;
+					break;
+				case D16_UNORM_S8_UINT_IMAGE_FORMAT:
+				case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+				case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+					hasDepthBuffer = true;
+					hasStencilBuffer = true;
+					break;
+				}
+			}
+			else
+			{
+				hasDepthBuffer = false;
+				hasStencilBuffer = false;
+			}
 		}
 
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		bool hasDepthStencilAttachment =
+			framebuffer->gl.isDefault ||
+			framebuffer->gl.depthStencilAttachment;
+
+		Image* colorAttachments =
+			framebuffer->gl.colorAttachments;
+		size_t colorAttachmentCount =
+			framebuffer->gl.colorAttachmentCount;
+
+		if (framebuffer->gl.gBufferAttachmentCount > 0)
+		{
+			// Lighting framebuffer is cleared before the G-buffer subpass
+			beginGlFramebufferRender(
+				framebuffer->gl.subpassHandle,
+				framebuffer->gl.size,
+				framebuffer->gl.colorAttachments,
+				colorAttachmentCount,
+				false,
+				false,
+				NULL,
+				clearValues,
+				clearValueCount);
+
+			if (clearValueCount > 0)
+				clearValues += colorAttachmentCount;
+
+			colorAttachments = framebuffer->gl.gBufferAttachments;
+			colorAttachmentCount =
+				framebuffer->gl.gBufferAttachmentCount;
+		}
+
+		beginGlFramebufferRender(
+			framebuffer->gl.handle,
+			framebuffer->gl.size,
+			colorAttachments,
+			colorAttachmentCount,
+			hasDepthBuffer,
+			hasStencilBuffer,
+			framebuffer->gl.loadOps,
+			clearValues,
+			clearValueCount);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
 	}
 
-	*framebuffer = framebufferInstance;
-	return SUCCESS_MPGX_RESULT;
+	window->renderFramebuffer = framebuffer;
 }
-MpgxResult createShadowFramebuffer(
-	Window window,
-	Vec2I size,
-	bool useBeginClear,
-	Image depthAttachment,
-	Framebuffer* framebuffer)
+
+void endFramebufferRender(Framebuffer framebuffer)
 {
-	assert(window);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(depthAttachment);
-	assert(depthAttachment->base.size.x == size.x &&
-		depthAttachment->base.size.y == size.y);
-	assert(depthAttachment->base.window == window);
 	assert(framebuffer);
-	assert(!window->isRecording);
-	assert(!window->isEnumeratingFramebuffers);
+	assert(framebuffer->base.window->isRecording);
+	assert(framebuffer->base.window->renderFramebuffer == framebuffer);
 	assert(graphicsInitialized);
 
-	MpgxResult mpgxResult;
-	Framebuffer framebufferInstance;
+	Window window = framebuffer->base.window;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = window->vkWindow;
-		VkDevice device = vkWindow->device;
-
-		VkRenderPass renderPass;
-
-		mpgxResult = createVkShadowRenderPass(
-			device,
-			depthAttachment->vk.vkFormat,
-			useBeginClear,
-			&renderPass);
-
-		if (mpgxResult != SUCCESS_MPGX_RESULT)
-			return mpgxResult;
+		endVkFramebufferRender(
+			window->vkWindow->currenCommandBuffer);
 
-		mpgxResult = createVkFramebuffer(
-			device,
-			renderPass,
-			window,
-			size,
-			useBeginClear,
-			NULL,
-			0,
-			depthAttachment,
-			&framebufferInstance);
+		if (!framebuffer->vk.isDefault)
+			setVkFramebufferAttachmentStates(framebuffer);
+#else
+		abort();
+#endif
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_OPENGL
+		endGlFramebufferRender(
+			framebuffer->gl.handle,
+			framebuffer->gl.resolveHandle,
+			framebuffer->gl.size,
+			framebuffer->gl.colorAttachmentCount,
+			framebuffer->gl.depthStencilAttachment,
+			framebuffer->gl.storeOps);
+#else
+		abort();
+#endif
+	}
+	else
+	{
+		abort();
+	}
 
-		if (mpgxResult != SUCCESS_MPGX_RESULT)
-		{
-			vkDestroyRenderPass(
-				device,
-				renderPass,
-				NULL);
-		}
+	window->renderFramebuffer = NULL;
+}
+void nextFramebufferSubpass(Framebuffer framebuffer)
+{
+	assert(framebuffer);
+	assert(framebuffer->base.gBufferAttachmentCount > 0);
+	assert(framebuffer->base.window->isRecording);
+	assert(framebuffer->base.window->renderFramebuffer == framebuffer);
+	assert(graphicsInitialized);
+
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		nextVkFramebufferSubpass(
+			framebuffer->vk.window->vkWindow->currenCommandBuffer);
 #else
 		abort();
 #endif
@@ -3395,14 +6840,8 @@ MpgxResult createShadowFramebuffer(
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		mpgxResult = createGlFramebuffer(
-			window,
-			size,
-			useBeginClear,
-			NULL,
-			0,
-			depthAttachment,
-			&framebufferInstance);
+		nextGlFramebufferSubpass(
+			framebuffer->gl.subpassHandle);
 #else
 		abort();
 #endif
@@ -3411,247 +6850,359 @@ MpgxResult createShadowFramebuffer(
 	{
 		abort();
 	}
+}
 
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-		return mpgxResult;
+void clearFramebuffer(
+	Framebuffer framebuffer,
+	const bool* clearAttachments,
+	const FramebufferClear* clearValues,
+	size_t clearValueCount)
+{
+	assert(framebuffer);
+	assert(clearAttachments);
+	assert(clearValues);
+	assert(clearValueCount > 0);
+	assert(framebuffer->base.gBufferAttachmentCount == 0);
+	assert(framebuffer->base.window->isRecording);
+	assert(framebuffer->base.window->renderFramebuffer);
+	assert(graphicsInitialized);
 
-	if (!addWindowFramebuffer(window, framebufferInstance))
+#ifndef NDEBUG
+	if (clearValueCount > 0)
 	{
-		if (graphicsAPI == VULKAN_GRAPHICS_API)
-		{
-#if MPGX_SUPPORT_VULKAN
-			destroyVkFramebuffer(
-				window->vkWindow->device,
-				framebufferInstance);
-#else
-			abort();
-#endif
-		}
+		Image depthStencilAttachment =
+			framebuffer->base.depthStencilAttachment;
+		size_t colorAttachmentCount =
+			framebuffer->base.colorAttachmentCount;
+		size_t attachmentCount = depthStencilAttachment ?
+			colorAttachmentCount + 1 : colorAttachmentCount;
+
+		if (framebuffer->base.isDefault)
+			assert(clearValueCount == 2);
 		else
+			assert(clearValueCount == attachmentCount);
+
+		if (depthStencilAttachment)
 		{
-#if MPGX_SUPPORT_OPENGL
-			destroyGlFramebuffer(framebufferInstance);
-#else
-			abort();
-#endif
+			float depth = clearValues[colorAttachmentCount].depthStencil.depth;
+			assert(depth >= 0.0f && depth <= 1.0f);
 		}
-
-		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 	}
-
-	*framebuffer = framebufferInstance;
-	return SUCCESS_MPGX_RESULT;
-}
-void destroyFramebuffer(Framebuffer framebuffer)
-{
-	if (!framebuffer)
-		return;
-
-	assert(!framebuffer->base.window->isRecording);
-	assert(!framebuffer->base.window->isEnumeratingFramebuffers);
-	assert(graphicsInitialized);
+#endif
 
 	Window window = framebuffer->base.window;
-	Framebuffer* framebuffers = window->framebuffers;
-	size_t framebufferCount = window->framebufferCount;
+	bool hasDepthBuffer, hasStencilBuffer;
 
-	for (int64_t i = (int64_t)framebufferCount - 1; i >= 0; i--)
+	if (framebuffer->base.isDefault)
 	{
-		if (framebuffer != framebuffers[i])
-			continue;
+		hasDepthBuffer = true;
+		hasStencilBuffer = window->useStencilBuffer;
+	}
+	else
+	{
+		Image depthStencilAttachment =
+			framebuffer->base.depthStencilAttachment;
 
-		if (graphicsAPI == VULKAN_GRAPHICS_API)
+		if (depthStencilAttachment)
 		{
-#if MPGX_SUPPORT_VULKAN
-			VkWindow vkWindow = window->vkWindow;
-
-			VkResult result = vkQueueWaitIdle(
-				vkWindow->graphicsQueue);
+			ImageFormat format = depthStencilAttachment->base.format;
 
-			if (result != VK_SUCCESS)
+			switch (format)
+			{
+			default:
 				abort();
+			case D16_UNORM_IMAGE_FORMAT:
+			case D32_SFLOAT_IMAGE_FORMAT:
+				hasDepthBuffer = true;
+				hasStencilBuffer = false;
+				break;
+			case D16_UNORM_S8_UINT_IMAGE_FORMAT:
+			case D24_UNORM_S8_UINT_IMAGE_FORMAT:
+			case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
+				hasDepthBuffer = true;
+				hasStencilBuffer = true;
+				break;
+			}
+		}
+		else
+		{
+			hasDepthBuffer = false;
+			hasStencilBuffer = false;
+		}
+	}
 
-			destroyVkFramebuffer(
-				vkWindow->device,
-				framebuffer);
+	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	{
+#if MPGX_SUPPORT_VULKAN
+		clearVkFramebuffer(
+			window->vkWindow->currenCommandBuffer,
+			framebuffer->vk.size,
+			hasDepthBuffer,
+			hasStencilBuffer,
+			framebuffer->vk.colorAttachments,
+			framebuffer->vk.clearAttachments,
+			clearAttachments,
+			clearValues,
+			clearValueCount);
 #else
-			abort();
+		abort();
 #endif
-		}
-		else if (graphicsAPI == OPENGL_GRAPHICS_API)
-		{
+	}
+	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	{
 #if MPGX_SUPPORT_OPENGL
-			destroyGlFramebuffer(framebuffer);
+		clearGlFramebuffer(
+			framebuffer->gl.size,
+			framebuffer->gl.colorAttachments,
+			framebuffer->gl.colorAttachmentCount,
+			hasDepthBuffer,
+			hasStencilBuffer,
+			clearAttachments,
+			clearValues,
+			clearValueCount);
 #else
-			abort();
+		abort();
 #endif
-		}
-		else
-		{
-			abort();
-		}
-
-		for (size_t j = i + 1; j < framebufferCount; j++)
-			framebuffers[j - 1] = framebuffers[j];
-
-		window->framebufferCount--;
-		return;
 	}
-
-	abort();
+	else
+	{
+		abort();
+	}
 }
 
-Window getFramebufferWindow(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(graphicsInitialized);
-	return framebuffer->base.window;
-}
-Vec2I getFramebufferSize(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(graphicsInitialized);
-	return framebuffer->base.size;
-}
-bool isFramebufferUseBeginClear(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(graphicsInitialized);
-	return framebuffer->base.useBeginClear;
-}
-Image* getFramebufferColorAttachments(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(!framebuffer->base.isDefault);
-	assert(graphicsInitialized);
-	return framebuffer->base.colorAttachments;
-}
-size_t getFramebufferColorAttachmentCount(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(!framebuffer->base.isDefault);
-	assert(graphicsInitialized);
-	return framebuffer->base.colorAttachmentCount;
-}
-Image getFramebufferDepthStencilAttachment(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(!framebuffer->base.isDefault);
-	assert(graphicsInitialized);
-	return framebuffer->base.depthStencilAttachment;
-}
-bool isFramebufferDefault(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(graphicsInitialized);
-	return framebuffer->base.isDefault;
-}
-size_t getFramebufferPipelineCount(Framebuffer framebuffer)
+void enumerateFramebufferGraphicsPipelines(
+	Framebuffer framebuffer,
+	OnFramebufferGraphicsPipeline onGraphicsPipeline,
+	void* handle)
 {
 	assert(framebuffer);
+	assert(onGraphicsPipeline);
 	assert(graphicsInitialized);
-	return framebuffer->base.pipelineCount;
+
+#ifndef NDEBUG
+	framebuffer->base.isEnumerating = true;
+#endif
+
+	GraphicsPipeline* pipelines = framebuffer->base.pipelines;
+	size_t pipelineCount = framebuffer->base.pipelineCount;
+
+	for (size_t i = 0; i < pipelineCount; i++)
+		onGraphicsPipeline(pipelines[i], handle);
+
+#ifndef NDEBUG
+	framebuffer->base.isEnumerating = false;
+#endif
 }
 
-MpgxResult setFramebufferAttachments(
+#ifndef NDEBUG
+static bool isGraphicsPipelineStateValid(
 	Framebuffer framebuffer,
-	Vec2I size,
-	bool useBeginClear,
-	Image* colorAttachments,
-	size_t colorAttachmentCount,
-	Image depthStencilAttachment)
-{
-	assert(framebuffer);
-	assert(size.x > 0);
-	assert(size.y > 0);
-	assert(!framebuffer->base.isDefault);
-	assert(!framebuffer->base.window->isRecording);
-	assert(graphicsInitialized);
+	const GraphicsPipelineState* state,
+	Shader* shaders,
+	size_t shaderCount)
+{
+	if (state->drawMode >= DRAW_MODE_COUNT ||
+		state->polygonMode >= POLYGON_MODE_COUNT ||
+		state->cullMode >= CULL_MODE_COUNT ||
+		state->depthCompareOperator >= COMPARE_OPERATOR_COUNT ||
+		state->colorComponentWriteMask > ALL_COLOR_COMPONENT ||
+		state->srcColorBlendFactor >= BLEND_FACTOR_COUNT ||
+		state->dstColorBlendFactor >= BLEND_FACTOR_COUNT ||
+		state->srcAlphaBlendFactor >= BLEND_FACTOR_COUNT ||
+		state->dstAlphaBlendFactor >= BLEND_FACTOR_COUNT ||
+		state->colorBlendOperator >= BLEND_OPERATOR_COUNT ||
+		state->alphaBlendOperator >= BLEND_OPERATOR_COUNT ||
+		state->lineWidth <= 0.0f)
+	{
+		return false;
+	}
 
-#ifndef NDEBUG
-	bool hasSomeAttachments = false;
+	if (state->viewport.x < 0 || state->viewport.y < 0 ||
+		state->viewport.z < 0 || state->viewport.w < 0 ||
+		state->scissor.x < 0 || state->scissor.y < 0 ||
+		state->scissor.z < 0 || state->scissor.w < 0 ||
+		state->scissor.x + state->scissor.z > framebuffer->base.size.x ||
+		state->scissor.y + state->scissor.w > framebuffer->base.size.y)
+	{
+		return false;
+	}
 
-	if (colorAttachmentCount > 0)
+	if (state->subpassIndex >=
+		(framebuffer->base.gBufferAttachmentCount > 0 ? 2 : 1))
 	{
-		assert(colorAttachments);
+		return false;
+	}
 
-		for (size_t i = 0; i < colorAttachmentCount; i++)
-		{
-			Image image = colorAttachments[i];
+	for (size_t i = 0; i < shaderCount; i++)
+	{
+		Shader shader = shaders[i];
 
-			assert(image->base.type &
-				COLOR_ATTACHMENT_IMAGE_TYPE);
-			assert(image->base.size.x  == size.x &&
-				image->base.size.y == size.y);
-			assert(image->base.window == framebuffer->base.window);
+		if (shader->base.type != VERTEX_SHADER_TYPE &&
+			shader->base.type != FRAGMENT_SHADER_TYPE &&
+			shader->base.type != TESSELLATION_CONTROL_SHADER_TYPE &&
+			shader->base.type != TESSELLATION_EVALUATION_SHADER_TYPE &&
+			shader->base.type != GEOMETRY_SHADER_TYPE)
+		{
+			return false;
 		}
 
-		hasSomeAttachments = true;
-	}
-	else
-	{
-		assert(!colorAttachments);
-	}
-	if (depthStencilAttachment)
-	{
-		assert(depthStencilAttachment->base.type &
-			DEPTH_STENCIL_ATTACHMENT_IMAGE_TYPE);
-		assert(depthStencilAttachment->base.size.x == size.x &&
-			depthStencilAttachment->base.size.y == size.y);
-		assert(depthStencilAttachment->base.window == framebuffer->base.window);
-		hasSomeAttachments = true;
+		if (shader->base.window != framebuffer->base.window)
+			return false;
 	}
 
-	assert(hasSomeAttachments);
+	return true;
+}
 #endif
 
+static MpgxResult createAnyGraphicsPipeline(
+	Framebuffer framebuffer,
+	const char* name,
+	const GraphicsPipelineState* state,
+	OnGraphicsPipelineBind onBind,
+	OnGraphicsPipelineUniformsSet onUniformsSet,
+	OnGraphicsPipelineResize onResize,
+	OnGraphicsPipelineDestroy onDestroy,
+	OnGraphicsPipelineReady onReady,
+	void* handle,
+	const void* createData,
+	Shader* shaders,
+	size_t shaderCount,
+	GraphicsPipeline fallback,
+	bool useAsync,
+	GraphicsPipeline* graphicsPipeline)
+{
+	assert(framebuffer);
+	assert(state);
+	assert(onResize);
+	assert(onDestroy);
+	assert(handle);
+	assert(shaders);
+	assert(shaderCount > 0);
+	assert(graphicsPipeline);
+	assert(isGraphicsPipelineStateValid(
+		framebuffer,
+		state,
+		shaders,
+		shaderCount));
+	assert(!framebuffer->base.window->isRecording);
+	assert(!framebuffer->base.isEnumerating);
+	assert(!fallback || fallback->base.framebuffer == framebuffer);
+	assert(graphicsInitialized);
+
 	Window window = framebuffer->base.window;
 
+	MpgxResult mpgxResult;
+	GraphicsPipeline graphicsPipelineInstance;
+
+#if MPGX_SUPPORT_VULKAN
+	VkGraphicsPipelineTask task = NULL;
+#endif
+
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
 		VkWindow vkWindow = window->vkWindow;
 		VkDevice device = vkWindow->device;
+		VkReflectedLayout reflectedLayout = NULL;
+		VkGraphicsPipelineCreateData reflectedCreateData;
 
-		VkRenderPass renderPass;
-
-		MpgxResult mpgxResult = createVkGeneralRenderPass(
-			device,
-			useBeginClear,
-			colorAttachments,
-			colorAttachmentCount,
-			depthStencilAttachment,
-			&renderPass);
-
-		if (mpgxResult != SUCCESS_MPGX_RESULT)
-			return mpgxResult;
+		if (!createData)
+		{
+			mpgxResult = getVkShaderReflectedLayout(
+				window,
+				shaders,
+				shaderCount,
+				&reflectedLayout);
 
-		VkResult vkResult = vkQueueWaitIdle(
-			vkWindow->graphicsQueue);
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				return mpgxResult;
 
-		if (vkResult != VK_SUCCESS)
-		{
-			vkDestroyRenderPass(device, renderPass, NULL);
-			return vkToMpgxResult(vkResult);
+			getVkReflectedGraphicsCreateData(
+				reflectedLayout,
+				&reflectedCreateData);
+			createData = &reflectedCreateData;
 		}
 
-		mpgxResult = setVkFramebufferAttachments(
-			vkWindow->device,
-			renderPass,
+		mpgxResult = createVkGraphicsPipeline(
+			device,
+			vkWindow->pipelineCache,
+			createData,
+			reflectedLayout,
 			framebuffer,
-			size,
-			useBeginClear,
-			colorAttachments,
-			colorAttachmentCount,
-			depthStencilAttachment);
+			window,
+			name,
+			*state,
+			onBind,
+			onUniformsSet,
+			onResize,
+			onDestroy,
+			handle,
+			shaders,
+			shaderCount,
+			fallback,
+			useAsync,
+			vkWindow->useGraphicsPipelineLibrary &&
+				reflectedLayout && !useAsync,
+			&graphicsPipelineInstance);
 
-		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		if (mpgxResult == SUCCESS_MPGX_RESULT && useAsync)
 		{
-			vkDestroyRenderPass(device, renderPass, NULL);
-			return mpgxResult;
+			mpgxResult = createVkGraphicsPipelineTask(
+				device,
+				window->pipelineMutex,
+				graphicsPipelineInstance,
+				createData,
+				onReady,
+				&task);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				destroyVkGraphicsPipeline(
+					device,
+					graphicsPipelineInstance);
+				return mpgxResult;
+			}
+		}
+		else if (mpgxResult == SUCCESS_MPGX_RESULT &&
+			graphicsPipelineInstance->vk.libraries[0])
+		{
+			// Optimized link is not required, fast
+			// linked pipeline is used if task failed.
+			if (createVkGraphicsPipelineLinkTask(
+				device,
+				window->pipelineMutex,
+				graphicsPipelineInstance,
+				&task) != SUCCESS_MPGX_RESULT)
+			{
+				task = NULL;
+			}
 		}
 
-		return SUCCESS_MPGX_RESULT;
+		if (task)
+		{
+			size_t taskCount = window->pipelineTaskCount;
+
+			if (taskCount == window->pipelineTaskCapacity)
+			{
+				size_t capacity = window->pipelineTaskCapacity * 2;
+
+				VkGraphicsPipelineTask* tasks = realloc(
+					window->pipelineTasks,
+					sizeof(VkGraphicsPipelineTask) * capacity);
+
+				if (!tasks)
+				{
+					destroyVkGraphicsPipelineTask(task);
+					destroyVkGraphicsPipeline(
+						device,
+						graphicsPipelineInstance);
+					return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+				}
+
+				window->pipelineTasks = tasks;
+				window->pipelineTaskCapacity = capacity;
+			}
+		}
 #else
 		abort();
 #endif
@@ -3659,13 +7210,25 @@ MpgxResult setFramebufferAttachments(
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		return setGlFramebufferAttachments(
+		assert(!createData);
+
+		if (state->discardRasterizer)
+			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+
+		mpgxResult = createGlGraphicsPipeline(
 			framebuffer,
-			size,
-			useBeginClear,
-			colorAttachments,
-			colorAttachmentCount,
-			depthStencilAttachment);
+			window,
+			name,
+			*state,
+			onBind,
+			onUniformsSet,
+			onResize,
+			onDestroy,
+			handle,
+			shaders,
+			shaderCount,
+			window->cacheDirectory,
+			&graphicsPipelineInstance);
 #else
 		abort();
 #endif
@@ -3674,390 +7237,497 @@ MpgxResult setFramebufferAttachments(
 	{
 		abort();
 	}
-}
-
-void beginFramebufferRender(
-	Framebuffer framebuffer,
-	const FramebufferClear* clearValues,
-	size_t clearValueCount)
-{
-	assert(framebuffer);
-	assert((clearValues && clearValueCount > 0 &&
-		framebuffer->base.useBeginClear) ||
-		(!clearValues && clearValueCount == 0 &&
-		!framebuffer->base.useBeginClear));
-	assert(framebuffer->base.window->isRecording);
-	assert(!framebuffer->base.window->renderFramebuffer);
-	assert(graphicsInitialized);
-
-#ifndef NDEBUG
-	if (clearValueCount > 0)
-	{
-		Image depthStencilAttachment =
-			framebuffer->base.depthStencilAttachment;
-		size_t colorAttachmentCount =
-			framebuffer->base.colorAttachmentCount;
-		size_t attachmentCount = depthStencilAttachment ?
-								 colorAttachmentCount + 1 : colorAttachmentCount;
-
-		if (framebuffer->base.isDefault)
-			assert(clearValueCount == 2);
-		else
-			assert(clearValueCount == attachmentCount);
 
-		if (depthStencilAttachment)
-		{
-			float depth = clearValues[colorAttachmentCount].depthStencil.depth;
-			assert(depth >= 0.0f && depth <= 1.0f);
-		}
-	}
-#endif
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+		return mpgxResult;
 
-	Window window = framebuffer->base.window;
+	size_t count = framebuffer->base.pipelineCount;
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	if (count == framebuffer->base.pipelineCapacity)
 	{
-#if MPGX_SUPPORT_VULKAN
-		VkWindow vkWindow = window->vkWindow;
+		size_t capacity = framebuffer->base.pipelineCapacity * 2;
 
-		beginVkFramebufferRender(
-			vkWindow->currenCommandBuffer,
-			framebuffer->vk.renderPass,
-			framebuffer->vk.handle,
-			framebuffer->vk.size,
-			clearValues,
-			clearValueCount);
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_OPENGL
-		bool hasDepthBuffer, hasStencilBuffer;
+		GraphicsPipeline* pipelines = realloc(
+			framebuffer->base.pipelines,
+			sizeof(GraphicsPipeline) * capacity);
 
-		if (framebuffer->gl.isDefault)
-		{
-			hasDepthBuffer = true;
-			hasStencilBuffer = window->useStencilBuffer;
-		}
-		else
+		if (!pipelines)
 		{
-			Image depthStencilAttachment =
-				framebuffer->gl.depthStencilAttachment;
-
-			if (depthStencilAttachment)
+			if (graphicsAPI == VULKAN_GRAPHICS_API)
 			{
-				ImageFormat format = depthStencilAttachment->gl.format;
-
-				switch (format)
-				{
-				default:
-					abort();
-				case D16_UNORM_IMAGE_FORMAT:
-				case D32_SFLOAT_IMAGE_FORMAT:
-					hasDepthBuffer = true;
-					hasStencilBuffer = false;
-					break;
-				case D16_UNORM_S8_UINT_IMAGE_FORMAT:
-				case D24_UNORM_S8_UINT_IMAGE_FORMAT:
-				case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
-					hasDepthBuffer = true;
-					hasStencilBuffer = true;
-					break;
-				}
+#if MPGX_SUPPORT_VULKAN
+				destroyVkGraphicsPipelineTask(task);
+				destroyVkGraphicsPipeline(
+					window->vkWindow->device,
+					graphicsPipelineInstance);
+#else
+				abort();
+#endif
 			}
 			else
 			{
-				hasDepthBuffer = false;
-				hasStencilBuffer = false;
+#if MPGX_SUPPORT_OPENGL
+				destroyGlGraphicsPipeline(graphicsPipelineInstance);
+#else
+				abort();
+#endif
 			}
-		}
 
-		bool hasDepthStencilAttachment =
-			framebuffer->gl.isDefault ||
-			framebuffer->gl.depthStencilAttachment;
+			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+		}
 
-		beginGlFramebufferRender(
-			framebuffer->gl.handle,
-			framebuffer->gl.size,
-			framebuffer->gl.colorAttachmentCount,
-			hasDepthBuffer,
-			hasStencilBuffer,
-			clearValues,
-			clearValueCount);
-#else
-		abort();
-#endif
-	}
-	else
-	{
-		abort();
+		framebuffer->base.pipelines = pipelines;
+		framebuffer->base.pipelineCapacity = capacity;
 	}
 
-	window->renderFramebuffer = framebuffer;
-}
+	framebuffer->base.pipelines[count] = graphicsPipelineInstance;
+	framebuffer->base.pipelineCount = count + 1;
 
-void endFramebufferRender(Framebuffer framebuffer)
-{
-	assert(framebuffer);
-	assert(framebuffer->base.window->isRecording);
-	assert(framebuffer->base.window->renderFramebuffer == framebuffer);
-	assert(graphicsInitialized);
+	// Fallback should outlive the pipelines using it
+	if (graphicsPipelineInstance->base.fallback)
+		graphicsPipelineInstance->base.fallback->base.dependentCount++;
 
-	Window window = framebuffer->base.window;
+#if MPGX_SUPPORT_VULKAN
+	bool isReady = true;
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
+	if (task)
 	{
-#if MPGX_SUPPORT_VULKAN
-		endVkFramebufferRender(
-			window->vkWindow->currenCommandBuffer);
-#else
-		abort();
-#endif
+		window->pipelineTasks[window->pipelineTaskCount++] = task;
+		graphicsPipelineInstance->vk.taskCount++;
+		isReady = task->isLinkTask;
+
+		// Compile on the calling thread if task queue is full
+		if (!tryAddThreadPoolTask(
+			window->pipelineThreadPool,
+			onVkGraphicsPipelineTask,
+			task))
+		{
+			onVkGraphicsPipelineTask(task);
+		}
 	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_OPENGL
-		endGlFramebufferRender();
 #else
-		abort();
+	bool isReady = true;
 #endif
-	}
-	else
+
+	if (isReady && onReady)
 	{
-		abort();
+		onReady(graphicsPipelineInstance,
+			SUCCESS_MPGX_RESULT);
 	}
 
-	window->renderFramebuffer = NULL;
+	*graphicsPipeline = graphicsPipelineInstance;
+	return SUCCESS_MPGX_RESULT;
 }
-
-void clearFramebuffer(
+MpgxResult createGraphicsPipeline(
 	Framebuffer framebuffer,
-	const bool* clearAttachments,
-	const FramebufferClear* clearValues,
-	size_t clearValueCount)
+	const char* name,
+	const GraphicsPipelineState* state,
+	OnGraphicsPipelineBind onBind,
+	OnGraphicsPipelineUniformsSet onUniformsSet,
+	OnGraphicsPipelineResize onResize,
+	OnGraphicsPipelineDestroy onDestroy,
+	void* handle,
+	const void* createData,
+	Shader* shaders,
+	size_t shaderCount,
+	GraphicsPipeline* graphicsPipeline)
 {
-	assert(framebuffer);
-	assert(clearAttachments);
-	assert(clearValues);
-	assert(clearValueCount > 0);
-	assert(framebuffer->base.window->isRecording);
-	assert(framebuffer->base.window->renderFramebuffer);
-	assert(graphicsInitialized);
+	return createAnyGraphicsPipeline(
+		framebuffer,
+		name,
+		state,
+		onBind,
+		onUniformsSet,
+		onResize,
+		onDestroy,
+		NULL,
+		handle,
+		createData,
+		shaders,
+		shaderCount,
+		NULL,
+		false,
+		graphicsPipeline);
+}
+MpgxResult createAsyncGraphicsPipeline(
+	Framebuffer framebuffer,
+	const char* name,
+	const GraphicsPipelineState* state,
+	OnGraphicsPipelineBind onBind,
+	OnGraphicsPipelineUniformsSet onUniformsSet,
+	OnGraphicsPipelineResize onResize,
+	OnGraphicsPipelineDestroy onDestroy,
+	OnGraphicsPipelineReady onReady,
+	void* handle,
+	const void* createData,
+	Shader* shaders,
+	size_t shaderCount,
+	GraphicsPipeline fallback,
+	GraphicsPipeline* graphicsPipeline)
+{
+	return createAnyGraphicsPipeline(
+		framebuffer,
+		name,
+		state,
+		onBind,
+		onUniformsSet,
+		onResize,
+		onDestroy,
+		onReady,
+		handle,
+		createData,
+		shaders,
+		shaderCount,
+		fallback,
+		true,
+		graphicsPipeline);
+}
+#if MPGX_SUPPORT_VULKAN
+static MpgxResult createVkGraphicsPipelines(
+	const GraphicsPipelineInfo* infos,
+	size_t infoCount,
+	GraphicsPipeline* graphicsPipelines)
+{
+	assert(infos);
+	assert(infoCount > 0);
+	assert(graphicsPipelines);
+
+	Window window = infos[0].framebuffer->base.window;
+	VkWindow vkWindow = window->vkWindow;
+	VkDevice device = vkWindow->device;
+	VkPipelineCache cache = vkWindow->pipelineCache;
+
+	size_t dataSize = infoCount * (sizeof(VkGraphicsPipelineCreateInfoData) +
+		sizeof(VkGraphicsPipelineCreateData) + sizeof(VkGraphicsPipelineCreateInfo) +
+		sizeof(VkPipeline) + sizeof(GraphicsPipeline) + sizeof(size_t) +
+		sizeof(VkGraphicsPipelineBatch));
+	uint8_t* data = calloc(1, dataSize);
+
+	if (!data)
+		return OUT_OF_HOST_MEMORY_MPGX_RESULT;
 
-#ifndef NDEBUG
-	if (clearValueCount > 0)
-	{
-		Image depthStencilAttachment =
-			framebuffer->base.depthStencilAttachment;
-		size_t colorAttachmentCount =
-			framebuffer->base.colorAttachmentCount;
-		size_t attachmentCount = depthStencilAttachment ?
-			colorAttachmentCount + 1 : colorAttachmentCount;
+	VkGraphicsPipelineCreateInfoData* createInfoDatas =
+		(VkGraphicsPipelineCreateInfoData*)data;
+	VkGraphicsPipelineCreateData* reflectedCreateDatas =
+		(VkGraphicsPipelineCreateData*)(createInfoDatas + infoCount);
+	VkGraphicsPipelineCreateInfo* createInfos =
+		(VkGraphicsPipelineCreateInfo*)(reflectedCreateDatas + infoCount);
+	VkPipeline* handles = (VkPipeline*)(createInfos + infoCount);
+	GraphicsPipeline* pipelines = (GraphicsPipeline*)(handles + infoCount);
+	size_t* indices = (size_t*)(pipelines + infoCount);
+	VkGraphicsPipelineBatch* batches =
+		(VkGraphicsPipelineBatch*)(indices + infoCount);
+
+	MpgxResult mpgxResult = SUCCESS_MPGX_RESULT;
+	size_t pipelineCount = 0;
+
+	for (; pipelineCount < infoCount; pipelineCount++)
+	{
+		const GraphicsPipelineInfo* info = &infos[pipelineCount];
+		Framebuffer framebuffer = info->framebuffer;
+
+		assert(framebuffer);
+		assert(info->state);
+		assert(info->onResize);
+		assert(info->onDestroy);
+		assert(info->handle);
+		assert(info->shaders);
+		assert(info->shaderCount > 0);
+		assert(isGraphicsPipelineStateValid(
+			framebuffer,
+			info->state,
+			info->shaders,
+			info->shaderCount));
+		assert(framebuffer->base.window == window);
+		assert(!framebuffer->base.isEnumerating);
 
-		if (framebuffer->base.isDefault)
-			assert(clearValueCount == 2);
-		else
-			assert(clearValueCount == attachmentCount);
+		const VkGraphicsPipelineCreateData* createData = info->createData;
+		VkReflectedLayout reflectedLayout = NULL;
 
-		if (depthStencilAttachment)
+		if (!createData)
 		{
-			float depth = clearValues[colorAttachmentCount].depthStencil.depth;
-			assert(depth >= 0.0f && depth <= 1.0f);
+			mpgxResult = getVkShaderReflectedLayout(
+				window,
+				info->shaders,
+				info->shaderCount,
+				&reflectedLayout);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				break;
+
+			getVkReflectedGraphicsCreateData(
+				reflectedLayout,
+				&reflectedCreateDatas[pipelineCount]);
+			createData = &reflectedCreateDatas[pipelineCount];
 		}
-	}
-#endif
 
-	Window window = framebuffer->base.window;
-	bool hasDepthBuffer, hasStencilBuffer;
+		// Pipeline is created without handle,
+		// handles are created below in one call.
+		GraphicsPipeline pipeline;
 
-	if (framebuffer->base.isDefault)
+		mpgxResult = createVkGraphicsPipeline(
+			device,
+			cache,
+			createData,
+			reflectedLayout,
+			framebuffer,
+			window,
+			info->name,
+			*info->state,
+			info->onBind,
+			info->onUniformsSet,
+			info->onResize,
+			info->onDestroy,
+			info->handle,
+			info->shaders,
+			info->shaderCount,
+			NULL,
+			true,
+			false,
+			&pipeline);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			break;
+
+		pipelines[pipelineCount] = pipeline;
+
+		mpgxResult = createVkGraphicsPipelineCreateInfo(
+			framebuffer->vk.renderPass,
+			pipeline->vk.layout,
+			info->shaders,
+			info->shaderCount,
+			pipeline->vk.specializationInfo,
+			*info->state,
+			getFramebufferSubpassColorCount(
+				framebuffer->vk.colorAttachmentCount,
+				framebuffer->vk.gBufferAttachmentCount,
+				info->state->subpassIndex),
+			(VkSampleCountFlagBits)framebuffer->vk.sampleCount,
+			framebuffer->vk.size,
+			createData,
+			0,
+			&createInfoDatas[pipelineCount]);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			destroyVkGraphicsPipeline(device, pipeline);
+			break;
+		}
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
 	{
-		hasDepthBuffer = true;
-		hasStencilBuffer = window->useStencilBuffer;
+		for (size_t i = 0; i < pipelineCount; i++)
+		{
+			destroyVkGraphicsPipelineCreateInfo(&createInfoDatas[i]);
+			destroyVkGraphicsPipeline(device, pipelines[i]);
+		}
+
+		free(data);
+		return mpgxResult;
 	}
-	else
+
+	// Pipelines of the same render pass are grouped
+	// to be created with one call, framebuffers
+	// with compatible attachments share render pass.
+	size_t indexCount = 0;
+
+	for (size_t i = 0; i < infoCount; i++)
 	{
-		Image depthStencilAttachment =
-			framebuffer->base.depthStencilAttachment;
+		VkRenderPass renderPass = infos[i].framebuffer->vk.renderPass;
+		bool isGrouped = false;
 
-		if (depthStencilAttachment)
+		for (size_t j = 0; j < i; j++)
 		{
-			ImageFormat format = depthStencilAttachment->base.format;
-
-			switch (format)
+			if (infos[j].framebuffer->vk.renderPass == renderPass)
 			{
-			default:
-				abort();
-			case D16_UNORM_IMAGE_FORMAT:
-			case D32_SFLOAT_IMAGE_FORMAT:
-				hasDepthBuffer = true;
-				hasStencilBuffer = false;
-				break;
-			case D16_UNORM_S8_UINT_IMAGE_FORMAT:
-			case D24_UNORM_S8_UINT_IMAGE_FORMAT:
-			case D32_SFLOAT_S8_UINT_IMAGE_FORMAT:
-				hasDepthBuffer = true;
-				hasStencilBuffer = true;
+				isGrouped = true;
 				break;
 			}
 		}
-		else
+
+		if (isGrouped)
+			continue;
+
+		for (size_t j = i; j < infoCount; j++)
 		{
-			hasDepthBuffer = false;
-			hasStencilBuffer = false;
+			if (infos[j].framebuffer->vk.renderPass != renderPass)
+				continue;
+
+			createInfos[indexCount] = createInfoDatas[j].createInfo;
+			indices[indexCount++] = j;
 		}
 	}
 
-	if (graphicsAPI == VULKAN_GRAPHICS_API)
-	{
-#if MPGX_SUPPORT_VULKAN
-		clearVkFramebuffer(
-			window->vkWindow->currenCommandBuffer,
-			framebuffer->vk.size,
-			hasDepthBuffer,
-			hasStencilBuffer,
-			framebuffer->vk.clearAttachments,
-			clearAttachments,
-			clearValues,
-			clearValueCount);
-#else
-		abort();
-#endif
-	}
-	else if (graphicsAPI == OPENGL_GRAPHICS_API)
+	for (size_t i = 0; i < infoCount; i++)
 	{
-#if MPGX_SUPPORT_OPENGL
-		clearGlFramebuffer(
-			framebuffer->gl.size,
-			framebuffer->gl.colorAttachmentCount,
-			hasDepthBuffer,
-			hasStencilBuffer,
-			clearAttachments,
-			clearValues,
-			clearValueCount);
-#else
-		abort();
-#endif
+		Framebuffer framebuffer = infos[i].framebuffer;
+		bool isReserved = false;
+
+		for (size_t j = 0; j < i; j++)
+		{
+			if (infos[j].framebuffer == framebuffer)
+			{
+				isReserved = true;
+				break;
+			}
+		}
+
+		if (isReserved)
+			continue;
+
+		size_t count = framebuffer->vk.pipelineCount;
+
+		for (size_t j = i; j < infoCount; j++)
+		{
+			if (infos[j].framebuffer == framebuffer)
+				count++;
+		}
+
+		size_t capacity = framebuffer->vk.pipelineCapacity;
+
+		if (count > capacity)
+		{
+			while (count > capacity)
+				capacity *= 2;
+
+			GraphicsPipeline* framebufferPipelines = realloc(
+				framebuffer->vk.pipelines,
+				sizeof(GraphicsPipeline) * capacity);
+
+			if (!framebufferPipelines)
+			{
+				mpgxResult = OUT_OF_HOST_MEMORY_MPGX_RESULT;
+				continue;
+			}
+
+			framebuffer->vk.pipelines = framebufferPipelines;
+			framebuffer->vk.pipelineCapacity = capacity;
+		}
 	}
-	else
+
+	size_t batchCount = 0;
+
+	if (mpgxResult == SUCCESS_MPGX_RESULT)
 	{
-		abort();
-	}
-}
+		size_t groupStart = 0;
+
+		while (groupStart < infoCount)
+		{
+			VkRenderPass renderPass =
+				infos[indices[groupStart]].framebuffer->vk.renderPass;
+			size_t groupEnd = groupStart + 1;
+
+			while (groupEnd < infoCount &&
+				infos[indices[groupEnd]].framebuffer->vk.renderPass == renderPass)
+			{
+				groupEnd++;
+			}
+
+			size_t groupCount = groupEnd - groupStart;
+
+			// Large groups are split between the pipeline threads,
+			// because not every driver compiles one call in parallel.
+			size_t splitCount = groupCount >= PIPELINE_BATCH_MIN_SPLIT ?
+				PIPELINE_THREAD_COUNT : 1;
+			size_t splitSize = (groupCount + splitCount - 1) / splitCount;
+
+			for (size_t i = groupStart; i < groupEnd; i += splitSize)
+			{
+				size_t batchSize = groupEnd - i < splitSize ?
+					groupEnd - i : splitSize;
+
+				VkGraphicsPipelineBatch batch;
+
+				mpgxResult = createVkGraphicsPipelineBatch(
+					device,
+					cache,
+					createInfos + i,
+					handles + i,
+					(uint32_t)batchSize,
+					&batch);
 
-void enumerateFramebufferGraphicsPipelines(
-	Framebuffer framebuffer,
-	OnFramebufferGraphicsPipeline onGraphicsPipeline,
-	void* handle)
-{
-	assert(framebuffer);
-	assert(onGraphicsPipeline);
-	assert(graphicsInitialized);
+				if (mpgxResult != SUCCESS_MPGX_RESULT)
+					break;
 
-#ifndef NDEBUG
-	framebuffer->base.isEnumerating = true;
-#endif
+				// Not submitted batch is created below by this thread
+				batch->refCount = 2;
 
-	GraphicsPipeline* pipelines = framebuffer->base.pipelines;
-	size_t pipelineCount = framebuffer->base.pipelineCount;
+				if (!tryAddThreadPoolTask(
+					window->pipelineThreadPool,
+					onVkGraphicsPipelineBatch,
+					batch))
+				{
+					batch->refCount = 1;
+				}
 
-	for (size_t i = 0; i < pipelineCount; i++)
-		onGraphicsPipeline(pipelines[i], handle);
+				batches[batchCount++] = batch;
+			}
 
-#ifndef NDEBUG
-	framebuffer->base.isEnumerating = false;
-#endif
-}
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				break;
 
-MpgxResult createGraphicsPipeline(
-	Framebuffer framebuffer,
-	const char* name,
-	const GraphicsPipelineState* state,
-	OnGraphicsPipelineBind onBind,
-	OnGraphicsPipelineUniformsSet onUniformsSet,
-	OnGraphicsPipelineResize onResize,
-	OnGraphicsPipelineDestroy onDestroy,
-	void* handle,
-	const void* createData,
-	Shader* shaders,
-	size_t shaderCount,
-	GraphicsPipeline* graphicsPipeline)
-{
-	assert(framebuffer);
-	assert(state);
-	assert(onResize);
-	assert(onDestroy);
-	assert(handle);
-	assert(shaders);
-	assert(shaderCount > 0);
-	assert(graphicsPipeline);
-	assert(state->drawMode < DRAW_MODE_COUNT);
-	assert(state->polygonMode < POLYGON_MODE_COUNT);
-	assert(state->cullMode < CULL_MODE_COUNT);
-	assert(state->depthCompareOperator < COMPARE_OPERATOR_COUNT);
-	assert(state->colorComponentWriteMask <= ALL_COLOR_COMPONENT);
-	assert(state->srcColorBlendFactor < BLEND_FACTOR_COUNT);
-	assert(state->dstColorBlendFactor < BLEND_FACTOR_COUNT);
-	assert(state->srcAlphaBlendFactor < BLEND_FACTOR_COUNT);
-	assert(state->dstAlphaBlendFactor < BLEND_FACTOR_COUNT);
-	assert(state->colorBlendOperator < BLEND_OPERATOR_COUNT);
-	assert(state->alphaBlendOperator < BLEND_OPERATOR_COUNT);
-	assert(state->lineWidth > 0.0f);
-	assert(state->viewport.x >= 0);
-	assert(state->viewport.y >= 0);
-	assert(state->viewport.z >= 0);
-	assert(state->viewport.w >= 0);
-	assert(state->scissor.x >= 0);
-	assert(state->scissor.y >= 0);
-	assert(state->scissor.z >= 0);
-	assert(state->scissor.w >= 0);
-	assert(state->scissor.x + state->scissor.z <= framebuffer->base.size.x);
-	assert(state->scissor.y + state->scissor.w <= framebuffer->base.size.y);
-	assert(!framebuffer->base.window->isRecording);
-	assert(!framebuffer->base.isEnumerating);
-	assert(graphicsInitialized);
+			groupStart = groupEnd;
+		}
 
-#ifndef NDEBUG
-	for (size_t i = 0; i < shaderCount; i++)
+		// Waits only for own batches, other pool tasks
+		// can be compiling asynchronous pipelines.
+		for (size_t i = 0; i < batchCount; i++)
+		{
+			VkResult vkResult = runVkGraphicsPipelineBatch(batches[i]);
+
+			if (vkResult != VK_SUCCESS && mpgxResult == SUCCESS_MPGX_RESULT)
+				mpgxResult = vkToMpgxResult(vkResult);
+		}
+	}
+
+	for (size_t i = 0; i < infoCount; i++)
 	{
-		Shader shader = shaders[i];
+		GraphicsPipeline pipeline = pipelines[indices[i]];
+		pipeline->vk.vkHandle = handles[i];
+		pipeline->vk.isReady = true;
+		destroyVkGraphicsPipelineCreateInfo(&createInfoDatas[i]);
+	}
+
+	if (mpgxResult != SUCCESS_MPGX_RESULT)
+	{
+		for (size_t i = 0; i < infoCount; i++)
+			destroyVkGraphicsPipeline(device, pipelines[i]);
 
-		assert(shader->base.type == VERTEX_SHADER_TYPE ||
-			shader->base.type == FRAGMENT_SHADER_TYPE ||
-			shader->base.type == TESSELLATION_CONTROL_SHADER_TYPE ||
-			shader->base.type == TESSELLATION_EVALUATION_SHADER_TYPE ||
-			shader->base.type == GEOMETRY_SHADER_TYPE);
-		assert(shader->base.window == framebuffer->base.window);
+		free(data);
+		return mpgxResult;
 	}
-#endif
 
-	Window window = framebuffer->base.window;
+	for (size_t i = 0; i < infoCount; i++)
+	{
+		GraphicsPipeline pipeline = pipelines[i];
+		Framebuffer framebuffer = pipeline->vk.framebuffer;
+		framebuffer->vk.pipelines[framebuffer->vk.pipelineCount++] = pipeline;
+		graphicsPipelines[i] = pipeline;
+	}
 
-	MpgxResult mpgxResult;
-	GraphicsPipeline graphicsPipelineInstance;
+	free(data);
+	return SUCCESS_MPGX_RESULT;
+}
+#endif
+MpgxResult createGraphicsPipelines(
+	const GraphicsPipelineInfo* infos,
+	size_t infoCount,
+	GraphicsPipeline* graphicsPipelines)
+{
+	assert(infos);
+	assert(infoCount > 0);
+	assert(graphicsPipelines);
+	assert(!infos[0].framebuffer->base.window->isRecording);
+	assert(graphicsInitialized);
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		assert(createData);
-
-		mpgxResult = createVkGraphicsPipeline(
-			window->vkWindow->device,
-			createData,
-			framebuffer,
-			window,
-			name,
-			*state,
-			onBind,
-			onUniformsSet,
-			onResize,
-			onDestroy,
-			handle,
-			shaders,
-			shaderCount,
-			&graphicsPipelineInstance);
+		return createVkGraphicsPipelines(
+			infos,
+			infoCount,
+			graphicsPipelines);
 #else
 		abort();
 #endif
@@ -4065,24 +7735,37 @@ MpgxResult createGraphicsPipeline(
 	else if (graphicsAPI == OPENGL_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_OPENGL
-		assert(!createData);
+		// OpenGL programs are linked one by one
+		for (size_t i = 0; i < infoCount; i++)
+		{
+			const GraphicsPipelineInfo* info = &infos[i];
+
+			MpgxResult mpgxResult = createAnyGraphicsPipeline(
+				info->framebuffer,
+				info->name,
+				info->state,
+				info->onBind,
+				info->onUniformsSet,
+				info->onResize,
+				info->onDestroy,
+				NULL,
+				info->handle,
+				info->createData,
+				info->shaders,
+				info->shaderCount,
+				NULL,
+				false,
+				&graphicsPipelines[i]);
 
-		if (state->discardRasterizer)
-			return FORMAT_IS_NOT_SUPPORTED_MPGX_RESULT;
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+			{
+				for (size_t j = 0; j < i; j++)
+					destroyGraphicsPipeline(graphicsPipelines[j]);
+				return mpgxResult;
+			}
+		}
 
-		mpgxResult = createGlGraphicsPipeline(
-			framebuffer,
-			window,
-			name,
-			*state,
-			onBind,
-			onUniformsSet,
-			onResize,
-			onDestroy,
-			handle,
-			shaders,
-			shaderCount,
-			&graphicsPipelineInstance);
+		return SUCCESS_MPGX_RESULT;
 #else
 		abort();
 #endif
@@ -4091,65 +7774,27 @@ MpgxResult createGraphicsPipeline(
 	{
 		abort();
 	}
-
-	if (mpgxResult != SUCCESS_MPGX_RESULT)
-		return mpgxResult;
-
-	size_t count = framebuffer->base.pipelineCount;
-
-	if (count == framebuffer->base.pipelineCapacity)
-	{
-		size_t capacity = framebuffer->base.pipelineCapacity * 2;
-
-		GraphicsPipeline* pipelines = realloc(
-			framebuffer->base.pipelines,
-			sizeof(GraphicsPipeline) * capacity);
-
-		if (!pipelines)
-		{
-			if (graphicsAPI == VULKAN_GRAPHICS_API)
-			{
-#if MPGX_SUPPORT_VULKAN
-				destroyVkGraphicsPipeline(
-					window->vkWindow->device,
-					graphicsPipelineInstance);
-#else
-				abort();
-#endif
-			}
-			else
-			{
-#if MPGX_SUPPORT_OPENGL
-				destroyGlGraphicsPipeline(graphicsPipelineInstance);
-#else
-				abort();
-#endif
-			}
-
-			return OUT_OF_HOST_MEMORY_MPGX_RESULT;
-		}
-
-		framebuffer->base.pipelines = pipelines;
-		framebuffer->base.pipelineCapacity = capacity;
-	}
-
-	framebuffer->base.pipelines[count] = graphicsPipelineInstance;
-	framebuffer->base.pipelineCount = count + 1;
-
-	*graphicsPipeline = graphicsPipelineInstance;
-	return SUCCESS_MPGX_RESULT;
 }
 void destroyGraphicsPipeline(GraphicsPipeline pipeline)
 {
 	if (!pipeline)
 		return;
 
+	assert(pipeline->base.dependentCount == 0);
 	assert(!pipeline->base.window->isRecording);
 	assert(!pipeline->base.framebuffer->base.isEnumerating);
 	assert(graphicsInitialized);
 
 	Framebuffer framebuffer = pipeline->base.framebuffer;
 	Window window = framebuffer->base.window;
+	GraphicsPipeline fallback = pipeline->base.fallback;
+
+#if MPGX_SUPPORT_VULKAN
+	// Fast linked pipeline is ready, but still used by the optimized link task
+	if (graphicsAPI == VULKAN_GRAPHICS_API && pipeline->vk.taskCount > 0)
+		cancelVkGraphicsPipelineTasks(window, pipeline);
+#endif
+
 	size_t pipelineCount = framebuffer->base.pipelineCount;
 	GraphicsPipeline* pipelines = framebuffer->base.pipelines;
 
@@ -4195,6 +7840,9 @@ void destroyGraphicsPipeline(GraphicsPipeline pipeline)
 			pipelines[j - 1] = pipelines[j];
 
 		framebuffer->base.pipelineCount--;
+
+		if (fallback)
+			fallback->base.dependentCount--;
 		return;
 	}
 
@@ -4271,8 +7919,20 @@ Window getGraphicsPipelineWindow(GraphicsPipeline pipeline)
 	assert(graphicsInitialized);
 	return pipeline->base.window;
 }
+GraphicsPipeline getGraphicsPipelineFallback(GraphicsPipeline pipeline)
+{
+	assert(pipeline);
+	assert(graphicsInitialized);
+	return pipeline->base.fallback;
+}
+bool isGraphicsPipelineReady(GraphicsPipeline pipeline)
+{
+	assert(pipeline);
+	assert(graphicsInitialized);
+	return pipeline->base.isReady;
+}
 
-void bindGraphicsPipeline(GraphicsPipeline pipeline)
+MpgxResult bindGraphicsPipeline(GraphicsPipeline pipeline)
 {
 	assert(pipeline);
 	assert(pipeline->base.window->isRecording);
@@ -4280,6 +7940,18 @@ void bindGraphicsPipeline(GraphicsPipeline pipeline)
 		pipeline->base.window->renderFramebuffer);
 	assert(graphicsInitialized);
 
+	if (!pipeline->base.isReady)
+	{
+		// Failed pipeline never becomes ready
+		if (pipeline->base.compileResult != SUCCESS_MPGX_RESULT)
+			return pipeline->base.compileResult;
+
+		pipeline = pipeline->base.fallback;
+
+		if (!pipeline || !pipeline->base.isReady)
+			return SUCCESS_MPGX_RESULT;
+	}
+
 	Window window = pipeline->base.window;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
@@ -4303,6 +7975,8 @@ void bindGraphicsPipeline(GraphicsPipeline pipeline)
 	{
 		abort();
 	}
+
+	return SUCCESS_MPGX_RESULT;
 }
 
 MpgxResult createGraphicsMesh(
@@ -4701,6 +8375,17 @@ size_t drawGraphicsMesh(GraphicsPipeline pipeline, GraphicsMesh mesh)
 	assert(!mesh->base.vertexBuffer->base.isMapped);
 	assert(!mesh->base.indexBuffer->base.isMapped);
 
+	if (!pipeline->base.isReady)
+	{
+		if (pipeline->base.compileResult != SUCCESS_MPGX_RESULT)
+			return 0;
+
+		pipeline = pipeline->base.fallback;
+
+		if (!pipeline || !pipeline->base.isReady)
+			return 0;
+	}
+
 	Window window = mesh->base.window;
 
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
@@ -4729,6 +8414,43 @@ size_t drawGraphicsMesh(GraphicsPipeline pipeline, GraphicsMesh mesh)
 	return mesh->base.indexCount;
 }
 
+#if MPGX_SUPPORT_VULKAN
+static void destroyVkWindowComputePipeline(
+	Window window,
+	ComputePipeline computePipeline)
+{
+	assert(window);
+	assert(computePipeline);
+
+	VkComputePipelineEntry* entries = window->computePipelineEntries;
+	size_t entryCount = window->computePipelineEntryCount;
+	VkPipeline vkHandle = computePipeline->vk.vkHandle;
+
+	for (size_t i = 0; i < entryCount; i++)
+	{
+		VkComputePipelineEntry* entry = &entries[i];
+
+		if (entry->handle != vkHandle)
+			continue;
+
+		// Shared handle is destroyed with the last pipeline
+		if (--entry->refCount > 0)
+		{
+			computePipeline->vk.vkHandle = VK_NULL_HANDLE;
+			break;
+		}
+
+		free(entry->key);
+		entries[i] = entries[entryCount - 1];
+		window->computePipelineEntryCount = entryCount - 1;
+		break;
+	}
+
+	destroyVkComputePipeline(
+		window->vkWindow->device,
+		computePipeline);
+}
+#endif
 MpgxResult createComputePipeline(
 	Window window,
 	const char* name,
@@ -4756,18 +8478,111 @@ MpgxResult createComputePipeline(
 	if (graphicsAPI == VULKAN_GRAPHICS_API)
 	{
 #if MPGX_SUPPORT_VULKAN
-		assert(createData);
+		VkReflectedLayout reflectedLayout = NULL;
+		VkComputePipelineCreateData reflectedCreateData;
+
+		if (!createData)
+		{
+			mpgxResult = getVkShaderReflectedLayout(
+				window,
+				&shader,
+				1,
+				&reflectedLayout);
+
+			if (mpgxResult != SUCCESS_MPGX_RESULT)
+				return mpgxResult;
+
+			getVkReflectedComputeCreateData(
+				reflectedLayout,
+				&reflectedCreateData);
+			createData = &reflectedCreateData;
+		}
+
+		uint8_t* key;
+		size_t keySize;
+
+		mpgxResult = createVkComputePipelineKey(
+			shader,
+			createData,
+			&key,
+			&keySize);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+			return mpgxResult;
+
+		// Identical permutations share one pipeline handle,
+		// driver pipeline cache would still create a new one.
+		VkComputePipelineEntry* entries = window->computePipelineEntries;
+		size_t entryCount = window->computePipelineEntryCount;
+		size_t entryIndex = 0;
+
+		for (; entryIndex < entryCount; entryIndex++)
+		{
+			VkComputePipelineEntry* entry = &entries[entryIndex];
+
+			if (entry->keySize == keySize &&
+				memcmp(entry->key, key, keySize) == 0)
+			{
+				break;
+			}
+		}
+
+		if (entryIndex == entryCount &&
+			entryCount == window->computePipelineEntryCapacity)
+		{
+			size_t capacity = window->computePipelineEntryCapacity * 2;
+
+			entries = realloc(entries,
+				capacity * sizeof(VkComputePipelineEntry));
+
+			if (!entries)
+			{
+				free(key);
+				return OUT_OF_HOST_MEMORY_MPGX_RESULT;
+			}
+
+			window->computePipelineEntries = entries;
+			window->computePipelineEntryCapacity = capacity;
+		}
 
 		mpgxResult = createVkComputePipeline(
 			window->vkWindow->device,
+			window->vkWindow->pipelineCache,
 			createData,
+			reflectedLayout,
 			window,
 			name,
 			onBind,
 			onDestroy,
 			handle,
 			shader,
+			entryIndex < entryCount ?
+				entries[entryIndex].handle : VK_NULL_HANDLE,
 			&computePipelineInstance);
+
+		if (mpgxResult != SUCCESS_MPGX_RESULT)
+		{
+			free(key);
+			return mpgxResult;
+		}
+
+		if (entryIndex < entryCount)
+		{
+			entries[entryIndex].refCount++;
+			free(key);
+		}
+		else
+		{
+			VkComputePipelineEntry entry = {
+				key,
+				keySize,
+				computePipelineInstance->vk.vkHandle,
+				1,
+			};
+
+			entries[entryCount] = entry;
+			window->computePipelineEntryCount = entryCount + 1;
+		}
 #else
 		abort();
 #endif
@@ -4799,8 +8614,8 @@ MpgxResult createComputePipeline(
 			if (graphicsAPI == VULKAN_GRAPHICS_API)
 			{
 #if MPGX_SUPPORT_VULKAN
-				destroyVkComputePipeline(
-					window->vkWindow->device,
+				destroyVkWindowComputePipeline(
+					window,
 					computePipelineInstance);
 #else
 				abort();
@@ -4856,8 +8671,8 @@ void destroyComputePipeline(ComputePipeline pipeline)
 			if (result != VK_SUCCESS)
 				abort();
 
-			destroyVkComputePipeline(
-				vkWindow->device,
+			destroyVkWindowComputePipeline(
+				window,
 				pipeline);
 #else
 			abort();
@@ -5035,6 +8850,7 @@ MpgxResult createRayTracingPipeline(
 		mpgxResult = createVkRayTracingPipeline(
 			vkWindow->device,
 			vkWindow->allocator,
+			vkWindow->pipelineCache,
 			createData,
 			rayTracing,
 			name,
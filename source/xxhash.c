@@ -0,0 +1,208 @@
+/*
+ * xxHash - Extremely Fast Hash algorithm
+ * Copyright (C) 2012-2021 Yann Collet
+ *
+ * BSD 2-Clause License (https://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following disclaimer
+ *      in the documentation and/or other materials provided with the
+ *      distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at:
+ *   - xxHash homepage: https://www.xxhash.com
+ *   - xxHash source repository: https://github.com/Cyan4973/xxHash
+ */
+
+/*********************************************************************
+* Filename:   xxhash.c
+* Authors:    Yann Collet (xxHash algorithm), Nikita Fediuchin
+* Copyright:  2012-2021 Yann Collet, BSD 2-Clause License
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Implementation of the XXH64 hashing algorithm.
+				  Algorithm specification can be found here:
+				   * https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+				  This implementation uses little endian byte order.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <memory.h>
+#include "mpgx/xxhash.h"
+
+/****************************** MACROS ******************************/
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define ROTLEFT(a,b) ((a << b) | (a >> (64-b)))
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+inline static uint64_t xxh64_read64(const uint8_t data[])
+{
+	// Compilers turn it into a single unaligned load.
+	uint64_t value;
+	memcpy(&value, data, sizeof(uint64_t));
+	return value;
+}
+inline static uint32_t xxh64_read32(const uint8_t data[])
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(uint32_t));
+	return value;
+}
+
+inline static uint64_t xxh64_round(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * PRIME64_2;
+	accumulator = ROTLEFT(accumulator, 31);
+	return accumulator * PRIME64_1;
+}
+inline static uint64_t xxh64_merge_round(uint64_t accumulator, uint64_t value)
+{
+	accumulator ^= xxh64_round(0, value);
+	return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+inline static void xxh64_transform(uint64_t state[], const uint8_t data[])
+{
+	// Four independent lanes keep the CPU pipeline busy.
+	state[0] = xxh64_round(state[0], xxh64_read64(data));
+	state[1] = xxh64_round(state[1], xxh64_read64(data + 8));
+	state[2] = xxh64_round(state[2], xxh64_read64(data + 16));
+	state[3] = xxh64_round(state[3], xxh64_read64(data + 24));
+}
+
+void xxh64_init(XXH64_CONTEXT* context, uint64_t seed)
+{
+	context->state[0] = seed + PRIME64_1 + PRIME64_2;
+	context->state[1] = seed + PRIME64_2;
+	context->state[2] = seed;
+	context->state[3] = seed - PRIME64_1;
+	context->totalLength = 0;
+	context->dataLength = 0;
+}
+
+void xxh64_update(XXH64_CONTEXT* context, const uint8_t data[], size_t length)
+{
+	context->totalLength += length;
+
+	// Fill the partially filled stripe first.
+	if (context->dataLength > 0)
+	{
+		size_t fillLength = XXH64_STRIPE_SIZE - context->dataLength;
+
+		if (length < fillLength)
+		{
+			memcpy(context->data + context->dataLength, data, length);
+			context->dataLength += (uint32_t)length;
+			return;
+		}
+
+		memcpy(context->data + context->dataLength, data, fillLength);
+		xxh64_transform(context->state, context->data);
+
+		data += fillLength;
+		length -= fillLength;
+		context->dataLength = 0;
+	}
+
+	while (length >= XXH64_STRIPE_SIZE)
+	{
+		xxh64_transform(context->state, data);
+		data += XXH64_STRIPE_SIZE;
+		length -= XXH64_STRIPE_SIZE;
+	}
+
+	if (length > 0)
+	{
+		memcpy(context->data, data, length);
+		context->dataLength = (uint32_t)length;
+	}
+}
+
+uint64_t xxh64_final(const XXH64_CONTEXT* context)
+{
+	const uint64_t* state = context->state;
+	uint64_t hash;
+
+	if (context->totalLength >= XXH64_STRIPE_SIZE)
+	{
+		hash = ROTLEFT(state[0], 1) + ROTLEFT(state[1], 7) +
+			ROTLEFT(state[2], 12) + ROTLEFT(state[3], 18);
+		hash = xxh64_merge_round(hash, state[0]);
+		hash = xxh64_merge_round(hash, state[1]);
+		hash = xxh64_merge_round(hash, state[2]);
+		hash = xxh64_merge_round(hash, state[3]);
+	}
+	else
+	{
+		// State[2] holds the unmodified seed value.
+		hash = state[2] + PRIME64_5;
+	}
+
+	hash += context->totalLength;
+
+	const uint8_t* data = context->data;
+	size_t length = context->dataLength;
+
+	// Consume whatever data is left in the buffer.
+	while (length >= 8)
+	{
+		hash ^= xxh64_round(0, xxh64_read64(data));
+		hash = ROTLEFT(hash, 27) * PRIME64_1 + PRIME64_4;
+		data += 8;
+		length -= 8;
+	}
+
+	if (length >= 4)
+	{
+		hash ^= (uint64_t)xxh64_read32(data) * PRIME64_1;
+		hash = ROTLEFT(hash, 23) * PRIME64_2 + PRIME64_3;
+		data += 4;
+		length -= 4;
+	}
+
+	while (length > 0)
+	{
+		hash ^= (*data) * PRIME64_5;
+		hash = ROTLEFT(hash, 11) * PRIME64_1;
+		data++;
+		length--;
+	}
+
+	// Final avalanche mixes all bits of the hash.
+	hash ^= hash >> 33;
+	hash *= PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= PRIME64_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+uint64_t xxh64(const uint8_t data[], size_t length, uint64_t seed)
+{
+	XXH64_CONTEXT context;
+	xxh64_init(&context, seed);
+	xxh64_update(&context, data, length);
+	return xxh64_final(&context);
+}